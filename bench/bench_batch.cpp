@@ -0,0 +1,54 @@
+#include "bench_harness.hpp"
+
+#include "batch_mode.hpp"
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+// Cost per --batch request: one request answered on the calling thread, and
+// streams of requests answered by run_batch() with one and four workers. An
+// iteration is one request, so ns_per_op of the streams is the inverse of
+// their throughput.
+
+namespace {
+
+constexpr const char *kRequest =
+    "server_port = 3990\\nplayer_name = Batch Bot\\ngame_type = invite\\ninvite_code = +BATCH01\\n"
+    "advertised_grfs = 4D4D0001,4D4D0002,4D4D0003,4D4D0004\\nheartbeat_interval = 45"
+    "\t--headless\t--coordinator\tcoordinator.example.org:3976";
+
+void run_stream(std::size_t iterations, std::size_t workers) {
+    std::string input;
+    input.reserve(iterations * (std::char_traits<char>::length(kRequest) + 1));
+    for (std::size_t index = 0; index < iterations; ++index) {
+        input.append(kRequest).push_back('\n');
+    }
+    std::istringstream in{std::move(input)};
+    std::ostringstream out;
+    sotc::BatchOptions options{};
+    options.workers = workers;
+    const auto stats = sotc::run_batch(in, out, {}, options);
+    sotc::bench::do_not_optimize(stats);
+    sotc::bench::do_not_optimize(out);
+}
+
+} // namespace
+
+SOTC_BENCHMARK(batch_write_response) {
+    const sotc::LaunchOptions defaults{};
+    std::ostringstream out;
+    for (std::size_t index = 0; index < iterations; ++index) {
+        out.str({});
+        const bool success = sotc::write_batch_response(index + 1, kRequest, defaults, out);
+        sotc::bench::do_not_optimize(success);
+    }
+}
+
+SOTC_BENCHMARK(batch_stream_1_worker) {
+    run_stream(iterations, 1);
+}
+
+SOTC_BENCHMARK(batch_stream_4_workers) {
+    run_stream(iterations, 4);
+}
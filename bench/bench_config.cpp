@@ -0,0 +1,229 @@
+#include "bench_harness.hpp"
+
+#include "launch_config.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// Configuration file loading, from a hand-written file to a generated fleet
+// definition with thousands of hosted servers, and profile files of 1, 10 and
+// 100 MB: the profile loader is a single pass, so time per file should grow
+// linearly with its size. The 255-NewGRF fleets count what each profile's
+// copy of the list costs.
+
+namespace {
+
+// Writes a configuration file once and removes it when the process exits.
+class ConfigFixture {
+public:
+    ConfigFixture(const std::string &name, std::size_t hosted_servers, std::size_t grf_count)
+        : path_(std::filesystem::temp_directory_path() / name) {
+        std::ofstream output{path_};
+        output << "# Generated by sotc_bench\n"
+               << "server_host = bench.example.org\n"
+               << "server_port = 3979\n"
+               << "player_name = Benchmark\n"
+               << "headless = yes\n"
+               << "coordinator_host = coordinator.example.org\n"
+               << "coordinator_port = 3976\n"
+               << "game_type = invite\n"
+               << "invite_code = +BENCH01\n"
+               << "listed_publicly = false\n"
+               << "allow_direct = on\n"
+               << "allow_stun = on\n"
+               << "allow_turn = off\n"
+               << "heartbeat_interval = 45\n"
+               << "register_with_coordinator = true\n"
+               << "advertised_grfs = ";
+        for (std::size_t index = 0; index < grf_count; ++index) {
+            output << (index == 0 ? "" : ", ") << "4D4D" << 100000 + index;
+        }
+        output << '\n';
+        for (std::size_t index = 0; index < hosted_servers; ++index) {
+            output << "\n; server " << index << '\n'
+                   << "hosted_server = " << 4000 + index % 60000 << ",name=Fleet server " << index
+                   << ",game_type=public,heartbeat=" << 30 + index % 30 << ",direct=on,stun=off\n";
+        }
+        if (!output) {
+            throw std::runtime_error{"failed to write benchmark configuration " + path_.string()};
+        }
+    }
+
+    ~ConfigFixture() {
+        std::error_code ignored;
+        std::filesystem::remove(path_, ignored);
+    }
+
+    ConfigFixture(const ConfigFixture &) = delete;
+    ConfigFixture &operator=(const ConfigFixture &) = delete;
+
+    [[nodiscard]] std::string path() const { return path_.string(); }
+
+private:
+    std::filesystem::path path_;
+};
+
+// A generated file of [profile] sections, each with its own port, name and a
+// few hosted servers, grown until it reaches the requested size.
+class ProfileFixture {
+public:
+    ProfileFixture(const std::string &name, std::size_t megabytes)
+        : path_(std::filesystem::temp_directory_path() / name) {
+        std::ofstream output{path_, std::ios::binary};
+        output << "# Generated by sotc_bench\n"
+               << "coordinator_host = coordinator.example.org\n"
+               << "headless = yes\n"
+               << "game_type = public\n"
+               << "heartbeat_interval = 45\n";
+        const std::size_t target = megabytes * 1024 * 1024;
+        for (std::size_t index = 0; static_cast<std::size_t>(output.tellp()) < target; ++index) {
+            output << "\n[fleet-" << index << "]\n"
+                   << "server_port = " << 4000 + index % 60000 << '\n'
+                   << "player_name = Fleet operator " << index << '\n'
+                   << "invite_code = +F" << index << '\n';
+            for (std::size_t server = 0; server < 4; ++server) {
+                output << "hosted_server = " << 4000 + (index * 4 + server) % 60000 << ",name=Fleet server " << index
+                       << '-' << server << ",heartbeat=" << 30 + server << ",stun=off\n";
+            }
+            last_profile_ = "fleet-" + std::to_string(index);
+        }
+        if (!output) {
+            throw std::runtime_error{"failed to write benchmark configuration " + path_.string()};
+        }
+    }
+
+    ~ProfileFixture() {
+        std::error_code ignored;
+        std::filesystem::remove(path_, ignored);
+    }
+
+    ProfileFixture(const ProfileFixture &) = delete;
+    ProfileFixture &operator=(const ProfileFixture &) = delete;
+
+    [[nodiscard]] std::string path() const { return path_.string(); }
+    [[nodiscard]] const std::string &last_profile() const noexcept { return last_profile_; }
+
+private:
+    std::filesystem::path path_;
+    std::string last_profile_{};
+};
+
+// 255 advertised NewGRFs and many profiles that either inherit them from the
+// top level or repeat the same list, as generated fleet files do.
+class GrfProfileFixture {
+public:
+    GrfProfileFixture(const std::string &name, std::size_t profiles, bool repeat_grfs)
+        : path_(std::filesystem::temp_directory_path() / name) {
+        std::string grfs;
+        for (std::size_t index = 0; index < 255; ++index) {
+            if (index != 0) {
+                grfs.push_back(',');
+            }
+            grfs += std::to_string(0x4D4D0000 + index);
+        }
+        std::ofstream output{path_, std::ios::binary};
+        output << "# Generated by sotc_bench\n"
+               << "coordinator_host = coordinator.example.org\n"
+               << "advertised_grfs = " << grfs << '\n';
+        for (std::size_t index = 0; index < profiles; ++index) {
+            output << "\n[fleet-" << index << "]\n"
+                   << "server_port = " << 4000 + index % 60000 << '\n';
+            if (repeat_grfs) {
+                output << "advertised_grfs = " << grfs << '\n';
+            }
+        }
+        if (!output) {
+            throw std::runtime_error{"failed to write benchmark configuration " + path_.string()};
+        }
+    }
+
+    ~GrfProfileFixture() {
+        std::error_code ignored;
+        std::filesystem::remove(path_, ignored);
+    }
+
+    GrfProfileFixture(const GrfProfileFixture &) = delete;
+    GrfProfileFixture &operator=(const GrfProfileFixture &) = delete;
+
+    [[nodiscard]] std::string path() const { return path_.string(); }
+
+private:
+    std::filesystem::path path_;
+};
+
+template <typename Fixture>
+void load_profiles(const Fixture &fixture, std::size_t iterations) {
+    const auto path = fixture.path();
+    for (std::size_t index = 0; index < iterations; ++index) {
+        sotc::LaunchOptions base{};
+        std::vector<sotc::ConfigProfile> profiles;
+        const bool loaded = sotc::load_config_profiles(path, base, profiles);
+        sotc::bench::do_not_optimize(loaded);
+        sotc::bench::do_not_optimize(profiles);
+    }
+}
+
+void load(const ConfigFixture &fixture, std::size_t iterations) {
+    const auto path = fixture.path();
+    for (std::size_t index = 0; index < iterations; ++index) {
+        sotc::LaunchOptions options{};
+        const bool loaded = sotc::load_config_file(path, options);
+        sotc::bench::do_not_optimize(loaded);
+        sotc::bench::do_not_optimize(options);
+    }
+}
+
+} // namespace
+
+SOTC_BENCHMARK(load_config_file_typical) {
+    static const ConfigFixture fixture{"sotc_bench_typical.cfg", 0, 8};
+    load(fixture, iterations);
+}
+
+SOTC_BENCHMARK(load_config_file_5000_hosted_servers) {
+    static const ConfigFixture fixture{"sotc_bench_fleet.cfg", 5000, 255};
+    load(fixture, iterations);
+}
+
+SOTC_BENCHMARK(load_config_profiles_1mb) {
+    static const ProfileFixture fixture{"sotc_bench_profiles_1mb.cfg", 1};
+    load_profiles(fixture, iterations);
+}
+
+SOTC_BENCHMARK(load_config_profiles_10mb) {
+    static const ProfileFixture fixture{"sotc_bench_profiles_10mb.cfg", 10};
+    load_profiles(fixture, iterations);
+}
+
+SOTC_BENCHMARK(load_config_profiles_100mb) {
+    static const ProfileFixture fixture{"sotc_bench_profiles_100mb.cfg", 100};
+    load_profiles(fixture, iterations);
+}
+
+// The per-op byte count is what 1000 profiles keep alive.
+SOTC_BENCHMARK(load_config_profiles_255_grfs_1000_inherited) {
+    static const GrfProfileFixture fixture{"sotc_bench_grf_profiles_inherited.cfg", 1000, false};
+    load_profiles(fixture, iterations);
+}
+
+SOTC_BENCHMARK(load_config_profiles_255_grfs_1000_repeated) {
+    static const GrfProfileFixture fixture{"sotc_bench_grf_profiles_repeated.cfg", 1000, true};
+    load_profiles(fixture, iterations);
+}
+
+// Tokenizes all 100 MB but applies only the last profile.
+SOTC_BENCHMARK(load_config_file_last_profile_100mb) {
+    static const ProfileFixture fixture{"sotc_bench_profiles_100mb_select.cfg", 100};
+    const auto path = fixture.path();
+    for (std::size_t index = 0; index < iterations; ++index) {
+        sotc::LaunchOptions options{};
+        const bool loaded = sotc::load_config_file(path, options, fixture.last_profile());
+        sotc::bench::do_not_optimize(loaded);
+        sotc::bench::do_not_optimize(options);
+    }
+}
@@ -0,0 +1,134 @@
+#include "bench_harness.hpp"
+
+#include "network/coordinator_client.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using sotc::network::CoordinatorHandshakeFrame;
+using sotc::network::CoordinatorHandshakeFrameView;
+
+using Corpus = std::vector<std::vector<std::byte>>;
+
+constexpr std::size_t kCorpusSize = 1024;
+
+[[nodiscard]] std::vector<std::byte> make_payload(std::size_t grf_count) {
+    CoordinatorHandshakeFrame frame{};
+    frame.server_name = "Benchmark Fleet Server";
+    frame.invite_code = "+BENCH01";
+    std::vector<std::string> grfs;
+    for (std::size_t index = 0; index < grf_count; ++index) {
+        grfs.push_back("4D4D" + std::to_string(100000 + index));
+    }
+    frame.newgrfs = sotc::network::GrfList{std::move(grfs)};
+    return frame.serialize();
+}
+
+// Mixes the malformed shapes seen from misbehaving peers: truncation, bogus
+// string lengths and GRF counts, trailing junk and random bit flips.
+[[nodiscard]] Corpus make_corrupted_corpus() {
+    std::mt19937 rng{0x50746364U};
+    const auto base = make_payload(62);
+
+    Corpus corpus;
+    corpus.reserve(kCorpusSize);
+    for (std::size_t index = 0; index < kCorpusSize; ++index) {
+        auto payload = base;
+        switch (index % 5) {
+        case 0:
+            payload.resize(std::uniform_int_distribution<std::size_t>{0, payload.size() - 1}(rng));
+            break;
+        case 1:
+            payload[10] = std::byte{0xFF};
+            payload[11] = std::byte{0xFF};
+            break;
+        case 2:
+            payload.insert(payload.end(), 1 + index % 16, std::byte{0xAB});
+            break;
+        case 3: {
+            const auto position = std::uniform_int_distribution<std::size_t>{0, payload.size() - 1}(rng);
+            payload[position] ^= std::byte{static_cast<unsigned char>(1U << (index % 8))};
+            payload.pop_back();
+            break;
+        }
+        default:
+            for (auto &byte : payload) {
+                byte = static_cast<std::byte>(rng() & 0xFFU);
+            }
+            break;
+        }
+        corpus.push_back(std::move(payload));
+    }
+    return corpus;
+}
+
+[[nodiscard]] const Corpus &corrupted_corpus() {
+    static const Corpus corpus = make_corrupted_corpus();
+    return corpus;
+}
+
+[[nodiscard]] const std::vector<std::byte> &valid_payload() {
+    static const auto payload = make_payload(62);
+    return payload;
+}
+
+} // namespace
+
+SOTC_BENCHMARK(decode_corrupted_throwing_deserialize) {
+    const auto &corpus = corrupted_corpus();
+    std::size_t failures = 0;
+    for (std::size_t index = 0; index < iterations; ++index) {
+        try {
+            auto frame = CoordinatorHandshakeFrame::deserialize(corpus[index % corpus.size()]);
+            sotc::bench::do_not_optimize(frame);
+        } catch (const std::exception &) {
+            ++failures;
+        }
+    }
+    sotc::bench::do_not_optimize(failures);
+}
+
+SOTC_BENCHMARK(decode_corrupted_try_deserialize) {
+    const auto &corpus = corrupted_corpus();
+    std::size_t failures = 0;
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto result = CoordinatorHandshakeFrame::try_deserialize(corpus[index % corpus.size()]);
+        failures += result.has_value() ? 0U : 1U;
+        sotc::bench::do_not_optimize(result);
+    }
+    sotc::bench::do_not_optimize(failures);
+}
+
+SOTC_BENCHMARK(decode_corrupted_view_try_parse) {
+    const auto &corpus = corrupted_corpus();
+    std::size_t failures = 0;
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto result = CoordinatorHandshakeFrameView::try_parse(corpus[index % corpus.size()]);
+        failures += result.has_value() ? 0U : 1U;
+        sotc::bench::do_not_optimize(result);
+    }
+    sotc::bench::do_not_optimize(failures);
+}
+
+SOTC_BENCHMARK(decode_valid_62_grfs_deserialize) {
+    const auto &payload = valid_payload();
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto frame = CoordinatorHandshakeFrame::deserialize(payload);
+        sotc::bench::do_not_optimize(frame);
+    }
+}
+
+SOTC_BENCHMARK(decode_valid_62_grfs_try_deserialize) {
+    const auto &payload = valid_payload();
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto result = CoordinatorHandshakeFrame::try_deserialize(payload);
+        sotc::bench::do_not_optimize(result);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace sotc::bench {
+
+// A benchmark body runs its measured operation `iterations` times.
+using BenchmarkBody = std::function<void(std::size_t iterations)>;
+
+struct Benchmark {
+    std::string name;
+    BenchmarkBody body;
+};
+
+inline std::vector<Benchmark> &registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+struct Registrar {
+    Registrar(std::string name, BenchmarkBody body) {
+        registry().push_back(Benchmark{std::move(name), std::move(body)});
+    }
+};
+
+// Keeps the optimiser from discarding a computed value.
+template <typename T>
+inline void do_not_optimize(const T &value) {
+#if defined(_MSC_VER)
+    static const void *volatile sink = nullptr;
+    sink = &value;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+} // namespace sotc::bench
+
+#define SOTC_BENCH_CONCAT_INNER(a, b) a##b
+#define SOTC_BENCH_CONCAT(a, b) SOTC_BENCH_CONCAT_INNER(a, b)
+
+#define SOTC_BENCHMARK(name)                                                                     \
+    static void name(std::size_t iterations);                                                    \
+    static const ::sotc::bench::Registrar SOTC_BENCH_CONCAT(name, _registrar){#name, &name};     \
+    static void name(std::size_t iterations)
@@ -0,0 +1,312 @@
+#include "bench_harness.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Every allocation made by the process, so benchmarks also report how many
+// allocations and bytes one operation costs.
+std::atomic<std::size_t> g_allocations{0};
+std::atomic<std::size_t> g_allocated_bytes{0};
+
+[[nodiscard]] void *counted_allocation(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+    return counted_allocation(size);
+}
+
+void *operator new[](std::size_t size) {
+    return counted_allocation(size);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+
+struct Measurement {
+    std::string name;
+    std::size_t iterations{0};
+    double nanoseconds_per_op{0.0};
+    double allocations_per_op{0.0};
+    double bytes_per_op{0.0};
+};
+
+struct Options {
+    std::string filter;
+    bool json{false};
+    std::string baseline;
+    double tolerance{0.25};
+    std::size_t repetitions{1};
+    std::chrono::milliseconds min_time{200};
+};
+
+[[nodiscard]] Measurement measure_once(const sotc::bench::Benchmark &benchmark, std::chrono::milliseconds min_time) {
+    using clock = std::chrono::steady_clock;
+
+    // Grow the iteration count until a single run lasts long enough to time.
+    std::size_t iterations = 1;
+    bool first_run = true;
+    while (true) {
+        const auto allocations = g_allocations.load(std::memory_order_relaxed);
+        const auto bytes = g_allocated_bytes.load(std::memory_order_relaxed);
+        const auto start = clock::now();
+        benchmark.body(iterations);
+        const auto elapsed = clock::now() - start;
+        // The first run also builds the benchmark's static fixtures; when it
+        // is already long enough on its own, time it again without them.
+        if (first_run && elapsed >= min_time) {
+            first_run = false;
+            continue;
+        }
+        first_run = false;
+        if (elapsed >= min_time || iterations >= (std::size_t{1} << 30)) {
+            const auto nanoseconds = std::chrono::duration<double, std::nano>(elapsed).count();
+            const auto count = static_cast<double>(iterations);
+            return Measurement{
+                benchmark.name,
+                iterations,
+                nanoseconds / count,
+                static_cast<double>(g_allocations.load(std::memory_order_relaxed) - allocations) / count,
+                static_cast<double>(g_allocated_bytes.load(std::memory_order_relaxed) - bytes) / count,
+            };
+        }
+        iterations *= elapsed < min_time / 10 ? std::size_t{10} : std::size_t{2};
+    }
+}
+
+// Keeps the fastest repetition; slower ones are dominated by scheduler noise.
+[[nodiscard]] Measurement measure(const sotc::bench::Benchmark &benchmark, const Options &options) {
+    auto best = measure_once(benchmark, options.min_time);
+    for (std::size_t repetition = 1; repetition < options.repetitions; ++repetition) {
+        const auto next = measure_once(benchmark, options.min_time);
+        if (next.nanoseconds_per_op < best.nanoseconds_per_op) {
+            best = next;
+        }
+    }
+    return best;
+}
+
+void print_usage() {
+    std::cout << "sotc_bench usage:\n"
+              << "  sotc_bench [options]\n\n"
+              << "Options:\n"
+              << "  -h, --help            Show this help message.\n"
+              << "      --filter TEXT     Only run benchmarks whose name contains TEXT.\n"
+              << "      --json            Write results as JSON (the baseline format) to stdout.\n"
+              << "      --baseline FILE   Compare against a JSON baseline and exit with status 2\n"
+              << "                        if any benchmark is slower than allowed.\n"
+              << "      --tolerance F     Allowed slowdown as a fraction of the baseline (default 0.25).\n"
+              << "      --repetitions N   Run each benchmark N times and keep the fastest (default 1).\n"
+              << "      --min-time MS     Minimum duration of one timed run (default 200).\n";
+}
+
+[[nodiscard]] std::string json_escape(std::string_view value) {
+    std::string escaped;
+    for (const char c : value) {
+        if (c == '"' || c == '\\') {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+
+void write_json(std::ostream &output, const std::vector<Measurement> &results) {
+    output << "{\n  \"benchmarks\": [";
+    for (std::size_t index = 0; index < results.size(); ++index) {
+        const auto &result = results[index];
+        output << (index == 0 ? "\n" : ",\n") << "    {\"name\": \"" << json_escape(result.name)
+               << "\", \"iterations\": " << result.iterations << ", \"ns_per_op\": " << std::fixed
+               << std::setprecision(3) << result.nanoseconds_per_op << ", \"allocs_per_op\": " << std::setprecision(1)
+               << result.allocations_per_op << ", \"bytes_per_op\": " << result.bytes_per_op << '}';
+    }
+    output << "\n  ]\n}\n";
+}
+
+void write_table_header(std::ostream &output) {
+    output << std::left << std::setw(56) << "benchmark" << std::right << std::setw(14) << "iterations"
+           << std::setw(14) << "ns/op" << std::setw(12) << "allocs/op" << std::setw(14) << "bytes/op" << '\n';
+}
+
+void write_table_row(std::ostream &output, const Measurement &result) {
+    output << std::left << std::setw(56) << result.name << std::right << std::setw(14) << result.iterations
+           << std::setw(14) << std::fixed << std::setprecision(1) << result.nanoseconds_per_op << std::setw(12)
+           << result.allocations_per_op << std::setw(14) << result.bytes_per_op << std::endl;
+}
+
+// Reads the name/ns_per_op pairs back from a file written by --json. Only that
+// layout is understood; it is not a general JSON parser.
+[[nodiscard]] std::optional<std::unordered_map<std::string, double>> read_baseline(const std::string &path) {
+    std::ifstream input{path};
+    if (!input) {
+        return std::nullopt;
+    }
+    std::ostringstream buffer;
+    buffer << input.rdbuf();
+    const auto text = buffer.str();
+
+    constexpr std::string_view name_key{"\"name\": \""};
+    constexpr std::string_view time_key{"\"ns_per_op\": "};
+    std::unordered_map<std::string, double> baseline;
+    std::size_t position = 0;
+    while ((position = text.find(name_key, position)) != std::string::npos) {
+        position += name_key.size();
+        std::string name;
+        while (position < text.size() && text[position] != '"') {
+            if (text[position] == '\\' && position + 1 < text.size()) {
+                ++position;
+            }
+            name.push_back(text[position++]);
+        }
+        const auto time = text.find(time_key, position);
+        if (time == std::string::npos) {
+            return std::nullopt;
+        }
+        position = time + time_key.size();
+        baseline[name] = std::strtod(text.c_str() + position, nullptr);
+    }
+    return baseline;
+}
+
+// Reports every result against the baseline on stderr and returns false if
+// any benchmark regressed past the tolerance. Benchmarks missing from the
+// baseline are listed but never fail the comparison.
+[[nodiscard]] bool compare_with_baseline(const std::vector<Measurement> &results,
+                                         const std::unordered_map<std::string, double> &baseline,
+                                         double tolerance) {
+    bool within = true;
+    for (const auto &result : results) {
+        const auto found = baseline.find(result.name);
+        if (found == baseline.end() || found->second <= 0.0) {
+            std::cerr << "new        " << result.name << '\n';
+            continue;
+        }
+        const auto ratio = result.nanoseconds_per_op / found->second;
+        const bool regressed = ratio > 1.0 + tolerance;
+        within = within && !regressed;
+        std::cerr << (regressed ? "REGRESSED  " : "ok         ") << result.name << ' ' << std::fixed
+                  << std::setprecision(2) << ratio << "x baseline\n";
+    }
+    return within;
+}
+
+[[nodiscard]] bool parse_arguments(int argc, char **argv, Options &options, bool &show_help) {
+    for (int index = 1; index < argc; ++index) {
+        const std::string_view current{argv[index]};
+        if (current == "-h" || current == "--help") {
+            show_help = true;
+            return true;
+        }
+        if (current == "--json") {
+            options.json = true;
+            continue;
+        }
+        if (index + 1 >= argc) {
+            std::cerr << "Unknown option or missing value: " << current << '\n';
+            return false;
+        }
+        const std::string value{argv[++index]};
+        char *end = nullptr;
+        if (current == "--filter") {
+            options.filter = value;
+        } else if (current == "--baseline") {
+            options.baseline = value;
+        } else if (current == "--tolerance") {
+            options.tolerance = std::strtod(value.c_str(), &end);
+        } else if (current == "--repetitions") {
+            options.repetitions = std::max<std::size_t>(1, std::strtoull(value.c_str(), &end, 10));
+        } else if (current == "--min-time") {
+            options.min_time = std::chrono::milliseconds{std::strtoll(value.c_str(), &end, 10)};
+        } else {
+            std::cerr << "Unknown option: " << current << '\n';
+            return false;
+        }
+        if (end != nullptr && (*end != '\0' || end == value.c_str())) {
+            std::cerr << "Invalid value for " << current << ": " << value << '\n';
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options{};
+    bool show_help = false;
+    if (!parse_arguments(argc, argv, options, show_help)) {
+        return 1;
+    }
+    if (show_help) {
+        print_usage();
+        return 0;
+    }
+
+    std::optional<std::unordered_map<std::string, double>> baseline;
+    if (!options.baseline.empty()) {
+        baseline = read_baseline(options.baseline);
+        if (!baseline) {
+            std::cerr << "Unable to read baseline " << options.baseline << '\n';
+            return 1;
+        }
+    }
+
+    if (!options.json) {
+        write_table_header(std::cout);
+    }
+    std::vector<Measurement> results;
+    for (const auto &benchmark : sotc::bench::registry()) {
+        if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        results.push_back(measure(benchmark, options));
+        if (!options.json) {
+            write_table_row(std::cout, results.back());
+        }
+    }
+
+    if (options.json) {
+        write_json(std::cout, results);
+    }
+    if (baseline && !compare_with_baseline(results, *baseline, options.tolerance)) {
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "bench_harness.hpp"
+
+#include "network/newgrf_set.hpp"
+#include "network/server_index.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+using namespace sotc::network;
+
+constexpr std::size_t kServers = 5000;
+constexpr std::uint32_t kGrfPool = 4000;
+
+[[nodiscard]] NewGrfIdentity pool_grf(std::uint32_t index) {
+    NewGrfIdentity identity{};
+    identity.grfid = 0x4D4D0000U + index * 2654435761U % kGrfPool;
+    identity.md5[0] = static_cast<std::uint8_t>(index);
+    identity.md5[15] = static_cast<std::uint8_t>(index >> 8U);
+    return identity;
+}
+
+// Every server advertises the NETWORK_MAX_GRF_COUNT maximum drawn from a
+// shared pool; most are popular sets, so plenty of servers are joinable.
+[[nodiscard]] std::vector<ServerListingEntry> make_listing() {
+    std::vector<ServerListingEntry> listing(kServers);
+    for (std::size_t server = 0; server < kServers; ++server) {
+        auto &entry = listing[server];
+        entry.connection_string = "192.0.2." + std::to_string(server % 250 + 1) + ':' + std::to_string(3979 + server);
+        entry.info.server_name = "Bench server " + std::to_string(server);
+        entry.info.newgrfs.reserve(NETWORK_MAX_GRF_COUNT);
+        for (std::size_t grf = 0; grf < NETWORK_MAX_GRF_COUNT; ++grf) {
+            const auto popular = static_cast<std::uint32_t>(grf * 7 % 1000);
+            const auto rare = static_cast<std::uint32_t>(1000 + (server * 131 + grf * 17) % (kGrfPool - 1000));
+            entry.info.newgrfs.push_back(pool_grf(server % 4 == 0 && grf == 0 ? rare : popular));
+        }
+    }
+    return listing;
+}
+
+// The popular sets plus every other rare one.
+[[nodiscard]] NewGrfSet make_installed() {
+    std::vector<NewGrfIdentity> installed;
+    for (std::uint32_t index = 0; index < kGrfPool; ++index) {
+        if (index < 1000 || index % 2 == 0) {
+            installed.push_back(pool_grf(index));
+        }
+    }
+    return NewGrfSet{std::move(installed)};
+}
+
+} // namespace
+
+SOTC_BENCHMARK(newgrf_joinable_index_5000x255) {
+    const auto listing = make_listing();
+    ServerIndex index;
+    index.reserve(listing.size());
+    for (const auto &entry : listing) {
+        index.add(entry);
+    }
+    const auto installed = make_installed();
+    for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        auto selection = index.joinable(installed);
+        sotc::bench::do_not_optimize(selection);
+    }
+}
+
+SOTC_BENCHMARK(newgrf_joinable_per_server_merge_5000x255) {
+    // Each server's list sorted once, then one merge against the installed set.
+    std::vector<NewGrfSet> servers;
+    for (const auto &entry : make_listing()) {
+        servers.emplace_back(entry.info.newgrfs);
+    }
+    const auto installed = make_installed();
+    for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        std::size_t joinable = 0;
+        for (const auto &server : servers) {
+            joinable += installed.includes(server) ? 1U : 0U;
+        }
+        sotc::bench::do_not_optimize(joinable);
+    }
+}
+
+SOTC_BENCHMARK(newgrf_joinable_hash_probe_5000x255) {
+    // Reference point: every advertised NewGRF looked up in a hash set.
+    const auto listing = make_listing();
+    const auto identities = make_installed().identities();
+    const std::unordered_set<NewGrfIdentity, NewGrfIdentityHash> installed{identities.begin(), identities.end()};
+    for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        std::size_t joinable = 0;
+        for (const auto &entry : listing) {
+            bool all = true;
+            for (const auto &identity : entry.info.newgrfs) {
+                all = all && installed.contains(identity);
+            }
+            joinable += all ? 1U : 0U;
+        }
+        sotc::bench::do_not_optimize(joinable);
+    }
+}
@@ -0,0 +1,100 @@
+#include "bench_harness.hpp"
+
+#include "client_app.hpp"
+#include "gui/coordinator_settings_window.hpp"
+#include "launch_config.hpp"
+#include "network/coordinator_client.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Per-heartbeat cost of producing the SERVER_UPDATE payload: rebuilding the
+// frame from RegistrationConfig versus reconciling a cached serialised frame.
+// Also the path from launch options to everything derived from them: the
+// registration, its cached frame and the settings window state.
+
+namespace {
+
+using sotc::network::CachedRegistrationFrame;
+using sotc::network::CoordinatorClient;
+using sotc::network::RegistrationConfig;
+
+[[nodiscard]] RegistrationConfig make_config(std::size_t grf_count) {
+    RegistrationConfig config{};
+    config.server_name = "Benchmark Fleet Server";
+    config.invite_code = "+BENCH01";
+    std::vector<std::string> grfs;
+    for (std::size_t index = 0; index < grf_count; ++index) {
+        grfs.push_back("4D4D" + std::to_string(100000 + index));
+    }
+    config.advertised_grfs = sotc::network::GrfList{std::move(grfs)};
+    return config;
+}
+
+} // namespace
+
+SOTC_BENCHMARK(heartbeat_62_grfs_rebuild_and_serialize) {
+    const auto config = make_config(62);
+    const CoordinatorClient client{};
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto payload = client.build_registration_frame(config).serialize();
+        sotc::bench::do_not_optimize(payload);
+    }
+}
+
+SOTC_BENCHMARK(heartbeat_62_grfs_cached_unchanged) {
+    const auto config = make_config(62);
+    CachedRegistrationFrame cached{config};
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto update = cached.update(config);
+        sotc::bench::do_not_optimize(update);
+        auto payload = cached.payload();
+        sotc::bench::do_not_optimize(payload);
+    }
+}
+
+SOTC_BENCHMARK(heartbeat_62_grfs_cached_patch_fixed_fields) {
+    auto config = make_config(62);
+    CachedRegistrationFrame cached{config};
+    for (std::size_t index = 0; index < iterations; ++index) {
+        config.listed_publicly = (index & 1U) == 0;
+        config.heartbeat_interval = std::chrono::seconds{30 + static_cast<long long>(index & 7U)};
+        auto update = cached.update(config);
+        sotc::bench::do_not_optimize(update);
+        auto payload = cached.payload();
+        sotc::bench::do_not_optimize(payload);
+    }
+}
+
+SOTC_BENCHMARK(heartbeat_62_grfs_cached_set_heartbeat_seconds) {
+    CachedRegistrationFrame cached{make_config(62)};
+    for (std::size_t index = 0; index < iterations; ++index) {
+        cached.set_heartbeat_seconds(static_cast<std::uint16_t>(30 + (index & 7U)));
+        auto payload = cached.payload();
+        sotc::bench::do_not_optimize(payload);
+    }
+}
+
+SOTC_BENCHMARK(launch_options_to_frame_and_state_255_grfs) {
+    sotc::LaunchOptions options{};
+    std::string grfs;
+    for (std::size_t index = 0; index < 255; ++index) {
+        if (index != 0) {
+            grfs.push_back(',');
+        }
+        grfs += std::to_string(0x4D4D0000 + index);
+    }
+    static_cast<void>(sotc::apply_config_key("advertised_grfs", grfs, options));
+    for (std::size_t index = 0; index < iterations; ++index) {
+        const sotc::LaunchOptions copy = options;
+        const auto registrations = sotc::build_registrations(copy);
+        const CachedRegistrationFrame cached{registrations.front()};
+        const auto state = sotc::ui::build_state_from_launch_options(copy);
+        sotc::bench::do_not_optimize(cached);
+        sotc::bench::do_not_optimize(state);
+    }
+}
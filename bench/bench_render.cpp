@@ -0,0 +1,49 @@
+#include "bench_harness.hpp"
+
+#include "gui/configuration_preview.hpp"
+#include "gui/coordinator_settings_window.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+[[nodiscard]] std::vector<sotc::ui::Section> settings_window_sections(std::size_t grf_count) {
+    sotc::LaunchOptions options{};
+    options.player_name = "Benchmark";
+    options.server_host = "bench.example.org";
+    options.invite_code = "+BENCH01";
+    std::vector<std::string> grfs;
+    for (std::size_t index = 0; index < grf_count; ++index) {
+        grfs.push_back("4D4D" + std::to_string(100000 + index));
+    }
+    options.advertised_grfs = sotc::network::GrfList{std::move(grfs)};
+    const sotc::ui::CoordinatorSettingsWindow window{sotc::ui::build_state_from_launch_options(options)};
+    return window.build_sections();
+}
+
+void render(const std::vector<sotc::ui::Section> &sections, std::size_t iterations) {
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto text = sotc::ui::render_sections(sections);
+        sotc::bench::do_not_optimize(text);
+    }
+}
+
+} // namespace
+
+SOTC_BENCHMARK(render_sections_settings_window) {
+    render(settings_window_sections(8), iterations);
+}
+
+SOTC_BENCHMARK(render_sections_settings_window_255_grfs) {
+    render(settings_window_sections(255), iterations);
+}
+
+SOTC_BENCHMARK(build_and_render_settings_window) {
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto text = sotc::ui::render_sections(settings_window_sections(8));
+        sotc::bench::do_not_optimize(text);
+    }
+}
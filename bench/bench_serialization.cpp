@@ -0,0 +1,94 @@
+#include "bench_harness.hpp"
+
+#include "network/coordinator_client.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Registration payload costs at the GRF counts that bound real servers: none,
+// a typical modded game and the protocol maximum.
+
+namespace {
+
+using sotc::network::CoordinatorClient;
+using sotc::network::CoordinatorHandshakeFrame;
+using sotc::network::CoordinatorHandshakeFrameView;
+using sotc::network::RegistrationConfig;
+
+[[nodiscard]] RegistrationConfig make_config(std::size_t grf_count) {
+    RegistrationConfig config{};
+    config.server_name = "Benchmark Fleet Server";
+    config.invite_code = "+BENCH01";
+    std::vector<std::string> grfs;
+    for (std::size_t index = 0; index < grf_count; ++index) {
+        grfs.push_back("4D4D" + std::to_string(100000 + index));
+    }
+    config.advertised_grfs = sotc::network::GrfList{std::move(grfs)};
+    return config;
+}
+
+void build_frame(std::size_t grf_count, std::size_t iterations) {
+    const auto config = make_config(grf_count);
+    const CoordinatorClient client{};
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto frame = client.build_registration_frame(config);
+        sotc::bench::do_not_optimize(frame);
+    }
+}
+
+void serialize(std::size_t grf_count, std::size_t iterations) {
+    const auto frame = CoordinatorClient{}.build_registration_frame(make_config(grf_count));
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto payload = frame.serialize();
+        sotc::bench::do_not_optimize(payload);
+    }
+}
+
+void serialize_into(std::size_t grf_count, std::size_t iterations) {
+    const auto frame = CoordinatorClient{}.build_registration_frame(make_config(grf_count));
+    std::vector<std::byte> buffer(frame.serialized_size());
+    for (std::size_t index = 0; index < iterations; ++index) {
+        frame.serialize_into(buffer);
+        sotc::bench::do_not_optimize(buffer);
+    }
+}
+
+void deserialize(std::size_t grf_count, std::size_t iterations) {
+    const auto payload = CoordinatorClient{}.build_registration_frame(make_config(grf_count)).serialize();
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto frame = CoordinatorHandshakeFrame::deserialize(payload);
+        sotc::bench::do_not_optimize(frame);
+    }
+}
+
+void view_parse(std::size_t grf_count, std::size_t iterations) {
+    const auto payload = CoordinatorClient{}.build_registration_frame(make_config(grf_count)).serialize();
+    for (std::size_t index = 0; index < iterations; ++index) {
+        auto view = CoordinatorHandshakeFrameView::try_parse(payload);
+        sotc::bench::do_not_optimize(view);
+    }
+}
+
+} // namespace
+
+SOTC_BENCHMARK(build_registration_frame_0_grfs) { build_frame(0, iterations); }
+SOTC_BENCHMARK(build_registration_frame_62_grfs) { build_frame(62, iterations); }
+SOTC_BENCHMARK(build_registration_frame_255_grfs) { build_frame(255, iterations); }
+
+SOTC_BENCHMARK(serialize_0_grfs) { serialize(0, iterations); }
+SOTC_BENCHMARK(serialize_62_grfs) { serialize(62, iterations); }
+SOTC_BENCHMARK(serialize_255_grfs) { serialize(255, iterations); }
+
+SOTC_BENCHMARK(serialize_into_0_grfs) { serialize_into(0, iterations); }
+SOTC_BENCHMARK(serialize_into_62_grfs) { serialize_into(62, iterations); }
+SOTC_BENCHMARK(serialize_into_255_grfs) { serialize_into(255, iterations); }
+
+SOTC_BENCHMARK(deserialize_0_grfs) { deserialize(0, iterations); }
+SOTC_BENCHMARK(deserialize_62_grfs) { deserialize(62, iterations); }
+SOTC_BENCHMARK(deserialize_255_grfs) { deserialize(255, iterations); }
+
+SOTC_BENCHMARK(view_try_parse_0_grfs) { view_parse(0, iterations); }
+SOTC_BENCHMARK(view_try_parse_62_grfs) { view_parse(62, iterations); }
+SOTC_BENCHMARK(view_try_parse_255_grfs) { view_parse(255, iterations); }
@@ -0,0 +1,70 @@
+#include "bench_harness.hpp"
+
+#include "network/server_index.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace {
+
+using namespace sotc::network;
+
+[[nodiscard]] ServerIndex make_index(std::size_t rows) {
+    ServerIndex index;
+    index.reserve(rows);
+    for (std::size_t row = 0; row < rows; ++row) {
+        ServerListingEntry entry{};
+        entry.connection_string = "192.0.2." + std::to_string(row % 250 + 1) + ':' + std::to_string(3979 + row);
+        entry.info.server_name = "Bench server " + std::to_string(row * 7919 % rows);
+        entry.info.server_revision = row % 5 == 0 ? "13.4" : "14.1";
+        entry.info.clients_max = 25;
+        entry.info.clients_on = static_cast<std::uint8_t>(row * 31 % 26);
+        entry.info.companies_on = static_cast<std::uint8_t>(row % 16);
+        entry.info.use_password = row % 3 == 0;
+        index.add(entry, static_cast<ServerGameType>(row % 3), static_cast<std::uint8_t>(row % 8));
+    }
+    return index;
+}
+
+[[nodiscard]] ServerFilter joinable_filter() {
+    ServerFilter filter{};
+    filter.min_clients = 1;
+    filter.min_free_slots = 2;
+    filter.game_type = ServerGameType::Public;
+    filter.required_nat_capabilities = static_cast<std::uint8_t>(NatCapability::Stun);
+    filter.revision = "14.1";
+    filter.use_password = false;
+    return filter;
+}
+
+} // namespace
+
+SOTC_BENCHMARK(server_index_filter_10000) {
+    const auto index = make_index(10000);
+    const auto filter = joinable_filter();
+    for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        auto selection = index.filter(filter);
+        sotc::bench::do_not_optimize(selection);
+    }
+}
+
+SOTC_BENCHMARK(server_index_filter_sorted_view_10000) {
+    auto index = make_index(10000);
+    const auto filter = joinable_filter();
+    for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        auto rows = index.select_sorted(index.filter(filter), ServerSortKey::Clients, true);
+        sotc::bench::do_not_optimize(rows);
+    }
+}
+
+SOTC_BENCHMARK(server_index_sort_by_name_10000) {
+    auto index = make_index(10000);
+    ServerListingEntry entry{};
+    for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        // Each add invalidates the cached view, so every iteration re-sorts.
+        index.add(entry);
+        auto rows = index.sorted(ServerSortKey::Name);
+        sotc::bench::do_not_optimize(rows);
+    }
+}
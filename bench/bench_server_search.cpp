@@ -0,0 +1,91 @@
+#include "bench_harness.hpp"
+
+#include "network/server_search_index.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+using sotc::network::ServerSearchIndex;
+
+constexpr std::size_t kServers = 10000;
+
+[[nodiscard]] std::string server_name(std::size_t row) {
+    static constexpr const char *kWords[] = {"Public", "Rail",    "Tycoon", "Friends", "Cargo",   "Express",
+                                             "Arctic", "Tropic",  "Coop",   "Server",  "Network", "Company"};
+    constexpr std::size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+    return std::string{kWords[row % kWordCount]} + ' ' + kWords[row * 7 % kWordCount] + " #" + std::to_string(row);
+}
+
+[[nodiscard]] ServerSearchIndex make_index() {
+    ServerSearchIndex index;
+    for (std::size_t row = 0; row < kServers; ++row) {
+        index.insert(static_cast<std::uint32_t>(row), server_name(row), "+Inv" + std::to_string(row * 7919));
+    }
+    return index;
+}
+
+[[nodiscard]] std::vector<std::string> folded_names() {
+    std::vector<std::string> names;
+    for (std::size_t row = 0; row < kServers; ++row) {
+        auto name = server_name(row);
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char character) { return static_cast<char>(std::tolower(character)); });
+        names.push_back(std::move(name));
+    }
+    return names;
+}
+
+} // namespace
+
+SOTC_BENCHMARK(server_search_name_rare_10000) {
+    const auto index = make_index();
+    for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        auto rows = index.find_name("#4242");
+        sotc::bench::do_not_optimize(rows);
+    }
+}
+
+SOTC_BENCHMARK(server_search_name_common_limit_50_10000) {
+    const auto index = make_index();
+    for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        auto rows = index.find_name("rail tyc", 50);
+        sotc::bench::do_not_optimize(rows);
+    }
+}
+
+SOTC_BENCHMARK(server_search_invite_prefix_10000) {
+    const auto index = make_index();
+    for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        auto rows = index.find_invite_code("+Inv123");
+        sotc::bench::do_not_optimize(rows);
+    }
+}
+
+// What find_name replaces: a case-folded scan of every name.
+SOTC_BENCHMARK(server_search_name_linear_scan_10000) {
+    const auto names = folded_names();
+    for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        std::vector<std::uint32_t> rows;
+        for (std::size_t row = 0; row < names.size(); ++row) {
+            if (names[row].find("#4242") != std::string::npos) {
+                rows.push_back(static_cast<std::uint32_t>(row));
+            }
+        }
+        sotc::bench::do_not_optimize(rows);
+    }
+}
+
+SOTC_BENCHMARK(server_search_insert_erase_10000) {
+    auto index = make_index();
+    for (std::size_t iteration = 0; iteration < iterations; ++iteration) {
+        const auto row = static_cast<std::uint32_t>(iteration % kServers);
+        index.erase(row);
+        index.insert(row, server_name(row), "+Inv" + std::to_string(row));
+    }
+}
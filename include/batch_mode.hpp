@@ -0,0 +1,48 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+
+#include "client_app.hpp"
+
+namespace sotc {
+
+struct BatchOptions {
+    // Threads answering requests; zero means one per hardware thread.
+    std::size_t workers{0};
+    // Requests read ahead of the oldest unanswered one, which bounds memory
+    // when input arrives faster than answers can be written.
+    std::size_t max_pending{4096};
+};
+
+struct BatchStats {
+    std::uint64_t requests{0};
+    std::uint64_t failed{0};
+    std::size_t workers{0};
+    std::chrono::steady_clock::duration elapsed{};
+
+    [[nodiscard]] double requests_per_second() const noexcept;
+};
+
+// Answers one batch request. A request is one line of tab-separated fields:
+// configuration text in which "\n", "\t" and "\\" stand for a newline, a tab
+// and a backslash, followed by command-line arguments (one per field) that
+// override it, as flags after --config do. --profile NAME selects a section
+// of the text. The options start out as defaults.
+//
+// Writes "request=<number>", then "status=ok" with the --dump-launch-options
+// and --dump-registration lines, or "status=error" with one "error=" line per
+// problem, and finally an empty line. Returns false for an error.
+bool write_batch_response(std::uint64_t number, std::string_view request, const LaunchOptions &defaults,
+                          std::ostream &out);
+
+// Reads requests from in until it ends and writes their responses to out in
+// request order, answering up to options.workers requests at a time. out is
+// flushed whenever no answered request is left waiting, so an interactive
+// caller gets each response without closing its end.
+BatchStats run_batch(std::istream &in, std::ostream &out, const LaunchOptions &defaults, BatchOptions options = {});
+
+} // namespace sotc
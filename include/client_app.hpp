@@ -1,14 +1,38 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "network/coordinator_client.hpp"
 
 namespace sotc {
 
+namespace network {
+class DnsCache;
+} // namespace network
+
+// One additional server registered by this process. Unset fields inherit the
+// corresponding top-level launch option.
+struct HostedServerOptions {
+    std::uint16_t listen_port{network::NETWORK_DEFAULT_GAME_PORT};
+    std::string server_name{};
+    std::optional<std::string> invite_code{};
+    std::optional<network::ServerGameType> server_game_type{};
+    std::optional<std::chrono::seconds> heartbeat_interval{};
+    std::optional<bool> allow_direct{};
+    std::optional<bool> allow_stun{};
+    std::optional<bool> allow_turn{};
+};
+
+struct ConfigProfile;
+
 struct LaunchOptions {
     std::string server_host;
     std::uint16_t server_port{network::NETWORK_DEFAULT_GAME_PORT};
@@ -23,25 +47,99 @@ struct LaunchOptions {
     bool allow_stun{true};
     bool allow_turn{true};
     std::chrono::seconds heartbeat_interval{std::chrono::seconds{30}};
-    std::vector<std::string> advertised_grfs{};
+    network::GrfList advertised_grfs{};
+    bool register_with_coordinator{false};
+    bool list_servers{false};
+    // Measure UDP round-trip times to the listed servers, or to server_host
+    // when no listing is requested.
+    bool probe_latency{false};
+    bool discover_lan{false};
+    // HOST[:PORT] or A.B.C.D/N entries probed by discover_lan; empty means
+    // the IPv4 broadcast address.
+    std::vector<std::string> lan_targets{};
+    std::vector<HostedServerOptions> hosted_servers{};
+    // File holding coordinator sessions from earlier runs; registrations try
+    // to resume from it. Empty disables the cache.
+    std::string session_cache_path{};
+    // Re-read the configuration files when they change while registered and
+    // bring the registrations in line with them.
+    bool watch_config{false};
+    // Every [name] section of the --config files read under --all-profiles,
+    // with the options that follow them applied. When not empty, the
+    // profiles register in place of these options.
+    std::vector<ConfigProfile> profiles{};
+};
+
+// A [name] section of a configuration file: the file's top-level keys with
+// the section's keys applied on top.
+struct ConfigProfile {
+    std::string name;
+    LaunchOptions options;
+};
+
+// Launch options as one immutable, reference-counted block. Everything that
+// needs the configuration holds a snapshot instead of its own copy, and a
+// reload publishes a new snapshot rather than editing the current one.
+using LaunchSnapshot = std::shared_ptr<const LaunchOptions>;
+
+[[nodiscard]] inline LaunchSnapshot make_launch_snapshot(LaunchOptions options) {
+    return std::make_shared<const LaunchOptions>(std::move(options));
+}
+
+// The current snapshot. Readers may load() from any thread and keep using
+// what they got while another thread store()s its successor.
+class LaunchSnapshotSlot {
+public:
+    explicit LaunchSnapshotSlot(LaunchSnapshot snapshot) noexcept : current_(std::move(snapshot)) {}
+
+    [[nodiscard]] LaunchSnapshot load() const noexcept { return current_.load(std::memory_order_acquire); }
+    void store(LaunchSnapshot snapshot) noexcept { current_.store(std::move(snapshot), std::memory_order_release); }
+    // Publishes snapshot and returns the one it replaced.
+    [[nodiscard]] LaunchSnapshot exchange(LaunchSnapshot snapshot) noexcept {
+        return current_.exchange(std::move(snapshot), std::memory_order_acq_rel);
+    }
+
+private:
+    std::atomic<LaunchSnapshot> current_;
 };
 
+// The coordinator registrations options asks for: one per hosted server, or
+// a single one for server_port when none are listed; with profiles, those of
+// every profile in turn.
+[[nodiscard]] std::vector<network::RegistrationConfig> build_registrations(const LaunchOptions &options);
+
 class ClientApp {
 public:
     ClientApp();
 
     void configure(LaunchOptions options);
 
-    [[nodiscard]] const LaunchOptions &options() const noexcept { return options_; }
+    [[nodiscard]] LaunchSnapshot options() const noexcept { return options_.load(); }
+
+    // Produces the options to switch to after one of paths changed; returns
+    // false to keep the current ones.
+    using ConfigReloader = std::function<bool(LaunchOptions &options)>;
+
+    // Files behind the options, watched when LaunchOptions::watch_config is
+    // set.
+    void set_config_files(std::vector<std::string> paths, ConfigReloader reload);
 
     void run();
 
 private:
-    LaunchOptions options_{};
-    void log_startup_info() const;
-    void render_gui_preview() const;
+    LaunchSnapshotSlot options_;
+    // Resolves the coordinator and server hosts in the background from the
+    // start of run(); null where unsupported.
+    std::shared_ptr<network::DnsCache> resolver_{};
+    std::vector<std::string> config_paths_{};
+    ConfigReloader reload_config_{};
+    void log_startup_info(const LaunchOptions &options) const;
+    void render_gui_preview(const LaunchOptions &options) const;
+    void run_coordinator_sessions(const LaunchOptions &options,
+                                  const std::vector<network::RegistrationConfig> &registrations);
+    void list_coordinator_servers(const LaunchOptions &options) const;
+    void discover_lan_servers(const LaunchOptions &options) const;
+    void probe_server_latency(const LaunchOptions &options) const;
 };
 
-std::vector<std::string> discover_local_servers();
-
 } // namespace sotc
@@ -25,7 +25,7 @@ struct CoordinatorSettingsState {
     bool allow_stun{true};
     bool allow_turn{true};
     std::chrono::seconds heartbeat_interval{std::chrono::seconds{30}};
-    std::vector<std::string> advertised_grfs;
+    network::GrfList advertised_grfs;
 };
 
 [[nodiscard]] CoordinatorSettingsState build_state_from_launch_options(const LaunchOptions &options);
@@ -40,7 +40,7 @@ public:
     void set_listed_publicly(bool listed) noexcept { state_.listed_publicly = listed; }
     void set_server_game_type(network::ServerGameType type) noexcept { state_.server_game_type = type; }
     void update_nat_capabilities(bool allow_direct, bool allow_stun, bool allow_turn) noexcept;
-    void set_advertised_grfs(std::vector<std::string> grfs) noexcept;
+    void set_advertised_grfs(network::GrfList grfs) noexcept;
 
     [[nodiscard]] std::vector<Section> build_sections() const;
 
@@ -5,6 +5,7 @@
 #include <string_view>
 
 #include "network/coordinator_client.hpp"
+#include "network/server_listing.hpp"
 
 namespace sotc::ui {
 
@@ -17,5 +18,8 @@ namespace sotc::ui {
 
 [[nodiscard]] std::string describe_nat_policy(bool allow_direct, bool allow_stun, bool allow_turn);
 
+// One-line summary of a coordinator listing entry for the server browser.
+[[nodiscard]] std::string describe_listing_entry(const network::ServerListingEntry &entry);
+
 } // namespace sotc::ui
 
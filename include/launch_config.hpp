@@ -0,0 +1,165 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "client_app.hpp"
+
+namespace sotc {
+
+// Parsers shared by the command line and configuration files. Each returns
+// false and leaves out untouched when value is invalid.
+[[nodiscard]] bool parse_bool(std::string_view value, bool &out);
+[[nodiscard]] bool parse_uint16(std::string_view value, std::uint16_t &out);
+[[nodiscard]] bool parse_seconds(std::string_view value, std::chrono::seconds &out);
+[[nodiscard]] bool parse_server_game_type(std::string_view value, network::ServerGameType &out);
+[[nodiscard]] bool parse_host_and_port(std::string_view value, std::string &host_out, std::uint16_t &port_out);
+
+// Parses PORT[,key=value...] where key is one of name, invite_code, game_type,
+// heartbeat, direct, stun or turn. Reports the first invalid token to stderr.
+[[nodiscard]] bool parse_hosted_server(std::string_view value, HostedServerOptions &out);
+[[nodiscard]] std::string format_hosted_server(const HostedServerOptions &server);
+
+// What a command-line option does besides setting LaunchOptions fields.
+enum class LaunchCommand : std::uint8_t {
+    None,
+    Help,
+    Config,
+    Profile,
+    AllProfiles,
+    DumpLaunchOptions,
+    DumpRegistration,
+    Batch,
+    BatchWorkers,
+};
+
+// One launch option: its configuration key, command-line flags, --help text
+// and --dump-launch-options line, and how its value is applied. Every option
+// is defined once in the table returned by launch_option_specs().
+struct LaunchOptionSpec {
+    using Apply = bool (*)(std::string_view value, LaunchOptions &options);
+    using Format = void (*)(const LaunchOptions &options, std::ostream &out);
+
+    // Configuration file key; empty for command-line-only options.
+    std::string_view key{};
+    // A second configuration key accepted for the same option.
+    std::string_view key_alias{};
+    // Key in --dump-launch-options; empty when the option is not dumped.
+    std::string_view summary_key{};
+    std::string_view flag{};
+    std::string_view short_flag{};
+    // Accepted on the command line but not listed in --help.
+    std::string_view flag_alias{};
+    // Flag that applies off_value, e.g. --no-headless.
+    std::string_view off_flag{};
+    // Placeholder for the flag's value in --help. Empty when the flag takes
+    // no value and applies on_value instead.
+    std::string_view metavar{};
+    std::string_view on_value{"true"};
+    std::string_view off_value{"false"};
+    // Lines are separated by '\n'.
+    std::string_view help{};
+    std::string_view off_help{};
+    // Names the option in "Invalid <label>: <value>" on the command line and
+    // selects "Invalid <key> value: <value>" in files. Empty when apply
+    // reports its own problems.
+    std::string_view label{};
+    // May appear more than once in one configuration section.
+    bool repeatable{false};
+    LaunchCommand command{LaunchCommand::None};
+    Apply apply{nullptr};
+    // Command-line form when it differs from the file form: --advertised-grf
+    // adds one NewGRF where advertised_grfs replaces the list.
+    Apply apply_flag{nullptr};
+    Format format{nullptr};
+};
+
+// Every option, in --help and --dump-launch-options order.
+[[nodiscard]] std::span<const LaunchOptionSpec> launch_option_specs() noexcept;
+
+struct LaunchFlag {
+    const LaunchOptionSpec *spec{nullptr};
+    // The flag was spec->off_flag.
+    bool off{false};
+};
+
+// Looks up a command-line flag (any spelling, including short and off
+// flags) in a perfect hash built at compile time.
+[[nodiscard]] std::optional<LaunchFlag> find_launch_flag(std::string_view flag) noexcept;
+// Same for configuration keys; nullptr when key is unknown.
+[[nodiscard]] const LaunchOptionSpec *find_config_key(std::string_view key) noexcept;
+
+// Applies a flag of an option (command None) with value, which is the
+// argument that followed it or the spec's on_value or off_value. Reports an
+// invalid value and returns false.
+bool apply_launch_flag(const LaunchFlag &flag, std::string_view value, LaunchOptions &options);
+
+// Applies a command line's worth of flags to options. Repeated
+// --advertised-grf flags are collected in a plain list and interned once by
+// finish() instead of copying and interning the list for every flag. Call
+// finish() before options is read or changed by anything else, such as a
+// --config file.
+class LaunchFlagApplier {
+public:
+    explicit LaunchFlagApplier(LaunchOptions &options) noexcept;
+
+    LaunchFlagApplier(const LaunchFlagApplier &) = delete;
+    LaunchFlagApplier &operator=(const LaunchFlagApplier &) = delete;
+
+    // As apply_launch_flag().
+    bool apply(const LaunchFlag &flag, std::string_view value);
+    void finish();
+
+private:
+    LaunchOptions &options_;
+    std::vector<std::string> grfs_{};
+    bool collecting_grfs_{false};
+};
+
+enum class ConfigKeyApplyResult {
+    Applied,
+    InvalidValue,
+    Unknown,
+};
+
+[[nodiscard]] bool is_known_config_key(std::string_view key);
+ConfigKeyApplyResult apply_config_key(std::string_view key, std::string_view value, LaunchOptions &options);
+
+// Sends the problems reported by configuration parsing on this thread to out
+// instead of stderr for as long as it is in scope.
+class ConfigDiagnosticsScope {
+public:
+    explicit ConfigDiagnosticsScope(std::ostream &out) noexcept;
+    ~ConfigDiagnosticsScope();
+
+    ConfigDiagnosticsScope(const ConfigDiagnosticsScope &) = delete;
+    ConfigDiagnosticsScope &operator=(const ConfigDiagnosticsScope &) = delete;
+
+private:
+    std::ostream *previous_;
+};
+
+// Applies every top-level key=value line of the file at path to options, then
+// the lines of the [profile] section when profile is not empty. Other
+// sections are skipped. Problems are reported to stderr; returns false if any
+// line was rejected or the profile does not exist.
+bool load_config_file(const std::string &path, LaunchOptions &options, std::string_view profile = {});
+// Same for configuration text held in memory; name stands in for the path in
+// messages.
+bool load_config_text(std::string_view text, const std::string &name, LaunchOptions &options,
+                      std::string_view profile = {});
+
+// Reads the file at path in one pass: top-level keys are applied to base and
+// every [name] section becomes a profile appended to profiles, in file order.
+// Within each section a key may appear once, as at the top level; a repeated
+// [name] is reported and its keys ignored. Each profile starts as a copy of
+// base, so base should not hold profiles of its own.
+bool load_config_profiles(const std::string &path, LaunchOptions &base, std::vector<ConfigProfile> &profiles);
+
+} // namespace sotc
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <iosfwd>
+
+#include "client_app.hpp"
+
+namespace sotc {
+
+// key=value lines for --dump-launch-options, one per option in
+// launch_option_specs() order.
+void write_launch_summary(const LaunchOptions &options, std::ostream &out);
+
+// key=value lines for --dump-registration: the handshake frame and payload
+// of the top-level registration and, with a session cache, whether it holds
+// an entry for the server.
+void write_registration_summary(const LaunchOptions &options, std::ostream &out);
+
+} // namespace sotc
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace sotc {
+
+// Read-only view of a whole file. On POSIX systems a regular file is mapped
+// into memory, so a large file is paged in as it is read rather than copied
+// into a buffer first; pipes, character devices and files elsewhere are read
+// into memory once.
+class MappedFile {
+public:
+    // Throws std::system_error when the file cannot be opened or mapped.
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] std::string_view text() const noexcept { return {data_, size_}; }
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+private:
+#if !defined(_WIN32)
+    // Drains a descriptor that cannot be mapped into buffer_ and closes it.
+    void read_stream(int fd, const std::string &path);
+#endif
+
+    const char *data_{nullptr};
+    std::size_t size_{0};
+    bool mapped_{false};
+    // Backing storage where mmap is unavailable.
+    std::string buffer_{};
+};
+
+} // namespace sotc
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "network/coordinator_client.hpp"
+#include "network/event_loop.hpp"
+#include "network/socket.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sotc::network {
+
+// One way of reaching a server: directly, through the address a STUN exchange
+// punched, or through a TURN relay.
+struct ConnectionPath {
+    NatCapability kind{NatCapability::Direct};
+    Endpoint endpoint{};
+    // Sent once connected; the path has finished its handshake when a complete
+    // packet comes back. With no hello the TCP connect alone decides.
+    std::vector<std::byte> hello{};
+};
+
+struct ConnectionRaceOptions {
+    // Head start each path gets over the next one. A path that fails starts
+    // the next one at once.
+    EventLoop::Clock::duration stagger{std::chrono::milliseconds{250}};
+    // Deadline for the whole race.
+    EventLoop::Clock::duration timeout{std::chrono::seconds{10}};
+};
+
+enum class RaceState : std::uint8_t {
+    Idle,
+    Racing,
+    Connected,
+    Failed,
+};
+
+enum class PathOutcome : std::uint8_t {
+    NotStarted,
+    Pending,
+    Won,
+    Failed,
+    Cancelled,
+};
+
+[[nodiscard]] std::string_view to_string(RaceState state) noexcept;
+[[nodiscard]] std::string_view to_string(PathOutcome outcome) noexcept;
+
+struct PathAttempt {
+    NatCapability kind{NatCapability::Direct};
+    Endpoint endpoint{};
+    PathOutcome outcome{PathOutcome::NotStarted};
+    // Since the race started.
+    EventLoop::Clock::duration started_after{};
+    // From starting the path to winning, failing or being cancelled.
+    EventLoop::Clock::duration elapsed{};
+    std::string error{};
+};
+
+// The allowed paths of config in preference order: direct, STUN, TURN.
+[[nodiscard]] std::vector<NatCapability> allowed_paths(const RegistrationConfig &config);
+
+// Races connection paths on an EventLoop, happy-eyeballs style. Paths start
+// in the order given, each one stagger after the previous, and run
+// concurrently; the first to finish its handshake wins and every other
+// attempt is closed. Each attempt records its outcome and timing.
+class ConnectionRacer {
+public:
+    using CompletionCallback = std::function<void(RaceState)>;
+
+    explicit ConnectionRacer(EventLoop &loop, ConnectionRaceOptions options = {});
+    ~ConnectionRacer();
+
+    ConnectionRacer(const ConnectionRacer &) = delete;
+    ConnectionRacer &operator=(const ConnectionRacer &) = delete;
+
+    // Starts a new race; an unfinished one is cancelled. An empty path list
+    // fails at once.
+    void start(std::vector<ConnectionPath> paths);
+    void cancel() noexcept;
+
+    void set_completion_callback(CompletionCallback callback) { completion_callback_ = std::move(callback); }
+
+    [[nodiscard]] RaceState state() const noexcept { return state_; }
+    [[nodiscard]] const std::vector<PathAttempt> &attempts() const noexcept { return attempts_; }
+    [[nodiscard]] std::optional<NatCapability> winning_path() const noexcept;
+    [[nodiscard]] const std::string &last_error() const noexcept { return last_error_; }
+    // The winner's handshake reply, header included.
+    [[nodiscard]] const std::vector<std::byte> &handshake_reply() const noexcept { return reply_; }
+    // Hands the connected socket to the caller; empty unless Connected.
+    [[nodiscard]] SocketHandle take_socket() noexcept;
+
+private:
+    struct Attempt {
+        ConnectionPath path{};
+        SocketHandle socket{};
+        bool connected{false};
+        std::vector<std::byte> received{};
+        EventLoop::Clock::time_point started_at{};
+    };
+
+    void start_next();
+    void schedule_next();
+    void on_io(std::size_t index, std::uint32_t events);
+    void on_connected(std::size_t index);
+    void on_readable(std::size_t index);
+    void fail_attempt(std::size_t index, std::string error);
+    void win(std::size_t index);
+    void finish(RaceState state);
+    void close_attempt(std::size_t index, PathOutcome outcome) noexcept;
+    void cancel_timers() noexcept;
+
+    EventLoop &loop_;
+    ConnectionRaceOptions options_;
+    RaceState state_{RaceState::Idle};
+    std::string last_error_{};
+    CompletionCallback completion_callback_{};
+
+    std::vector<Attempt> running_{};
+    std::vector<PathAttempt> attempts_{};
+    std::size_t next_{0};
+    std::optional<std::size_t> winner_{};
+    std::vector<std::byte> reply_{};
+    SocketHandle winner_socket_{};
+    EventLoop::Clock::time_point started_at_{};
+    EventLoop::TimerId stagger_timer_{0};
+    EventLoop::TimerId race_timer_{0};
+};
+
+} // namespace sotc::network
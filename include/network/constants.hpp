@@ -18,4 +18,7 @@ inline constexpr std::size_t NETWORK_MAX_GRF_COUNT = 255;
 inline constexpr std::size_t NETWORK_MAX_SERVER_NAME_LENGTH = 255;
 inline constexpr std::size_t NETWORK_MAX_INVITE_CODE_LENGTH = 63;
 
+inline constexpr std::size_t NETWORK_COMPAT_MTU = 1460;
+inline constexpr std::size_t NETWORK_TCP_MTU = 32 * 1024;
+
 } // namespace sotc::network
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "network/event_loop.hpp"
+#include "network/md5.hpp"
+#include "network/server_listing.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sotc::network {
+
+// Directory of NewGRF files named by their MD5, fanned out over 256
+// subdirectories by the first digest byte. A file only appears under its
+// final name after its checksum has been verified, so presence means valid.
+class ContentCache {
+public:
+    explicit ContentCache(std::filesystem::path root);
+
+    [[nodiscard]] std::filesystem::path path_for(const Md5Digest &digest) const;
+    // Where a download in progress keeps its bytes, so a later attempt or
+    // run can resume it.
+    [[nodiscard]] std::filesystem::path partial_path_for(const Md5Digest &digest) const;
+    [[nodiscard]] bool contains(const Md5Digest &digest) const;
+
+    [[nodiscard]] const std::filesystem::path &root() const noexcept { return root_; }
+
+private:
+    std::filesystem::path root_;
+};
+
+struct ContentDownloadOptions {
+    std::filesystem::path cache_directory{};
+    // Connections curl may open to one host; further transfers to that host
+    // wait for a free connection.
+    std::size_t max_connections_per_host{4};
+    // Transfers handed to curl at once, across hosts.
+    std::size_t max_transfers{16};
+    // Tries per file. Every retry resumes from the bytes already on disk.
+    std::size_t max_attempts{3};
+    // Bound for files whose request gives no size.
+    std::uint64_t max_file_size{64 * 1024 * 1024};
+    EventLoop::Clock::duration connect_timeout{std::chrono::seconds{10}};
+    // A transfer that receives nothing for this long is aborted (and retried).
+    std::chrono::seconds stall_timeout{30};
+};
+
+enum class ContentDownloadStatus : std::uint8_t {
+    Queued,
+    Active,
+    // Already in the cache; nothing was downloaded.
+    Cached,
+    Downloaded,
+    ChecksumMismatch,
+    Failed,
+};
+
+[[nodiscard]] std::string_view to_string(ContentDownloadStatus status) noexcept;
+
+struct ContentRequest {
+    NewGrfIdentity identity{};
+    std::string url{};
+    // Expected size in bytes, or 0 when unknown.
+    std::uint64_t size{0};
+};
+
+struct ContentDownload {
+    ContentRequest request{};
+    ContentDownloadStatus status{ContentDownloadStatus::Queued};
+    // The verified cache file once Cached or Downloaded.
+    std::filesystem::path path{};
+    // Body bytes received over the network, across attempts.
+    std::uint64_t bytes_received{0};
+    // Offset the latest attempt resumed from; 0 for a fresh transfer.
+    std::uint64_t resumed_from{0};
+    std::size_t attempts{0};
+    std::string error{};
+};
+
+// Fetches NewGRF files over HTTP with libcurl's multi interface, driven by an
+// EventLoop: curl's sockets and timeout are registered with the loop, so all
+// transfers run on the caller's thread without blocking. Bytes are written to
+// a partial file and hashed as they arrive; a finished transfer is moved into
+// the ContentCache only if its MD5 matches the request. Interrupted transfers
+// resume with a byte-range request, falling back to a full download when the
+// server ignores the range. Requests for content that is already cached, or
+// already being fetched, download nothing.
+class ContentDownloader {
+public:
+    using DownloadId = std::size_t;
+    using ResultCallback = std::function<void(DownloadId, const ContentDownload &)>;
+
+    ContentDownloader(EventLoop &loop, ContentDownloadOptions options);
+    // Aborts transfers in flight; their partial files are kept for resuming.
+    ~ContentDownloader();
+
+    ContentDownloader(const ContentDownloader &) = delete;
+    ContentDownloader &operator=(const ContentDownloader &) = delete;
+
+    // The result callback fires before this returns when the content is
+    // already cached, and once the download settles otherwise.
+    DownloadId add(ContentRequest request);
+    void close() noexcept;
+
+    void set_result_callback(ResultCallback callback) { result_callback_ = std::move(callback); }
+
+    [[nodiscard]] const ContentCache &cache() const noexcept { return cache_; }
+    [[nodiscard]] std::size_t size() const noexcept { return downloads_.size(); }
+    [[nodiscard]] const ContentDownload &download(DownloadId id) const { return downloads_.at(id); }
+    // Nothing queued or in flight.
+    [[nodiscard]] bool idle() const noexcept { return queue_.empty() && transfers_.empty(); }
+    [[nodiscard]] std::size_t active() const noexcept { return transfers_.size(); }
+    [[nodiscard]] std::size_t peak_active() const noexcept { return peak_active_; }
+    [[nodiscard]] std::uint64_t bytes_downloaded() const noexcept { return bytes_downloaded_; }
+    [[nodiscard]] std::uint64_t cache_hits() const noexcept { return cache_hits_; }
+
+private:
+    // One attempt at one file. curl handles are kept as void * (curl's own
+    // CURL type) so this header does not need curl.h.
+    struct Transfer {
+        Transfer() = default;
+        ~Transfer();
+
+        Transfer(const Transfer &) = delete;
+        Transfer &operator=(const Transfer &) = delete;
+
+        ContentDownloader *owner{nullptr};
+        DownloadId id{0};
+        void *easy{nullptr};
+        std::FILE *file{nullptr};
+        std::filesystem::path partial{};
+        Md5 hash{};
+        // Bytes of the file on disk, including those from earlier attempts.
+        std::uint64_t offset{0};
+        std::uint64_t limit{0};
+        bool status_checked{false};
+        std::string range{};
+        std::string error{};
+        // CURLOPT_ERRORBUFFER; CURL_ERROR_SIZE bytes.
+        std::array<char, 256> curl_error{};
+    };
+    struct MultiDeleter {
+        void operator()(void *multi) const noexcept;
+    };
+
+    static std::size_t on_write(char *data, std::size_t size, std::size_t count, void *user) noexcept;
+    static int on_socket(void *easy, int fd, int what, void *user, void *socket_user) noexcept;
+    static int on_timer(void *multi, long timeout_ms, void *user) noexcept;
+
+    [[nodiscard]] bool write(Transfer &transfer, const char *data, std::size_t size);
+    void watch(int fd, int what);
+    void on_socket_event(int fd, std::uint32_t events);
+    void on_timeout();
+    void pump();
+    void start(DownloadId id);
+    void drain_completed();
+    void complete(Transfer &transfer, int result);
+    // Marks id and every request waiting on the same digest as settled.
+    void settle(DownloadId id, ContentDownloadStatus status, std::string error = {});
+
+    EventLoop &loop_;
+    ContentDownloadOptions options_;
+    ContentCache cache_;
+    std::unique_ptr<void, MultiDeleter> multi_;
+    EventLoop::TimerId timer_{0};
+    std::unordered_set<int> watched_{};
+    std::vector<ContentDownload> downloads_{};
+    // Requests waiting for the download of the same digest, by that download.
+    std::unordered_map<DownloadId, std::vector<DownloadId>> followers_{};
+    std::unordered_map<std::string, DownloadId> pending_by_digest_{};
+    std::deque<DownloadId> queue_{};
+    std::unordered_map<DownloadId, std::unique_ptr<Transfer>> transfers_{};
+    std::size_t peak_active_{0};
+    std::uint64_t bytes_downloaded_{0};
+    std::uint64_t cache_hits_{0};
+    ResultCallback result_callback_{};
+};
+
+} // namespace sotc::network
@@ -1,12 +1,16 @@
 #pragma once
 
 #include "network/constants.hpp"
+#include "network/decode_result.hpp"
+#include "network/grf_list.hpp"
 
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace sotc::network {
@@ -37,13 +41,15 @@ struct RegistrationConfig {
     std::uint16_t coordinator_port{NETWORK_COORDINATOR_SERVER_PORT};
     std::uint16_t listen_port{NETWORK_DEFAULT_GAME_PORT};
     std::string invite_code{};
-    std::vector<std::string> advertised_grfs{};
+    GrfList advertised_grfs{};
     ServerGameType server_game_type{ServerGameType::Public};
     bool allow_direct{true};
     bool allow_stun{true};
     bool allow_turn{true};
     bool listed_publicly{true};
     std::chrono::seconds heartbeat_interval{std::chrono::seconds{30}};
+
+    friend bool operator==(const RegistrationConfig &, const RegistrationConfig &) = default;
 };
 
 struct CoordinatorHandshakeFrame {
@@ -57,10 +63,93 @@ struct CoordinatorHandshakeFrame {
     std::uint8_t public_listing{1U};
     std::string server_name{};
     std::string invite_code{};
-    std::vector<std::string> newgrfs{};
+    GrfList newgrfs{};
 
+    [[nodiscard]] std::size_t serialized_size() const;
+    std::size_t serialize_into(std::span<std::byte> buffer) const;
     [[nodiscard]] std::vector<std::byte> serialize() const;
     [[nodiscard]] static CoordinatorHandshakeFrame deserialize(std::span<const std::byte> payload);
+    [[nodiscard]] static DecodeResult<CoordinatorHandshakeFrame> try_deserialize(std::span<const std::byte> payload);
+};
+
+// Non-owning, bounds-checked view over a serialised handshake frame. String
+// fields point into the payload, which must outlive the view.
+class CoordinatorHandshakeFrameView {
+public:
+    class GrfIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::string_view;
+
+        GrfIterator() = default;
+        GrfIterator(std::span<const std::byte> payload, std::size_t offset, std::size_t remaining) noexcept
+            : payload_(payload), offset_(offset), remaining_(remaining) {}
+
+        [[nodiscard]] std::string_view operator*() const noexcept;
+        GrfIterator &operator++() noexcept;
+        GrfIterator operator++(int) noexcept;
+
+        [[nodiscard]] friend bool operator==(const GrfIterator &lhs, const GrfIterator &rhs) noexcept {
+            return lhs.remaining_ == rhs.remaining_;
+        }
+
+    private:
+        std::span<const std::byte> payload_{};
+        std::size_t offset_{0};
+        std::size_t remaining_{0};
+    };
+
+    class GrfRange {
+    public:
+        GrfRange(std::span<const std::byte> payload, std::size_t offset, std::size_t count) noexcept
+            : payload_(payload), offset_(offset), count_(count) {}
+
+        [[nodiscard]] GrfIterator begin() const noexcept { return GrfIterator{payload_, offset_, count_}; }
+        [[nodiscard]] GrfIterator end() const noexcept { return GrfIterator{payload_, payload_.size(), 0}; }
+        [[nodiscard]] std::size_t size() const noexcept { return count_; }
+        [[nodiscard]] bool empty() const noexcept { return count_ == 0; }
+
+    private:
+        std::span<const std::byte> payload_;
+        std::size_t offset_;
+        std::size_t count_;
+    };
+
+    [[nodiscard]] static CoordinatorHandshakeFrameView parse(std::span<const std::byte> payload);
+    [[nodiscard]] static DecodeResult<CoordinatorHandshakeFrameView> try_parse(
+        std::span<const std::byte> payload) noexcept;
+
+    [[nodiscard]] std::uint8_t coordinator_version() const noexcept { return coordinator_version_; }
+    [[nodiscard]] std::uint8_t game_info_version() const noexcept { return game_info_version_; }
+    [[nodiscard]] std::uint8_t admin_version() const noexcept { return admin_version_; }
+    [[nodiscard]] std::uint16_t listen_port() const noexcept { return listen_port_; }
+    [[nodiscard]] std::uint16_t heartbeat_seconds() const noexcept { return heartbeat_seconds_; }
+    [[nodiscard]] std::uint8_t server_game_type() const noexcept { return server_game_type_; }
+    [[nodiscard]] std::uint8_t nat_capabilities() const noexcept { return nat_capabilities_; }
+    [[nodiscard]] std::uint8_t public_listing() const noexcept { return public_listing_; }
+    [[nodiscard]] std::string_view server_name() const noexcept { return server_name_; }
+    [[nodiscard]] std::string_view invite_code() const noexcept { return invite_code_; }
+    [[nodiscard]] GrfRange grfs() const noexcept { return GrfRange{payload_, grf_offset_, grf_count_}; }
+
+    [[nodiscard]] CoordinatorHandshakeFrame to_frame() const;
+
+private:
+    std::span<const std::byte> payload_{};
+    std::uint8_t coordinator_version_{0};
+    std::uint8_t game_info_version_{0};
+    std::uint8_t admin_version_{0};
+    std::uint16_t listen_port_{0};
+    std::uint16_t heartbeat_seconds_{0};
+    std::uint8_t server_game_type_{0};
+    std::uint8_t nat_capabilities_{0};
+    std::uint8_t public_listing_{0};
+    std::string_view server_name_{};
+    std::string_view invite_code_{};
+    std::size_t grf_offset_{0};
+    std::size_t grf_count_{0};
 };
 
 class CoordinatorClient {
@@ -68,8 +157,51 @@ public:
     CoordinatorClient();
 
     [[nodiscard]] CoordinatorHandshakeFrame build_registration_frame(const RegistrationConfig &config) const;
+    // Fills only the fixed-width fields of frame from config.
+    void apply_fixed_fields(const RegistrationConfig &config, CoordinatorHandshakeFrame &frame) const;
+};
+
+enum class FrameUpdate : std::uint8_t {
+    Unchanged,
+    Patched,
+    Rebuilt,
+};
+
+// A registration frame kept together with its serialised payload. Fixed-width
+// fields are patched in place at their schema offsets; the payload is only
+// re-serialised when a string or the GRF list changes.
+class CachedRegistrationFrame {
+public:
+    explicit CachedRegistrationFrame(const RegistrationConfig &config);
+    explicit CachedRegistrationFrame(CoordinatorHandshakeFrame frame);
+
+    // Brings the cached frame in line with config. Does not allocate unless a
+    // variable-length field changed.
+    FrameUpdate update(const RegistrationConfig &config);
+
+    void set_listen_port(std::uint16_t listen_port) noexcept;
+    void set_heartbeat_seconds(std::uint16_t heartbeat_seconds) noexcept;
+    void set_server_game_type(std::uint8_t server_game_type) noexcept;
+    void set_nat_capabilities(std::uint8_t nat_capabilities) noexcept;
+    void set_public_listing(bool listed) noexcept;
+
+    [[nodiscard]] const CoordinatorHandshakeFrame &frame() const noexcept { return frame_; }
+    [[nodiscard]] std::span<const std::byte> payload() const noexcept { return payload_; }
+    [[nodiscard]] std::uint64_t rebuilds() const noexcept { return rebuilds_; }
+    [[nodiscard]] std::uint64_t patches() const noexcept { return patches_; }
+
+private:
+    void rebuild();
+
+    CoordinatorHandshakeFrame frame_;
+    std::vector<std::byte> payload_{};
+    std::uint64_t rebuilds_{0};
+    std::uint64_t patches_{0};
 };
 
 [[nodiscard]] std::string describe_capabilities(std::uint8_t nat_capabilities);
+// As above, followed by the path a connection actually took.
+[[nodiscard]] std::string describe_capabilities(std::uint8_t nat_capabilities, NatCapability effective_path);
+[[nodiscard]] std::string_view to_string(NatCapability capability) noexcept;
 
 } // namespace sotc::network
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "network/coordinator_session.hpp"
+#include "network/event_loop.hpp"
+#include "network/latency_histogram.hpp"
+#include "network/registration_diff.hpp"
+#include "network/timer_wheel.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace sotc::network {
+
+struct CoordinatorFleetOptions {
+    // Resolution of the shared heartbeat wheel and therefore the upper bound
+    // on how late a heartbeat can be dispatched by the wheel itself.
+    EventLoop::Clock::duration wheel_tick{std::chrono::milliseconds{10}};
+    EventLoop::Clock::duration connect_timeout{std::chrono::seconds{10}};
+    // Shared by every session; see CoordinatorSessionOptions::resolver.
+    DnsCache *resolver{nullptr};
+    // Shared by every session; see CoordinatorSessionOptions::session_cache.
+    // The fleet writes it out once cache_flush_delay after the first change,
+    // so a burst of registrations costs one write, and again on close().
+    SessionCache *session_cache{nullptr};
+    EventLoop::Clock::duration cache_flush_delay{std::chrono::milliseconds{100}};
+};
+
+// How reconcile() treated each server, counted by RegistrationChange.
+struct FleetReconcileResult {
+    std::size_t unchanged{0};
+    std::size_t patched{0};
+    std::size_t reregistered{0};
+    std::size_t added{0};
+    std::size_t removed{0};
+};
+
+// Registers many servers with the coordinator from one process. Every server
+// gets its own CoordinatorSession (and connection) on the shared EventLoop,
+// while all heartbeats are scheduled on a single TimerWheel that is driven by
+// one loop timer, armed for the wheel's next expiry, so per-server timer cost
+// stays constant as the fleet grows.
+class CoordinatorFleet {
+public:
+    using StateCallback = std::function<void(std::size_t server, SessionState state)>;
+
+    explicit CoordinatorFleet(EventLoop &loop, CoordinatorFleetOptions options = {});
+    ~CoordinatorFleet();
+
+    CoordinatorFleet(const CoordinatorFleet &) = delete;
+    CoordinatorFleet &operator=(const CoordinatorFleet &) = delete;
+
+    // Adds a server; its invite code and NAT flags are taken from config, as
+    // is its heartbeat interval unless heartbeat_interval is non-zero.
+    // Returns the server's index for session(), which may be one a removed
+    // server used before. Servers added after start() start immediately.
+    std::size_t add(RegistrationConfig config, EventLoop::Clock::duration heartbeat_interval = {});
+    // Closes and destroys the server's session and frees its index for the
+    // next add(). Its heartbeats and acknowledgements stay in the totals.
+    void remove(std::size_t server);
+
+    // Brings the fleet in line with desired, e.g. after the configuration was
+    // reloaded. Servers are matched by listen port (see diff_registrations):
+    // an unchanged server is not touched, a changed one is patched and sends
+    // a SERVER_UPDATE right away, one whose coordinator changed (or that had
+    // failed) is replaced by a fresh registration, and servers no longer
+    // desired are removed.
+    FleetReconcileResult reconcile(std::span<const RegistrationConfig> desired);
+
+    void start();
+    void close() noexcept;
+
+    void set_state_callback(StateCallback callback) { state_callback_ = std::move(callback); }
+
+    // Servers that have not been removed, including failed ones.
+    [[nodiscard]] std::size_t size() const noexcept { return sessions_.size() - free_.size(); }
+    // Servers not removed, in the order of the last reconcile() and add()s
+    // since.
+    [[nodiscard]] const std::vector<std::size_t> &active() const noexcept { return active_; }
+    // server must not have been removed.
+    [[nodiscard]] const CoordinatorSession &session(std::size_t server) const { return *sessions_.at(server); }
+    [[nodiscard]] std::size_t count(SessionState state) const noexcept;
+    // True once every session has either failed or been closed.
+    [[nodiscard]] bool finished() const noexcept;
+
+    [[nodiscard]] std::uint64_t heartbeats_sent() const noexcept;
+    [[nodiscard]] LatencyHistogram ack_latency() const noexcept;
+    // Lateness of each heartbeat relative to its scheduled deadline.
+    [[nodiscard]] const LatencyHistogram &heartbeat_jitter() const noexcept { return wheel_.jitter(); }
+    [[nodiscard]] const TimerWheel &wheel() const noexcept { return wheel_; }
+
+private:
+    void arm_wheel();
+    // Arms the cache flush timer when the session cache has unsaved changes.
+    void schedule_cache_flush();
+    void flush_session_cache() noexcept;
+    // Closes and destroys a session without touching active_.
+    void release(std::size_t server);
+
+    EventLoop &loop_;
+    CoordinatorFleetOptions options_;
+    TimerWheel wheel_;
+    std::vector<std::unique_ptr<CoordinatorSession>> sessions_{};
+    // Each server's registration as configured, which reconcile() diffs
+    // against; the session's own config() also carries what it resumed.
+    std::vector<RegistrationConfig> configs_{};
+    // Indices of removed servers, reused by add().
+    std::vector<std::size_t> free_{};
+    std::uint64_t released_heartbeats_{0};
+    LatencyHistogram released_ack_latency_{};
+    std::vector<std::size_t> active_{};
+    bool started_{false};
+    StateCallback state_callback_{};
+    EventLoop::TimerId wheel_timer_{0};
+    EventLoop::Clock::time_point wheel_deadline_{};
+    EventLoop::TimerId cache_timer_{0};
+};
+
+} // namespace sotc::network
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "network/decode_result.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sotc::network {
+
+// Coordinator TCP packet types, numbered as in OpenTTD 14.1's
+// PacketCoordinatorType.
+enum class PacketCoordinatorType : std::uint8_t {
+    GcError = 0,
+    ServerRegister = 1,
+    GcRegisterAck = 2,
+    ServerUpdate = 3,
+    ClientListing = 4,
+    GcListing = 5,
+    ClientConnect = 6,
+    GcConnecting = 7,
+    SercliConnectFailed = 8,
+    GcConnectFailed = 9,
+    ClientConnected = 10,
+    GcDirectConnect = 11,
+    GcStunRequest = 12,
+    SercliStunResult = 13,
+    GcNewGrfLookup = 14,
+    GcTurnConnect = 15,
+};
+
+enum class CoordinatorErrorCode : std::uint8_t {
+    Unknown = 0,
+    RegistrationFailed = 1,
+    InvalidInviteCode = 2,
+    ReuseOfInviteCode = 3,
+};
+
+enum class ConnectionType : std::uint8_t {
+    Unknown = 0,
+    Isolated = 1,
+    Direct = 2,
+    Stun = 3,
+    Turn = 4,
+};
+
+// PACKET_COORDINATOR_GC_REGISTER_ACK: sent in reply to a registration or
+// update; carries the invite code assigned to the server.
+struct CoordinatorRegisterAck {
+    std::string invite_code{};
+    std::string invite_code_secret{};
+    std::uint8_t connection_type{static_cast<std::uint8_t>(ConnectionType::Unknown)};
+
+    [[nodiscard]] std::size_t serialized_size() const;
+    std::size_t serialize_into(std::span<std::byte> buffer) const;
+    [[nodiscard]] static DecodeResult<CoordinatorRegisterAck> try_deserialize(std::span<const std::byte> payload);
+};
+
+// PACKET_COORDINATOR_GC_ERROR.
+struct CoordinatorErrorPacket {
+    std::uint8_t error_code{static_cast<std::uint8_t>(CoordinatorErrorCode::Unknown)};
+    std::string detail{};
+
+    [[nodiscard]] std::size_t serialized_size() const;
+    std::size_t serialize_into(std::span<std::byte> buffer) const;
+    [[nodiscard]] static DecodeResult<CoordinatorErrorPacket> try_deserialize(std::span<const std::byte> payload);
+};
+
+[[nodiscard]] std::string to_string(CoordinatorErrorCode code);
+
+} // namespace sotc::network
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "network/coordinator_client.hpp"
+#include "network/coordinator_protocol.hpp"
+#include "network/dns_cache.hpp"
+#include "network/event_loop.hpp"
+#include "network/latency_histogram.hpp"
+#include "network/packet_framer.hpp"
+#include "network/session_cache.hpp"
+#include "network/socket.hpp"
+#include "network/timer_wheel.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sotc::network {
+
+enum class SessionState : std::uint8_t {
+    Idle,
+    Connecting,
+    Registering,
+    Registered,
+    Failed,
+    Closed,
+};
+
+[[nodiscard]] std::string_view to_string(SessionState state) noexcept;
+
+struct CoordinatorSessionOptions {
+    // Zero uses the heartbeat advertised in the registration frame.
+    EventLoop::Clock::duration heartbeat_interval{};
+    EventLoop::Clock::duration connect_timeout{std::chrono::seconds{10}};
+    // How long to wait for the GC_REGISTER_ACK once connected before the
+    // registration is treated as failed.
+    EventLoop::Clock::duration register_timeout{std::chrono::seconds{10}};
+    // When set, heartbeats are scheduled on this wheel instead of the loop's
+    // timer queue; the owner is responsible for advancing it.
+    TimerWheel *heartbeat_wheel{nullptr};
+    // When set, the coordinator host is resolved through this cache instead
+    // of a blocking lookup in start(). It must be attached to the same loop.
+    DnsCache *resolver{nullptr};
+    // When set and it holds an entry for this server, start() dials the
+    // cached coordinator address directly and presents the cached invite
+    // code (unless the config has its own). If that fails before the
+    // coordinator acknowledges it, the entry is dropped and the session
+    // falls back to a full registration. The first acknowledgement is
+    // written back to the cache, and the entry follows the server when
+    // update_registration() changes its identity. The session only updates
+    // the cache in memory; writing it out is left to the owner (see
+    // SessionCache::flush(), which CoordinatorFleet calls).
+    SessionCache *session_cache{nullptr};
+};
+
+// Non-blocking coordinator registration driven by an EventLoop. The session
+// connects, sends PACKET_COORDINATOR_SERVER_REGISTER, waits for the
+// GC_REGISTER_ACK and then sends SERVER_UPDATE heartbeats. Every register or
+// update that is acknowledged contributes one sample to ack_latency().
+class CoordinatorSession {
+public:
+    using StateCallback = std::function<void(SessionState)>;
+
+    CoordinatorSession(EventLoop &loop, RegistrationConfig config, CoordinatorSessionOptions options = {});
+    ~CoordinatorSession();
+
+    CoordinatorSession(const CoordinatorSession &) = delete;
+    CoordinatorSession &operator=(const CoordinatorSession &) = delete;
+
+    void start();
+    void close() noexcept;
+
+    void set_state_callback(StateCallback callback) { state_callback_ = std::move(callback); }
+
+    [[nodiscard]] SessionState state() const noexcept { return state_; }
+    [[nodiscard]] const std::string &last_error() const noexcept { return last_error_; }
+    [[nodiscard]] const RegistrationConfig &config() const noexcept { return config_; }
+    [[nodiscard]] const CoordinatorHandshakeFrame &frame() const noexcept { return frame_.frame(); }
+    [[nodiscard]] const CachedRegistrationFrame &cached_frame() const noexcept { return frame_; }
+    [[nodiscard]] const CoordinatorRegisterAck &registration() const noexcept { return registration_; }
+    [[nodiscard]] const LatencyHistogram &ack_latency() const noexcept { return ack_latency_; }
+    [[nodiscard]] std::uint64_t heartbeats_sent() const noexcept { return heartbeats_sent_; }
+    // True while the current registration came from the session cache.
+    [[nodiscard]] bool resumed() const noexcept { return resumed_; }
+    // From start() to the first acknowledgement; zero until registered.
+    [[nodiscard]] EventLoop::Clock::duration time_to_registered() const noexcept { return time_to_registered_; }
+
+    // Sends a SERVER_UPDATE immediately; used by the heartbeat timer.
+    void send_heartbeat();
+
+    // Applies config to the frame sent with the next heartbeat. Changes to
+    // fixed-width fields are patched into the cached payload. A resumed
+    // invite code is kept unless config sets one.
+    FrameUpdate update_registration(const RegistrationConfig &config);
+
+private:
+    using Clock = EventLoop::Clock;
+
+    void set_state(SessionState state);
+    void fail(std::string message);
+    bool resume();
+    void fall_back();
+    // Stores the current registration under identity_.
+    void remember_registration();
+    // Resets the stream and connects to direct, or to the resolved
+    // coordinator host when direct is null.
+    void begin(const Endpoint *direct);
+    void connect_to(const std::vector<Endpoint> &endpoints);
+    void on_io(std::uint32_t events);
+    void on_connected();
+    void on_readable();
+    void handle_packet(const FramedPacket &packet);
+    void queue_frame(PacketCoordinatorType type);
+    void flush();
+    void schedule_heartbeat();
+    void cancel_timers() noexcept;
+
+    EventLoop &loop_;
+    RegistrationConfig config_;
+    CoordinatorSessionOptions options_;
+    bool heartbeat_follows_frame_{false};
+    CachedRegistrationFrame frame_;
+    SessionState state_{SessionState::Idle};
+    std::string last_error_{};
+    StateCallback state_callback_{};
+
+    std::string identity_{};
+    bool resumed_{false};
+    bool resumed_invite_code_{false};
+    std::string coordinator_endpoint_{};
+    Clock::time_point started_at_{};
+    Clock::duration time_to_registered_{};
+
+    SocketHandle socket_{};
+    bool watching_writable_{false};
+    DnsCache::RequestId resolve_request_{0};
+    PacketFramer framer_;
+    std::vector<std::byte> outbound_{};
+    std::size_t outbound_offset_{0};
+    std::vector<std::byte> scratch_{};
+
+    std::deque<Clock::time_point> pending_acks_{};
+    CoordinatorRegisterAck registration_{};
+    LatencyHistogram ack_latency_{};
+    std::uint64_t heartbeats_sent_{0};
+
+    EventLoop::TimerId connect_timer_{0};
+    EventLoop::TimerId heartbeat_timer_{0};
+};
+
+} // namespace sotc::network
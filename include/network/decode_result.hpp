@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace sotc::network {
+
+// Reasons a coordinator payload can be rejected. The numeric values are part
+// of the diagnostics surface (logs, metrics) and must not be renumbered.
+enum class DecodeError : std::uint8_t {
+    None = 0,
+    Truncated = 1,
+    StringTooLong = 2,
+    TooManyItems = 3,
+    TrailingData = 4,
+    InvalidPacketSize = 5,
+    UnsupportedVersion = 6,
+    InvalidValue = 7,
+};
+
+[[nodiscard]] constexpr std::string_view to_string(DecodeError error) noexcept {
+    switch (error) {
+    case DecodeError::None:
+        return "none";
+    case DecodeError::Truncated:
+        return "truncated";
+    case DecodeError::StringTooLong:
+        return "string too long";
+    case DecodeError::TooManyItems:
+        return "too many items";
+    case DecodeError::TrailingData:
+        return "trailing data";
+    case DecodeError::InvalidPacketSize:
+        return "invalid packet size";
+    case DecodeError::UnsupportedVersion:
+        return "unsupported version";
+    case DecodeError::InvalidValue:
+        return "invalid value";
+    }
+    return "unknown";
+}
+
+// Value-or-error result returned by the non-throwing decode paths, modelled on
+// std::expected. error_field() names the field that failed to decode and
+// always refers to static storage.
+template <typename T>
+class DecodeResult {
+public:
+    DecodeResult(T value) : value_(std::move(value)) {}
+    DecodeResult(DecodeError error, std::string_view field) noexcept : error_(error), field_(field) {}
+
+    [[nodiscard]] bool has_value() const noexcept { return value_.has_value(); }
+    [[nodiscard]] explicit operator bool() const noexcept { return has_value(); }
+
+    [[nodiscard]] T &value() & {
+        require_value();
+        return *value_;
+    }
+    [[nodiscard]] const T &value() const & {
+        require_value();
+        return *value_;
+    }
+    [[nodiscard]] T &&value() && {
+        require_value();
+        return std::move(*value_);
+    }
+
+    [[nodiscard]] T &operator*() & noexcept { return *value_; }
+    [[nodiscard]] const T &operator*() const & noexcept { return *value_; }
+    [[nodiscard]] T *operator->() noexcept { return &*value_; }
+    [[nodiscard]] const T *operator->() const noexcept { return &*value_; }
+
+    [[nodiscard]] DecodeError error() const noexcept { return error_; }
+    [[nodiscard]] std::string_view error_field() const noexcept { return field_; }
+
+private:
+    void require_value() const {
+        if (!value_) {
+            throw std::logic_error{"DecodeResult accessed without a value"};
+        }
+    }
+
+    std::optional<T> value_{};
+    DecodeError error_{DecodeError::None};
+    std::string_view field_{};
+};
+
+} // namespace sotc::network
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "network/event_loop.hpp"
+#include "network/socket.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/socket.h>
+
+namespace sotc::network {
+
+struct DnsAnswer {
+    std::vector<Endpoint> endpoints{};
+    // Set by backends that know the record TTL; getaddrinfo does not.
+    std::optional<std::chrono::seconds> ttl{};
+    // The lookup failed for a reason that may clear up by itself, such as
+    // EAI_AGAIN or EAI_SYSTEM, rather than because the name does not exist.
+    bool transient{false};
+};
+
+using DnsBackend = std::function<DnsAnswer(const std::string &host, std::uint16_t port, int socket_type)>;
+
+// resolve_endpoints() behind the DnsBackend interface. Only EAI_NONAME and
+// EAI_NODATA count as the name not existing; other failures are transient.
+[[nodiscard]] DnsAnswer system_dns_backend(const std::string &host, std::uint16_t port, int socket_type);
+
+struct DnsCacheOptions {
+    // Used when the backend reports no TTL.
+    EventLoop::Clock::duration positive_ttl{std::chrono::minutes{5}};
+    // How long a name that does not exist is remembered before it is retried.
+    EventLoop::Clock::duration negative_ttl{std::chrono::seconds{30}};
+    // The same for a transient failure; zero retries on the next request, so
+    // a resolver hiccup does not hide a host for negative_ttl.
+    EventLoop::Clock::duration transient_ttl{};
+};
+
+// Resolver cache with TTLs and negative caching. Lookups run on one worker
+// thread, so the event loop never blocks in getaddrinfo; completions are
+// handed back on the loop the cache is attached to. Concurrent requests for
+// the same name share one lookup.
+class DnsCache {
+public:
+    using RequestId = std::uint64_t;
+    using ResolveCallback = std::function<void(const std::vector<Endpoint> &endpoints)>;
+
+    explicit DnsCache(DnsCacheOptions options = {}, DnsBackend backend = system_dns_backend);
+    // Joins the worker, which may first have to finish a lookup in progress.
+    ~DnsCache();
+
+    DnsCache(const DnsCache &) = delete;
+    DnsCache &operator=(const DnsCache &) = delete;
+
+    // Completions are delivered through loop from now on. Lookups that
+    // finished while detached are delivered at once.
+    void attach(EventLoop &loop);
+    void detach() noexcept;
+
+    // Starts a lookup unless a fresh answer is cached or one is in progress.
+    void prefetch(const std::string &host, std::uint16_t port, int socket_type = SOCK_STREAM);
+    // Calls back before returning, with 0 as the id, when a fresh answer is
+    // cached; otherwise on the attached loop once the lookup finishes. An
+    // empty endpoint list means the host did not resolve.
+    RequestId resolve(const std::string &host, std::uint16_t port, ResolveCallback callback,
+                      int socket_type = SOCK_STREAM);
+    // The callback of a cancelled request is never invoked.
+    void cancel(RequestId id) noexcept;
+
+    // The fresh cached answer, if any; empty for a cached failure.
+    [[nodiscard]] std::optional<std::vector<Endpoint>> cached(const std::string &host, std::uint16_t port,
+                                                              int socket_type = SOCK_STREAM) const;
+    void clear();
+
+    [[nodiscard]] std::uint64_t hits() const noexcept;
+    [[nodiscard]] std::uint64_t negative_hits() const noexcept;
+    [[nodiscard]] std::uint64_t misses() const noexcept;
+    [[nodiscard]] std::uint64_t lookups() const noexcept;
+
+private:
+    struct Entry {
+        std::vector<Endpoint> endpoints{};
+        EventLoop::Clock::time_point expires{};
+        bool resolved{false};
+        bool resolving{false};
+        std::vector<RequestId> waiters{};
+    };
+    struct Job {
+        std::string key{};
+        std::string host{};
+        std::uint16_t port{0};
+        int socket_type{SOCK_STREAM};
+    };
+
+    [[nodiscard]] static std::string make_key(const std::string &host, std::uint16_t port, int socket_type);
+    // With mutex_ held. Returns the entry, queueing a lookup if it is stale.
+    Entry &ensure_lookup(const std::string &key, const std::string &host, std::uint16_t port, int socket_type);
+    void run_worker();
+    void dispatch_completed();
+
+    DnsCacheOptions options_;
+    DnsBackend backend_;
+    EventLoop *loop_{nullptr};
+    SocketHandle wakeup_{};
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::unordered_map<std::string, Entry> entries_{};
+    std::unordered_map<RequestId, ResolveCallback> requests_{};
+    std::deque<Job> jobs_{};
+    std::vector<std::string> completed_{};
+    RequestId next_request_{1};
+    bool stopping_{false};
+    std::uint64_t hits_{0};
+    std::uint64_t negative_hits_{0};
+    std::uint64_t misses_{0};
+    std::uint64_t lookups_{0};
+
+    std::thread worker_;
+};
+
+} // namespace sotc::network
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+namespace sotc::network {
+
+// Single-threaded readiness loop built on epoll. File descriptors and timers
+// are dispatched from run_once(); callbacks may freely add or remove other
+// registrations, including their own.
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+    using IoCallback = std::function<void(std::uint32_t events)>;
+    using TimerCallback = std::function<void()>;
+    using TimerId = std::uint64_t;
+
+    static constexpr std::uint32_t kReadable = 0x01;
+    static constexpr std::uint32_t kWritable = 0x02;
+    static constexpr std::uint32_t kError = 0x04;
+    static constexpr std::uint32_t kHangup = 0x08;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    void add(int fd, std::uint32_t events, IoCallback callback);
+    void modify(int fd, std::uint32_t events);
+    void remove(int fd) noexcept;
+
+    TimerId schedule_at(Clock::time_point deadline, TimerCallback callback);
+    TimerId schedule_after(Clock::duration delay, TimerCallback callback);
+    void cancel(TimerId id) noexcept;
+
+    // Waits for at most max_wait (less if a timer is due sooner) and
+    // dispatches ready descriptors and expired timers. Returns the number of
+    // callbacks invoked.
+    std::size_t run_once(Clock::duration max_wait);
+
+    // Dispatches until stop() is called or nothing is left to wait for.
+    void run();
+    void stop() noexcept { stopped_ = true; }
+    [[nodiscard]] bool stopped() const noexcept { return stopped_; }
+
+    [[nodiscard]] std::size_t watched_descriptors() const noexcept { return handlers_.size(); }
+    [[nodiscard]] std::size_t pending_timers() const noexcept { return timers_.size(); }
+
+private:
+    std::size_t dispatch_timers();
+
+    using TimerKey = std::pair<Clock::time_point, TimerId>;
+
+    int epoll_fd_{-1};
+    bool stopped_{false};
+    TimerId next_timer_id_{1};
+    std::unordered_map<int, std::shared_ptr<IoCallback>> handlers_{};
+    std::map<TimerKey, TimerCallback> timers_{};
+    std::unordered_map<TimerId, Clock::time_point> timer_deadlines_{};
+};
+
+} // namespace sotc::network
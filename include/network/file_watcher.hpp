@@ -0,0 +1,73 @@
+#pragma once
+
+#include "network/event_loop.hpp"
+#include "network/socket.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sotc::network {
+
+struct FileWatcherOptions {
+    // Events for the watched files are collected for this long before the
+    // callback runs, so an editor's write, truncate and rename steps arrive
+    // as one change.
+    EventLoop::Clock::duration settle{std::chrono::milliseconds{20}};
+};
+
+// Watches files for changes with inotify on an EventLoop. The directories
+// holding the files are watched rather than the files themselves, so a file
+// that is replaced by rename (as most editors save) stays watched. A change
+// is a write being closed or a file being moved or created under a watched
+// name.
+class FileWatcher {
+public:
+    using Clock = EventLoop::Clock;
+    // changed holds the watched paths, as given to the constructor, seen
+    // since the previous call; first_event is when the first of them was
+    // noticed.
+    using ChangeCallback = std::function<void(const std::vector<std::filesystem::path> &changed,
+                                              Clock::time_point first_event)>;
+
+    // Throws std::system_error when inotify is unavailable or a directory
+    // cannot be watched.
+    FileWatcher(EventLoop &loop, const std::vector<std::filesystem::path> &files, FileWatcherOptions options = {});
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    void set_change_callback(ChangeCallback callback) { change_callback_ = std::move(callback); }
+
+    // inotify events that named a watched file.
+    [[nodiscard]] std::uint64_t events() const noexcept { return events_; }
+    // Times the change callback ran.
+    [[nodiscard]] std::uint64_t changes() const noexcept { return changes_; }
+
+private:
+    struct WatchedFile {
+        std::filesystem::path path;
+        bool pending{false};
+    };
+
+    void on_readable();
+    void notify();
+
+    EventLoop &loop_;
+    FileWatcherOptions options_;
+    SocketHandle inotify_{};
+    // Watched files by watch descriptor, then by file name.
+    std::unordered_map<int, std::unordered_map<std::string, WatchedFile>> watches_{};
+    EventLoop::TimerId settle_timer_{0};
+    Clock::time_point first_event_{};
+    std::uint64_t events_{0};
+    std::uint64_t changes_{0};
+    ChangeCallback change_callback_{};
+};
+
+} // namespace sotc::network
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sotc::network {
+
+// Immutable list of advertised NewGRF identifiers. Copies share one
+// reference-counted block, so launch options, their profiles, the
+// registrations and handshake frames built from them and the settings window
+// all hold the same strings. Lists read from configuration are interned:
+// while one is alive, every other interned list with the same identifiers
+// shares its block.
+class GrfList {
+public:
+    using const_iterator = std::vector<std::string>::const_iterator;
+
+    GrfList() noexcept = default;
+    explicit GrfList(std::vector<std::string> grfs);
+    GrfList(std::initializer_list<std::string_view> grfs);
+
+    [[nodiscard]] std::size_t size() const noexcept { return items().size(); }
+    [[nodiscard]] bool empty() const noexcept { return grfs_ == nullptr; }
+    [[nodiscard]] const std::string &operator[](std::size_t index) const noexcept { return items()[index]; }
+    [[nodiscard]] const_iterator begin() const noexcept { return items().begin(); }
+    [[nodiscard]] const_iterator end() const noexcept { return items().end(); }
+
+    // The live interned list holding grfs, or a new one when there is none.
+    [[nodiscard]] static GrfList interned(std::vector<std::string> grfs);
+
+    // This list with grf added at the end, interned.
+    [[nodiscard]] GrfList appended(std::string grf) const;
+
+    // Shared storage, which every copy and interned duplicate has, compares
+    // without looking at the identifiers.
+    [[nodiscard]] friend bool operator==(const GrfList &lhs, const GrfList &rhs) noexcept {
+        return lhs.grfs_ == rhs.grfs_ || lhs.items() == rhs.items();
+    }
+
+    // Number of lists sharing this one's storage; zero for an empty list.
+    [[nodiscard]] long use_count() const noexcept { return grfs_.use_count(); }
+
+private:
+    using Storage = std::vector<std::string>;
+
+    [[nodiscard]] const Storage &items() const noexcept {
+        static const Storage empty_storage{};
+        return grfs_ != nullptr ? *grfs_ : empty_storage;
+    }
+
+    explicit GrfList(std::shared_ptr<const Storage> grfs) noexcept : grfs_(std::move(grfs)) {}
+
+    // Null for the empty list.
+    std::shared_ptr<const Storage> grfs_{};
+};
+
+} // namespace sotc::network
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "network/constants.hpp"
+#include "network/server_listing.hpp"
+#include "network/socket.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sotc::network {
+
+enum class PacketUdpType : std::uint8_t {
+    ClientFindServer = 0,
+    ServerResponse = 1,
+};
+
+// Large enough for a server response advertising all NETWORK_MAX_GRF_COUNT
+// NewGRFs; longer datagrams are counted as malformed.
+inline constexpr std::size_t NETWORK_LAN_MAX_DATAGRAM_SIZE = 8 * 1024;
+
+struct LanDiscoveryOptions {
+    // Each target is HOST[:PORT], which may be a broadcast address, or an
+    // IPv4 subnet A.B.C.D/N (N >= 16) that is probed host by host.
+    std::vector<std::string> targets{"255.255.255.255"};
+    std::uint16_t default_port{NETWORK_DEFAULT_GAME_PORT};
+    // Deadline for the whole discovery, probes included.
+    std::chrono::milliseconds timeout{std::chrono::milliseconds{750}};
+    // Datagrams per sendmmsg/recvmmsg call.
+    std::size_t batch_size{64};
+};
+
+struct LanServer {
+    Endpoint endpoint{};
+    NetworkGameInfo info{};
+    // From the probe sent to this address, or from the first probe for
+    // replies to a broadcast.
+    std::chrono::nanoseconds round_trip{0};
+};
+
+struct LanDiscoveryResult {
+    // In order of arrival, one per responding address.
+    std::vector<LanServer> servers{};
+    std::size_t probes_sent{0};
+    std::size_t probes_failed{0};
+    std::size_t duplicates{0};
+    std::size_t malformed{0};
+};
+
+// Resolves and expands targets into probe destinations, without duplicates.
+// Throws std::invalid_argument for a target that cannot be parsed or resolved.
+[[nodiscard]] std::vector<Endpoint> expand_lan_targets(const std::vector<std::string> &targets,
+                                                       std::uint16_t default_port);
+
+// PACKET_UDP_CLIENT_FIND_SERVER and PACKET_UDP_SERVER_RESPONSE datagrams.
+[[nodiscard]] std::vector<std::byte> build_lan_probe();
+[[nodiscard]] std::vector<std::byte> build_lan_response(const NetworkGameInfo &info);
+[[nodiscard]] bool is_lan_probe(std::span<const std::byte> datagram) noexcept;
+[[nodiscard]] DecodeResult<NetworkGameInfo> parse_lan_response(std::span<const std::byte> datagram);
+
+// Probes every target in one round: all probes go out in sendmmsg batches,
+// then a single loop collects replies with recvmmsg until the deadline or,
+// when only unicast addresses were probed, until each of them has answered.
+// Replies are deduplicated by source address. Throws std::system_error if
+// the sockets cannot be created.
+[[nodiscard]] LanDiscoveryResult discover_local_servers(const LanDiscoveryOptions &options = {});
+
+} // namespace sotc::network
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sotc::network {
+
+// Fixed-size log-linear histogram for latency samples. Each power-of-two
+// range is split into 16 linear sub-buckets, bounding the relative error of
+// reported percentiles to about 6%. Recording is O(1) and never allocates.
+class LatencyHistogram {
+public:
+    void record(std::chrono::nanoseconds value) noexcept;
+    void merge(const LatencyHistogram &other) noexcept;
+    void reset() noexcept;
+
+    [[nodiscard]] std::uint64_t count() const noexcept { return count_; }
+    [[nodiscard]] std::chrono::nanoseconds min() const noexcept;
+    [[nodiscard]] std::chrono::nanoseconds max() const noexcept;
+    [[nodiscard]] std::chrono::nanoseconds mean() const noexcept;
+
+    // percentile is in [0, 100]; returns zero for an empty histogram.
+    [[nodiscard]] std::chrono::nanoseconds percentile(double percentile) const noexcept;
+
+private:
+    static constexpr std::size_t kSubBucketBits = 4;
+    static constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBucketBits;
+    static constexpr std::size_t kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+    [[nodiscard]] static std::size_t bucket_index(std::uint64_t value) noexcept;
+    [[nodiscard]] static std::uint64_t bucket_upper_bound(std::size_t index) noexcept;
+
+    std::array<std::uint64_t, kBucketCount> buckets_{};
+    std::uint64_t count_{0};
+    std::uint64_t sum_{0};
+    std::uint64_t min_{UINT64_MAX};
+    std::uint64_t max_{0};
+};
+
+// Rolling window over the most recent samples of one endpoint. Unlike
+// LatencyHistogram it forgets old samples and is small enough to keep per
+// server; percentiles are exact over the window.
+class RttWindow {
+public:
+    explicit RttWindow(std::size_t capacity = 32);
+
+    void record(std::chrono::nanoseconds value);
+    void reset() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return samples_.size(); }
+    [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+    [[nodiscard]] std::chrono::nanoseconds last() const noexcept;
+    [[nodiscard]] std::chrono::nanoseconds min() const noexcept;
+    // percentile is in [0, 100] using nearest rank; zero while empty.
+    [[nodiscard]] std::chrono::nanoseconds percentile(double percentile) const;
+
+private:
+    std::vector<std::chrono::nanoseconds> samples_{};
+    std::size_t capacity_;
+    std::size_t next_{0};
+};
+
+} // namespace sotc::network
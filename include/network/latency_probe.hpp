@@ -0,0 +1,138 @@
+#pragma once
+
+#include "network/dns_cache.hpp"
+#include "network/event_loop.hpp"
+#include "network/latency_histogram.hpp"
+#include "network/socket.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sotc::network {
+
+struct LatencyProbeOptions {
+    // Probes awaiting a reply or timeout at any one time, across endpoints.
+    std::size_t max_in_flight{32};
+    // Probes sent to each endpoint after it is added.
+    std::size_t probes_per_endpoint{3};
+    EventLoop::Clock::duration probe_timeout{std::chrono::seconds{1}};
+    // Pause between consecutive probes to the same endpoint.
+    EventLoop::Clock::duration probe_interval{std::chrono::milliseconds{100}};
+    // Samples kept per endpoint for min/p50/p99.
+    std::size_t window{32};
+    // Resolves hosts passed to add() without blocking the loop; when null
+    // they are resolved in place.
+    DnsCache *resolver{nullptr};
+};
+
+struct EndpointLatency {
+    std::string host{};
+    std::uint16_t port{0};
+    Endpoint endpoint{};
+    bool resolved{false};
+    RttWindow rtt{};
+    std::size_t sent{0};
+    std::size_t received{0};
+    std::size_t lost{0};
+    // Replies that arrived after their probe had timed out; not counted as
+    // received.
+    std::size_t late{0};
+};
+
+// Measures UDP round-trip times to many game servers on an EventLoop. Each
+// probe is a PACKET_UDP_CLIENT_FIND_SERVER; the server's response closes it.
+// At most max_in_flight probes are outstanding, every endpoint has at most
+// one, and timestamps come from the loop's steady clock. The result callback
+// fires after every reply or timeout, so a server browser can show pings as
+// they come in.
+//
+// The reply echoes nothing from the probe, so it is matched by source
+// address and by the socket it arrives on. After a timeout the endpoint's
+// next probe goes out from the other of two sockets, and a late answer to
+// the lost probe is counted as late instead of as the next probe's reply.
+class LatencyProber {
+public:
+    using EndpointId = std::size_t;
+    using ResultCallback = std::function<void(EndpointId, const EndpointLatency &)>;
+
+    explicit LatencyProber(EventLoop &loop, LatencyProbeOptions options = {});
+    ~LatencyProber();
+
+    LatencyProber(const LatencyProber &) = delete;
+    LatencyProber &operator=(const LatencyProber &) = delete;
+
+    // Resolves host, through the options' resolver when set, and queues its
+    // probes. An unresolvable host is kept with resolved == false and
+    // reported through the callback. A host that resolves to an address
+    // already added probes that endpoint again instead.
+    EndpointId add(std::string host, std::uint16_t port);
+    // As above for a host already resolved to endpoint, e.g. through DnsCache.
+    EndpointId add(std::string host, std::uint16_t port, const Endpoint &endpoint);
+    // Queues another probes_per_endpoint probes for an existing endpoint.
+    void reprobe(EndpointId id);
+    void close() noexcept;
+
+    void set_result_callback(ResultCallback callback) { result_callback_ = std::move(callback); }
+
+    [[nodiscard]] std::size_t size() const noexcept { return endpoints_.size(); }
+    [[nodiscard]] const EndpointLatency &endpoint(EndpointId id) const { return endpoints_.at(id).latency; }
+    // True once every probe queued for the endpoint has completed.
+    [[nodiscard]] bool done(EndpointId id) const;
+    [[nodiscard]] std::size_t in_flight() const noexcept { return in_flight_; }
+    [[nodiscard]] std::size_t peak_in_flight() const noexcept { return peak_in_flight_; }
+    // No probe queued, waiting for its interval or in flight.
+    [[nodiscard]] bool idle() const noexcept;
+    // Every reply received, across endpoints.
+    [[nodiscard]] const LatencyHistogram &rtt_histogram() const noexcept { return histogram_; }
+
+private:
+    struct State {
+        EndpointLatency latency{};
+        std::size_t queued{0};
+        bool in_flight{false};
+        bool waiting{false};
+        EventLoop::Clock::time_point sent_at{};
+        EventLoop::TimerId timer{0};
+        DnsCache::RequestId resolve_request{0};
+        bool resolving{false};
+        // Which of the family's two sockets the next probe is sent from, and
+        // the descriptor the current one went out on.
+        std::size_t lane{0};
+        int probe_fd{-1};
+    };
+
+    void pump();
+    void send_probe(EndpointId id);
+    // Closes the endpoint's current probe and schedules its next one. Callers
+    // pump() afterwards.
+    void finish_probe(EndpointId id, bool replied, EventLoop::Clock::time_point now);
+    // Finishes an add() once host resolved to endpoints (empty if it did not).
+    void on_resolved(EndpointId id, const std::vector<Endpoint> &endpoints);
+    void on_readable(int fd);
+    [[nodiscard]] int socket_for(const Endpoint &endpoint, std::size_t lane);
+
+    EventLoop &loop_;
+    LatencyProbeOptions options_;
+    std::vector<State> endpoints_{};
+    std::unordered_map<std::string, EndpointId> by_address_{};
+    std::deque<EndpointId> ready_{};
+    std::size_t waiting_{0};
+    std::size_t resolving_{0};
+    std::size_t in_flight_{0};
+    std::size_t peak_in_flight_{0};
+    // Two per address family; see the class comment.
+    std::array<SocketHandle, 4> sockets_{};
+    std::vector<std::byte> probe_{};
+    std::vector<std::byte> buffer_{};
+    LatencyHistogram histogram_{};
+    ResultCallback result_callback_{};
+};
+
+} // namespace sotc::network
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace sotc::network {
+
+using Md5Digest = std::array<std::uint8_t, 16>;
+
+// Incremental MD5 (RFC 1321), the checksum OpenTTD identifies NewGRFs by.
+// Bytes can be fed as they arrive; finish() pads and returns the digest and
+// leaves the hasher ready for a new message.
+class Md5 {
+public:
+    Md5() noexcept { reset(); }
+
+    void reset() noexcept;
+    void update(std::span<const std::byte> data) noexcept;
+    [[nodiscard]] Md5Digest finish() noexcept;
+
+    // Bytes fed since the last reset.
+    [[nodiscard]] std::uint64_t size() const noexcept { return length_; }
+
+private:
+    void transform(const std::uint8_t *block) noexcept;
+
+    std::array<std::uint32_t, 4> state_{};
+    std::array<std::uint8_t, 64> buffer_{};
+    std::uint64_t length_{0};
+};
+
+// Lower-case hex, as used for content-addressed cache file names.
+[[nodiscard]] std::string to_hex(const Md5Digest &digest);
+
+} // namespace sotc::network
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "network/server_listing.hpp"
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace sotc::network {
+
+// The identity is 20 bytes with no padding, so a set of them is one dense
+// array that is compared with plain integer and byte comparisons.
+static_assert(sizeof(NewGrfIdentity) == 20);
+
+// Sorted, duplicate-free NewGRF identities in one contiguous array, e.g. the
+// NewGRFs installed locally. Membership is a binary search and set
+// containment a single merge pass.
+class NewGrfSet {
+public:
+    NewGrfSet() = default;
+    explicit NewGrfSet(std::vector<NewGrfIdentity> identities);
+
+    // Returns false when identity was already present.
+    bool insert(const NewGrfIdentity &identity);
+    [[nodiscard]] bool contains(const NewGrfIdentity &identity) const noexcept;
+    // True when every element of sorted, which must be ascending, is in the
+    // set.
+    [[nodiscard]] bool includes(std::span<const NewGrfIdentity> sorted) const noexcept;
+    [[nodiscard]] bool includes(const NewGrfSet &other) const noexcept { return includes(other.identities()); }
+    // The identities of required, in any order, that are not in the set.
+    [[nodiscard]] std::vector<NewGrfIdentity> missing(std::span<const NewGrfIdentity> required) const;
+
+    [[nodiscard]] std::span<const NewGrfIdentity> identities() const noexcept { return identities_; }
+    [[nodiscard]] std::size_t size() const noexcept { return identities_.size(); }
+    [[nodiscard]] bool empty() const noexcept { return identities_.empty(); }
+    void clear() noexcept { identities_.clear(); }
+
+private:
+    std::vector<NewGrfIdentity> identities_{};
+};
+
+} // namespace sotc::network
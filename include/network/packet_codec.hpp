@@ -0,0 +1,420 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "network/decode_result.hpp"
+
+// Declarative wire codec for coordinator packets. A packet is described once as
+// a PacketSchema listing its fields in wire order; the schema then provides the
+// exact serialised size, a fused serialiser and a single-pass parser. Everything
+// is resolved at compile time, so there is no per-field dispatch at runtime.
+
+namespace sotc::network::codec {
+
+template <std::size_t N>
+struct FieldName {
+    char value[N]{};
+
+    constexpr FieldName(const char (&text)[N]) { std::copy_n(text, N, value); }
+
+    [[nodiscard]] constexpr std::string_view view() const { return std::string_view{value, N - 1}; }
+};
+
+namespace detail {
+
+inline void write_uint8(std::span<std::byte> buffer, std::size_t &offset, std::uint8_t value) {
+    buffer[offset++] = static_cast<std::byte>(value);
+}
+
+inline void write_uint16_be(std::span<std::byte> buffer, std::size_t &offset, std::uint16_t value) {
+    buffer[offset++] = static_cast<std::byte>((value >> 8) & 0xFF);
+    buffer[offset++] = static_cast<std::byte>(value & 0xFF);
+}
+
+inline void write_uint32_be(std::span<std::byte> buffer, std::size_t &offset, std::uint32_t value) {
+    write_uint16_be(buffer, offset, static_cast<std::uint16_t>(value >> 16));
+    write_uint16_be(buffer, offset, static_cast<std::uint16_t>(value & 0xFFFF));
+}
+
+inline void write_string(std::span<std::byte> buffer, std::size_t &offset, std::string_view value) {
+    write_uint16_be(buffer, offset, static_cast<std::uint16_t>(value.size()));
+    if (!value.empty()) {
+        std::memcpy(buffer.data() + offset, value.data(), value.size());
+        offset += value.size();
+    }
+}
+
+[[nodiscard]] inline std::size_t string_size(std::string_view value) {
+    if (value.size() > std::numeric_limits<std::uint16_t>::max()) {
+        throw std::length_error{"String too long to serialise into coordinator payload"};
+    }
+    return sizeof(std::uint16_t) + value.size();
+}
+
+// Readers never throw: they report failures as DecodeError and leave offset
+// unspecified on error. throw_decode_error() maps a failure onto the exception
+// types used by the throwing parse paths.
+
+[[nodiscard]] inline DecodeError read_uint8(std::span<const std::byte> payload, std::size_t &offset, std::uint8_t &out) noexcept {
+    if (offset >= payload.size()) {
+        return DecodeError::Truncated;
+    }
+    out = std::to_integer<std::uint8_t>(payload[offset++]);
+    return DecodeError::None;
+}
+
+[[nodiscard]] inline DecodeError read_uint16_be(std::span<const std::byte> payload, std::size_t &offset, std::uint16_t &out) noexcept {
+    if (payload.size() - std::min(offset, payload.size()) < 2) {
+        return DecodeError::Truncated;
+    }
+    const auto high = std::to_integer<std::uint8_t>(payload[offset++]);
+    const auto low = std::to_integer<std::uint8_t>(payload[offset++]);
+    out = static_cast<std::uint16_t>((static_cast<std::uint16_t>(high) << 8U) | low);
+    return DecodeError::None;
+}
+
+[[nodiscard]] inline DecodeError read_uint32_be(std::span<const std::byte> payload, std::size_t &offset, std::uint32_t &out) noexcept {
+    std::uint16_t high = 0;
+    std::uint16_t low = 0;
+    if (payload.size() - std::min(offset, payload.size()) < 4) {
+        return DecodeError::Truncated;
+    }
+    static_cast<void>(read_uint16_be(payload, offset, high));
+    static_cast<void>(read_uint16_be(payload, offset, low));
+    out = (static_cast<std::uint32_t>(high) << 16U) | low;
+    return DecodeError::None;
+}
+
+[[nodiscard]] inline DecodeError read_string_view(
+    std::span<const std::byte> payload,
+    std::size_t &offset,
+    std::size_t max_length,
+    std::string_view &out) noexcept {
+    std::uint16_t length = 0;
+    if (read_uint16_be(payload, offset, length) != DecodeError::None) {
+        return DecodeError::Truncated;
+    }
+    if (length > max_length) {
+        return DecodeError::StringTooLong;
+    }
+    if (payload.size() - offset < length) {
+        return DecodeError::Truncated;
+    }
+
+    out = std::string_view{reinterpret_cast<const char *>(payload.data() + offset), length};
+    offset += length;
+    return DecodeError::None;
+}
+
+[[noreturn]] inline void throw_decode_error(DecodeError error, std::string_view field_name) {
+    switch (error) {
+    case DecodeError::StringTooLong:
+        throw std::length_error{"Coordinator " + std::string{field_name} + " exceeds supported length"};
+    case DecodeError::TooManyItems:
+        throw std::length_error{"Coordinator payload lists more " + std::string{field_name} + " than supported"};
+    case DecodeError::TrailingData:
+        throw std::invalid_argument{"Coordinator payload contains unexpected trailing data"};
+    case DecodeError::InvalidPacketSize:
+        throw std::length_error{"Coordinator packet size is outside the supported range"};
+    case DecodeError::UnsupportedVersion:
+        throw std::invalid_argument{"Coordinator " + std::string{field_name} + " version is not supported"};
+    case DecodeError::InvalidValue:
+        throw std::invalid_argument{"Coordinator " + std::string{field_name} + " has an invalid value"};
+    case DecodeError::Truncated:
+    case DecodeError::None:
+        break;
+    }
+    throw std::out_of_range{"Coordinator payload ended unexpectedly while reading " + std::string{field_name}};
+}
+
+} // namespace detail
+
+template <auto Member>
+struct UInt8Field {
+    static constexpr auto member = Member;
+    static constexpr std::size_t min_size = 1;
+    static constexpr std::size_t max_size = 1;
+    static constexpr std::string_view name = "uint8";
+
+    template <typename Packet>
+    [[nodiscard]] static constexpr std::size_t size(const Packet &) noexcept {
+        return 1;
+    }
+
+    template <typename Packet>
+    static void write(const Packet &packet, std::span<std::byte> buffer, std::size_t &offset) {
+        detail::write_uint8(buffer, offset, packet.*Member);
+    }
+
+    template <typename Packet>
+    [[nodiscard]] static DecodeError read(Packet &packet, std::span<const std::byte> payload, std::size_t &offset) noexcept {
+        return detail::read_uint8(payload, offset, packet.*Member);
+    }
+};
+
+template <auto Member>
+struct UInt16Field {
+    static constexpr auto member = Member;
+    static constexpr std::size_t min_size = 2;
+    static constexpr std::size_t max_size = 2;
+    static constexpr std::string_view name = "uint16";
+
+    template <typename Packet>
+    [[nodiscard]] static constexpr std::size_t size(const Packet &) noexcept {
+        return 2;
+    }
+
+    template <typename Packet>
+    static void write(const Packet &packet, std::span<std::byte> buffer, std::size_t &offset) {
+        detail::write_uint16_be(buffer, offset, packet.*Member);
+    }
+
+    template <typename Packet>
+    [[nodiscard]] static DecodeError read(Packet &packet, std::span<const std::byte> payload, std::size_t &offset) noexcept {
+        return detail::read_uint16_be(payload, offset, packet.*Member);
+    }
+};
+
+template <auto Member>
+struct UInt32Field {
+    static constexpr auto member = Member;
+    static constexpr std::size_t min_size = 4;
+    static constexpr std::size_t max_size = 4;
+    static constexpr std::string_view name = "uint32";
+
+    template <typename Packet>
+    [[nodiscard]] static constexpr std::size_t size(const Packet &) noexcept {
+        return 4;
+    }
+
+    template <typename Packet>
+    static void write(const Packet &packet, std::span<std::byte> buffer, std::size_t &offset) {
+        detail::write_uint32_be(buffer, offset, packet.*Member);
+    }
+
+    template <typename Packet>
+    [[nodiscard]] static DecodeError read(Packet &packet, std::span<const std::byte> payload, std::size_t &offset) noexcept {
+        return detail::read_uint32_be(payload, offset, packet.*Member);
+    }
+};
+
+// Length-prefixed (uint16 big-endian) string. The maximum length is enforced
+// when parsing; writers are expected to truncate before serialising.
+template <auto Member, std::size_t MaxLength, FieldName Name>
+struct StringField {
+    static constexpr auto member = Member;
+    static constexpr std::size_t min_size = 2;
+    static constexpr std::size_t max_size = 2 + MaxLength;
+    static constexpr std::string_view name = Name.view();
+
+    template <typename Packet>
+    [[nodiscard]] static std::size_t size(const Packet &packet) {
+        return detail::string_size(packet.*Member);
+    }
+
+    template <typename Packet>
+    static void write(const Packet &packet, std::span<std::byte> buffer, std::size_t &offset) {
+        detail::write_string(buffer, offset, packet.*Member);
+    }
+
+    template <typename Packet>
+    [[nodiscard]] static DecodeError read(Packet &packet, std::span<const std::byte> payload, std::size_t &offset) {
+        std::string_view value;
+        const auto error = detail::read_string_view(payload, offset, MaxLength, value);
+        if (error == DecodeError::None) {
+            (packet.*Member).assign(value);
+        }
+        return error;
+    }
+};
+
+// uint8 element count followed by that many length-prefixed strings. Lists
+// longer than MaxCount are truncated on write and rejected on read.
+template <auto Member, std::size_t MaxCount, std::size_t MaxLength, FieldName ItemName, FieldName ListName>
+struct StringListField {
+    static_assert(MaxCount <= std::numeric_limits<std::uint8_t>::max(), "list count must fit in a uint8 prefix");
+
+    static constexpr auto member = Member;
+    static constexpr std::size_t min_size = 1;
+    static constexpr std::size_t max_size = 1 + MaxCount * (2 + MaxLength);
+    // Count errors report the list name, everything else the item name.
+    static constexpr std::string_view name = ItemName.view();
+    static constexpr std::string_view count_name = ListName.view();
+
+    template <typename Packet>
+    [[nodiscard]] static std::size_t count(const Packet &packet) noexcept {
+        return std::min<std::size_t>((packet.*Member).size(), MaxCount);
+    }
+
+    template <typename Packet>
+    [[nodiscard]] static std::size_t size(const Packet &packet) {
+        const auto &items = packet.*Member;
+        std::size_t total = 1;
+        for (std::size_t index = 0, end = count(packet); index < end; ++index) {
+            total += detail::string_size(items[index]);
+        }
+        return total;
+    }
+
+    template <typename Packet>
+    static void write(const Packet &packet, std::span<std::byte> buffer, std::size_t &offset) {
+        const auto &items = packet.*Member;
+        const auto items_to_write = count(packet);
+        detail::write_uint8(buffer, offset, static_cast<std::uint8_t>(items_to_write));
+        for (std::size_t index = 0; index < items_to_write; ++index) {
+            detail::write_string(buffer, offset, items[index]);
+        }
+    }
+
+    template <typename Packet>
+    [[nodiscard]] static DecodeError read(Packet &packet, std::span<const std::byte> payload, std::size_t &offset) {
+        std::uint8_t item_count = 0;
+        if (detail::read_uint8(payload, offset, item_count) != DecodeError::None) {
+            return DecodeError::Truncated;
+        }
+        if (item_count > MaxCount) {
+            return DecodeError::TooManyItems;
+        }
+
+        // Immutable list types are built from a vector once it is complete.
+        auto &items = packet.*Member;
+        using Items = std::remove_cvref_t<decltype(items)>;
+        std::vector<std::string> parsed;
+        parsed.reserve(item_count);
+        for (std::size_t index = 0; index < item_count; ++index) {
+            std::string_view value;
+            const auto error = detail::read_string_view(payload, offset, MaxLength, value);
+            if (error != DecodeError::None) {
+                return error;
+            }
+            parsed.emplace_back(value);
+        }
+        if constexpr (std::is_same_v<Items, std::vector<std::string>>) {
+            items = std::move(parsed);
+        } else {
+            items = Items{std::move(parsed)};
+        }
+        return DecodeError::None;
+    }
+};
+
+template <typename Packet, typename... Fields>
+struct PacketSchema {
+    static constexpr std::size_t min_size = (std::size_t{0} + ... + Fields::min_size);
+    static constexpr std::size_t max_size = (std::size_t{0} + ... + Fields::max_size);
+    static constexpr bool is_fixed_size = min_size == max_size;
+
+    // Byte offset of Member within every serialised packet. Only defined for
+    // fields preceded exclusively by fixed-width fields.
+    template <auto Member>
+    [[nodiscard]] static consteval std::size_t fixed_offset() {
+        std::size_t offset = 0;
+        bool found = false;
+        bool fixed_prefix = true;
+        static_cast<void>(((matches<Fields, Member>() ? (found = true)
+                                                      : (fixed_prefix = fixed_prefix && Fields::min_size == Fields::max_size,
+                                                         offset += Fields::min_size,
+                                                         false)) ||
+                           ...));
+        if (!found || !fixed_prefix) {
+            throw std::logic_error{"field is not at a fixed offset"};
+        }
+        return offset;
+    }
+
+    [[nodiscard]] static std::size_t serialized_size(const Packet &packet) {
+        if constexpr (is_fixed_size) {
+            return min_size;
+        } else {
+            return (std::size_t{0} + ... + Fields::size(packet));
+        }
+    }
+
+    // Writes the packet into buffer and returns the number of bytes written.
+    static std::size_t serialize_into(const Packet &packet, std::span<std::byte> buffer) {
+        if (buffer.size() < serialized_size(packet)) {
+            throw std::length_error{"Coordinator payload buffer is too small"};
+        }
+        return write(packet, buffer);
+    }
+
+    // As serialize_into(), for callers that already sized buffer from
+    // serialized_size().
+    static std::size_t write(const Packet &packet, std::span<std::byte> buffer) {
+        std::size_t offset = 0;
+        (Fields::write(packet, buffer, offset), ...);
+        return offset;
+    }
+
+    // Non-throwing parse for untrusted or high-volume input.
+    [[nodiscard]] static DecodeResult<Packet> try_parse(std::span<const std::byte> payload) {
+        if (payload.size() < min_size) {
+            return DecodeResult<Packet>{DecodeError::Truncated, "packet header"};
+        }
+
+        Packet packet{};
+        std::size_t offset = 0;
+        DecodeError error = DecodeError::None;
+        std::string_view failed_field{};
+
+        // Short-circuits on the first field that fails to decode.
+        static_cast<void>((read_field<Fields>(packet, payload, offset, error, failed_field) && ...));
+        if (error != DecodeError::None) {
+            return DecodeResult<Packet>{error, failed_field};
+        }
+
+        if (offset != payload.size()) {
+            return DecodeResult<Packet>{DecodeError::TrailingData, "payload"};
+        }
+        return DecodeResult<Packet>{std::move(packet)};
+    }
+
+    [[nodiscard]] static Packet parse(std::span<const std::byte> payload) {
+        auto result = try_parse(payload);
+        if (!result) {
+            detail::throw_decode_error(result.error(), result.error_field());
+        }
+        return std::move(*result);
+    }
+
+private:
+    template <typename Field, auto Member>
+    [[nodiscard]] static consteval bool matches() {
+        if constexpr (std::is_same_v<std::remove_cv_t<decltype(Field::member)>, decltype(Member)>) {
+            return Field::member == Member;
+        } else {
+            return false;
+        }
+    }
+
+    template <typename Field>
+    [[nodiscard]] static bool read_field(Packet &packet,
+                                         std::span<const std::byte> payload,
+                                         std::size_t &offset,
+                                         DecodeError &error,
+                                         std::string_view &failed_field) {
+        error = Field::read(packet, payload, offset);
+        if (error == DecodeError::None) {
+            return true;
+        }
+        if constexpr (requires { Field::count_name; }) {
+            failed_field = error == DecodeError::TooManyItems ? Field::count_name : Field::name;
+        } else {
+            failed_field = Field::name;
+        }
+        return false;
+    }
+};
+
+} // namespace sotc::network::codec
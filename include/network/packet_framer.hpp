@@ -0,0 +1,81 @@
+#pragma once
+
+#include "network/constants.hpp"
+#include "network/decode_result.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace sotc::network {
+
+// Every TCP packet starts with a big-endian uint16 total size (header
+// included) followed by a uint8 packet type.
+inline constexpr std::size_t NETWORK_PACKET_HEADER_SIZE = 3;
+inline constexpr std::size_t NETWORK_MAX_TCP_PACKET_SIZE = NETWORK_PACKET_HEADER_SIZE + NETWORK_TCP_MTU;
+
+// A complete packet inside the framer's ring buffer. The payload is split in
+// two spans when it wraps around the end of the ring; `second` is empty
+// otherwise. Spans stay valid until the packet is popped.
+struct FramedPacket {
+    std::uint8_t type{0};
+    std::span<const std::byte> first{};
+    std::span<const std::byte> second{};
+
+    [[nodiscard]] std::size_t size() const noexcept { return first.size() + second.size(); }
+    [[nodiscard]] bool contiguous() const noexcept { return second.empty(); }
+
+    // Returns the payload as one span, copying into scratch only when the
+    // packet wraps.
+    [[nodiscard]] std::span<const std::byte> linearize(std::vector<std::byte> &scratch) const;
+};
+
+// Writes the packet header for a payload of payload_size bytes into the
+// first NETWORK_PACKET_HEADER_SIZE bytes of buffer.
+void write_packet_header(std::span<std::byte> buffer, std::uint8_t type, std::size_t payload_size);
+
+// Incremental framer for length-prefixed TCP packets. Socket reads go straight
+// into the ring through prepare()/commit(); complete packets are handed out in
+// place without being copied.
+class PacketFramer {
+public:
+    explicit PacketFramer(std::size_t capacity = 2 * NETWORK_MAX_TCP_PACKET_SIZE,
+                          std::size_t max_packet_size = NETWORK_MAX_TCP_PACKET_SIZE);
+
+    // Largest contiguous free region of the ring; may be smaller than
+    // free_space() when the free area wraps.
+    [[nodiscard]] std::span<std::byte> prepare() noexcept;
+    void commit(std::size_t bytes) noexcept;
+
+    // Copies as much of data as fits and returns the number of bytes accepted.
+    std::size_t feed(std::span<const std::byte> data) noexcept;
+
+    // The oldest complete packet, or nullopt when more data is needed or the
+    // stream is malformed.
+    [[nodiscard]] std::optional<FramedPacket> front() noexcept;
+    void pop_front() noexcept;
+
+    [[nodiscard]] bool failed() const noexcept { return error_ != DecodeError::None; }
+    [[nodiscard]] DecodeError error() const noexcept { return error_; }
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return buffer_.size(); }
+    [[nodiscard]] std::size_t buffered() const noexcept { return tail_ - head_; }
+    [[nodiscard]] std::size_t free_space() const noexcept { return capacity() - buffered(); }
+
+    void reset() noexcept;
+
+private:
+    [[nodiscard]] std::byte at(std::size_t position) const noexcept { return buffer_[position & mask_]; }
+
+    std::vector<std::byte> buffer_;
+    std::size_t mask_{0};
+    std::size_t max_packet_size_{0};
+    std::size_t head_{0};
+    std::size_t tail_{0};
+    std::size_t front_size_{0};
+    DecodeError error_{DecodeError::None};
+};
+
+} // namespace sotc::network
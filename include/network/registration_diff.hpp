@@ -0,0 +1,41 @@
+#pragma once
+
+#include "network/coordinator_client.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace sotc::network {
+
+enum class RegistrationChange : std::uint8_t {
+    Unchanged,
+    // Same coordinator; the new settings go out with the next SERVER_UPDATE.
+    Patched,
+    // The coordinator endpoint changed, so the server registers anew.
+    Reregistered,
+    Added,
+    Removed,
+};
+
+[[nodiscard]] std::string_view to_string(RegistrationChange change) noexcept;
+
+struct RegistrationDiffEntry {
+    static constexpr std::size_t kNone = static_cast<std::size_t>(-1);
+
+    RegistrationChange change{RegistrationChange::Unchanged};
+    // Index into before; kNone for Added.
+    std::size_t before{kNone};
+    // Index into after; kNone for Removed.
+    std::size_t after{kNone};
+};
+
+// Pairs the servers of two registration lists by listen port (in order, when
+// a port appears more than once) and classifies each pair. Entries come in
+// after order, followed by the removed servers in before order.
+[[nodiscard]] std::vector<RegistrationDiffEntry> diff_registrations(std::span<const RegistrationConfig> before,
+                                                                    std::span<const RegistrationConfig> after);
+
+} // namespace sotc::network
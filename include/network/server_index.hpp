@@ -0,0 +1,177 @@
+#pragma once
+
+#include "network/coordinator_client.hpp"
+#include "network/newgrf_set.hpp"
+#include "network/server_listing.hpp"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace sotc::network {
+
+// One bit per index row, packed into 64-bit words. Bits past size() are kept
+// clear so count() and iteration need no tail masking.
+class SelectionBitmap {
+public:
+    SelectionBitmap() = default;
+    SelectionBitmap(std::size_t size, bool selected);
+
+    [[nodiscard]] std::size_t size() const noexcept { return size_; }
+    [[nodiscard]] bool test(std::size_t row) const noexcept { return (words_[row / 64] >> (row % 64)) & 1U; }
+    [[nodiscard]] std::size_t count() const noexcept;
+    [[nodiscard]] std::span<std::uint64_t> words() noexcept { return words_; }
+    [[nodiscard]] std::span<const std::uint64_t> words() const noexcept { return words_; }
+
+    void set(std::size_t row) noexcept { words_[row / 64] |= std::uint64_t{1} << (row % 64); }
+    void reset(std::size_t row) noexcept { words_[row / 64] &= ~(std::uint64_t{1} << (row % 64)); }
+    SelectionBitmap &operator&=(const SelectionBitmap &other) noexcept;
+
+    // Calls fn(row) for every selected row in ascending order.
+    template <typename Fn>
+    void for_each(Fn &&fn) const {
+        for (std::size_t word = 0; word < words_.size(); ++word) {
+            for (auto bits = words_[word]; bits != 0; bits &= bits - 1) {
+                fn(word * 64 + static_cast<std::size_t>(std::countr_zero(bits)));
+            }
+        }
+    }
+
+private:
+    std::vector<std::uint64_t> words_{};
+    std::size_t size_{0};
+};
+
+// Append-only string pool; equal strings share one id.
+class StringInterner {
+public:
+    [[nodiscard]] std::uint32_t intern(std::string_view value);
+    [[nodiscard]] std::optional<std::uint32_t> find(std::string_view value) const;
+    [[nodiscard]] const std::string &at(std::uint32_t id) const { return strings_.at(id); }
+    [[nodiscard]] std::size_t size() const noexcept { return strings_.size(); }
+    void clear() noexcept;
+
+private:
+    // A deque keeps the strings in place, so the map can key on views of them.
+    std::deque<std::string> strings_{};
+    std::unordered_map<std::string_view, std::uint32_t> ids_{};
+};
+
+// Every predicate is optional; rows must match all that are set.
+struct ServerFilter {
+    std::optional<std::uint8_t> min_clients{};
+    std::optional<std::uint8_t> max_clients{};
+    // Free client slots, clients_max - clients_on.
+    std::optional<std::uint8_t> min_free_slots{};
+    std::optional<ServerGameType> game_type{};
+    // Rows must advertise every bit of this NatCapability mask.
+    std::uint8_t required_nat_capabilities{0};
+    std::optional<std::string> revision{};
+    std::optional<bool> use_password{};
+    std::optional<bool> dedicated{};
+};
+
+enum class ServerSortKey : std::uint8_t {
+    Name,
+    Clients,
+    FreeSlots,
+    Companies,
+    GameType,
+    Revision,
+};
+
+inline constexpr std::size_t SERVER_SORT_KEY_COUNT = 6;
+
+// Structure-of-arrays index over listed servers for filtering and sorting
+// thousands of rows many times per second. Numeric attributes live in
+// fixed-width columns that filter() scans branch-free, 64 rows per bitmap
+// word, so the compiler can vectorise each predicate. Names, revisions and
+// connection strings are interned. Sorted views are built on first use and
+// reused until the next add() or clear().
+class ServerIndex {
+public:
+    // GC_LISTING does not carry the game type or NAT capabilities; callers
+    // that learnt them elsewhere (e.g. from registrations) pass them in.
+    std::uint32_t add(const ServerListingEntry &entry, ServerGameType game_type = ServerGameType::Public,
+                      std::uint8_t nat_capabilities = 0);
+    void clear() noexcept;
+    void reserve(std::size_t rows);
+
+    [[nodiscard]] std::size_t size() const noexcept { return clients_on_.size(); }
+    // Bumped by every change; lets callers cache derived views.
+    [[nodiscard]] std::uint64_t generation() const noexcept { return generation_; }
+
+    [[nodiscard]] SelectionBitmap filter(const ServerFilter &filter) const;
+    // Rows whose NewGRFs are all in installed, i.e. servers we can join
+    // without downloading anything. One merge of the index's NewGRF
+    // dictionary against installed finds the NewGRFs that are missing; only
+    // the rows listed for those are cleared, so the cost follows what is
+    // missing rather than the size of the listing.
+    [[nodiscard]] SelectionBitmap joinable(const NewGrfSet &installed) const;
+    [[nodiscard]] std::vector<NewGrfIdentity> missing_newgrfs(std::uint32_t row, const NewGrfSet &installed) const;
+
+    // Row ids ordered by key, ties broken by row id. The span stays valid
+    // until the index changes.
+    [[nodiscard]] std::span<const std::uint32_t> sorted(ServerSortKey key, bool descending = false);
+    // The selected rows of sorted(key, descending), in that order.
+    [[nodiscard]] std::vector<std::uint32_t> select_sorted(const SelectionBitmap &selection, ServerSortKey key,
+                                                           bool descending = false);
+
+    [[nodiscard]] const std::string &name(std::uint32_t row) const { return strings_.at(name_ids_.at(row)); }
+    [[nodiscard]] const std::string &revision(std::uint32_t row) const { return strings_.at(revision_ids_.at(row)); }
+    [[nodiscard]] const std::string &connection_string(std::uint32_t row) const {
+        return strings_.at(connection_ids_.at(row));
+    }
+    [[nodiscard]] std::span<const std::uint8_t> clients_on() const noexcept { return clients_on_; }
+    [[nodiscard]] std::span<const std::uint8_t> clients_max() const noexcept { return clients_max_; }
+    [[nodiscard]] std::span<const std::uint8_t> companies_on() const noexcept { return companies_on_; }
+    [[nodiscard]] std::span<const std::uint8_t> game_types() const noexcept { return game_types_; }
+    [[nodiscard]] std::span<const std::uint8_t> nat_capabilities() const noexcept { return nat_capabilities_; }
+
+private:
+    struct SortCache {
+        std::uint64_t generation{0};
+        bool valid{false};
+        std::vector<std::uint32_t> rows{};
+    };
+
+    static constexpr std::uint8_t kFlagPassword = 0x01;
+    static constexpr std::uint8_t kFlagDedicated = 0x02;
+
+    void build_sorted(ServerSortKey key, bool descending, std::vector<std::uint32_t> &rows) const;
+
+    StringInterner strings_{};
+    std::vector<std::uint8_t> clients_on_{};
+    std::vector<std::uint8_t> clients_max_{};
+    std::vector<std::uint8_t> free_slots_{};
+    std::vector<std::uint8_t> companies_on_{};
+    std::vector<std::uint8_t> game_types_{};
+    std::vector<std::uint8_t> nat_capabilities_{};
+    std::vector<std::uint8_t> flags_{};
+    std::vector<std::uint32_t> revision_ids_{};
+    std::vector<std::uint32_t> name_ids_{};
+    std::vector<std::uint32_t> connection_ids_{};
+    // Row r refers to the NewGRF dictionary entries
+    // newgrf_refs_[newgrf_offsets_[r], newgrf_offsets_[r + 1]).
+    std::vector<std::uint32_t> newgrf_offsets_{0};
+    std::vector<std::uint32_t> newgrf_refs_{};
+    std::vector<NewGrfIdentity> newgrf_dictionary_{};
+    std::unordered_map<NewGrfIdentity, std::uint32_t, NewGrfIdentityHash> newgrf_ids_{};
+    // Dictionary ids in identity order, kept sorted on insert.
+    std::vector<std::uint32_t> newgrf_order_{};
+    // Ascending rows that refer to each dictionary entry.
+    std::vector<std::vector<std::uint32_t>> newgrf_rows_{};
+    std::uint64_t generation_{0};
+    // Ascending views first, then descending ones.
+    std::array<SortCache, 2 * SERVER_SORT_KEY_COUNT> sort_cache_{};
+};
+
+} // namespace sotc::network
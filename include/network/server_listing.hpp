@@ -0,0 +1,188 @@
+#pragma once
+
+#include "network/constants.hpp"
+#include "network/coordinator_protocol.hpp"
+#include "network/decode_result.hpp"
+#include "network/packet_framer.hpp"
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sotc::network {
+
+inline constexpr std::size_t NETWORK_MAX_NEWGRF_NAME_LENGTH = 255;
+inline constexpr std::size_t NETWORK_MAX_CONNECTION_STRING_LENGTH = 255;
+inline constexpr std::size_t NETWORK_MAX_REVISION_LENGTH = 32;
+inline constexpr std::size_t NETWORK_MAX_GAMESCRIPT_NAME_LENGTH = 255;
+
+// Largest GC_LISTING / GC_NEWGRF_LOOKUP payload the coordinator sends.
+inline constexpr std::size_t NETWORK_MAX_LISTING_PAYLOAD_SIZE = NETWORK_TCP_MTU - NETWORK_PACKET_HEADER_SIZE;
+
+// How a game info block identifies its NewGRFs. Coordinator listings use
+// LookupId, which refers to entries of the NewGRF lookup table.
+enum class NewGrfSerialization : std::uint8_t {
+    GrfIdMd5 = 0,
+    GrfIdMd5Name = 1,
+    LookupId = 2,
+};
+
+struct NewGrfIdentity {
+    std::uint32_t grfid{0};
+    std::array<std::uint8_t, 16> md5{};
+
+    // Ordered by grfid, then MD5; sorted NewGrfSet relies on this.
+    friend auto operator<=>(const NewGrfIdentity &, const NewGrfIdentity &) = default;
+    friend bool operator==(const NewGrfIdentity &, const NewGrfIdentity &) = default;
+};
+
+struct NewGrfIdentityHash {
+    [[nodiscard]] std::size_t operator()(const NewGrfIdentity &identity) const noexcept;
+};
+
+// NetworkGameInfo as carried by GC_LISTING (game info version 7).
+struct NetworkGameInfo {
+    std::uint64_t ticks_playing{0};
+    std::uint32_t gamescript_version{0xFFFFFFFFU};
+    std::string gamescript_name{};
+    std::vector<NewGrfIdentity> newgrfs{};
+    std::uint32_t game_date{0};
+    std::uint32_t start_date{0};
+    std::uint8_t companies_max{0};
+    std::uint8_t companies_on{0};
+    std::uint8_t spectators_max{0};
+    std::string server_name{};
+    std::string server_revision{};
+    bool use_password{false};
+    std::uint8_t clients_max{0};
+    std::uint8_t clients_on{0};
+    std::uint8_t spectators_on{0};
+    std::uint16_t map_width{0};
+    std::uint16_t map_height{0};
+    std::uint8_t landscape{0};
+    bool dedicated{false};
+};
+
+struct ServerListingEntry {
+    std::string connection_string{};
+    NetworkGameInfo info{};
+    // NewGRFs whose lookup index was missing from the table. They are left
+    // out of info.newgrfs.
+    std::size_t unresolved_newgrfs{0};
+};
+
+// PACKET_COORDINATOR_CLIENT_LISTING. newgrf_lookup_cursor tells the
+// coordinator which lookup table entries the client already holds.
+struct CoordinatorClientListing {
+    std::uint8_t coordinator_version{NETWORK_COORDINATOR_VERSION};
+    std::uint8_t game_info_version{NETWORK_GAME_INFO_VERSION};
+    std::string revision{};
+    std::uint32_t newgrf_lookup_cursor{0};
+
+    [[nodiscard]] std::size_t serialized_size() const;
+    std::size_t serialize_into(std::span<std::byte> buffer) const;
+    [[nodiscard]] static DecodeResult<CoordinatorClientListing> try_deserialize(std::span<const std::byte> payload);
+};
+
+// Index -> NewGRF table shared by the coordinator and a listing client.
+// Entries are append-only and numbered by the coordinator. cursor() is the
+// index after the last entry the holder knows, so a client that keeps its
+// table between refreshes only receives entries added since.
+class NewGrfLookupTable {
+public:
+    struct Entry {
+        NewGrfIdentity identity{};
+        std::string name{};
+    };
+
+    [[nodiscard]] std::uint32_t cursor() const noexcept { return cursor_; }
+    [[nodiscard]] std::size_t size() const noexcept { return entries_.size(); }
+    [[nodiscard]] const Entry *find(std::uint32_t index) const noexcept;
+    [[nodiscard]] const std::uint32_t *find(const NewGrfIdentity &identity) const noexcept;
+
+    // Stores an entry received from the coordinator.
+    void insert(std::uint32_t index, Entry entry);
+    void advance_cursor(std::uint32_t cursor) noexcept;
+
+    // Coordinator side: returns the index of identity, appending it at the
+    // cursor when it is new.
+    std::uint32_t intern(const NewGrfIdentity &identity, std::string_view name);
+
+    void clear() noexcept;
+
+private:
+    std::unordered_map<std::uint32_t, Entry> entries_{};
+    std::unordered_map<NewGrfIdentity, std::uint32_t, NewGrfIdentityHash> indices_{};
+    std::uint32_t cursor_{0};
+};
+
+// Incremental decoder for the coordinator's reply to CLIENT_LISTING: any
+// number of GC_NEWGRF_LOOKUP packets, then GC_LISTING packets, each carrying
+// a batch of servers, closed by an empty GC_LISTING. Every server is handed
+// to the callback as soon as its packet arrives; lookup entries go straight
+// into the table, which outlives the decoder.
+class ServerListingDecoder {
+public:
+    using EntryCallback = std::function<void(const ServerListingEntry &)>;
+
+    explicit ServerListingDecoder(NewGrfLookupTable &table) : table_(table) {}
+
+    void set_entry_callback(EntryCallback callback) { entry_callback_ = std::move(callback); }
+
+    // Decodes one payload of the given packet type. Returns the number of
+    // servers or lookup entries it contained. Other packet types are
+    // ignored and decode to zero.
+    [[nodiscard]] DecodeResult<std::size_t> decode(PacketCoordinatorType type, std::span<const std::byte> payload);
+
+    // True once the terminating empty GC_LISTING has been decoded.
+    [[nodiscard]] bool complete() const noexcept { return complete_; }
+    [[nodiscard]] std::size_t entries_decoded() const noexcept { return entries_decoded_; }
+    [[nodiscard]] std::size_t lookup_entries_decoded() const noexcept { return lookup_entries_decoded_; }
+
+    void reset() noexcept;
+
+private:
+    [[nodiscard]] DecodeResult<std::size_t> decode_lookup(std::span<const std::byte> payload);
+    [[nodiscard]] DecodeResult<std::size_t> decode_listing(std::span<const std::byte> payload);
+
+    NewGrfLookupTable &table_;
+    EntryCallback entry_callback_{};
+    ServerListingEntry entry_{};
+    bool complete_{false};
+    std::size_t entries_decoded_{0};
+    std::size_t lookup_entries_decoded_{0};
+};
+
+// A bare game info block, as carried by UDP server responses. LookupId
+// serialisation needs table; GrfIdMd5Name takes the names from it when given.
+[[nodiscard]] std::vector<std::byte> serialize_game_info(const NetworkGameInfo &info,
+                                                         NewGrfSerialization serialization = NewGrfSerialization::GrfIdMd5,
+                                                         const NewGrfLookupTable *table = nullptr);
+// Parses a bare game info block. LookupId serialisation is rejected, as there
+// is no table to resolve it against.
+[[nodiscard]] DecodeResult<NetworkGameInfo> try_parse_game_info(std::span<const std::byte> payload);
+
+// Coordinator side of the listing. Both return complete payloads of at most
+// max_payload bytes, without the packet header.
+//
+// Every table entry at or after since_cursor, split over GC_NEWGRF_LOOKUP
+// payloads. Empty when the client is up to date.
+[[nodiscard]] std::vector<std::vector<std::byte>> serialize_newgrf_lookup(
+    const NewGrfLookupTable &table, std::uint32_t since_cursor,
+    std::size_t max_payload = NETWORK_MAX_LISTING_PAYLOAD_SIZE);
+
+// The servers as GC_LISTING payloads followed by the empty terminator. Every
+// NewGRF must already be interned in table.
+[[nodiscard]] std::vector<std::vector<std::byte>> serialize_listing(
+    std::span<const ServerListingEntry> entries, const NewGrfLookupTable &table,
+    std::size_t max_payload = NETWORK_MAX_LISTING_PAYLOAD_SIZE);
+
+} // namespace sotc::network
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "network/constants.hpp"
+#include "network/dns_cache.hpp"
+#include "network/event_loop.hpp"
+#include "network/packet_framer.hpp"
+#include "network/server_listing.hpp"
+#include "network/socket.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sotc::network {
+
+enum class ListingState : std::uint8_t {
+    Idle,
+    Connecting,
+    Receiving,
+    Complete,
+    Failed,
+};
+
+[[nodiscard]] std::string_view to_string(ListingState state) noexcept;
+
+struct ServerListingOptions {
+    std::string coordinator_host{"coordinator.openttd.org"};
+    std::uint16_t coordinator_port{NETWORK_COORDINATOR_SERVER_PORT};
+    std::string revision{"sotc-0.1.0"};
+    EventLoop::Clock::duration connect_timeout{std::chrono::seconds{10}};
+    // Whole listing, from connect to the terminating GC_LISTING.
+    EventLoop::Clock::duration listing_timeout{std::chrono::seconds{30}};
+    // Resolves the coordinator host off the loop thread when set; it must be
+    // attached to the client's loop.
+    DnsCache *resolver{nullptr};
+};
+
+// Fetches the public server listing from the coordinator on an EventLoop.
+// Each refresh() opens a connection, sends CLIENT_LISTING with the cursor of
+// the NewGRF lookup table kept from earlier refreshes, and hands every server
+// to the entry callback as its GC_LISTING packet is decoded. The connection
+// is closed once the listing is complete.
+class ServerListingClient {
+public:
+    using EntryCallback = ServerListingDecoder::EntryCallback;
+    using StateCallback = std::function<void(ListingState)>;
+
+    ServerListingClient(EventLoop &loop, ServerListingOptions options = {});
+    ~ServerListingClient();
+
+    ServerListingClient(const ServerListingClient &) = delete;
+    ServerListingClient &operator=(const ServerListingClient &) = delete;
+
+    // Starts a new listing; an unfinished one is abandoned.
+    void refresh();
+    void close() noexcept;
+
+    void set_entry_callback(EntryCallback callback) { decoder_.set_entry_callback(std::move(callback)); }
+    void set_state_callback(StateCallback callback) { state_callback_ = std::move(callback); }
+
+    [[nodiscard]] ListingState state() const noexcept { return state_; }
+    [[nodiscard]] const std::string &last_error() const noexcept { return last_error_; }
+    [[nodiscard]] const NewGrfLookupTable &newgrf_table() const noexcept { return table_; }
+    // Counts for the current or most recent refresh.
+    [[nodiscard]] std::size_t entries_received() const noexcept { return decoder_.entries_decoded(); }
+    [[nodiscard]] std::size_t lookup_entries_received() const noexcept { return decoder_.lookup_entries_decoded(); }
+    [[nodiscard]] std::uint64_t refreshes() const noexcept { return refreshes_; }
+
+private:
+    void set_state(ListingState state);
+    void fail(std::string message);
+    void disconnect() noexcept;
+    void connect_to(const std::vector<Endpoint> &endpoints);
+    void on_io(std::uint32_t events);
+    void on_connected();
+    void on_readable();
+    void handle_packet(const FramedPacket &packet);
+    void flush();
+
+    EventLoop &loop_;
+    ServerListingOptions options_;
+    NewGrfLookupTable table_{};
+    ServerListingDecoder decoder_{table_};
+    ListingState state_{ListingState::Idle};
+    std::string last_error_{};
+    StateCallback state_callback_{};
+    std::uint64_t refreshes_{0};
+
+    SocketHandle socket_{};
+    bool watching_writable_{false};
+    DnsCache::RequestId resolve_request_{0};
+    // Listing packets may use the full TCP MTU, unlike registration replies.
+    PacketFramer framer_{};
+    std::vector<std::byte> outbound_{};
+    std::size_t outbound_offset_{0};
+    std::vector<std::byte> scratch_{};
+
+    EventLoop::TimerId connect_timer_{0};
+    EventLoop::TimerId listing_timer_{0};
+};
+
+} // namespace sotc::network
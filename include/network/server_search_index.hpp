@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sotc::network {
+
+// Incrementally maintained search index over listed servers, keyed by the
+// caller's row ids (e.g. ServerIndex rows).
+//
+// Server names are matched case-insensitively (ASCII) by substring. Every
+// distinct 1-, 2- and 3-byte gram of a name has a sorted posting list. A query
+// intersects the lists of its trigrams, smallest first, and confirms the few
+// survivors against the stored name, so no query scans the whole listing.
+// Invite codes, i.e. connection strings starting with '+', are kept in sorted
+// order for prefix lookups.
+class ServerSearchIndex {
+public:
+    static constexpr std::size_t kNoLimit = std::numeric_limits<std::size_t>::max();
+
+    // Adds or replaces the row.
+    void insert(std::uint32_t row, std::string_view server_name, std::string_view connection_string);
+    // Returns false when the row was not indexed.
+    bool erase(std::uint32_t row);
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return rows_.size(); }
+    [[nodiscard]] bool contains(std::uint32_t row) const noexcept { return rows_.contains(row); }
+
+    // Rows whose name contains text, ascending. An empty query matches
+    // every row.
+    [[nodiscard]] std::vector<std::uint32_t> find_name(std::string_view text, std::size_t limit = kNoLimit) const;
+    // Rows whose invite code starts with prefix, in invite code order. The
+    // leading '+' is optional in the query.
+    [[nodiscard]] std::vector<std::uint32_t> find_invite_code(std::string_view prefix,
+                                                              std::size_t limit = kNoLimit) const;
+
+private:
+    struct Row {
+        std::string folded_name{};
+        std::string invite_code{};
+    };
+
+    void add_postings(std::uint32_t row, std::string_view folded_name);
+    void remove_postings(std::uint32_t row, std::string_view folded_name);
+
+    std::unordered_map<std::uint32_t, Row> rows_{};
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> postings_{};
+    std::set<std::pair<std::string, std::uint32_t>> invite_codes_{};
+};
+
+} // namespace sotc::network
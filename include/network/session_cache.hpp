@@ -0,0 +1,61 @@
+#pragma once
+
+#include "network/coordinator_client.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+
+namespace sotc::network {
+
+// What the coordinator issued to one registered server, kept across restarts.
+// The invite code secret is not kept: the handshake has no field to present
+// it in.
+struct CachedSession {
+    std::string invite_code{};
+    std::uint8_t connection_type{0};
+    // Coordinator address the registration went to, as Endpoint::to_string().
+    std::string coordinator_endpoint{};
+    // Seconds since the Unix epoch.
+    std::int64_t saved_at{0};
+};
+
+// Key for a server's cache entry: coordinator host and port, listen port,
+// server name and game type, hashed. Heartbeat, NAT and NewGRF settings may
+// change without invalidating the entry.
+[[nodiscard]] std::string session_identity(const RegistrationConfig &config);
+
+// Small on-disk cache of coordinator sessions, one line per server. save()
+// writes a temporary file, readable by its owner only, and renames it over
+// the old one, so a crash never leaves a truncated cache behind. store() and
+// erase() only change the entries in memory and mark the cache dirty; flush()
+// writes it out once however many changes piled up.
+class SessionCache {
+public:
+    explicit SessionCache(std::filesystem::path path);
+
+    // Returns false when the file is missing or unreadable; malformed lines
+    // are skipped.
+    bool load();
+    // Throws std::system_error when the file cannot be written.
+    void save() const;
+    // save()s when anything changed since the last load() or flush().
+    void flush();
+
+    [[nodiscard]] const CachedSession *find(const std::string &identity) const;
+    void store(const std::string &identity, CachedSession session);
+    bool erase(const std::string &identity);
+
+    [[nodiscard]] bool dirty() const noexcept { return dirty_; }
+    [[nodiscard]] std::size_t size() const noexcept { return entries_.size(); }
+    [[nodiscard]] const std::filesystem::path &path() const noexcept { return path_; }
+
+private:
+    std::filesystem::path path_;
+    std::map<std::string, CachedSession> entries_{};
+    bool dirty_{false};
+};
+
+} // namespace sotc::network
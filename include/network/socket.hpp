@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/socket.h>
+
+namespace sotc::network {
+
+// Owning wrapper around a POSIX socket descriptor.
+class SocketHandle {
+public:
+    SocketHandle() = default;
+    explicit SocketHandle(int fd) noexcept : fd_(fd) {}
+    ~SocketHandle() { reset(); }
+
+    SocketHandle(SocketHandle &&other) noexcept : fd_(other.release()) {}
+    SocketHandle &operator=(SocketHandle &&other) noexcept {
+        if (this != &other) {
+            reset(other.release());
+        }
+        return *this;
+    }
+
+    SocketHandle(const SocketHandle &) = delete;
+    SocketHandle &operator=(const SocketHandle &) = delete;
+
+    [[nodiscard]] int get() const noexcept { return fd_; }
+    [[nodiscard]] explicit operator bool() const noexcept { return fd_ >= 0; }
+
+    int release() noexcept {
+        const int fd = fd_;
+        fd_ = -1;
+        return fd;
+    }
+    void reset(int fd = -1) noexcept;
+
+private:
+    int fd_{-1};
+};
+
+struct Endpoint {
+    sockaddr_storage address{};
+    socklen_t length{0};
+
+    [[nodiscard]] std::uint16_t port() const noexcept;
+    [[nodiscard]] std::string to_string() const;
+};
+
+// Blocking name resolution through getaddrinfo. Returns an empty list when
+// the host cannot be resolved; error, when given, receives getaddrinfo's
+// result (0 on success).
+[[nodiscard]] std::vector<Endpoint> resolve_endpoints(const std::string &host,
+                                                      std::uint16_t port,
+                                                      int socket_type = SOCK_STREAM,
+                                                      int *error = nullptr);
+
+// Starts a non-blocking TCP connect. in_progress is set when completion must
+// be awaited via writability; an invalid handle is returned on failure.
+[[nodiscard]] SocketHandle connect_nonblocking(const Endpoint &endpoint, bool &in_progress);
+
+// Non-blocking listening socket bound to endpoint; port 0 picks a free port.
+[[nodiscard]] SocketHandle listen_nonblocking(const Endpoint &endpoint, int backlog = 1024);
+
+[[nodiscard]] Endpoint local_endpoint(int fd);
+[[nodiscard]] Endpoint loopback_endpoint(std::uint16_t port);
+// Parses a numeric address in Endpoint::to_string() form without touching
+// the resolver.
+[[nodiscard]] std::optional<Endpoint> parse_endpoint(std::string_view text);
+
+// Pending SO_ERROR for a socket, or errno when it cannot be queried.
+[[nodiscard]] int socket_error(int fd) noexcept;
+
+void set_nonblocking(int fd);
+void set_no_delay(int fd) noexcept;
+
+} // namespace sotc::network
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "network/latency_histogram.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace sotc::network {
+
+// Hierarchical timing wheel (four levels of 64 slots) for large numbers of
+// periodic timers such as per-server heartbeats. Scheduling and cancelling
+// are O(1); advance() does constant work per elapsed tick plus one cascade
+// per timer per level. Deadlines are rounded up to the tick, so timers never
+// fire early. The gap between each deadline and the time it was actually
+// dispatched is recorded in jitter().
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using TimerId = std::uint64_t;
+
+    static constexpr std::size_t kLevelBits = 6;
+    static constexpr std::size_t kSlotsPerLevel = std::size_t{1} << kLevelBits;
+    static constexpr std::size_t kLevels = 4;
+
+    explicit TimerWheel(Clock::duration tick = std::chrono::milliseconds{10}, Clock::time_point origin = Clock::now());
+
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator=(const TimerWheel &) = delete;
+
+    TimerId schedule_at(Clock::time_point deadline, Callback callback);
+    TimerId schedule_after(Clock::duration delay, Callback callback);
+    void cancel(TimerId id) noexcept;
+
+    // Dispatches every timer whose deadline is at or before now. Timers that
+    // are already overdue when scheduled fire on the next tick. Callbacks may
+    // schedule or cancel timers, including rescheduling themselves. Returns
+    // the number of callbacks invoked.
+    std::size_t advance(Clock::time_point now);
+
+    // Earliest time at which advance() has work to do, or nullopt when no
+    // timer is pending. Exact for timers due within one level-0 revolution;
+    // for later ones it is the start of the range their slot cascades from,
+    // so a caller that sleeps until then and advances never misses a timer.
+    // Looks at no more than one slot per level position, not at the timers.
+    [[nodiscard]] std::optional<Clock::time_point> next_expiry() const noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept { return active_; }
+    [[nodiscard]] bool empty() const noexcept { return active_ == 0; }
+    [[nodiscard]] Clock::duration tick() const noexcept { return tick_; }
+    [[nodiscard]] const LatencyHistogram &jitter() const noexcept { return jitter_; }
+    void reset_jitter() noexcept { jitter_.reset(); }
+
+private:
+    static constexpr std::uint32_t kNone = UINT32_MAX;
+    // Holds the timers of the slot being dispatched, so timers its callbacks
+    // schedule into that same slot wait for its next turn.
+    static constexpr std::uint32_t kDispatchSlot = kLevels * kSlotsPerLevel;
+
+    struct Node {
+        Callback callback{};
+        Clock::time_point deadline{};
+        std::uint64_t expires{0};
+        std::uint32_t generation{0};
+        std::uint32_t prev{kNone};
+        std::uint32_t next{kNone};
+        std::uint32_t slot{kNone};
+    };
+
+    [[nodiscard]] std::uint64_t ticks_until(Clock::time_point deadline) const noexcept;
+    void link(std::uint32_t index);
+    void unlink(std::uint32_t index) noexcept;
+    void release(std::uint32_t index) noexcept;
+    void cascade(std::size_t level);
+
+    Clock::duration tick_;
+    Clock::time_point origin_;
+    std::uint64_t current_tick_{0};
+    std::size_t active_{0};
+    std::vector<Node> nodes_{};
+    std::vector<std::uint32_t> free_{};
+    std::array<std::uint32_t, kLevels * kSlotsPerLevel + 1> slots_{};
+    LatencyHistogram jitter_{};
+};
+
+} // namespace sotc::network
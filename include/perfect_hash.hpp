@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace sotc {
+
+// Collision-free hash over a fixed set of strings, built at compile time. The
+// constructor searches for a seed under which every key lands in its own
+// slot, so a lookup is one hash and at most one string comparison. Duplicate
+// keys fail to compile.
+template <std::size_t Size>
+class PerfectHash {
+public:
+    static_assert(Size > 0 && Size < 0xFFFF);
+
+    // Four slots per key keeps the seed search short.
+    static constexpr std::size_t kSlots = std::bit_ceil(Size * 4);
+
+    consteval explicit PerfectHash(const std::array<std::string_view, Size> &keys) : keys_(keys) {
+        for (std::size_t first = 0; first < Size; ++first) {
+            for (std::size_t second = first + 1; second < Size; ++second) {
+                if (keys_[first] == keys_[second]) {
+                    throw "PerfectHash keys must be unique";
+                }
+            }
+        }
+        while (!place_keys()) {
+            ++seed_;
+        }
+    }
+
+    // Index of key in the array the table was built from.
+    [[nodiscard]] constexpr std::optional<std::size_t> find(std::string_view key) const noexcept {
+        const auto slot = slots_[hash(key, seed_) & (kSlots - 1)];
+        if (slot == 0 || keys_[slot - 1] != key) {
+            return std::nullopt;
+        }
+        return slot - 1;
+    }
+
+    [[nodiscard]] constexpr std::size_t size() const noexcept { return Size; }
+    [[nodiscard]] constexpr std::uint32_t seed() const noexcept { return seed_; }
+
+private:
+    // Seeded FNV-1a with a final mix so the low bits used for the slot
+    // depend on every byte.
+    [[nodiscard]] static constexpr std::uint32_t hash(std::string_view key, std::uint32_t seed) noexcept {
+        std::uint32_t value = 2166136261U ^ (seed * 0x9E3779B9U);
+        for (const char c : key) {
+            value ^= static_cast<unsigned char>(c);
+            value *= 16777619U;
+        }
+        value ^= value >> 16;
+        value *= 0x85EBCA6BU;
+        value ^= value >> 13;
+        return value;
+    }
+
+    [[nodiscard]] constexpr bool place_keys() noexcept {
+        slots_.fill(0);
+        for (std::size_t index = 0; index < Size; ++index) {
+            auto &slot = slots_[hash(keys_[index], seed_) & (kSlots - 1)];
+            if (slot != 0) {
+                return false;
+            }
+            slot = static_cast<std::uint16_t>(index + 1);
+        }
+        return true;
+    }
+
+    std::array<std::string_view, Size> keys_{};
+    std::uint32_t seed_{0};
+    // Key index plus one; zero marks an empty slot.
+    std::array<std::uint16_t, kSlots> slots_{};
+};
+
+} // namespace sotc
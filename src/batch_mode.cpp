@@ -0,0 +1,237 @@
+#include "batch_mode.hpp"
+
+#include "launch_config.hpp"
+#include "launch_summary.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sotc {
+
+namespace {
+
+[[nodiscard]] std::vector<std::string_view> split_fields(std::string_view line) {
+    std::vector<std::string_view> fields;
+    while (true) {
+        const auto tab = line.find('\t');
+        fields.push_back(line.substr(0, tab));
+        if (tab == std::string_view::npos) {
+            return fields;
+        }
+        line.remove_prefix(tab + 1);
+    }
+}
+
+// Undoes the request escapes; any other backslash is kept as it is.
+[[nodiscard]] std::string unescape(std::string_view text) {
+    std::string result;
+    result.reserve(text.size());
+    for (std::size_t index = 0; index < text.size(); ++index) {
+        if (text[index] == '\\' && index + 1 < text.size()) {
+            const char next = text[index + 1];
+            if (next == 'n' || next == 't' || next == '\\') {
+                result.push_back(next == 'n' ? '\n' : next == 't' ? '\t' : '\\');
+                ++index;
+                continue;
+            }
+        }
+        result.push_back(text[index]);
+    }
+    return result;
+}
+
+// Applies the request to options, reporting problems to errors.
+bool parse_request(std::string_view request, LaunchOptions &options, std::ostream &errors) {
+    if (!request.empty() && request.back() == '\r') {
+        request.remove_suffix(1);
+    }
+    const auto fields = split_fields(request);
+
+    // The profile applies to the configuration text, which comes first.
+    std::string_view profile;
+    for (std::size_t index = 1; index + 1 < fields.size(); ++index) {
+        const auto flag = find_launch_flag(fields[index]);
+        if (flag && flag->spec->command == LaunchCommand::Profile) {
+            profile = fields[index + 1];
+        }
+    }
+
+    const ConfigDiagnosticsScope diagnostics{errors};
+    bool success = true;
+    if (!fields.front().empty() || !profile.empty()) {
+        success = load_config_text(unescape(fields.front()), "request", options, profile);
+    }
+    LaunchFlagApplier flags{options};
+    for (std::size_t index = 1; index < fields.size(); ++index) {
+        const auto argument = fields[index];
+        const auto flag = find_launch_flag(argument);
+        if (!flag) {
+            errors << "Unknown option: " << argument << '\n';
+            return false;
+        }
+        const auto &spec = *flag->spec;
+        std::string_view value = flag->off ? spec.off_value : spec.on_value;
+        if (!flag->off && !spec.metavar.empty()) {
+            if (index + 1 >= fields.size()) {
+                errors << "Missing value for option " << argument << '\n';
+                return false;
+            }
+            value = fields[++index];
+        }
+        if (spec.command == LaunchCommand::Profile) {
+            continue;
+        }
+        if (spec.command != LaunchCommand::None) {
+            errors << "Option " << argument << " is not supported in batch requests\n";
+            return false;
+        }
+        success = flags.apply(*flag, value) && success;
+    }
+    flags.finish();
+    return success;
+}
+
+} // namespace
+
+double BatchStats::requests_per_second() const noexcept {
+    const auto seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0.0 ? static_cast<double>(requests) / seconds : 0.0;
+}
+
+bool write_batch_response(std::uint64_t number, std::string_view request, const LaunchOptions &defaults,
+                          std::ostream &out) {
+    out << "request=" << number << '\n';
+    std::ostringstream errors;
+    LaunchOptions options = defaults;
+    bool success = parse_request(request, options, errors);
+    if (success) {
+        try {
+            std::ostringstream summary;
+            write_launch_summary(options, summary);
+            write_registration_summary(options, summary);
+            out << "status=ok\n" << summary.str() << '\n';
+            return true;
+        } catch (const std::exception &error) {
+            errors << error.what() << '\n';
+            success = false;
+        }
+    }
+
+    out << "status=error\n";
+    std::string message;
+    std::istringstream lines{errors.str()};
+    bool reported = false;
+    while (std::getline(lines, message)) {
+        if (!message.empty()) {
+            out << "error=" << message << '\n';
+            reported = true;
+        }
+    }
+    if (!reported) {
+        out << "error=Invalid request\n";
+    }
+    out << '\n';
+    return false;
+}
+
+BatchStats run_batch(std::istream &in, std::ostream &out, const LaunchOptions &defaults, BatchOptions options) {
+    BatchStats stats{};
+    stats.workers = options.workers != 0 ? options.workers : std::max(1U, std::thread::hardware_concurrency());
+    const auto max_pending = std::max<std::size_t>(options.max_pending, 1);
+    const auto started = std::chrono::steady_clock::now();
+
+    struct Slot {
+        std::string response;
+        bool done{false};
+    };
+
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable slot_free;
+    // Requests not yet picked up by a worker, by number.
+    std::deque<std::pair<std::uint64_t, std::string>> queue;
+    // Responses from the oldest unwritten request on; slots.front() belongs
+    // to request next_to_write.
+    std::deque<Slot> slots;
+    std::uint64_t next_to_write = 1;
+    bool input_done = false;
+
+    const auto work = [&] {
+        std::unique_lock lock{mutex};
+        while (true) {
+            work_ready.wait(lock, [&] { return !queue.empty() || input_done; });
+            if (queue.empty()) {
+                return;
+            }
+            auto [number, request] = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+
+            std::ostringstream response;
+            const bool success = write_batch_response(number, request, defaults, response);
+
+            lock.lock();
+            auto &slot = slots[number - next_to_write];
+            slot.response = std::move(response).str();
+            slot.done = true;
+            stats.failed += success ? 0 : 1;
+            const bool writable = slots.front().done;
+            while (!slots.empty() && slots.front().done) {
+                out << slots.front().response;
+                slots.pop_front();
+                ++next_to_write;
+            }
+            if (writable) {
+                // Under load the next answers are moments away; flush once
+                // nothing more is in flight.
+                if (queue.empty()) {
+                    out.flush();
+                }
+                slot_free.notify_one();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(stats.workers);
+    for (std::size_t index = 0; index < stats.workers; ++index) {
+        workers.emplace_back(work);
+    }
+
+    std::string line;
+    std::uint64_t number = 0;
+    while (std::getline(in, line)) {
+        std::unique_lock lock{mutex};
+        slot_free.wait(lock, [&] { return slots.size() < max_pending; });
+        queue.emplace_back(++number, std::move(line));
+        slots.emplace_back();
+        lock.unlock();
+        work_ready.notify_one();
+        line.clear();
+    }
+    {
+        const std::lock_guard lock{mutex};
+        input_done = true;
+    }
+    work_ready.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    out.flush();
+
+    stats.requests = number;
+    stats.elapsed = std::chrono::steady_clock::now() - started;
+    return stats;
+}
+
+} // namespace sotc
@@ -1,53 +1,205 @@
 #include "client_app.hpp"
 
 #include <chrono>
+#include <csignal>
 #include <cstddef>
 #include <cstdint>
+#include <exception>
+#include <filesystem>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "gui/configuration_preview.hpp"
 #include "gui/coordinator_settings_window.hpp"
 #include "gui/session_formatting.hpp"
+#include "launch_config.hpp"
 #include "network/coordinator_client.hpp"
 
+#if SOTC_HAS_EPOLL
+#include "network/coordinator_fleet.hpp"
+#include "network/dns_cache.hpp"
+#include "network/event_loop.hpp"
+#include "network/file_watcher.hpp"
+#include "network/lan_discovery.hpp"
+#include "network/latency_probe.hpp"
+#include "network/server_listing_client.hpp"
+#include "network/session_cache.hpp"
+#endif
+
 namespace sotc {
 
-ClientApp::ClientApp() = default;
+namespace {
+
+volatile std::sig_atomic_t g_interrupted = 0;
+
+extern "C" void handle_interrupt(int) {
+    g_interrupted = 1;
+}
+
+#if SOTC_HAS_EPOLL
+// Delivers the resolver's completions on loop for as long as it is in scope.
+class ResolverAttachment {
+public:
+    ResolverAttachment(network::DnsCache *resolver, network::EventLoop &loop) : resolver_(resolver) {
+        if (resolver_ != nullptr) {
+            resolver_->attach(loop);
+        }
+    }
+    ~ResolverAttachment() {
+        if (resolver_ != nullptr) {
+            resolver_->detach();
+        }
+    }
+
+    ResolverAttachment(const ResolverAttachment &) = delete;
+    ResolverAttachment &operator=(const ResolverAttachment &) = delete;
+
+private:
+    network::DnsCache *resolver_;
+};
+
+[[nodiscard]] double to_milliseconds(std::chrono::nanoseconds value) {
+    return std::chrono::duration<double, std::milli>(value).count();
+}
+
+void print_latency(const network::EndpointLatency &latency) {
+    std::cout << "  ping " << ui::format_endpoint(latency.host, latency.port) << ": ";
+    if (!latency.resolved) {
+        std::cout << "unresolved" << std::endl;
+        return;
+    }
+    if (latency.rtt.size() == 0) {
+        std::cout << "no reply (" << latency.lost << " lost)" << std::endl;
+        return;
+    }
+    std::cout << "min " << to_milliseconds(latency.rtt.min()) << " ms, p50 "
+              << to_milliseconds(latency.rtt.percentile(50)) << " ms, p99 "
+              << to_milliseconds(latency.rtt.percentile(99)) << " ms (" << latency.received << '/' << latency.sent
+              << " replies)" << std::endl;
+}
+
+void print_latency_summary(const network::LatencyProber &prober) {
+    const auto &histogram = prober.rtt_histogram();
+    std::cout << "Latency probes: " << prober.size() << " endpoints, " << histogram.count() << " replies, p50 "
+              << to_milliseconds(histogram.percentile(50)) << " ms, p99 " << to_milliseconds(histogram.percentile(99))
+              << " ms, peak in flight " << prober.peak_in_flight() << std::endl;
+}
+#endif
+
+[[nodiscard]] network::RegistrationConfig build_base_registration(const LaunchOptions &options) {
+    network::RegistrationConfig registration{};
+    registration.server_name = ui::build_server_name(options.player_name);
+    registration.coordinator_host = options.coordinator_host.empty() ? std::string{"coordinator.openttd.org"}
+                                                                     : options.coordinator_host;
+    registration.coordinator_port = options.coordinator_port == 0 ? network::NETWORK_COORDINATOR_SERVER_PORT
+                                                                  : options.coordinator_port;
+    registration.listen_port = options.server_port;
+    registration.listed_publicly = options.listed_publicly && !options.headless;
+    registration.server_game_type = options.server_game_type;
+    registration.invite_code = options.invite_code;
+    registration.allow_direct = options.allow_direct;
+    registration.allow_stun = options.allow_stun;
+    registration.allow_turn = options.allow_turn;
+    registration.heartbeat_interval = options.heartbeat_interval;
+    registration.advertised_grfs = options.advertised_grfs;
+    return registration;
+}
+
+} // namespace
+
+std::vector<network::RegistrationConfig> build_registrations(const LaunchOptions &options) {
+    if (!options.profiles.empty()) {
+        std::vector<network::RegistrationConfig> registrations;
+        registrations.reserve(options.profiles.size());
+        for (const auto &profile : options.profiles) {
+            auto profile_registrations = build_registrations(profile.options);
+            registrations.insert(registrations.end(), std::make_move_iterator(profile_registrations.begin()),
+                                 std::make_move_iterator(profile_registrations.end()));
+        }
+        return registrations;
+    }
+    const auto base = build_base_registration(options);
+    if (options.hosted_servers.empty()) {
+        return {base};
+    }
+    std::vector<network::RegistrationConfig> registrations;
+    registrations.reserve(options.hosted_servers.size());
+    for (const auto &hosted : options.hosted_servers) {
+        auto registration = base;
+        registration.listen_port = hosted.listen_port;
+        registration.server_name = hosted.server_name.empty()
+                                       ? base.server_name + " (port " + std::to_string(hosted.listen_port) + ')'
+                                       : hosted.server_name;
+        registration.invite_code = hosted.invite_code.value_or(base.invite_code);
+        registration.server_game_type = hosted.server_game_type.value_or(base.server_game_type);
+        registration.heartbeat_interval = hosted.heartbeat_interval.value_or(base.heartbeat_interval);
+        registration.allow_direct = hosted.allow_direct.value_or(base.allow_direct);
+        registration.allow_stun = hosted.allow_stun.value_or(base.allow_stun);
+        registration.allow_turn = hosted.allow_turn.value_or(base.allow_turn);
+        registrations.push_back(std::move(registration));
+    }
+    return registrations;
+}
+
+ClientApp::ClientApp() : options_(make_launch_snapshot(LaunchOptions{})) {}
 
 void ClientApp::configure(LaunchOptions options) {
-    options_ = std::move(options);
+    options_.store(make_launch_snapshot(std::move(options)));
+}
+
+void ClientApp::set_config_files(std::vector<std::string> paths, ConfigReloader reload) {
+    config_paths_ = std::move(paths);
+    reload_config_ = std::move(reload);
 }
 
 void ClientApp::run() {
-    log_startup_info();
-    render_gui_preview();
+    // Held for the whole run; a reload publishes a new snapshot without
+    // touching this one.
+    const auto snapshot = options_.load();
+    const auto &options = *snapshot;
+#if SOTC_HAS_EPOLL
+    if (options.list_servers || options.register_with_coordinator || options.probe_latency) {
+        // Lookups run while the startup summary and preview are printed.
+        resolver_ = std::make_shared<network::DnsCache>();
+        resolver_->prefetch(
+            options.coordinator_host.empty() ? std::string{"coordinator.openttd.org"} : options.coordinator_host,
+            options.coordinator_port == 0 ? network::NETWORK_COORDINATOR_SERVER_PORT : options.coordinator_port);
+        if (!options.server_host.empty()) {
+            // --ping probes it over UDP; DnsCache keys answers by socket type.
+            resolver_->prefetch(options.server_host, options.server_port,
+                                options.probe_latency ? SOCK_DGRAM : SOCK_STREAM);
+        }
+    }
+#endif
+    log_startup_info(options);
+    render_gui_preview(options);
     std::cout << "Simple OpenTTD Client scaffold running." << std::endl;
     std::cout << "Networking and rendering subsystems are not yet implemented." << std::endl;
 
-    sotc::network::CoordinatorClient coordinator{};
-    sotc::network::RegistrationConfig registration{};
-    registration.server_name = ui::build_server_name(options_.player_name);
-    registration.coordinator_host = options_.coordinator_host.empty()
-                                      ? std::string{"coordinator.openttd.org"}
-                                      : options_.coordinator_host;
-    registration.coordinator_port = options_.coordinator_port == 0
-                                        ? network::NETWORK_COORDINATOR_SERVER_PORT
-                                        : options_.coordinator_port;
-    registration.listen_port = options_.server_port;
-    registration.listed_publicly = options_.listed_publicly && !options_.headless;
-    registration.server_game_type = options_.server_game_type;
-    registration.invite_code = options_.invite_code;
-    registration.allow_direct = options_.allow_direct;
-    registration.allow_stun = options_.allow_stun;
-    registration.allow_turn = options_.allow_turn;
-    registration.heartbeat_interval = options_.heartbeat_interval;
-    registration.advertised_grfs = options_.advertised_grfs;
-
-    auto frame = coordinator.build_registration_frame(registration);
-    auto payload = frame.serialize();
+    if (options.list_servers) {
+        list_coordinator_servers(options);
+        return;
+    }
+    if (options.discover_lan) {
+        discover_lan_servers(options);
+        return;
+    }
+    if (options.probe_latency) {
+        probe_server_latency(options);
+        return;
+    }
+
+    const auto registration = build_base_registration(options);
+
+    const network::CachedRegistrationFrame cached_frame{registration};
+    const auto &frame = cached_frame.frame();
+    const auto payload = cached_frame.payload();
 
     std::cout << "Prepared coordinator registration payload targeting " << registration.coordinator_host << ':'
               << registration.coordinator_port << " (" << payload.size() << " bytes)." << std::endl;
@@ -69,7 +221,12 @@ void ClientApp::run() {
     }
     std::cout << std::dec << std::setfill(' ') << '\n';
 
-    if (options_.headless) {
+    if (options.register_with_coordinator) {
+        run_coordinator_sessions(options, build_registrations(options));
+        return;
+    }
+
+    if (options.headless) {
         std::cout << "Headless mode enabled; exiting immediately." << std::endl;
         return;
     }
@@ -83,30 +240,276 @@ void ClientApp::run() {
     std::cout << std::endl;
 }
 
-void ClientApp::log_startup_info() const {
+void ClientApp::log_startup_info(const LaunchOptions &options) const {
     std::cout << "Launching client with configuration:\n";
-    std::cout << "  Server: " << ui::format_endpoint(options_.server_host, options_.server_port) << '\n';
-    std::cout << "  Coordinator: " << ui::format_endpoint(options_.coordinator_host, options_.coordinator_port)
+    std::cout << "  Server: " << ui::format_endpoint(options.server_host, options.server_port) << '\n';
+    std::cout << "  Coordinator: " << ui::format_endpoint(options.coordinator_host, options.coordinator_port)
               << '\n';
-    std::cout << "  Player: " << (options_.player_name.empty() ? "<anonymous>" : options_.player_name) << '\n';
-    std::cout << "  Advertised name: " << ui::build_server_name(options_.player_name) << '\n';
-    std::cout << "  Headless: " << (options_.headless ? "yes" : "no") << '\n';
-    std::cout << "  Game type: " << ui::to_string(options_.server_game_type) << '\n';
-    std::cout << "  Public listing: " << (options_.listed_publicly ? "yes" : "no") << '\n';
-    std::cout << "  Invite code: " << (options_.invite_code.empty() ? "<not set>" : options_.invite_code) << '\n';
-    std::cout << "  NAT: " << ui::describe_nat_policy(options_.allow_direct, options_.allow_stun, options_.allow_turn) << '\n';
-    std::cout << "  Heartbeat: every " << options_.heartbeat_interval.count() << "s" << std::endl;
+    std::cout << "  Player: " << (options.player_name.empty() ? "<anonymous>" : options.player_name) << '\n';
+    std::cout << "  Advertised name: " << ui::build_server_name(options.player_name) << '\n';
+    std::cout << "  Headless: " << (options.headless ? "yes" : "no") << '\n';
+    std::cout << "  Game type: " << ui::to_string(options.server_game_type) << '\n';
+    std::cout << "  Public listing: " << (options.listed_publicly ? "yes" : "no") << '\n';
+    std::cout << "  Invite code: " << (options.invite_code.empty() ? "<not set>" : options.invite_code) << '\n';
+    std::cout << "  NAT: " << ui::describe_nat_policy(options.allow_direct, options.allow_stun, options.allow_turn) << '\n';
+    std::cout << "  Heartbeat: every " << options.heartbeat_interval.count() << "s" << std::endl;
+    if (!options.hosted_servers.empty()) {
+        std::cout << "  Hosted servers: " << options.hosted_servers.size() << std::endl;
+    }
 }
 
-void ClientApp::render_gui_preview() const {
-    auto state = ui::build_state_from_launch_options(options_);
+void ClientApp::render_gui_preview(const LaunchOptions &options) const {
+    auto state = ui::build_state_from_launch_options(options);
     ui::CoordinatorSettingsWindow window{std::move(state)};
     std::cout << '\n' << ui::render_sections(window.build_sections()) << std::endl;
 }
 
-std::vector<std::string> discover_local_servers() {
-    std::cout << "Server discovery is not implemented yet." << std::endl;
-    return {};
+void ClientApp::run_coordinator_sessions(const LaunchOptions &options,
+                                         const std::vector<network::RegistrationConfig> &registrations) {
+#if SOTC_HAS_EPOLL
+    using namespace std::chrono_literals;
+
+    network::EventLoop loop;
+    const ResolverAttachment attachment{resolver_.get(), loop};
+    network::CoordinatorFleetOptions fleet_options{};
+    fleet_options.resolver = resolver_.get();
+    std::optional<network::SessionCache> session_cache;
+    if (!options.session_cache_path.empty()) {
+        session_cache.emplace(options.session_cache_path);
+        if (session_cache->load()) {
+            std::cout << "Session cache " << options.session_cache_path << ": " << session_cache->size()
+                      << " entries" << std::endl;
+        }
+        fleet_options.session_cache = &*session_cache;
+    }
+    network::CoordinatorFleet fleet{loop, fleet_options};
+    for (const auto &registration : registrations) {
+        fleet.add(registration);
+    }
+    fleet.set_state_callback([&fleet](std::size_t server, network::SessionState state) {
+        const auto &session = fleet.session(server);
+        std::cout << "Coordinator session";
+        if (fleet.size() > 1) {
+            std::cout << " [" << session.config().server_name << ']';
+        }
+        std::cout << ' ' << network::to_string(state);
+        if (state == network::SessionState::Registered) {
+            if (!session.registration().invite_code.empty()) {
+                std::cout << " (invite code " << session.registration().invite_code
+                          << (session.resumed() ? ", resumed" : "") << ')';
+            }
+            std::cout << " after " << to_milliseconds(session.time_to_registered()) << " ms";
+        }
+        if (state == network::SessionState::Failed) {
+            std::cout << ": " << session.last_error();
+        }
+        std::cout << std::endl;
+    });
+
+    // Reload latency runs from the first inotify event to the end of
+    // reconcile().
+    network::LatencyHistogram reload_latency{};
+    std::optional<network::FileWatcher> watcher;
+    if (options.watch_config && !config_paths_.empty() && reload_config_) {
+        watcher.emplace(loop, std::vector<std::filesystem::path>(config_paths_.begin(), config_paths_.end()));
+        watcher->set_change_callback([&](const std::vector<std::filesystem::path> &changed,
+                                         network::FileWatcher::Clock::time_point first_event) {
+            std::cout << "Configuration changed: " << changed.front().string();
+            if (changed.size() > 1) {
+                std::cout << " and " << changed.size() - 1 << " more";
+            }
+            std::cout << std::endl;
+            LaunchOptions reloaded{};
+            if (!reload_config_(reloaded)) {
+                std::cout << "Keeping the previous configuration." << std::endl;
+                return;
+            }
+            const auto result = fleet.reconcile(build_registrations(reloaded));
+            options_.store(make_launch_snapshot(std::move(reloaded)));
+            const auto elapsed = network::FileWatcher::Clock::now() - first_event;
+            reload_latency.record(elapsed);
+            std::cout << "Configuration reloaded in " << to_milliseconds(elapsed) << " ms: " << result.unchanged
+                      << " unchanged, " << result.patched << " patched, " << result.reregistered
+                      << " re-registered, " << result.added << " added, " << result.removed << " removed"
+                      << std::endl;
+        });
+        std::cout << "Watching " << config_paths_.size() << " configuration file"
+                  << (config_paths_.size() == 1 ? "" : "s") << " for changes." << std::endl;
+    }
+
+    g_interrupted = 0;
+    const auto previous_handler = std::signal(SIGINT, handle_interrupt);
+    fleet.start();
+    // While watching, a fleet that failed can still be fixed by editing the
+    // configuration, so only an interrupt ends the run.
+    while (!g_interrupted && (watcher || !fleet.finished())) {
+        loop.run_once(250ms);
+    }
+    std::signal(SIGINT, previous_handler);
+
+    const auto latency = fleet.ack_latency();
+    const auto &jitter = fleet.heartbeat_jitter();
+    const auto to_ms = [](std::chrono::nanoseconds value) {
+        return std::chrono::duration<double, std::milli>(value).count();
+    };
+    if (fleet.active().size() > 1) {
+        std::cout << "Coordinator servers registered: " << fleet.count(network::SessionState::Registered) << '/'
+                  << fleet.active().size() << std::endl;
+    }
+    std::cout << "Coordinator acknowledgements: " << latency.count() << " (p50 " << to_ms(latency.percentile(50))
+              << " ms, p99 " << to_ms(latency.percentile(99)) << " ms), heartbeats sent: "
+              << fleet.heartbeats_sent() << std::endl;
+    std::cout << "Heartbeat scheduling jitter: p50 " << to_ms(jitter.percentile(50)) << " ms, p99 "
+              << to_ms(jitter.percentile(99)) << " ms, max " << to_ms(jitter.max()) << " ms" << std::endl;
+    if (reload_latency.count() > 0) {
+        std::cout << "Configuration reloads: " << reload_latency.count() << " (p50 "
+                  << to_ms(reload_latency.percentile(50)) << " ms, max " << to_ms(reload_latency.max()) << " ms)"
+                  << std::endl;
+    }
+    fleet.close();
+#else
+    static_cast<void>(options);
+    static_cast<void>(registrations);
+    std::cout << "Coordinator sessions are not supported on this platform yet." << std::endl;
+#endif
+}
+
+void ClientApp::list_coordinator_servers(const LaunchOptions &options) const {
+#if SOTC_HAS_EPOLL
+    using namespace std::chrono_literals;
+
+    network::ServerListingOptions listing_options{};
+    listing_options.coordinator_host = options.coordinator_host.empty() ? std::string{"coordinator.openttd.org"}
+                                                                         : options.coordinator_host;
+    listing_options.coordinator_port = options.coordinator_port == 0 ? network::NETWORK_COORDINATOR_SERVER_PORT
+                                                                      : options.coordinator_port;
+    listing_options.resolver = resolver_.get();
+
+    network::EventLoop loop;
+    const ResolverAttachment attachment{resolver_.get(), loop};
+    network::ServerListingClient client{loop, listing_options};
+    network::LatencyProbeOptions probe_options{};
+    probe_options.resolver = resolver_.get();
+    network::LatencyProber prober{loop, probe_options};
+    std::cout << "Requesting server listing from "
+              << ui::format_endpoint(listing_options.coordinator_host, listing_options.coordinator_port) << std::endl;
+    // Pings stream in while the rest of the listing is still arriving.
+    prober.set_result_callback([&prober](network::LatencyProber::EndpointId id,
+                                         const network::EndpointLatency &latency) {
+        if (prober.done(id)) {
+            print_latency(latency);
+        }
+    });
+    const bool probe_latency = options.probe_latency;
+    client.set_entry_callback([&prober, probe_latency](const network::ServerListingEntry &entry) {
+        std::cout << "  " << ui::describe_listing_entry(entry) << std::endl;
+        std::string host;
+        std::uint16_t port = network::NETWORK_DEFAULT_GAME_PORT;
+        // Invite codes need the coordinator to connect; they have no address to ping.
+        if (probe_latency && !entry.connection_string.starts_with('+') &&
+            parse_host_and_port(entry.connection_string, host, port)) {
+            static_cast<void>(prober.add(std::move(host), port));
+        }
+    });
+
+    g_interrupted = 0;
+    const auto previous_handler = std::signal(SIGINT, handle_interrupt);
+    client.refresh();
+    while (!g_interrupted && ((client.state() != network::ListingState::Complete &&
+                               client.state() != network::ListingState::Failed) ||
+                              !prober.idle())) {
+        loop.run_once(250ms);
+    }
+    std::signal(SIGINT, previous_handler);
+
+    if (client.state() == network::ListingState::Failed) {
+        std::cout << "Server listing failed: " << client.last_error() << std::endl;
+    } else {
+        std::cout << "Server listing " << network::to_string(client.state()) << ": " << client.entries_received()
+                  << " servers, " << client.lookup_entries_received() << " NewGRF lookup entries" << std::endl;
+    }
+    if (probe_latency) {
+        print_latency_summary(prober);
+    }
+    prober.close();
+    client.close();
+#else
+    static_cast<void>(options);
+    std::cout << "Server listing is not supported on this platform yet." << std::endl;
+#endif
+}
+
+void ClientApp::discover_lan_servers(const LaunchOptions &options) const {
+#if SOTC_HAS_EPOLL
+    network::LanDiscoveryOptions discovery{};
+    if (!options.lan_targets.empty()) {
+        discovery.targets = options.lan_targets;
+    }
+    discovery.default_port = network::NETWORK_DEFAULT_GAME_PORT;
+
+    std::cout << "Probing " << discovery.targets.size() << " LAN target(s) for servers" << std::endl;
+    network::LanDiscoveryResult result;
+    try {
+        result = network::discover_local_servers(discovery);
+    } catch (const std::exception &error) {
+        std::cout << "LAN discovery failed: " << error.what() << std::endl;
+        return;
+    }
+
+    for (const auto &server : result.servers) {
+        const network::ServerListingEntry entry{server.endpoint.to_string(), server.info, 0};
+        std::cout << "  " << ui::describe_listing_entry(entry) << ", "
+                  << std::chrono::duration<double, std::milli>(server.round_trip).count() << " ms" << std::endl;
+    }
+    std::cout << "LAN discovery complete: " << result.servers.size() << " servers, " << result.probes_sent
+              << " probes sent";
+    if (result.probes_failed != 0) {
+        std::cout << ", " << result.probes_failed << " failed";
+    }
+    if (result.malformed != 0) {
+        std::cout << ", " << result.malformed << " malformed replies";
+    }
+    std::cout << std::endl;
+#else
+    static_cast<void>(options);
+    std::cout << "LAN discovery is not supported on this platform yet." << std::endl;
+#endif
+}
+
+void ClientApp::probe_server_latency(const LaunchOptions &options) const {
+#if SOTC_HAS_EPOLL
+    using namespace std::chrono_literals;
+
+    if (options.server_host.empty()) {
+        std::cout << "No server to ping; pass --server or --list-servers." << std::endl;
+        return;
+    }
+
+    network::EventLoop loop;
+    const ResolverAttachment attachment{resolver_.get(), loop};
+    network::LatencyProbeOptions probe_options{};
+    probe_options.resolver = resolver_.get();
+    network::LatencyProber prober{loop, probe_options};
+    prober.set_result_callback([&prober](network::LatencyProber::EndpointId id,
+                                         const network::EndpointLatency &latency) {
+        if (prober.done(id)) {
+            print_latency(latency);
+        }
+    });
+
+    g_interrupted = 0;
+    const auto previous_handler = std::signal(SIGINT, handle_interrupt);
+    // The startup prefetch has usually resolved the host by now.
+    static_cast<void>(prober.add(options.server_host, options.server_port));
+    while (!g_interrupted && !prober.idle()) {
+        loop.run_once(250ms);
+    }
+    std::signal(SIGINT, previous_handler);
+    prober.close();
+#else
+    static_cast<void>(options);
+    std::cout << "Latency probing is not supported on this platform yet." << std::endl;
+#endif
 }
 
 } // namespace sotc
@@ -55,7 +55,7 @@ void CoordinatorSettingsWindow::update_nat_capabilities(bool allow_direct, bool
     state_.allow_turn = allow_turn;
 }
 
-void CoordinatorSettingsWindow::set_advertised_grfs(std::vector<std::string> grfs) noexcept {
+void CoordinatorSettingsWindow::set_advertised_grfs(network::GrfList grfs) noexcept {
     state_.advertised_grfs = std::move(grfs);
 }
 
@@ -1,6 +1,7 @@
 #include "gui/session_formatting.hpp"
 
 #include <algorithm>
+#include <sstream>
 
 namespace sotc::ui {
 
@@ -52,5 +53,25 @@ std::string describe_nat_policy(bool allow_direct, bool allow_stun, bool allow_t
     return description;
 }
 
+std::string describe_listing_entry(const network::ServerListingEntry &entry) {
+    const auto &info = entry.info;
+    std::ostringstream stream;
+    stream << (info.server_name.empty() ? std::string{"<unnamed>"} : info.server_name) << " ["
+           << entry.connection_string << "] clients " << static_cast<int>(info.clients_on) << '/'
+           << static_cast<int>(info.clients_max) << ", companies " << static_cast<int>(info.companies_on) << '/'
+           << static_cast<int>(info.companies_max) << ", " << info.map_width << 'x' << info.map_height << ", "
+           << info.newgrfs.size() + entry.unresolved_newgrfs << " NewGRFs";
+    if (entry.unresolved_newgrfs != 0) {
+        stream << " (" << entry.unresolved_newgrfs << " unknown)";
+    }
+    if (info.use_password) {
+        stream << ", password";
+    }
+    if (info.dedicated) {
+        stream << ", dedicated";
+    }
+    return stream.str();
+}
+
 } // namespace sotc::ui
 
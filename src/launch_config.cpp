@@ -0,0 +1,894 @@
+#include "launch_config.hpp"
+
+#include "mapped_file.hpp"
+#include "perfect_hash.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <system_error>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+
+namespace sotc {
+
+namespace {
+
+thread_local std::ostream *t_diagnostics = nullptr;
+
+[[nodiscard]] std::ostream &diagnostics() noexcept {
+    return t_diagnostics != nullptr ? *t_diagnostics : std::cerr;
+}
+
+[[nodiscard]] std::string_view trim(std::string_view value) noexcept {
+    while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front()))) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+[[nodiscard]] std::string trim_copy(std::string_view value) {
+    return std::string{trim(value)};
+}
+
+// Splits the next comma-separated field off rest. Like std::getline, a
+// trailing comma does not produce an empty last field.
+[[nodiscard]] std::string_view next_field(std::string_view &rest) noexcept {
+    const auto comma = rest.find(',');
+    const auto field = rest.substr(0, comma);
+    rest = comma == std::string_view::npos ? std::string_view{} : rest.substr(comma + 1);
+    return field;
+}
+
+[[nodiscard]] std::string_view game_type_name(network::ServerGameType type) noexcept {
+    switch (type) {
+    case network::ServerGameType::Public:
+        return "public";
+    case network::ServerGameType::FriendsOnly:
+        return "friends";
+    case network::ServerGameType::InviteOnly:
+        return "invite";
+    }
+    return "public";
+}
+
+[[nodiscard]] std::string to_lower_copy(std::string value) {
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return value;
+}
+
+} // namespace
+
+bool parse_bool(std::string_view value, bool &out) {
+    const auto lowered = to_lower_copy(std::string{value});
+    if (lowered == "true" || lowered == "yes" || lowered == "on" || lowered == "1") {
+        out = true;
+        return true;
+    }
+    if (lowered == "false" || lowered == "no" || lowered == "off" || lowered == "0") {
+        out = false;
+        return true;
+    }
+    return false;
+}
+
+bool parse_uint16(std::string_view value, std::uint16_t &out) {
+    try {
+        const unsigned long parsed = std::stoul(std::string{value}, nullptr, 10);
+        if (parsed > 0xFFFFUL) {
+            return false;
+        }
+        out = static_cast<std::uint16_t>(parsed);
+        return true;
+    } catch (const std::exception &) {
+        return false;
+    }
+}
+
+bool parse_seconds(std::string_view value, std::chrono::seconds &out) {
+    try {
+        const long long parsed = std::stoll(std::string{value}, nullptr, 10);
+        if (parsed < 0) {
+            return false;
+        }
+        out = std::chrono::seconds{parsed};
+        return true;
+    } catch (const std::exception &) {
+        return false;
+    }
+}
+
+bool parse_server_game_type(std::string_view value, network::ServerGameType &out) {
+    const auto lowered = to_lower_copy(std::string{value});
+    if (lowered == "public") {
+        out = network::ServerGameType::Public;
+        return true;
+    }
+    if (lowered == "friends" || lowered == "friends_only" || lowered == "friends-only") {
+        out = network::ServerGameType::FriendsOnly;
+        return true;
+    }
+    if (lowered == "invite" || lowered == "invite_only" || lowered == "invite-only") {
+        out = network::ServerGameType::InviteOnly;
+        return true;
+    }
+    return false;
+}
+
+bool parse_host_and_port(std::string_view value, std::string &host_out, std::uint16_t &port_out) {
+    std::string host;
+    std::string port_str;
+
+    if (!value.empty() && value.front() == '[') {
+        const auto closing = value.find(']');
+        if (closing != std::string_view::npos) {
+            host = std::string{value.substr(1, closing - 1)};
+            if (closing + 1 < value.size() && value[closing + 1] == ':') {
+                port_str = std::string{value.substr(closing + 2)};
+            }
+        } else {
+            host = std::string{value};
+        }
+    } else {
+        const auto last_colon = value.rfind(':');
+        if (last_colon != std::string_view::npos) {
+            host = std::string{value.substr(0, last_colon)};
+            port_str = std::string{value.substr(last_colon + 1)};
+        } else {
+            host = std::string{value};
+        }
+    }
+
+    if (!port_str.empty()) {
+        std::uint16_t parsed_port = 0;
+        if (!parse_uint16(port_str, parsed_port)) {
+            return false;
+        }
+        port_out = parsed_port;
+    }
+
+    host_out = trim_copy(host);
+    return true;
+}
+
+bool parse_hosted_server(std::string_view value, HostedServerOptions &out) {
+    std::string_view rest = value;
+    if (rest.empty() || !parse_uint16(trim(next_field(rest)), out.listen_port) || out.listen_port == 0) {
+        diagnostics() << "Invalid hosted server port in: " << value << '\n';
+        return false;
+    }
+
+    while (!rest.empty()) {
+        const auto token = next_field(rest);
+        const auto equals = token.find('=');
+        if (equals == std::string_view::npos) {
+            diagnostics() << "Invalid hosted server setting '" << trim(token) << "' in: " << value << '\n';
+            return false;
+        }
+        const auto key = trim(token.substr(0, equals));
+        const auto setting = trim(token.substr(equals + 1));
+        bool valid = true;
+        if (key == "name") {
+            out.server_name = setting;
+        } else if (key == "invite_code") {
+            out.invite_code = std::string{setting};
+        } else if (key == "game_type") {
+            network::ServerGameType type = network::ServerGameType::Public;
+            valid = parse_server_game_type(setting, type);
+            out.server_game_type = type;
+        } else if (key == "heartbeat") {
+            std::chrono::seconds heartbeat{};
+            valid = parse_seconds(setting, heartbeat);
+            out.heartbeat_interval = heartbeat;
+        } else if (key == "direct" || key == "stun" || key == "turn") {
+            bool flag = false;
+            valid = parse_bool(setting, flag);
+            auto &target = key == "direct" ? out.allow_direct : key == "stun" ? out.allow_stun : out.allow_turn;
+            target = flag;
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            diagnostics() << "Invalid hosted server setting '" << trim(token) << "' in: " << value << '\n';
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string format_hosted_server(const HostedServerOptions &server) {
+    const auto flag = [](bool value) { return value ? "on" : "off"; };
+    std::ostringstream oss;
+    oss << server.listen_port;
+    if (!server.server_name.empty()) {
+        oss << ",name=" << server.server_name;
+    }
+    if (server.invite_code) {
+        oss << ",invite_code=" << *server.invite_code;
+    }
+    if (server.server_game_type) {
+        oss << ",game_type=" << game_type_name(*server.server_game_type);
+    }
+    if (server.heartbeat_interval) {
+        oss << ",heartbeat=" << server.heartbeat_interval->count();
+    }
+    if (server.allow_direct) {
+        oss << ",direct=" << flag(*server.allow_direct);
+    }
+    if (server.allow_stun) {
+        oss << ",stun=" << flag(*server.allow_stun);
+    }
+    if (server.allow_turn) {
+        oss << ",turn=" << flag(*server.allow_turn);
+    }
+    return oss.str();
+}
+
+namespace {
+
+// Parses value into the LaunchOptions field Member with the parser for its
+// type.
+template <auto Member>
+bool assign(std::string_view value, LaunchOptions &options) {
+    auto &field = options.*Member;
+    using Field = std::remove_reference_t<decltype(field)>;
+    if constexpr (std::is_same_v<Field, std::string>) {
+        field = std::string{value};
+        return true;
+    } else if constexpr (std::is_same_v<Field, bool>) {
+        return parse_bool(value, field);
+    } else if constexpr (std::is_same_v<Field, std::uint16_t>) {
+        return parse_uint16(value, field);
+    } else if constexpr (std::is_same_v<Field, std::chrono::seconds>) {
+        return parse_seconds(value, field);
+    } else {
+        static_assert(std::is_same_v<Field, network::ServerGameType>);
+        return parse_server_game_type(value, field);
+    }
+}
+
+// Appends value to the list Member; empty values are ignored.
+template <auto Member>
+bool append(std::string_view value, LaunchOptions &options) {
+    auto &field = options.*Member;
+    if (!value.empty()) {
+        field.emplace_back(value);
+    }
+    return true;
+}
+
+template <auto Member>
+void print(const LaunchOptions &options, std::ostream &out) {
+    const auto &field = options.*Member;
+    using Field = std::remove_cvref_t<decltype(field)>;
+    if constexpr (std::is_same_v<Field, bool>) {
+        out << (field ? "true" : "false");
+    } else if constexpr (std::is_same_v<Field, std::chrono::seconds>) {
+        out << field.count();
+    } else if constexpr (std::is_same_v<Field, network::ServerGameType>) {
+        out << game_type_name(field);
+    } else if constexpr (std::is_same_v<Field, std::vector<std::string>> || std::is_same_v<Field, network::GrfList>) {
+        for (std::size_t index = 0; index < field.size(); ++index) {
+            out << (index == 0 ? "" : ",") << field[index];
+        }
+    } else {
+        out << field;
+    }
+}
+
+bool assign_advertised_grfs(std::string_view value, LaunchOptions &options) {
+    // Profiles usually repeat the list they inherit; keep sharing it then.
+    std::size_t count = 0;
+    bool unchanged = true;
+    for (auto rest = value; !rest.empty();) {
+        const auto token = trim(next_field(rest));
+        if (!token.empty()) {
+            unchanged = unchanged && count < options.advertised_grfs.size() && options.advertised_grfs[count] == token;
+            ++count;
+        }
+    }
+    if (unchanged && count == options.advertised_grfs.size()) {
+        return true;
+    }
+    std::vector<std::string> grfs;
+    grfs.reserve(count);
+    for (auto rest = value; !rest.empty();) {
+        const auto token = trim(next_field(rest));
+        if (!token.empty()) {
+            grfs.emplace_back(token);
+        }
+    }
+    options.advertised_grfs = network::GrfList::interned(std::move(grfs));
+    return true;
+}
+
+// One --advertised-grf on its own; LaunchFlagApplier collects a run of them
+// instead of copying the list for each.
+bool append_advertised_grf(std::string_view value, LaunchOptions &options) {
+    if (!value.empty()) {
+        options.advertised_grfs = options.advertised_grfs.appended(std::string{value});
+    }
+    return true;
+}
+
+bool append_hosted_server(std::string_view value, LaunchOptions &options) {
+    HostedServerOptions server{};
+    if (!parse_hosted_server(value, server)) {
+        return false;
+    }
+    options.hosted_servers.push_back(std::move(server));
+    return true;
+}
+
+void print_hosted_servers(const LaunchOptions &options, std::ostream &out) {
+    for (std::size_t index = 0; index < options.hosted_servers.size(); ++index) {
+        out << (index == 0 ? "" : ";") << format_hosted_server(options.hosted_servers[index]);
+    }
+}
+
+void print_profile_names(const LaunchOptions &options, std::ostream &out) {
+    for (std::size_t index = 0; index < options.profiles.size(); ++index) {
+        out << (index == 0 ? "" : ",") << options.profiles[index].name;
+    }
+}
+
+bool assign_server_endpoint(std::string_view value, LaunchOptions &options) {
+    return parse_host_and_port(value, options.server_host, options.server_port);
+}
+
+bool assign_coordinator_endpoint(std::string_view value, LaunchOptions &options) {
+    return parse_host_and_port(value, options.coordinator_host, options.coordinator_port);
+}
+
+using Spec = LaunchOptionSpec;
+using Options = LaunchOptions;
+
+constexpr std::array kLaunchOptions{
+    Spec{.flag = "--help", .short_flag = "-h", .help = "Show this help message.", .command = LaunchCommand::Help},
+    Spec{.flag = "--server",
+         .metavar = "HOST[:PORT]",
+         .help = "Set preferred server host and optional port.",
+         .label = "server endpoint",
+         .apply = &assign_server_endpoint},
+    Spec{.key = "server_host",
+         .summary_key = "server_host",
+         .flag = "--server-host",
+         .metavar = "HOST",
+         .help = "Set preferred server host.",
+         .apply = &assign<&Options::server_host>,
+         .format = &print<&Options::server_host>},
+    Spec{.key = "server_port",
+         .summary_key = "server_port",
+         .flag = "--server-port",
+         .metavar = "PORT",
+         .help = "Set preferred server port.",
+         .label = "server port",
+         .apply = &assign<&Options::server_port>,
+         .format = &print<&Options::server_port>},
+    Spec{.key = "player_name",
+         .summary_key = "player_name",
+         .flag = "--player",
+         .flag_alias = "--player-name",
+         .metavar = "NAME",
+         .help = "Set player display name.",
+         .apply = &assign<&Options::player_name>,
+         .format = &print<&Options::player_name>},
+    Spec{.key = "headless",
+         .summary_key = "headless",
+         .flag = "--headless",
+         .short_flag = "-D",
+         .off_flag = "--no-headless",
+         .help = "Enable headless (dedicated) mode.",
+         .off_help = "Disable headless mode.",
+         .label = "headless",
+         .apply = &assign<&Options::headless>,
+         .format = &print<&Options::headless>},
+    Spec{.flag = "--coordinator",
+         .metavar = "HOST[:PORT]",
+         .help = "Set coordinator endpoint.",
+         .label = "coordinator endpoint",
+         .apply = &assign_coordinator_endpoint},
+    Spec{.key = "coordinator_host",
+         .summary_key = "coordinator_host",
+         .flag = "--coordinator-host",
+         .metavar = "HOST",
+         .help = "Set coordinator host.",
+         .apply = &assign<&Options::coordinator_host>,
+         .format = &print<&Options::coordinator_host>},
+    Spec{.key = "coordinator_port",
+         .summary_key = "coordinator_port",
+         .flag = "--coordinator-port",
+         .metavar = "PORT",
+         .help = "Set coordinator port.",
+         .label = "coordinator port",
+         .apply = &assign<&Options::coordinator_port>,
+         .format = &print<&Options::coordinator_port>},
+    Spec{.key = "server_game_type",
+         .key_alias = "game_type",
+         .summary_key = "server_game_type",
+         .flag = "--game-type",
+         .metavar = "TYPE",
+         .help = "Set server game type (public, friends, invite).",
+         .label = "game type",
+         .apply = &assign<&Options::server_game_type>,
+         .format = &print<&Options::server_game_type>},
+    Spec{.key = "invite_code",
+         .summary_key = "invite_code",
+         .flag = "--invite-code",
+         .metavar = "CODE",
+         .help = "Set coordinator invite code.",
+         .apply = &assign<&Options::invite_code>,
+         .format = &print<&Options::invite_code>},
+    Spec{.key = "listed_publicly",
+         .summary_key = "listed_publicly",
+         .flag = "--public",
+         .off_flag = "--private",
+         .help = "Allow public listing.",
+         .off_help = "Disable public listing.",
+         .label = "listed_publicly",
+         .apply = &assign<&Options::listed_publicly>,
+         .format = &print<&Options::listed_publicly>},
+    Spec{.key = "allow_direct",
+         .summary_key = "allow_direct",
+         .flag = "--allow-direct",
+         .off_flag = "--no-direct",
+         .help = "Enable direct UDP connectivity.",
+         .off_help = "Disable direct UDP connectivity.",
+         .label = "allow_direct",
+         .apply = &assign<&Options::allow_direct>,
+         .format = &print<&Options::allow_direct>},
+    Spec{.key = "allow_stun",
+         .summary_key = "allow_stun",
+         .flag = "--allow-stun",
+         .off_flag = "--no-stun",
+         .help = "Enable STUN assistance.",
+         .off_help = "Disable STUN assistance.",
+         .label = "allow_stun",
+         .apply = &assign<&Options::allow_stun>,
+         .format = &print<&Options::allow_stun>},
+    Spec{.key = "allow_turn",
+         .summary_key = "allow_turn",
+         .flag = "--allow-turn",
+         .off_flag = "--no-turn",
+         .help = "Enable TURN relaying.",
+         .off_help = "Disable TURN relaying.",
+         .label = "allow_turn",
+         .apply = &assign<&Options::allow_turn>,
+         .format = &print<&Options::allow_turn>},
+    Spec{.key = "heartbeat_interval",
+         .summary_key = "heartbeat_interval",
+         .flag = "--heartbeat",
+         .metavar = "SECONDS",
+         .help = "Set coordinator heartbeat interval.",
+         .label = "heartbeat interval",
+         .apply = &assign<&Options::heartbeat_interval>,
+         .format = &print<&Options::heartbeat_interval>},
+    Spec{.key = "advertised_grfs",
+         .summary_key = "advertised_grfs",
+         .flag = "--advertised-grf",
+         .off_flag = "--clear-advertised-grfs",
+         .metavar = "ID",
+         .off_value = "",
+         .help = "Add an advertised NewGRF identifier.",
+         .off_help = "Remove previously advertised NewGRFs.",
+         .apply = &assign_advertised_grfs,
+         .apply_flag = &append_advertised_grf,
+         .format = &print<&Options::advertised_grfs>},
+    Spec{.key = "register_with_coordinator",
+         .summary_key = "register_with_coordinator",
+         .flag = "--register",
+         .help = "Register with the coordinator and send heartbeats until interrupted.",
+         .label = "register_with_coordinator",
+         .apply = &assign<&Options::register_with_coordinator>,
+         .format = &print<&Options::register_with_coordinator>},
+    Spec{.key = "list_servers",
+         .summary_key = "list_servers",
+         .flag = "--list-servers",
+         .help = "Fetch and print the coordinator's public server listing.",
+         .label = "list_servers",
+         .apply = &assign<&Options::list_servers>,
+         .format = &print<&Options::list_servers>},
+    Spec{.key = "probe_latency",
+         .summary_key = "probe_latency",
+         .flag = "--ping",
+         .help = "Measure UDP round-trip times to the listed servers\n(with --list-servers) or to --server.",
+         .label = "probe_latency",
+         .apply = &assign<&Options::probe_latency>,
+         .format = &print<&Options::probe_latency>},
+    Spec{.key = "discover_lan",
+         .summary_key = "discover_lan",
+         .flag = "--discover-lan",
+         .help = "Probe the LAN for servers and print the ones that answer.",
+         .label = "discover_lan",
+         .apply = &assign<&Options::discover_lan>,
+         .format = &print<&Options::discover_lan>},
+    Spec{.key = "lan_target",
+         .summary_key = "lan_targets",
+         .flag = "--lan-target",
+         .metavar = "TARGET",
+         .help = "Address probed by --discover-lan (repeatable): HOST[:PORT],\n"
+                 "a broadcast address, or an IPv4 subnet A.B.C.D/N.\n"
+                 "Defaults to 255.255.255.255.",
+         .repeatable = true,
+         .apply = &append<&Options::lan_targets>,
+         .format = &print<&Options::lan_targets>},
+    Spec{.key = "hosted_server",
+         .summary_key = "hosted_servers",
+         .flag = "--hosted-server",
+         .metavar = "SPEC",
+         .help = "Register an additional server (repeatable). SPEC is\n"
+                 "PORT[,name=N][,invite_code=C][,game_type=T][,heartbeat=S]\n"
+                 "[,direct=B][,stun=B][,turn=B]; unset fields inherit the\n"
+                 "top-level options.",
+         .repeatable = true,
+         .apply = &append_hosted_server,
+         .format = &print_hosted_servers},
+    Spec{.key = "session_cache",
+         .summary_key = "session_cache",
+         .flag = "--session-cache",
+         .metavar = "FILE",
+         .help = "Remember coordinator sessions in FILE and resume them on\nthe next --register.",
+         .apply = &assign<&Options::session_cache_path>,
+         .format = &print<&Options::session_cache_path>},
+    Spec{.key = "watch_config",
+         .summary_key = "watch_config",
+         .flag = "--watch-config",
+         .help = "While registered, re-read the --config files when they\n"
+                 "change and update only the servers that changed.",
+         .label = "watch_config",
+         .apply = &assign<&Options::watch_config>,
+         .format = &print<&Options::watch_config>},
+    Spec{.flag = "--config",
+         .metavar = "FILE",
+         .help = "Load options from a configuration file.",
+         .command = LaunchCommand::Config},
+    Spec{.flag = "--profile",
+         .metavar = "NAME",
+         .help = "Also apply section [NAME] of the --config files that follow.",
+         .command = LaunchCommand::Profile},
+    Spec{.summary_key = "profiles",
+         .flag = "--all-profiles",
+         .help = "Register every [NAME] section of the --config files that\n"
+                 "follow as its own server, with later options applied to\n"
+                 "each. Overrides --profile.",
+         .command = LaunchCommand::AllProfiles,
+         .format = &print_profile_names},
+    Spec{.flag = "--dump-launch-options",
+         .help = "Emit key=value launch configuration and exit.",
+         .command = LaunchCommand::DumpLaunchOptions},
+    Spec{.flag = "--dump-registration",
+         .help = "Emit coordinator registration payload summary and exit.",
+         .command = LaunchCommand::DumpRegistration},
+    Spec{.flag = "--batch",
+         .help = "Answer requests read from stdin, one per line, with the\n"
+                 "output of both dumps above; see README.",
+         .command = LaunchCommand::Batch},
+    Spec{.flag = "--batch-workers",
+         .metavar = "N",
+         .help = "Threads answering --batch requests (default: one per CPU).",
+         .command = LaunchCommand::BatchWorkers},
+};
+
+// Every spelling of a key or flag, with the option it belongs to.
+struct OptionName {
+    std::string_view name{};
+    std::uint8_t option{0};
+    bool off{false};
+};
+
+static_assert(kLaunchOptions.size() <= 0xFF);
+
+template <typename Visit>
+constexpr void for_each_config_name(Visit &&visit) {
+    for (std::size_t index = 0; index < kLaunchOptions.size(); ++index) {
+        const auto &spec = kLaunchOptions[index];
+        for (const auto name : {spec.key, spec.key_alias}) {
+            if (!name.empty()) {
+                visit(OptionName{name, static_cast<std::uint8_t>(index), false});
+            }
+        }
+    }
+}
+
+template <typename Visit>
+constexpr void for_each_flag_name(Visit &&visit) {
+    for (std::size_t index = 0; index < kLaunchOptions.size(); ++index) {
+        const auto &spec = kLaunchOptions[index];
+        for (const auto name : {spec.flag, spec.short_flag, spec.flag_alias}) {
+            if (!name.empty()) {
+                visit(OptionName{name, static_cast<std::uint8_t>(index), false});
+            }
+        }
+        if (!spec.off_flag.empty()) {
+            visit(OptionName{spec.off_flag, static_cast<std::uint8_t>(index), true});
+        }
+    }
+}
+
+template <std::size_t Count, typename ForEach>
+consteval std::array<OptionName, Count> collect_names(ForEach for_each) {
+    std::array<OptionName, Count> names{};
+    std::size_t next = 0;
+    for_each([&](OptionName name) { names[next++] = name; });
+    return names;
+}
+
+template <std::size_t Count>
+consteval std::array<std::string_view, Count> name_strings(const std::array<OptionName, Count> &names) {
+    std::array<std::string_view, Count> strings{};
+    for (std::size_t index = 0; index < Count; ++index) {
+        strings[index] = names[index].name;
+    }
+    return strings;
+}
+
+constexpr std::size_t kConfigNameCount = [] {
+    std::size_t count = 0;
+    for_each_config_name([&](OptionName) { ++count; });
+    return count;
+}();
+constexpr std::size_t kFlagNameCount = [] {
+    std::size_t count = 0;
+    for_each_flag_name([&](OptionName) { ++count; });
+    return count;
+}();
+
+constexpr auto kConfigNames =
+    collect_names<kConfigNameCount>([](auto &&visit) { for_each_config_name(visit); });
+constexpr auto kFlagNames = collect_names<kFlagNameCount>([](auto &&visit) { for_each_flag_name(visit); });
+constexpr PerfectHash<kConfigNameCount> kConfigIndex{name_strings(kConfigNames)};
+constexpr PerfectHash<kFlagNameCount> kFlagIndex{name_strings(kFlagNames)};
+
+} // namespace
+
+std::span<const LaunchOptionSpec> launch_option_specs() noexcept {
+    return kLaunchOptions;
+}
+
+std::optional<LaunchFlag> find_launch_flag(std::string_view flag) noexcept {
+    const auto found = kFlagIndex.find(flag);
+    if (!found) {
+        return std::nullopt;
+    }
+    const auto &name = kFlagNames[*found];
+    return LaunchFlag{&kLaunchOptions[name.option], name.off};
+}
+
+const LaunchOptionSpec *find_config_key(std::string_view key) noexcept {
+    const auto found = kConfigIndex.find(key);
+    return found ? &kLaunchOptions[kConfigNames[*found].option] : nullptr;
+}
+
+bool is_known_config_key(std::string_view key) {
+    return kConfigIndex.find(key).has_value();
+}
+
+ConfigKeyApplyResult apply_config_key(std::string_view key, std::string_view value, LaunchOptions &options) {
+    const auto *spec = find_config_key(key);
+    if (spec == nullptr) {
+        return ConfigKeyApplyResult::Unknown;
+    }
+    if (!spec->apply(value, options)) {
+        if (!spec->label.empty()) {
+            diagnostics() << "Invalid " << spec->key << " value: " << value << '\n';
+        }
+        return ConfigKeyApplyResult::InvalidValue;
+    }
+    return ConfigKeyApplyResult::Applied;
+}
+
+bool apply_launch_flag(const LaunchFlag &flag, std::string_view value, LaunchOptions &options) {
+    const auto &spec = *flag.spec;
+    const auto apply = !flag.off && spec.apply_flag != nullptr ? spec.apply_flag : spec.apply;
+    if (!apply(value, options)) {
+        if (!spec.label.empty()) {
+            diagnostics() << "Invalid " << spec.label << ": " << value << '\n';
+        }
+        return false;
+    }
+    return true;
+}
+
+LaunchFlagApplier::LaunchFlagApplier(LaunchOptions &options) noexcept : options_(options) {}
+
+bool LaunchFlagApplier::apply(const LaunchFlag &flag, std::string_view value) {
+    const auto &spec = *flag.spec;
+    if (spec.apply_flag == &append_advertised_grf && !flag.off) {
+        if (!collecting_grfs_) {
+            grfs_.assign(options_.advertised_grfs.begin(), options_.advertised_grfs.end());
+            collecting_grfs_ = true;
+        }
+        if (!value.empty()) {
+            grfs_.emplace_back(value);
+        }
+        return true;
+    }
+    if (spec.apply == &assign_advertised_grfs) {
+        finish();
+    }
+    return apply_launch_flag(flag, value, options_);
+}
+
+void LaunchFlagApplier::finish() {
+    if (!collecting_grfs_) {
+        return;
+    }
+    options_.advertised_grfs = network::GrfList::interned(std::move(grfs_));
+    grfs_.clear();
+    collecting_grfs_ = false;
+}
+
+ConfigDiagnosticsScope::ConfigDiagnosticsScope(std::ostream &out) noexcept : previous_(t_diagnostics) {
+    t_diagnostics = &out;
+}
+
+ConfigDiagnosticsScope::~ConfigDiagnosticsScope() {
+    t_diagnostics = previous_;
+}
+
+namespace {
+
+// Walks the text once, tokenizing each line in place. Calls
+// on_section(name, line_number) for a [name] header and
+// on_key(key, value, line_number) for a key = value line; both receive views
+// into text. Blank lines and # or ; comments are skipped and malformed lines
+// reported.
+template <typename OnSection, typename OnKey>
+void scan_config(std::string_view text, const std::string &path, OnSection &&on_section, OnKey &&on_key) {
+    std::size_t line_number = 0;
+    while (!text.empty()) {
+        const auto newline = text.find('\n');
+        const auto line = trim(text.substr(0, newline));
+        text = newline == std::string_view::npos ? std::string_view{} : text.substr(newline + 1);
+        ++line_number;
+        if (line.empty() || line.front() == '#' || line.front() == ';') {
+            continue;
+        }
+        if (line.front() == '[') {
+            const auto name = line.back() == ']' ? trim(line.substr(1, line.size() - 2)) : std::string_view{};
+            if (name.empty()) {
+                diagnostics() << "Ignoring malformed config line " << line_number << " in " << path << '\n';
+                continue;
+            }
+            on_section(name, line_number);
+            continue;
+        }
+        const auto equals = line.find('=');
+        if (equals == std::string_view::npos) {
+            diagnostics() << "Ignoring malformed config line " << line_number << " in " << path << '\n';
+            continue;
+        }
+        on_key(trim(line.substr(0, equals)), trim(line.substr(equals + 1)), line_number);
+    }
+}
+
+// Applies one key to one set of options, rejecting a second occurrence of a
+// key within the same section. Returns false if the line was rejected.
+class SectionApplier {
+public:
+    bool apply(std::string_view key, std::string_view value, std::size_t line_number, LaunchOptions &options) {
+        const auto index = kConfigIndex.find(key);
+        if (index && !kLaunchOptions[kConfigNames[*index].option].repeatable) {
+            if (seen_[*index]) {
+                diagnostics() << "Duplicate configuration key '" << key << "' at line " << line_number << '\n';
+                return false;
+            }
+            seen_[*index] = true;
+        }
+
+        switch (apply_config_key(key, value, options)) {
+        case ConfigKeyApplyResult::Applied:
+            return true;
+        case ConfigKeyApplyResult::InvalidValue:
+            return false;
+        case ConfigKeyApplyResult::Unknown:
+            if (!key.empty()) {
+                diagnostics() << "Unknown configuration key '" << key << "' at line " << line_number << '\n';
+                return false;
+            }
+            return true;
+        }
+        return true;
+    }
+
+private:
+    std::array<bool, kConfigNameCount> seen_{};
+};
+
+[[nodiscard]] std::optional<MappedFile> map_config_file(const std::string &path) {
+    try {
+        return std::optional<MappedFile>{std::in_place, path};
+    } catch (const std::system_error &) {
+        diagnostics() << "Failed to open configuration file: " << path << '\n';
+        return std::nullopt;
+    }
+}
+
+} // namespace
+
+bool load_config_file(const std::string &path, LaunchOptions &options, std::string_view profile) {
+    const auto file = map_config_file(path);
+    return file && load_config_text(file->text(), path, options, profile);
+}
+
+bool load_config_text(std::string_view text, const std::string &name, LaunchOptions &options,
+                      std::string_view profile) {
+    bool success = true;
+    bool found_profile = false;
+    // Keys apply while in the top-level section or the selected profile.
+    bool applying = true;
+    SectionApplier top_level;
+    SectionApplier selected;
+    scan_config(
+        text, name,
+        [&](std::string_view section, std::size_t line_number) {
+            applying = !profile.empty() && section == profile;
+            if (applying && found_profile) {
+                diagnostics() << "Duplicate configuration profile '" << section << "' at line " << line_number
+                              << '\n';
+                success = false;
+                applying = false;
+                return;
+            }
+            found_profile = found_profile || applying;
+        },
+        [&](std::string_view key, std::string_view value, std::size_t line_number) {
+            if (!applying) {
+                return;
+            }
+            auto &applier = found_profile ? selected : top_level;
+            success = applier.apply(key, value, line_number, options) && success;
+        });
+
+    if (!profile.empty() && !found_profile) {
+        diagnostics() << "Configuration profile '" << profile << "' not found in " << name << '\n';
+        return false;
+    }
+    return success;
+}
+
+bool load_config_profiles(const std::string &path, LaunchOptions &base, std::vector<ConfigProfile> &profiles) {
+    const auto file = map_config_file(path);
+    if (!file) {
+        return false;
+    }
+
+    bool success = true;
+    // Top-level keys all precede the first header, so base is complete by
+    // the time a profile copies it.
+    LaunchOptions *target = &base;
+    SectionApplier applier;
+    std::unordered_set<std::string_view> names;
+    scan_config(
+        file->text(), path,
+        [&](std::string_view name, std::size_t line_number) {
+            applier = SectionApplier{};
+            if (!names.insert(name).second) {
+                diagnostics() << "Duplicate configuration profile '" << name << "' at line " << line_number << '\n';
+                success = false;
+                target = nullptr;
+                return;
+            }
+            profiles.push_back(ConfigProfile{std::string{name}, base});
+            target = &profiles.back().options;
+        },
+        [&](std::string_view key, std::string_view value, std::size_t line_number) {
+            if (target != nullptr) {
+                success = applier.apply(key, value, line_number, *target) && success;
+            }
+        });
+    return success;
+}
+
+} // namespace sotc
@@ -0,0 +1,90 @@
+#include "launch_summary.hpp"
+
+#include "launch_config.hpp"
+#include "network/coordinator_client.hpp"
+#include "network/session_cache.hpp"
+
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+namespace sotc {
+
+void write_launch_summary(const LaunchOptions &options, std::ostream &out) {
+    for (const auto &spec : launch_option_specs()) {
+        if (spec.format != nullptr) {
+            out << spec.summary_key << '=';
+            spec.format(options, out);
+            out << '\n';
+        }
+    }
+}
+
+void write_registration_summary(const LaunchOptions &options, std::ostream &out) {
+    network::RegistrationConfig config{};
+
+    config.server_name = options.player_name.empty() ? std::string{"Simple OpenTTD Client"}
+                                                     : options.player_name + "'s game";
+    config.coordinator_host = options.coordinator_host.empty() ? std::string{"coordinator.openttd.org"}
+                                                              : options.coordinator_host;
+    config.coordinator_port = options.coordinator_port == 0
+                                  ? network::NETWORK_COORDINATOR_SERVER_PORT
+                                  : options.coordinator_port;
+    config.listen_port = options.server_port;
+    config.listed_publicly = options.listed_publicly && !options.headless;
+    config.server_game_type = options.server_game_type;
+    config.invite_code = options.invite_code;
+    config.allow_direct = options.allow_direct;
+    config.allow_stun = options.allow_stun;
+    config.allow_turn = options.allow_turn;
+    config.heartbeat_interval = options.heartbeat_interval;
+    config.advertised_grfs = options.advertised_grfs;
+
+    const network::CachedRegistrationFrame cached_frame{config};
+    const auto &frame = cached_frame.frame();
+    const auto payload = cached_frame.payload();
+
+    out << "coordinator_version=" << static_cast<int>(frame.coordinator_version) << '\n';
+    out << "game_info_version=" << static_cast<int>(frame.game_info_version) << '\n';
+    out << "admin_version=" << static_cast<int>(frame.admin_version) << '\n';
+    out << "listen_port=" << frame.listen_port << '\n';
+    out << "heartbeat_seconds=" << frame.heartbeat_seconds << '\n';
+    out << "server_game_type=" << static_cast<int>(frame.server_game_type) << '\n';
+    out << "nat_capabilities=" << static_cast<int>(frame.nat_capabilities) << '\n';
+    out << "public_listing=" << (frame.public_listing ? "true" : "false") << '\n';
+    out << "server_name=" << frame.server_name << '\n';
+    out << "invite_code=" << frame.invite_code << '\n';
+    out << "newgrfs=";
+    for (std::size_t i = 0; i < frame.newgrfs.size(); ++i) {
+        if (i != 0) {
+            out << ',';
+        }
+        out << frame.newgrfs[i];
+    }
+    out << '\n';
+
+    std::ostringstream payload_stream;
+    payload_stream << std::hex << std::setfill('0');
+    for (const auto byte : payload) {
+        payload_stream << std::setw(2) << static_cast<int>(std::to_integer<unsigned int>(byte));
+    }
+    out << "payload_hex=" << payload_stream.str() << '\n';
+
+    if (!options.session_cache_path.empty()) {
+        network::SessionCache cache{options.session_cache_path};
+        static_cast<void>(cache.load());
+        const auto identity = network::session_identity(config);
+        const auto *cached = cache.find(identity);
+        out << "session_identity=" << identity << '\n';
+        out << "session_cache_hit=" << (cached != nullptr ? "true" : "false") << '\n';
+        if (cached != nullptr) {
+            out << "resume_invite_code=" << cached->invite_code << '\n';
+            out << "resume_coordinator=" << cached->coordinator_endpoint << '\n';
+            out << "resume_saved_at=" << cached->saved_at << '\n';
+        }
+    }
+}
+
+} // namespace sotc
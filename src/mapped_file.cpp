@@ -0,0 +1,103 @@
+#include "mapped_file.hpp"
+
+#include <cerrno>
+#include <system_error>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sotc {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile(const std::string &path) {
+    std::ifstream input{path, std::ios::binary};
+    if (!input) {
+        throw std::system_error{std::make_error_code(std::errc::no_such_file_or_directory), "Unable to open " + path};
+    }
+    buffer_.assign(std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{});
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() = default;
+
+#else
+
+MappedFile::MappedFile(const std::string &path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error{errno, std::generic_category(), "Unable to open " + path};
+    }
+    struct stat status {};
+    if (::fstat(fd, &status) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error{error, std::generic_category(), "Unable to stat " + path};
+    }
+    if (S_ISFIFO(status.st_mode) || S_ISCHR(status.st_mode)) {
+        // Pipes such as --config <(...) or /dev/stdin cannot be mapped; read
+        // them into memory like the _WIN32 path does.
+        read_stream(fd, path);
+        return;
+    }
+    if (!S_ISREG(status.st_mode)) {
+        ::close(fd);
+        throw std::system_error{std::make_error_code(std::errc::invalid_argument), path + " is not a regular file"};
+    }
+    size_ = static_cast<std::size_t>(status.st_size);
+    // mmap rejects a zero length; an empty file is simply an empty view.
+    if (size_ != 0) {
+        void *mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error{error, std::generic_category(), "Unable to map " + path};
+        }
+        // The file is read front to back exactly once.
+        ::madvise(mapping, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(mapping);
+        mapped_ = true;
+    }
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+}
+
+void MappedFile::read_stream(int fd, const std::string &path) {
+    char chunk[65536];
+    while (true) {
+        const auto received = ::read(fd, chunk, sizeof(chunk));
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error{error, std::generic_category(), "Unable to read " + path};
+        }
+        if (received == 0) {
+            break;
+        }
+        buffer_.append(chunk, static_cast<std::size_t>(received));
+    }
+    ::close(fd);
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+}
+
+MappedFile::~MappedFile() {
+    if (mapped_) {
+        ::munmap(const_cast<char *>(data_), size_);
+    }
+}
+
+#endif
+
+} // namespace sotc
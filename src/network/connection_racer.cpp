@@ -0,0 +1,291 @@
+#include "network/connection_racer.hpp"
+
+#include "network/packet_framer.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <sys/socket.h>
+
+namespace sotc::network {
+
+std::string_view to_string(RaceState state) noexcept {
+    switch (state) {
+    case RaceState::Idle:
+        return "idle";
+    case RaceState::Racing:
+        return "racing";
+    case RaceState::Connected:
+        return "connected";
+    case RaceState::Failed:
+        return "failed";
+    }
+    return "unknown";
+}
+
+std::string_view to_string(PathOutcome outcome) noexcept {
+    switch (outcome) {
+    case PathOutcome::NotStarted:
+        return "not started";
+    case PathOutcome::Pending:
+        return "pending";
+    case PathOutcome::Won:
+        return "won";
+    case PathOutcome::Failed:
+        return "failed";
+    case PathOutcome::Cancelled:
+        return "cancelled";
+    }
+    return "unknown";
+}
+
+std::vector<NatCapability> allowed_paths(const RegistrationConfig &config) {
+    std::vector<NatCapability> paths;
+    if (config.allow_direct) {
+        paths.push_back(NatCapability::Direct);
+    }
+    if (config.allow_stun) {
+        paths.push_back(NatCapability::Stun);
+    }
+    if (config.allow_turn) {
+        paths.push_back(NatCapability::Turn);
+    }
+    return paths;
+}
+
+ConnectionRacer::ConnectionRacer(EventLoop &loop, ConnectionRaceOptions options)
+    : loop_(loop), options_(std::move(options)) {}
+
+ConnectionRacer::~ConnectionRacer() { cancel(); }
+
+void ConnectionRacer::start(std::vector<ConnectionPath> paths) {
+    cancel();
+    running_.clear();
+    attempts_.clear();
+    for (auto &path : paths) {
+        attempts_.push_back(PathAttempt{path.kind, path.endpoint});
+        running_.push_back(Attempt{std::move(path)});
+    }
+    next_ = 0;
+    winner_.reset();
+    reply_.clear();
+    last_error_.clear();
+    started_at_ = EventLoop::Clock::now();
+
+    if (running_.empty()) {
+        last_error_ = "No connection path is allowed";
+        finish(RaceState::Failed);
+        return;
+    }
+
+    state_ = RaceState::Racing;
+    race_timer_ = loop_.schedule_after(options_.timeout, [this] {
+        race_timer_ = 0;
+        for (std::size_t index = 0; index < running_.size(); ++index) {
+            if (attempts_[index].outcome == PathOutcome::Pending) {
+                attempts_[index].error = "Timed out";
+                close_attempt(index, PathOutcome::Failed);
+            }
+        }
+        last_error_ = "Timed out before any connection path finished its handshake";
+        finish(RaceState::Failed);
+    });
+    start_next();
+}
+
+void ConnectionRacer::cancel() noexcept {
+    cancel_timers();
+    for (std::size_t index = 0; index < running_.size(); ++index) {
+        if (attempts_[index].outcome == PathOutcome::Pending) {
+            close_attempt(index, PathOutcome::Cancelled);
+        }
+    }
+    winner_socket_.reset();
+    if (state_ == RaceState::Racing) {
+        state_ = RaceState::Idle;
+    }
+}
+
+std::optional<NatCapability> ConnectionRacer::winning_path() const noexcept {
+    if (!winner_) {
+        return std::nullopt;
+    }
+    return attempts_[*winner_].kind;
+}
+
+SocketHandle ConnectionRacer::take_socket() noexcept { return std::move(winner_socket_); }
+
+void ConnectionRacer::start_next() {
+    if (state_ != RaceState::Racing || next_ >= running_.size()) {
+        return;
+    }
+    const auto index = next_++;
+    auto &attempt = running_[index];
+    attempt.started_at = EventLoop::Clock::now();
+    attempts_[index].outcome = PathOutcome::Pending;
+    attempts_[index].started_after = attempt.started_at - started_at_;
+
+    bool in_progress = false;
+    attempt.socket = connect_nonblocking(attempt.path.endpoint, in_progress);
+    if (!attempt.socket) {
+        fail_attempt(index, std::string{"Unable to connect to "} + attempt.path.endpoint.to_string() + ": " +
+                                std::strerror(errno));
+        return;
+    }
+    loop_.add(attempt.socket.get(), EventLoop::kReadable | EventLoop::kWritable,
+              [this, index](std::uint32_t events) { on_io(index, events); });
+    schedule_next();
+    if (!in_progress) {
+        on_connected(index);
+    }
+}
+
+void ConnectionRacer::schedule_next() {
+    if (stagger_timer_ != 0) {
+        loop_.cancel(stagger_timer_);
+        stagger_timer_ = 0;
+    }
+    if (next_ < running_.size()) {
+        stagger_timer_ = loop_.schedule_after(options_.stagger, [this] {
+            stagger_timer_ = 0;
+            start_next();
+        });
+    }
+}
+
+void ConnectionRacer::on_io(std::size_t index, std::uint32_t events) {
+    auto &attempt = running_[index];
+    if (!attempt.connected) {
+        if ((events & (EventLoop::kWritable | EventLoop::kError | EventLoop::kHangup)) == 0) {
+            return;
+        }
+        if (const int error = socket_error(attempt.socket.get()); error != 0) {
+            fail_attempt(index, std::string{"Connection failed: "} + std::strerror(error));
+            return;
+        }
+        on_connected(index);
+        return;
+    }
+    if (events & EventLoop::kReadable) {
+        on_readable(index);
+    } else if (events & (EventLoop::kError | EventLoop::kHangup)) {
+        fail_attempt(index, std::string{"Connection error: "} + std::strerror(socket_error(attempt.socket.get())));
+    }
+}
+
+void ConnectionRacer::on_connected(std::size_t index) {
+    auto &attempt = running_[index];
+    attempt.connected = true;
+    if (attempt.path.hello.empty()) {
+        win(index);
+        return;
+    }
+    // The hello is one small packet on a fresh socket; it fits the send buffer.
+    const auto sent = ::send(attempt.socket.get(), attempt.path.hello.data(), attempt.path.hello.size(), MSG_NOSIGNAL);
+    if (sent < 0 || static_cast<std::size_t>(sent) != attempt.path.hello.size()) {
+        fail_attempt(index, std::string{"Unable to send handshake: "} + std::strerror(sent < 0 ? errno : EAGAIN));
+        return;
+    }
+    loop_.modify(attempt.socket.get(), EventLoop::kReadable);
+}
+
+void ConnectionRacer::on_readable(std::size_t index) {
+    auto &attempt = running_[index];
+    std::array<std::byte, 4096> chunk{};
+    for (;;) {
+        const auto received = ::recv(attempt.socket.get(), chunk.data(), chunk.size(), 0);
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            fail_attempt(index, std::string{"Handshake read failed: "} + std::strerror(errno));
+            return;
+        }
+        if (received == 0) {
+            fail_attempt(index, "Connection closed before the handshake finished");
+            return;
+        }
+        attempt.received.insert(attempt.received.end(), chunk.begin(), chunk.begin() + received);
+        if (attempt.received.size() < NETWORK_PACKET_HEADER_SIZE) {
+            continue;
+        }
+        const auto total = (std::to_integer<std::size_t>(attempt.received[0]) << 8U) |
+                           std::to_integer<std::size_t>(attempt.received[1]);
+        if (total < NETWORK_PACKET_HEADER_SIZE) {
+            fail_attempt(index, "Malformed handshake reply");
+            return;
+        }
+        if (attempt.received.size() >= total) {
+            reply_.assign(attempt.received.begin(), attempt.received.begin() + static_cast<std::ptrdiff_t>(total));
+            win(index);
+            return;
+        }
+    }
+}
+
+void ConnectionRacer::fail_attempt(std::size_t index, std::string error) {
+    attempts_[index].error = std::move(error);
+    close_attempt(index, PathOutcome::Failed);
+    if (next_ < running_.size()) {
+        start_next();
+        return;
+    }
+    for (const auto &attempt : attempts_) {
+        if (attempt.outcome == PathOutcome::Pending) {
+            return;
+        }
+    }
+    last_error_ = "Every connection path failed";
+    finish(RaceState::Failed);
+}
+
+void ConnectionRacer::win(std::size_t index) {
+    auto &attempt = running_[index];
+    loop_.remove(attempt.socket.get());
+    winner_socket_ = std::move(attempt.socket);
+    winner_ = index;
+    attempts_[index].outcome = PathOutcome::Won;
+    attempts_[index].elapsed = EventLoop::Clock::now() - attempt.started_at;
+    finish(RaceState::Connected);
+}
+
+void ConnectionRacer::finish(RaceState state) {
+    cancel_timers();
+    for (std::size_t index = 0; index < running_.size(); ++index) {
+        if (attempts_[index].outcome == PathOutcome::Pending) {
+            close_attempt(index, PathOutcome::Cancelled);
+        }
+    }
+    state_ = state;
+    if (completion_callback_) {
+        completion_callback_(state_);
+    }
+}
+
+void ConnectionRacer::close_attempt(std::size_t index, PathOutcome outcome) noexcept {
+    auto &attempt = running_[index];
+    if (attempt.socket) {
+        loop_.remove(attempt.socket.get());
+        attempt.socket.reset();
+    }
+    attempts_[index].outcome = outcome;
+    attempts_[index].elapsed = EventLoop::Clock::now() - attempt.started_at;
+}
+
+void ConnectionRacer::cancel_timers() noexcept {
+    if (stagger_timer_ != 0) {
+        loop_.cancel(stagger_timer_);
+        stagger_timer_ = 0;
+    }
+    if (race_timer_ != 0) {
+        loop_.cancel(race_timer_);
+        race_timer_ = 0;
+    }
+}
+
+} // namespace sotc::network
@@ -0,0 +1,448 @@
+#include "network/content_downloader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <curl/curl.h>
+#include <unistd.h>
+
+namespace sotc::network {
+
+namespace {
+
+// curl_global_init() is not thread-safe; do it once, before any handle.
+void ensure_curl_initialised() {
+    static const bool initialised = curl_global_init(CURL_GLOBAL_DEFAULT) == CURLE_OK;
+    if (!initialised) {
+        throw std::runtime_error{"curl_global_init failed"};
+    }
+}
+
+[[nodiscard]] std::string digest_key(const NewGrfIdentity &identity) {
+    return to_hex(identity.md5);
+}
+
+// Hashes the bytes already on disk so a resumed transfer can keep hashing
+// where they end. Returns false when the file cannot be read.
+[[nodiscard]] bool hash_file(std::FILE *file, Md5 &hash) {
+    std::array<std::byte, 64 * 1024> buffer{};
+    std::rewind(file);
+    while (true) {
+        const auto read = std::fread(buffer.data(), 1, buffer.size(), file);
+        hash.update(std::span{buffer.data(), read});
+        if (read < buffer.size()) {
+            return std::ferror(file) == 0;
+        }
+    }
+}
+
+} // namespace
+
+// Transfer::curl_error is sized for this.
+static_assert(CURL_ERROR_SIZE <= 256);
+
+ContentDownloader::Transfer::~Transfer() {
+    if (easy != nullptr) {
+        curl_easy_cleanup(easy);
+    }
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+}
+
+ContentCache::ContentCache(std::filesystem::path root) : root_(std::move(root)) {}
+
+std::filesystem::path ContentCache::path_for(const Md5Digest &digest) const {
+    const auto name = to_hex(digest);
+    return root_ / name.substr(0, 2) / name;
+}
+
+std::filesystem::path ContentCache::partial_path_for(const Md5Digest &digest) const {
+    auto path = path_for(digest);
+    path += ".part";
+    return path;
+}
+
+bool ContentCache::contains(const Md5Digest &digest) const {
+    std::error_code error;
+    return std::filesystem::is_regular_file(path_for(digest), error);
+}
+
+std::string_view to_string(ContentDownloadStatus status) noexcept {
+    switch (status) {
+    case ContentDownloadStatus::Queued:
+        return "queued";
+    case ContentDownloadStatus::Active:
+        return "active";
+    case ContentDownloadStatus::Cached:
+        return "cached";
+    case ContentDownloadStatus::Downloaded:
+        return "downloaded";
+    case ContentDownloadStatus::ChecksumMismatch:
+        return "checksum mismatch";
+    case ContentDownloadStatus::Failed:
+        return "failed";
+    }
+    return "unknown";
+}
+
+void ContentDownloader::MultiDeleter::operator()(void *multi) const noexcept {
+    curl_multi_cleanup(multi);
+}
+
+ContentDownloader::ContentDownloader(EventLoop &loop, ContentDownloadOptions options)
+    : loop_(loop), options_(std::move(options)), cache_(options_.cache_directory) {
+    options_.max_transfers = std::max<std::size_t>(options_.max_transfers, 1);
+    options_.max_attempts = std::max<std::size_t>(options_.max_attempts, 1);
+    ensure_curl_initialised();
+    multi_.reset(curl_multi_init());
+    if (!multi_) {
+        throw std::runtime_error{"curl_multi_init failed"};
+    }
+    auto *multi = multi_.get();
+    curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, &ContentDownloader::on_socket);
+    curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, &ContentDownloader::on_timer);
+    curl_multi_setopt(multi, CURLMOPT_TIMERDATA, this);
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(options_.max_connections_per_host));
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, static_cast<long>(options_.max_transfers));
+}
+
+ContentDownloader::~ContentDownloader() {
+    close();
+}
+
+void ContentDownloader::close() noexcept {
+    if (!multi_) {
+        return;
+    }
+    for (auto &[id, transfer] : transfers_) {
+        curl_multi_remove_handle(multi_.get(), transfer->easy);
+    }
+    transfers_.clear();
+    queue_.clear();
+    multi_.reset();
+    // curl reports closed sockets as it goes; drop whatever it left behind.
+    for (const auto fd : watched_) {
+        loop_.remove(fd);
+    }
+    watched_.clear();
+    loop_.cancel(timer_);
+    timer_ = 0;
+}
+
+ContentDownloader::DownloadId ContentDownloader::add(ContentRequest request) {
+    const auto id = downloads_.size();
+    downloads_.push_back(ContentDownload{std::move(request)});
+    auto &download = downloads_.back();
+
+    if (cache_.contains(download.request.identity.md5)) {
+        ++cache_hits_;
+        settle(id, ContentDownloadStatus::Cached);
+        return id;
+    }
+    const auto key = digest_key(download.request.identity);
+    if (const auto leader = pending_by_digest_.find(key); leader != pending_by_digest_.end()) {
+        followers_[leader->second].push_back(id);
+        return id;
+    }
+    pending_by_digest_.emplace(key, id);
+    queue_.push_back(id);
+    pump();
+    return id;
+}
+
+void ContentDownloader::pump() {
+    while (multi_ && !queue_.empty() && transfers_.size() < options_.max_transfers) {
+        const auto id = queue_.front();
+        queue_.pop_front();
+        start(id);
+    }
+}
+
+void ContentDownloader::start(DownloadId id) {
+    auto &download = downloads_[id];
+    ++download.attempts;
+    download.status = ContentDownloadStatus::Active;
+
+    auto transfer = std::make_unique<Transfer>();
+    transfer->owner = this;
+    transfer->id = id;
+    transfer->partial = cache_.partial_path_for(download.request.identity.md5);
+    transfer->limit = download.request.size != 0 ? download.request.size : options_.max_file_size;
+
+    std::error_code error;
+    std::filesystem::create_directories(transfer->partial.parent_path(), error);
+    if (error) {
+        settle(id, ContentDownloadStatus::Failed, "Unable to create " + transfer->partial.parent_path().string());
+        return;
+    }
+    // Append mode: every write lands at the end even after a truncate.
+    transfer->file = std::fopen(transfer->partial.c_str(), "a+b");
+    if (transfer->file == nullptr || !hash_file(transfer->file, transfer->hash)) {
+        settle(id, ContentDownloadStatus::Failed, "Unable to open " + transfer->partial.string());
+        return;
+    }
+    transfer->offset = transfer->hash.size();
+    if (transfer->offset > transfer->limit) {
+        // Leftovers of something else; start over.
+        static_cast<void>(::ftruncate(::fileno(transfer->file), 0));
+        transfer->hash.reset();
+        transfer->offset = 0;
+    }
+    download.resumed_from = transfer->offset;
+    if (download.request.size != 0 && transfer->offset == download.request.size) {
+        // Fully fetched by an earlier run that stopped before moving it.
+        complete(*transfer, CURLE_OK);
+        return;
+    }
+
+    transfer->easy = curl_easy_init();
+    if (transfer->easy == nullptr) {
+        settle(id, ContentDownloadStatus::Failed, "curl_easy_init failed");
+        return;
+    }
+    auto *easy = transfer->easy;
+    curl_easy_setopt(easy, CURLOPT_URL, download.request.url.c_str());
+    curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer.get());
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &ContentDownloader::on_write);
+    curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer.get());
+    curl_easy_setopt(easy, CURLOPT_ERRORBUFFER, transfer->curl_error.data());
+    curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(easy, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(easy, CURLOPT_MAXREDIRS, 5L);
+#if LIBCURL_VERSION_NUM >= 0x075500
+    curl_easy_setopt(easy, CURLOPT_PROTOCOLS_STR, "http,https");
+    curl_easy_setopt(easy, CURLOPT_REDIR_PROTOCOLS_STR, "http,https");
+#endif
+    curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT_MS,
+                     static_cast<long>(std::chrono::duration_cast<std::chrono::milliseconds>(options_.connect_timeout).count()));
+    curl_easy_setopt(easy, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(easy, CURLOPT_LOW_SPEED_TIME, static_cast<long>(options_.stall_timeout.count()));
+    if (transfer->offset != 0) {
+        transfer->range = std::to_string(transfer->offset) + '-';
+        curl_easy_setopt(easy, CURLOPT_RANGE, transfer->range.c_str());
+    }
+
+    if (curl_multi_add_handle(multi_.get(), easy) != CURLM_OK) {
+        settle(id, ContentDownloadStatus::Failed, "curl_multi_add_handle failed");
+        return;
+    }
+    transfers_.emplace(id, std::move(transfer));
+    peak_active_ = std::max(peak_active_, transfers_.size());
+}
+
+std::size_t ContentDownloader::on_write(char *data, std::size_t size, std::size_t count, void *user) noexcept {
+    auto &transfer = *static_cast<Transfer *>(user);
+    // Anything short of the full count makes curl abort the transfer.
+    return transfer.owner->write(transfer, data, size * count) ? size * count : 0;
+}
+
+bool ContentDownloader::write(Transfer &transfer, const char *data, std::size_t size) {
+    if (!transfer.status_checked) {
+        transfer.status_checked = true;
+        long status = 0;
+        curl_easy_getinfo(transfer.easy, CURLINFO_RESPONSE_CODE, &status);
+        if (transfer.offset != 0 && status != 206) {
+            // The server sent the whole file instead of the range.
+            if (::ftruncate(::fileno(transfer.file), 0) != 0) {
+                transfer.error = "Unable to truncate " + transfer.partial.string();
+                return false;
+            }
+            transfer.hash.reset();
+            transfer.offset = 0;
+            downloads_[transfer.id].resumed_from = 0;
+        }
+    }
+    if (size > transfer.limit - transfer.offset) {
+        transfer.error = "Content is larger than " + std::to_string(transfer.limit) + " bytes";
+        return false;
+    }
+    if (std::fwrite(data, 1, size, transfer.file) != size) {
+        transfer.error = "Unable to write " + transfer.partial.string();
+        return false;
+    }
+    transfer.hash.update(std::as_bytes(std::span{data, size}));
+    transfer.offset += size;
+    downloads_[transfer.id].bytes_received += size;
+    bytes_downloaded_ += size;
+    return true;
+}
+
+int ContentDownloader::on_socket(void *, int fd, int what, void *user, void *) noexcept {
+    try {
+        static_cast<ContentDownloader *>(user)->watch(fd, what);
+    } catch (const std::system_error &) {
+        return -1;
+    }
+    return 0;
+}
+
+void ContentDownloader::watch(int fd, int what) {
+    if (what == CURL_POLL_REMOVE) {
+        loop_.remove(fd);
+        watched_.erase(fd);
+        return;
+    }
+    std::uint32_t events = 0;
+    if (what & CURL_POLL_IN) {
+        events |= EventLoop::kReadable;
+    }
+    if (what & CURL_POLL_OUT) {
+        events |= EventLoop::kWritable;
+    }
+    if (watched_.contains(fd)) {
+        loop_.modify(fd, events);
+        return;
+    }
+    loop_.add(fd, events, [this, fd](std::uint32_t ready) { on_socket_event(fd, ready); });
+    watched_.insert(fd);
+}
+
+int ContentDownloader::on_timer(void *, long timeout_ms, void *user) noexcept {
+    auto &self = *static_cast<ContentDownloader *>(user);
+    self.loop_.cancel(self.timer_);
+    self.timer_ = 0;
+    if (timeout_ms >= 0) {
+        // curl must not be re-entered from this callback; the loop calls back
+        // into it on its next pass.
+        self.timer_ = self.loop_.schedule_after(std::chrono::milliseconds{timeout_ms}, [&self] {
+            self.timer_ = 0;
+            self.on_timeout();
+        });
+    }
+    return 0;
+}
+
+void ContentDownloader::on_socket_event(int fd, std::uint32_t events) {
+    int flags = 0;
+    if (events & (EventLoop::kReadable | EventLoop::kHangup)) {
+        flags |= CURL_CSELECT_IN;
+    }
+    if (events & EventLoop::kWritable) {
+        flags |= CURL_CSELECT_OUT;
+    }
+    if (events & EventLoop::kError) {
+        flags |= CURL_CSELECT_ERR;
+    }
+    int running = 0;
+    curl_multi_socket_action(multi_.get(), fd, flags, &running);
+    drain_completed();
+    pump();
+}
+
+void ContentDownloader::on_timeout() {
+    int running = 0;
+    curl_multi_socket_action(multi_.get(), CURL_SOCKET_TIMEOUT, 0, &running);
+    drain_completed();
+    pump();
+}
+
+void ContentDownloader::drain_completed() {
+    int remaining = 0;
+    while (multi_) {
+        auto *message = curl_multi_info_read(multi_.get(), &remaining);
+        if (message == nullptr) {
+            return;
+        }
+        if (message->msg != CURLMSG_DONE) {
+            continue;
+        }
+        Transfer *transfer = nullptr;
+        curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &transfer);
+        const auto result = message->data.result;
+        // The message is invalid once its handle is removed.
+        curl_multi_remove_handle(multi_.get(), transfer->easy);
+        const auto owned = std::move(transfers_.at(transfer->id));
+        transfers_.erase(transfer->id);
+        complete(*owned, result);
+    }
+}
+
+void ContentDownloader::complete(Transfer &transfer, int result) {
+    const auto id = transfer.id;
+    const auto &request = downloads_[id].request;
+    std::fclose(std::exchange(transfer.file, nullptr));
+    std::error_code ignored;
+
+    if (result == CURLE_OK) {
+        const auto digest = transfer.hash.finish();
+        if (digest != request.identity.md5 || (request.size != 0 && transfer.offset != request.size)) {
+            std::filesystem::remove(transfer.partial, ignored);
+            settle(id, ContentDownloadStatus::ChecksumMismatch,
+                   "Expected MD5 " + to_hex(request.identity.md5) + ", got " + to_hex(digest));
+            return;
+        }
+        const auto path = cache_.path_for(request.identity.md5);
+        std::error_code error;
+        std::filesystem::rename(transfer.partial, path, error);
+        if (error) {
+            settle(id, ContentDownloadStatus::Failed, "Unable to move download to " + path.string());
+            return;
+        }
+        downloads_[id].path = path;
+        settle(id, ContentDownloadStatus::Downloaded);
+        return;
+    }
+
+    long status = 0;
+    curl_easy_getinfo(transfer.easy, CURLINFO_RESPONSE_CODE, &status);
+    std::string error = !transfer.error.empty()          ? transfer.error
+                        : transfer.curl_error[0] != '\0' ? std::string{transfer.curl_error.data()}
+                                                         : std::string{curl_easy_strerror(static_cast<CURLcode>(result))};
+    if (!transfer.error.empty()) {
+        // Oversized or unwritable; another attempt would not do better.
+        std::filesystem::remove(transfer.partial, ignored);
+        settle(id, ContentDownloadStatus::Failed, std::move(error));
+        return;
+    }
+    if (status == 416) {
+        // The partial file does not fit the server's copy; start over.
+        std::filesystem::remove(transfer.partial, ignored);
+    }
+    // Client errors other than a bad range will not go away on retry.
+    const bool permanent = result == CURLE_HTTP_RETURNED_ERROR && status >= 400 && status < 500 && status != 416;
+    if (permanent || downloads_[id].attempts >= options_.max_attempts) {
+        settle(id, ContentDownloadStatus::Failed, std::move(error));
+        return;
+    }
+    downloads_[id].status = ContentDownloadStatus::Queued;
+    queue_.push_back(id);
+}
+
+void ContentDownloader::settle(DownloadId id, ContentDownloadStatus status, std::string error) {
+    auto &download = downloads_[id];
+    download.status = status;
+    download.error = std::move(error);
+    if (status == ContentDownloadStatus::Cached) {
+        download.path = cache_.path_for(download.request.identity.md5);
+    }
+    if (const auto pending = pending_by_digest_.find(digest_key(download.request.identity));
+        pending != pending_by_digest_.end() && pending->second == id) {
+        pending_by_digest_.erase(pending);
+    }
+
+    std::vector<DownloadId> settled{id};
+    if (const auto found = followers_.find(id); found != followers_.end()) {
+        for (const auto follower : found->second) {
+            downloads_[follower].status = download.status;
+            downloads_[follower].path = download.path;
+            downloads_[follower].error = download.error;
+            settled.push_back(follower);
+        }
+        followers_.erase(found);
+    }
+    if (result_callback_) {
+        for (const auto settled_id : settled) {
+            result_callback_(settled_id, downloads_[settled_id]);
+        }
+    }
+}
+
+} // namespace sotc::network
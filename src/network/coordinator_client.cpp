@@ -1,5 +1,7 @@
 #include "network/coordinator_client.hpp"
 
+#include "network/packet_codec.hpp"
+
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
@@ -8,13 +10,14 @@
 #include <string>
 #include <string_view>
 #include <span>
+#include <utility>
 #include <vector>
 
 namespace sotc::network {
 
 namespace {
 
-constexpr std::size_t kMaxCoordinatorPayloadLength = 32 * 1024;
+constexpr std::size_t kMaxCoordinatorPayloadLength = NETWORK_TCP_MTU;
 
 [[nodiscard]] std::uint16_t clamp_port(std::uint16_t port) {
     if (port == 0) {
@@ -23,68 +26,49 @@ constexpr std::size_t kMaxCoordinatorPayloadLength = 32 * 1024;
     return port;
 }
 
-[[nodiscard]] std::string truncate_string(std::string_view value, std::size_t max_length) {
-    if (value.size() <= max_length) {
-        return std::string{value};
-    }
-    return std::string{value.substr(0, max_length)};
-}
-
-void append_uint8(std::vector<std::byte> &buffer, std::uint8_t value) {
-    buffer.push_back(static_cast<std::byte>(value));
+[[nodiscard]] std::string_view truncate_view(std::string_view value, std::size_t max_length) noexcept {
+    return value.substr(0, std::min(value.size(), max_length));
 }
 
-void append_uint16_be(std::vector<std::byte> &buffer, std::uint16_t value) {
-    buffer.push_back(static_cast<std::byte>((value >> 8) & 0xFF));
-    buffer.push_back(static_cast<std::byte>(value & 0xFF));
-}
-
-void append_string(std::vector<std::byte> &buffer, const std::string &value) {
-    if (value.size() > std::numeric_limits<std::uint16_t>::max()) {
-        throw std::length_error{"String too long to serialise into coordinator payload"};
-    }
-    append_uint16_be(buffer, static_cast<std::uint16_t>(value.size()));
-    for (unsigned char ch : value) {
-        buffer.push_back(static_cast<std::byte>(ch));
-    }
+[[nodiscard]] std::string truncate_string(std::string_view value, std::size_t max_length) {
+    return std::string{truncate_view(value, max_length)};
 }
 
-[[nodiscard]] std::uint8_t read_uint8(std::span<const std::byte> payload, std::size_t &offset) {
-    if (offset >= payload.size()) {
-        throw std::out_of_range{"Coordinator payload ended unexpectedly while reading uint8"};
+// The list as it goes on the wire: shared with config unless an entry has to
+// be truncated or the list cut to the protocol maximum.
+[[nodiscard]] GrfList frame_grfs(const GrfList &grfs) {
+    const bool fits = grfs.size() <= NETWORK_MAX_GRF_COUNT &&
+                      std::all_of(grfs.begin(), grfs.end(), [](const std::string &grf) {
+                          return grf.size() <= NETWORK_MAX_SERVER_NAME_LENGTH;
+                      });
+    if (fits) {
+        return grfs;
     }
-    return std::to_integer<std::uint8_t>(payload[offset++]);
-}
-
-[[nodiscard]] std::uint16_t read_uint16_be(std::span<const std::byte> payload, std::size_t &offset) {
-    if (offset + 1 >= payload.size()) {
-        throw std::out_of_range{"Coordinator payload ended unexpectedly while reading uint16"};
+    std::vector<std::string> truncated;
+    truncated.reserve(std::min(grfs.size(), NETWORK_MAX_GRF_COUNT));
+    for (std::size_t i = 0; i < grfs.size() && i < NETWORK_MAX_GRF_COUNT; ++i) {
+        truncated.push_back(truncate_string(grfs[i], NETWORK_MAX_SERVER_NAME_LENGTH));
     }
-    const auto high = std::to_integer<std::uint8_t>(payload[offset++]);
-    const auto low = std::to_integer<std::uint8_t>(payload[offset++]);
-    return static_cast<std::uint16_t>((static_cast<std::uint16_t>(high) << 8U) | low);
+    return GrfList{std::move(truncated)};
 }
 
-[[nodiscard]] std::string read_string(
-    std::span<const std::byte> payload,
-    std::size_t &offset,
-    std::size_t max_length,
-    std::string_view field_name) {
-    const auto length = read_uint16_be(payload, offset);
-    if (length > max_length) {
-        throw std::length_error{std::string{"Coordinator "} + std::string{field_name} + " exceeds supported length"};
-    }
-    if (offset + length > payload.size()) {
-        throw std::out_of_range{"Coordinator payload ended unexpectedly while reading string"};
-    }
-
-    std::string value;
-    value.reserve(length);
-    for (std::size_t index = 0; index < length; ++index) {
-        value.push_back(static_cast<char>(std::to_integer<unsigned char>(payload[offset++])));
-    }
-    return value;
-}
+using HandshakeSchema = codec::PacketSchema<
+    CoordinatorHandshakeFrame,
+    codec::UInt8Field<&CoordinatorHandshakeFrame::coordinator_version>,
+    codec::UInt8Field<&CoordinatorHandshakeFrame::game_info_version>,
+    codec::UInt8Field<&CoordinatorHandshakeFrame::admin_version>,
+    codec::UInt16Field<&CoordinatorHandshakeFrame::listen_port>,
+    codec::UInt16Field<&CoordinatorHandshakeFrame::heartbeat_seconds>,
+    codec::UInt8Field<&CoordinatorHandshakeFrame::server_game_type>,
+    codec::UInt8Field<&CoordinatorHandshakeFrame::nat_capabilities>,
+    codec::UInt8Field<&CoordinatorHandshakeFrame::public_listing>,
+    codec::StringField<&CoordinatorHandshakeFrame::server_name, NETWORK_MAX_SERVER_NAME_LENGTH, "server name">,
+    codec::StringField<&CoordinatorHandshakeFrame::invite_code, NETWORK_MAX_INVITE_CODE_LENGTH, "invite code">,
+    codec::StringListField<&CoordinatorHandshakeFrame::newgrfs,
+                           NETWORK_MAX_GRF_COUNT,
+                           NETWORK_MAX_SERVER_NAME_LENGTH,
+                           "GRF identifier",
+                           "GRFs">>;
 
 } // namespace
 
@@ -92,7 +76,17 @@ CoordinatorClient::CoordinatorClient() = default;
 
 CoordinatorHandshakeFrame CoordinatorClient::build_registration_frame(const RegistrationConfig &config) const {
     CoordinatorHandshakeFrame frame{};
+    apply_fixed_fields(config, frame);
 
+    frame.server_name = truncate_string(config.server_name, NETWORK_MAX_SERVER_NAME_LENGTH);
+    frame.invite_code = truncate_string(config.invite_code, NETWORK_MAX_INVITE_CODE_LENGTH);
+
+    frame.newgrfs = frame_grfs(config.advertised_grfs);
+
+    return frame;
+}
+
+void CoordinatorClient::apply_fixed_fields(const RegistrationConfig &config, CoordinatorHandshakeFrame &frame) const {
     frame.listen_port = clamp_port(config.listen_port);
     frame.heartbeat_seconds = static_cast<std::uint16_t>(std::clamp<std::int64_t>(
         config.heartbeat_interval.count(), 5, std::numeric_limits<std::uint16_t>::max()));
@@ -110,82 +104,238 @@ CoordinatorHandshakeFrame CoordinatorClient::build_registration_frame(const Regi
     }
     frame.nat_capabilities = nat_flags;
     frame.public_listing = static_cast<std::uint8_t>(config.listed_publicly ? 1 : 0);
+}
 
-    frame.server_name = truncate_string(config.server_name, NETWORK_MAX_SERVER_NAME_LENGTH);
-    frame.invite_code = truncate_string(config.invite_code, NETWORK_MAX_INVITE_CODE_LENGTH);
-
-    frame.newgrfs.clear();
-    frame.newgrfs.reserve(std::min(config.advertised_grfs.size(), NETWORK_MAX_GRF_COUNT));
-    for (std::size_t i = 0; i < config.advertised_grfs.size() && i < NETWORK_MAX_GRF_COUNT; ++i) {
-        frame.newgrfs.emplace_back(truncate_string(config.advertised_grfs[i], NETWORK_MAX_SERVER_NAME_LENGTH));
+std::size_t CoordinatorHandshakeFrame::serialized_size() const {
+    const auto size = HandshakeSchema::serialized_size(*this);
+    if (size > kMaxCoordinatorPayloadLength) {
+        throw std::length_error{"Coordinator payload exceeds supported size"};
     }
+    return size;
+}
 
-    return frame;
+std::size_t CoordinatorHandshakeFrame::serialize_into(std::span<std::byte> buffer) const {
+    if (buffer.size() < serialized_size()) {
+        throw std::length_error{"Coordinator payload buffer is too small"};
+    }
+    return HandshakeSchema::write(*this, buffer);
 }
 
 std::vector<std::byte> CoordinatorHandshakeFrame::serialize() const {
-    std::vector<std::byte> buffer;
-    buffer.reserve(256);
+    std::vector<std::byte> buffer(serialized_size());
+    HandshakeSchema::write(*this, buffer);
+    return buffer;
+}
 
-    append_uint8(buffer, coordinator_version);
-    append_uint8(buffer, game_info_version);
-    append_uint8(buffer, admin_version);
-    append_uint16_be(buffer, listen_port);
-    append_uint16_be(buffer, heartbeat_seconds);
-    append_uint8(buffer, server_game_type);
-    append_uint8(buffer, nat_capabilities);
-    append_uint8(buffer, public_listing);
+CoordinatorHandshakeFrame CoordinatorHandshakeFrame::deserialize(std::span<const std::byte> payload) {
+    return HandshakeSchema::parse(payload);
+}
 
-    append_string(buffer, server_name);
-    append_string(buffer, invite_code);
+DecodeResult<CoordinatorHandshakeFrame> CoordinatorHandshakeFrame::try_deserialize(
+    std::span<const std::byte> payload) {
+    return HandshakeSchema::try_parse(payload);
+}
 
-    append_uint8(buffer, static_cast<std::uint8_t>(std::min<std::size_t>(newgrfs.size(), NETWORK_MAX_GRF_COUNT)));
-    for (const auto &grf_id : newgrfs) {
-        append_string(buffer, grf_id);
-    }
+std::string_view CoordinatorHandshakeFrameView::GrfIterator::operator*() const noexcept {
+    const auto high = std::to_integer<std::uint8_t>(payload_[offset_]);
+    const auto low = std::to_integer<std::uint8_t>(payload_[offset_ + 1]);
+    const auto length = static_cast<std::size_t>((static_cast<std::size_t>(high) << 8U) | low);
+    return std::string_view{reinterpret_cast<const char *>(payload_.data() + offset_ + 2), length};
+}
 
-    if (buffer.size() > kMaxCoordinatorPayloadLength) {
-        throw std::length_error{"Coordinator payload exceeds supported size"};
-    }
+CoordinatorHandshakeFrameView::GrfIterator &CoordinatorHandshakeFrameView::GrfIterator::operator++() noexcept {
+    offset_ += 2 + (**this).size();
+    --remaining_;
+    return *this;
+}
 
-    return buffer;
+CoordinatorHandshakeFrameView::GrfIterator CoordinatorHandshakeFrameView::GrfIterator::operator++(int) noexcept {
+    auto previous = *this;
+    ++*this;
+    return previous;
 }
 
-CoordinatorHandshakeFrame CoordinatorHandshakeFrame::deserialize(std::span<const std::byte> payload) {
-    CoordinatorHandshakeFrame frame{};
+CoordinatorHandshakeFrameView CoordinatorHandshakeFrameView::parse(std::span<const std::byte> payload) {
+    auto result = try_parse(payload);
+    if (!result) {
+        codec::detail::throw_decode_error(result.error(), result.error_field());
+    }
+    return *result;
+}
+
+DecodeResult<CoordinatorHandshakeFrameView> CoordinatorHandshakeFrameView::try_parse(
+    std::span<const std::byte> payload) noexcept {
+    using codec::detail::read_string_view;
+    using codec::detail::read_uint16_be;
+    using codec::detail::read_uint8;
+    using Result = DecodeResult<CoordinatorHandshakeFrameView>;
+
+    CoordinatorHandshakeFrameView view{};
+    view.payload_ = payload;
     std::size_t offset = 0;
 
-    frame.coordinator_version = read_uint8(payload, offset);
-    frame.game_info_version = read_uint8(payload, offset);
-    frame.admin_version = read_uint8(payload, offset);
-    frame.listen_port = read_uint16_be(payload, offset);
-    frame.heartbeat_seconds = read_uint16_be(payload, offset);
-    frame.server_game_type = read_uint8(payload, offset);
-    frame.nat_capabilities = read_uint8(payload, offset);
-    frame.public_listing = read_uint8(payload, offset);
+    if (read_uint8(payload, offset, view.coordinator_version_) != DecodeError::None ||
+        read_uint8(payload, offset, view.game_info_version_) != DecodeError::None ||
+        read_uint8(payload, offset, view.admin_version_) != DecodeError::None ||
+        read_uint16_be(payload, offset, view.listen_port_) != DecodeError::None ||
+        read_uint16_be(payload, offset, view.heartbeat_seconds_) != DecodeError::None ||
+        read_uint8(payload, offset, view.server_game_type_) != DecodeError::None ||
+        read_uint8(payload, offset, view.nat_capabilities_) != DecodeError::None ||
+        read_uint8(payload, offset, view.public_listing_) != DecodeError::None) {
+        return Result{DecodeError::Truncated, "packet header"};
+    }
 
-    frame.server_name = read_string(payload, offset, NETWORK_MAX_SERVER_NAME_LENGTH, "server name");
-    frame.invite_code = read_string(payload, offset, NETWORK_MAX_INVITE_CODE_LENGTH, "invite code");
+    if (const auto error = read_string_view(payload, offset, NETWORK_MAX_SERVER_NAME_LENGTH, view.server_name_);
+        error != DecodeError::None) {
+        return Result{error, "server name"};
+    }
+    if (const auto error = read_string_view(payload, offset, NETWORK_MAX_INVITE_CODE_LENGTH, view.invite_code_);
+        error != DecodeError::None) {
+        return Result{error, "invite code"};
+    }
 
-    const auto grf_count = read_uint8(payload, offset);
+    std::uint8_t grf_count = 0;
+    if (read_uint8(payload, offset, grf_count) != DecodeError::None) {
+        return Result{DecodeError::Truncated, "GRFs"};
+    }
     if (grf_count > NETWORK_MAX_GRF_COUNT) {
-        throw std::length_error{"Coordinator payload lists more GRFs than supported"};
+        return Result{DecodeError::TooManyItems, "GRFs"};
     }
+    view.grf_count_ = grf_count;
+    view.grf_offset_ = offset;
 
-    frame.newgrfs.clear();
-    frame.newgrfs.reserve(grf_count);
+    // Validate every GRF entry now so iteration can decode without bounds checks.
     for (std::uint8_t index = 0; index < grf_count; ++index) {
-        frame.newgrfs.emplace_back(
-            read_string(payload, offset, NETWORK_MAX_SERVER_NAME_LENGTH, "GRF identifier"));
+        std::string_view grf_id;
+        if (const auto error = read_string_view(payload, offset, NETWORK_MAX_SERVER_NAME_LENGTH, grf_id);
+            error != DecodeError::None) {
+            return Result{error, "GRF identifier"};
+        }
     }
 
     if (offset != payload.size()) {
-        throw std::invalid_argument{"Coordinator payload contains unexpected trailing data"};
+        return Result{DecodeError::TrailingData, "payload"};
+    }
+
+    return Result{view};
+}
+
+CoordinatorHandshakeFrame CoordinatorHandshakeFrameView::to_frame() const {
+    CoordinatorHandshakeFrame frame{};
+    frame.coordinator_version = coordinator_version_;
+    frame.game_info_version = game_info_version_;
+    frame.admin_version = admin_version_;
+    frame.listen_port = listen_port_;
+    frame.heartbeat_seconds = heartbeat_seconds_;
+    frame.server_game_type = server_game_type_;
+    frame.nat_capabilities = nat_capabilities_;
+    frame.public_listing = public_listing_;
+    frame.server_name = std::string{server_name_};
+    frame.invite_code = std::string{invite_code_};
+
+    std::vector<std::string> newgrfs;
+    newgrfs.reserve(grf_count_);
+    for (const auto grf_id : grfs()) {
+        newgrfs.emplace_back(grf_id);
     }
+    frame.newgrfs = GrfList{std::move(newgrfs)};
 
     return frame;
 }
 
+CachedRegistrationFrame::CachedRegistrationFrame(const RegistrationConfig &config)
+    : CachedRegistrationFrame(CoordinatorClient{}.build_registration_frame(config)) {}
+
+CachedRegistrationFrame::CachedRegistrationFrame(CoordinatorHandshakeFrame frame)
+    : frame_(std::move(frame)), payload_(frame_.serialize()) {}
+
+void CachedRegistrationFrame::rebuild() {
+    payload_.resize(frame_.serialized_size());
+    HandshakeSchema::write(frame_, payload_);
+    ++rebuilds_;
+}
+
+FrameUpdate CachedRegistrationFrame::update(const RegistrationConfig &config) {
+    const CoordinatorClient client{};
+    const auto variable_fields_match = [&] {
+        if (truncate_view(config.server_name, NETWORK_MAX_SERVER_NAME_LENGTH) != frame_.server_name ||
+            truncate_view(config.invite_code, NETWORK_MAX_INVITE_CODE_LENGTH) != frame_.invite_code ||
+            std::min(config.advertised_grfs.size(), NETWORK_MAX_GRF_COUNT) != frame_.newgrfs.size()) {
+            return false;
+        }
+        if (config.advertised_grfs == frame_.newgrfs) {
+            return true;
+        }
+        for (std::size_t i = 0; i < frame_.newgrfs.size(); ++i) {
+            if (truncate_view(config.advertised_grfs[i], NETWORK_MAX_SERVER_NAME_LENGTH) != frame_.newgrfs[i]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (!variable_fields_match()) {
+        frame_ = client.build_registration_frame(config);
+        rebuild();
+        return FrameUpdate::Rebuilt;
+    }
+
+    CoordinatorHandshakeFrame fixed{};
+    client.apply_fixed_fields(config, fixed);
+    const auto patches_before = patches_;
+    if (fixed.listen_port != frame_.listen_port) {
+        set_listen_port(fixed.listen_port);
+    }
+    if (fixed.heartbeat_seconds != frame_.heartbeat_seconds) {
+        set_heartbeat_seconds(fixed.heartbeat_seconds);
+    }
+    if (fixed.server_game_type != frame_.server_game_type) {
+        set_server_game_type(fixed.server_game_type);
+    }
+    if (fixed.nat_capabilities != frame_.nat_capabilities) {
+        set_nat_capabilities(fixed.nat_capabilities);
+    }
+    if (fixed.public_listing != frame_.public_listing) {
+        set_public_listing(fixed.public_listing != 0);
+    }
+    return patches_ == patches_before ? FrameUpdate::Unchanged : FrameUpdate::Patched;
+}
+
+void CachedRegistrationFrame::set_listen_port(std::uint16_t listen_port) noexcept {
+    frame_.listen_port = listen_port;
+    std::size_t offset = HandshakeSchema::fixed_offset<&CoordinatorHandshakeFrame::listen_port>();
+    codec::detail::write_uint16_be(payload_, offset, listen_port);
+    ++patches_;
+}
+
+void CachedRegistrationFrame::set_heartbeat_seconds(std::uint16_t heartbeat_seconds) noexcept {
+    frame_.heartbeat_seconds = heartbeat_seconds;
+    std::size_t offset = HandshakeSchema::fixed_offset<&CoordinatorHandshakeFrame::heartbeat_seconds>();
+    codec::detail::write_uint16_be(payload_, offset, heartbeat_seconds);
+    ++patches_;
+}
+
+void CachedRegistrationFrame::set_server_game_type(std::uint8_t server_game_type) noexcept {
+    frame_.server_game_type = server_game_type;
+    std::size_t offset = HandshakeSchema::fixed_offset<&CoordinatorHandshakeFrame::server_game_type>();
+    codec::detail::write_uint8(payload_, offset, server_game_type);
+    ++patches_;
+}
+
+void CachedRegistrationFrame::set_nat_capabilities(std::uint8_t nat_capabilities) noexcept {
+    frame_.nat_capabilities = nat_capabilities;
+    std::size_t offset = HandshakeSchema::fixed_offset<&CoordinatorHandshakeFrame::nat_capabilities>();
+    codec::detail::write_uint8(payload_, offset, nat_capabilities);
+    ++patches_;
+}
+
+void CachedRegistrationFrame::set_public_listing(bool listed) noexcept {
+    frame_.public_listing = static_cast<std::uint8_t>(listed ? 1 : 0);
+    std::size_t offset = HandshakeSchema::fixed_offset<&CoordinatorHandshakeFrame::public_listing>();
+    codec::detail::write_uint8(payload_, offset, frame_.public_listing);
+    ++patches_;
+}
+
 std::string describe_capabilities(std::uint8_t nat_capabilities) {
     std::string description;
     if (nat_capabilities & static_cast<std::uint8_t>(NatCapability::Direct)) {
@@ -205,4 +355,20 @@ std::string describe_capabilities(std::uint8_t nat_capabilities) {
     return description;
 }
 
+std::string describe_capabilities(std::uint8_t nat_capabilities, NatCapability effective_path) {
+    return describe_capabilities(nat_capabilities) + "; connected via " + std::string{to_string(effective_path)};
+}
+
+std::string_view to_string(NatCapability capability) noexcept {
+    switch (capability) {
+    case NatCapability::Direct:
+        return "direct";
+    case NatCapability::Stun:
+        return "STUN";
+    case NatCapability::Turn:
+        return "TURN";
+    }
+    return "unknown";
+}
+
 } // namespace sotc::network
@@ -0,0 +1,218 @@
+#include "network/coordinator_fleet.hpp"
+
+#include <algorithm>
+#include <system_error>
+#include <utility>
+
+namespace sotc::network {
+
+CoordinatorFleet::CoordinatorFleet(EventLoop &loop, CoordinatorFleetOptions options)
+    : loop_(loop), options_(options), wheel_(options_.wheel_tick) {}
+
+CoordinatorFleet::~CoordinatorFleet() {
+    close();
+}
+
+std::size_t CoordinatorFleet::add(RegistrationConfig config, EventLoop::Clock::duration heartbeat_interval) {
+    CoordinatorSessionOptions session_options{};
+    session_options.heartbeat_interval = heartbeat_interval;
+    session_options.connect_timeout = options_.connect_timeout;
+    session_options.heartbeat_wheel = &wheel_;
+    session_options.resolver = options_.resolver;
+    session_options.session_cache = options_.session_cache;
+
+    std::size_t server = sessions_.size();
+    if (!free_.empty()) {
+        server = free_.back();
+        free_.pop_back();
+    } else {
+        sessions_.emplace_back();
+        configs_.emplace_back();
+    }
+    configs_[server] = config;
+    auto session = std::make_unique<CoordinatorSession>(loop_, std::move(config), session_options);
+    session->set_state_callback([this, server](SessionState state) {
+        if (state == SessionState::Registered) {
+            arm_wheel();
+        }
+        schedule_cache_flush();
+        if (state_callback_) {
+            state_callback_(server, state);
+        }
+    });
+    sessions_[server] = std::move(session);
+    active_.push_back(server);
+    if (started_) {
+        sessions_[server]->start();
+    }
+    return server;
+}
+
+void CoordinatorFleet::remove(std::size_t server) {
+    if (sessions_.at(server) == nullptr) {
+        return;
+    }
+    release(server);
+    active_.erase(std::remove(active_.begin(), active_.end(), server), active_.end());
+}
+
+void CoordinatorFleet::release(std::size_t server) {
+    auto &session = sessions_[server];
+    session->close();
+    released_heartbeats_ += session->heartbeats_sent();
+    released_ack_latency_.merge(session->ack_latency());
+    session.reset();
+    configs_[server] = {};
+    free_.push_back(server);
+}
+
+FleetReconcileResult CoordinatorFleet::reconcile(std::span<const RegistrationConfig> desired) {
+    std::vector<RegistrationConfig> current;
+    current.reserve(active_.size());
+    for (const auto server : active_) {
+        current.push_back(configs_[server]);
+    }
+
+    const auto diff = diff_registrations(current, desired);
+    FleetReconcileResult result{};
+    // Removals go first so the servers added below can take their indices.
+    for (const auto &entry : diff) {
+        if (entry.change == RegistrationChange::Removed) {
+            ++result.removed;
+            release(active_[entry.before]);
+        }
+    }
+    std::vector<std::size_t> next;
+    next.reserve(desired.size());
+    for (const auto &entry : diff) {
+        switch (entry.change) {
+        case RegistrationChange::Unchanged:
+            ++result.unchanged;
+            next.push_back(active_[entry.before]);
+            break;
+        case RegistrationChange::Patched: {
+            auto &session = *sessions_[active_[entry.before]];
+            // A failed server gets a fresh attempt with its new settings.
+            if (session.state() == SessionState::Failed) {
+                ++result.reregistered;
+                release(active_[entry.before]);
+                next.push_back(add(desired[entry.after]));
+                break;
+            }
+            ++result.patched;
+            configs_[active_[entry.before]] = desired[entry.after];
+            session.update_registration(desired[entry.after]);
+            session.send_heartbeat();
+            next.push_back(active_[entry.before]);
+            break;
+        }
+        case RegistrationChange::Reregistered:
+            ++result.reregistered;
+            release(active_[entry.before]);
+            next.push_back(add(desired[entry.after]));
+            break;
+        case RegistrationChange::Added:
+            ++result.added;
+            next.push_back(add(desired[entry.after]));
+            break;
+        case RegistrationChange::Removed:
+            break;
+        }
+    }
+    active_ = std::move(next);
+    schedule_cache_flush();
+    return result;
+}
+
+void CoordinatorFleet::start() {
+    started_ = true;
+    for (const auto server : active_) {
+        sessions_[server]->start();
+    }
+}
+
+void CoordinatorFleet::close() noexcept {
+    loop_.cancel(wheel_timer_);
+    wheel_timer_ = 0;
+    for (auto &session : sessions_) {
+        if (session != nullptr) {
+            session->close();
+        }
+    }
+    loop_.cancel(cache_timer_);
+    cache_timer_ = 0;
+    flush_session_cache();
+}
+
+void CoordinatorFleet::schedule_cache_flush() {
+    if (cache_timer_ != 0 || options_.session_cache == nullptr || !options_.session_cache->dirty()) {
+        return;
+    }
+    cache_timer_ = loop_.schedule_after(options_.cache_flush_delay, [this] {
+        cache_timer_ = 0;
+        flush_session_cache();
+    });
+}
+
+void CoordinatorFleet::flush_session_cache() noexcept {
+    if (options_.session_cache == nullptr) {
+        return;
+    }
+    // A cache that cannot be written only costs the next start its resume.
+    try {
+        options_.session_cache->flush();
+    } catch (const std::system_error &) {
+    }
+}
+
+void CoordinatorFleet::arm_wheel() {
+    // The loop sleeps until the wheel next has work rather than waking on
+    // every tick; an earlier heartbeat scheduled since moves the wake up.
+    const auto next = wheel_.next_expiry();
+    if (!next || (wheel_timer_ != 0 && wheel_deadline_ <= *next)) {
+        return;
+    }
+    loop_.cancel(wheel_timer_);
+    wheel_deadline_ = *next;
+    wheel_timer_ = loop_.schedule_at(wheel_deadline_, [this] {
+        wheel_timer_ = 0;
+        wheel_.advance(EventLoop::Clock::now());
+        arm_wheel();
+    });
+}
+
+std::size_t CoordinatorFleet::count(SessionState state) const noexcept {
+    std::size_t matching = 0;
+    for (const auto &session : sessions_) {
+        if (session != nullptr && session->state() == state) {
+            ++matching;
+        }
+    }
+    return matching;
+}
+
+bool CoordinatorFleet::finished() const noexcept {
+    return count(SessionState::Failed) + count(SessionState::Closed) == size();
+}
+
+std::uint64_t CoordinatorFleet::heartbeats_sent() const noexcept {
+    std::uint64_t total = released_heartbeats_;
+    for (const auto &session : sessions_) {
+        if (session != nullptr) {
+            total += session->heartbeats_sent();
+        }
+    }
+    return total;
+}
+
+LatencyHistogram CoordinatorFleet::ack_latency() const noexcept {
+    LatencyHistogram merged = released_ack_latency_;
+    for (const auto &session : sessions_) {
+        if (session != nullptr) {
+            merged.merge(session->ack_latency());
+        }
+    }
+    return merged;
+}
+
+} // namespace sotc::network
@@ -0,0 +1,63 @@
+#include "network/coordinator_protocol.hpp"
+
+#include "network/constants.hpp"
+#include "network/packet_codec.hpp"
+
+namespace sotc::network {
+
+namespace {
+
+constexpr std::size_t kMaxErrorDetailLength = 1024;
+
+using RegisterAckSchema = codec::PacketSchema<
+    CoordinatorRegisterAck,
+    codec::StringField<&CoordinatorRegisterAck::invite_code, NETWORK_MAX_INVITE_CODE_LENGTH, "invite code">,
+    codec::StringField<&CoordinatorRegisterAck::invite_code_secret, NETWORK_MAX_INVITE_CODE_LENGTH, "invite code secret">,
+    codec::UInt8Field<&CoordinatorRegisterAck::connection_type>>;
+
+using ErrorSchema = codec::PacketSchema<
+    CoordinatorErrorPacket,
+    codec::UInt8Field<&CoordinatorErrorPacket::error_code>,
+    codec::StringField<&CoordinatorErrorPacket::detail, kMaxErrorDetailLength, "error detail">>;
+
+} // namespace
+
+std::size_t CoordinatorRegisterAck::serialized_size() const {
+    return RegisterAckSchema::serialized_size(*this);
+}
+
+std::size_t CoordinatorRegisterAck::serialize_into(std::span<std::byte> buffer) const {
+    return RegisterAckSchema::serialize_into(*this, buffer);
+}
+
+DecodeResult<CoordinatorRegisterAck> CoordinatorRegisterAck::try_deserialize(std::span<const std::byte> payload) {
+    return RegisterAckSchema::try_parse(payload);
+}
+
+std::size_t CoordinatorErrorPacket::serialized_size() const {
+    return ErrorSchema::serialized_size(*this);
+}
+
+std::size_t CoordinatorErrorPacket::serialize_into(std::span<std::byte> buffer) const {
+    return ErrorSchema::serialize_into(*this, buffer);
+}
+
+DecodeResult<CoordinatorErrorPacket> CoordinatorErrorPacket::try_deserialize(std::span<const std::byte> payload) {
+    return ErrorSchema::try_parse(payload);
+}
+
+std::string to_string(CoordinatorErrorCode code) {
+    switch (code) {
+    case CoordinatorErrorCode::Unknown:
+        return "unknown error";
+    case CoordinatorErrorCode::RegistrationFailed:
+        return "registration failed";
+    case CoordinatorErrorCode::InvalidInviteCode:
+        return "invalid invite code";
+    case CoordinatorErrorCode::ReuseOfInviteCode:
+        return "invite code already in use";
+    }
+    return "unknown error";
+}
+
+} // namespace sotc::network
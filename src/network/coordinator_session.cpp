@@ -0,0 +1,446 @@
+#include "network/coordinator_session.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <sys/socket.h>
+
+namespace sotc::network {
+
+namespace {
+
+// Coordinator replies are small; a compat-MTU sized ring keeps per-session
+// memory low when a process hosts many servers.
+constexpr std::size_t kReceiveBufferSize = 4 * NETWORK_COMPAT_MTU;
+
+} // namespace
+
+std::string_view to_string(SessionState state) noexcept {
+    switch (state) {
+    case SessionState::Idle:
+        return "idle";
+    case SessionState::Connecting:
+        return "connecting";
+    case SessionState::Registering:
+        return "registering";
+    case SessionState::Registered:
+        return "registered";
+    case SessionState::Failed:
+        return "failed";
+    case SessionState::Closed:
+        return "closed";
+    }
+    return "unknown";
+}
+
+CoordinatorSession::CoordinatorSession(EventLoop &loop, RegistrationConfig config, CoordinatorSessionOptions options)
+    : loop_(loop),
+      config_(std::move(config)),
+      options_(options),
+      frame_(config_),
+      framer_(kReceiveBufferSize, kReceiveBufferSize) {
+    if (options_.heartbeat_interval <= Clock::duration::zero()) {
+        heartbeat_follows_frame_ = true;
+        options_.heartbeat_interval = std::chrono::seconds{frame_.frame().heartbeat_seconds};
+    }
+    if (options_.session_cache != nullptr) {
+        identity_ = session_identity(config_);
+    }
+}
+
+CoordinatorSession::~CoordinatorSession() {
+    close();
+}
+
+void CoordinatorSession::set_state(SessionState state) {
+    if (state_ == state) {
+        return;
+    }
+    state_ = state;
+    if (state_callback_) {
+        state_callback_(state);
+    }
+}
+
+void CoordinatorSession::fail(std::string message) {
+    last_error_ = std::move(message);
+    cancel_timers();
+    if (socket_) {
+        loop_.remove(socket_.get());
+        socket_.reset();
+    }
+    if (resumed_ && state_ != SessionState::Registered) {
+        fall_back();
+        return;
+    }
+    set_state(SessionState::Failed);
+}
+
+void CoordinatorSession::close() noexcept {
+    cancel_timers();
+    if (socket_) {
+        loop_.remove(socket_.get());
+        socket_.reset();
+    }
+    if (state_ != SessionState::Idle && state_ != SessionState::Failed) {
+        state_ = SessionState::Closed;
+    }
+}
+
+void CoordinatorSession::cancel_timers() noexcept {
+    if (resolve_request_ != 0) {
+        options_.resolver->cancel(resolve_request_);
+        resolve_request_ = 0;
+    }
+    loop_.cancel(connect_timer_);
+    if (options_.heartbeat_wheel != nullptr) {
+        options_.heartbeat_wheel->cancel(heartbeat_timer_);
+    } else {
+        loop_.cancel(heartbeat_timer_);
+    }
+    connect_timer_ = 0;
+    heartbeat_timer_ = 0;
+}
+
+void CoordinatorSession::start() {
+    if (socket_ || resolve_request_ != 0 || connect_timer_ != 0) {
+        return;
+    }
+    started_at_ = Clock::now();
+    time_to_registered_ = {};
+    resumed_ = false;
+    if (!resume()) {
+        begin(nullptr);
+    }
+}
+
+bool CoordinatorSession::resume() {
+    if (options_.session_cache == nullptr) {
+        return false;
+    }
+    const auto *cached = options_.session_cache->find(identity_);
+    if (cached == nullptr) {
+        return false;
+    }
+    const auto endpoint = parse_endpoint(cached->coordinator_endpoint);
+    if (!endpoint) {
+        return false;
+    }
+
+    resumed_ = true;
+    if (config_.invite_code.empty()) {
+        config_.invite_code = cached->invite_code;
+        resumed_invite_code_ = true;
+        static_cast<void>(frame_.update(config_));
+    }
+    begin(&*endpoint);
+    return true;
+}
+
+void CoordinatorSession::fall_back() {
+    resumed_ = false;
+    options_.session_cache->erase(identity_);
+    if (resumed_invite_code_) {
+        config_.invite_code.clear();
+        resumed_invite_code_ = false;
+        static_cast<void>(frame_.update(config_));
+    }
+    // Deferred so the register starts from a clean stack rather than from
+    // inside the packet or socket handler that failed.
+    set_state(SessionState::Connecting);
+    connect_timer_ = loop_.schedule_after(Clock::duration::zero(), [this] {
+        connect_timer_ = 0;
+        begin(nullptr);
+    });
+}
+
+void CoordinatorSession::remember_registration() {
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    options_.session_cache->store(identity_,
+                                  CachedSession{registration_.invite_code, registration_.connection_type,
+                                                coordinator_endpoint_,
+                                                std::chrono::duration_cast<std::chrono::seconds>(now).count()});
+}
+
+void CoordinatorSession::begin(const Endpoint *direct) {
+    framer_.reset();
+    outbound_.clear();
+    outbound_offset_ = 0;
+    pending_acks_.clear();
+    last_error_.clear();
+
+    if (direct != nullptr) {
+        connect_to({*direct});
+        return;
+    }
+    if (options_.resolver == nullptr) {
+        connect_to(resolve_endpoints(config_.coordinator_host, config_.coordinator_port));
+        return;
+    }
+    // The connect timeout also bounds the lookup.
+    set_state(SessionState::Connecting);
+    connect_timer_ = loop_.schedule_after(options_.connect_timeout, [this] {
+        connect_timer_ = 0;
+        if (state_ == SessionState::Connecting) {
+            fail("Timed out connecting to coordinator");
+        }
+    });
+    const auto request = options_.resolver->resolve(config_.coordinator_host, config_.coordinator_port,
+                                                    [this](const std::vector<Endpoint> &endpoints) {
+                                                        resolve_request_ = 0;
+                                                        connect_to(endpoints);
+                                                    });
+    // Zero when a cached answer was used, and the connect has already begun.
+    if (request != 0) {
+        resolve_request_ = request;
+    }
+}
+
+void CoordinatorSession::connect_to(const std::vector<Endpoint> &endpoints) {
+    if (endpoints.empty()) {
+        fail("Unable to resolve coordinator host " + config_.coordinator_host);
+        return;
+    }
+
+    bool in_progress = false;
+    coordinator_endpoint_ = endpoints.front().to_string();
+    socket_ = connect_nonblocking(endpoints.front(), in_progress);
+    if (!socket_) {
+        fail("Unable to connect to coordinator " + endpoints.front().to_string() + ": " + std::strerror(errno));
+        return;
+    }
+
+    set_state(SessionState::Connecting);
+    watching_writable_ = true;
+    loop_.add(socket_.get(), EventLoop::kReadable | EventLoop::kWritable,
+              [this](std::uint32_t events) { on_io(events); });
+    if (connect_timer_ == 0) {
+        connect_timer_ = loop_.schedule_after(options_.connect_timeout, [this] {
+            connect_timer_ = 0;
+            if (state_ == SessionState::Connecting) {
+                fail("Timed out connecting to coordinator");
+            }
+        });
+    }
+
+    if (!in_progress) {
+        on_connected();
+    }
+}
+
+void CoordinatorSession::on_io(std::uint32_t events) {
+    if (state_ == SessionState::Connecting) {
+        if ((events & (EventLoop::kWritable | EventLoop::kError | EventLoop::kHangup)) == 0) {
+            return;
+        }
+        if (const int error = socket_error(socket_.get()); error != 0) {
+            fail(std::string{"Coordinator connection failed: "} + std::strerror(error));
+            return;
+        }
+        on_connected();
+        return;
+    }
+
+    if (events & EventLoop::kReadable) {
+        on_readable();
+    }
+    if (socket_ && (events & EventLoop::kWritable)) {
+        flush();
+    }
+    if (socket_ && (events & EventLoop::kError)) {
+        fail(std::string{"Coordinator connection error: "} + std::strerror(socket_error(socket_.get())));
+    }
+}
+
+void CoordinatorSession::on_connected() {
+    loop_.cancel(connect_timer_);
+    // The connect timer is re-armed to bound the wait for the first ack; a
+    // coordinator that accepts and then stays silent must not wedge us.
+    connect_timer_ = loop_.schedule_after(options_.register_timeout, [this] {
+        connect_timer_ = 0;
+        if (state_ == SessionState::Registering) {
+            fail("Timed out waiting for the coordinator to acknowledge registration");
+        }
+    });
+    set_state(SessionState::Registering);
+    queue_frame(PacketCoordinatorType::ServerRegister);
+}
+
+void CoordinatorSession::queue_frame(PacketCoordinatorType type) {
+    const auto payload = frame_.payload();
+    const auto start = outbound_.size();
+    outbound_.resize(start + NETWORK_PACKET_HEADER_SIZE + payload.size());
+
+    const std::span<std::byte> packet{outbound_.data() + start, NETWORK_PACKET_HEADER_SIZE + payload.size()};
+    write_packet_header(packet, static_cast<std::uint8_t>(type), payload.size());
+    std::memcpy(packet.data() + NETWORK_PACKET_HEADER_SIZE, payload.data(), payload.size());
+
+    pending_acks_.push_back(Clock::now());
+    flush();
+}
+
+void CoordinatorSession::flush() {
+    while (outbound_offset_ < outbound_.size()) {
+        const auto sent = ::send(socket_.get(), outbound_.data() + outbound_offset_,
+                                 outbound_.size() - outbound_offset_, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            fail(std::string{"Failed to send to coordinator: "} + std::strerror(errno));
+            return;
+        }
+        outbound_offset_ += static_cast<std::size_t>(sent);
+    }
+
+    if (outbound_offset_ == outbound_.size()) {
+        outbound_.clear();
+        outbound_offset_ = 0;
+    }
+
+    const bool want_writable = !outbound_.empty();
+    if (want_writable != watching_writable_) {
+        loop_.modify(socket_.get(), EventLoop::kReadable | (want_writable ? EventLoop::kWritable : 0U));
+        watching_writable_ = want_writable;
+    }
+}
+
+void CoordinatorSession::on_readable() {
+    while (socket_) {
+        auto region = framer_.prepare();
+        if (region.empty()) {
+            fail("Coordinator packet exceeds receive buffer");
+            return;
+        }
+        const auto received = ::recv(socket_.get(), region.data(), region.size(), 0);
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            fail(std::string{"Failed to read from coordinator: "} + std::strerror(errno));
+            return;
+        }
+        if (received == 0) {
+            fail("Coordinator closed the connection");
+            return;
+        }
+        framer_.commit(static_cast<std::size_t>(received));
+
+        while (socket_) {
+            const auto packet = framer_.front();
+            if (!packet) {
+                break;
+            }
+            handle_packet(*packet);
+            framer_.pop_front();
+        }
+        if (framer_.failed()) {
+            fail(std::string{"Malformed coordinator stream: "} + std::string{to_string(framer_.error())});
+            return;
+        }
+    }
+}
+
+void CoordinatorSession::handle_packet(const FramedPacket &packet) {
+    switch (static_cast<PacketCoordinatorType>(packet.type)) {
+    case PacketCoordinatorType::GcRegisterAck: {
+        auto ack = CoordinatorRegisterAck::try_deserialize(packet.linearize(scratch_));
+        if (!ack) {
+            fail("Malformed register acknowledgement: " + std::string{to_string(ack.error())});
+            return;
+        }
+        if (!pending_acks_.empty()) {
+            ack_latency_.record(Clock::now() - pending_acks_.front());
+            pending_acks_.pop_front();
+        }
+        registration_ = std::move(*ack);
+        if (state_ == SessionState::Registering) {
+            loop_.cancel(connect_timer_);
+            connect_timer_ = 0;
+            time_to_registered_ = Clock::now() - started_at_;
+            if (options_.session_cache != nullptr) {
+                remember_registration();
+            }
+            // Scheduled first so an owner driving heartbeat_wheel sees the
+            // heartbeat when it is told about the registration.
+            schedule_heartbeat();
+            set_state(SessionState::Registered);
+        }
+        break;
+    }
+    case PacketCoordinatorType::GcError: {
+        const auto error = CoordinatorErrorPacket::try_deserialize(packet.linearize(scratch_));
+        if (!error) {
+            fail("Coordinator reported an unreadable error");
+            return;
+        }
+        fail("Coordinator rejected registration: " +
+             to_string(static_cast<CoordinatorErrorCode>(error->error_code)) +
+             (error->detail.empty() ? std::string{} : " (" + error->detail + ')'));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void CoordinatorSession::schedule_heartbeat() {
+    auto on_heartbeat = [this] {
+        heartbeat_timer_ = 0;
+        send_heartbeat();
+        if (state_ == SessionState::Registered) {
+            schedule_heartbeat();
+        }
+    };
+    if (options_.heartbeat_wheel != nullptr) {
+        heartbeat_timer_ = options_.heartbeat_wheel->schedule_after(options_.heartbeat_interval, std::move(on_heartbeat));
+    } else {
+        heartbeat_timer_ = loop_.schedule_after(options_.heartbeat_interval, std::move(on_heartbeat));
+    }
+}
+
+FrameUpdate CoordinatorSession::update_registration(const RegistrationConfig &config) {
+    // An invite code taken from the session cache stays until the
+    // configuration names one of its own.
+    auto resumed_invite_code = std::move(config_.invite_code);
+    config_ = config;
+    if (resumed_invite_code_ && config_.invite_code.empty()) {
+        config_.invite_code = std::move(resumed_invite_code);
+    } else {
+        resumed_invite_code_ = false;
+    }
+    if (options_.session_cache != nullptr) {
+        // The server name and game type are part of the key, so a rename
+        // moves the entry rather than stranding it under the old identity.
+        auto identity = session_identity(config_);
+        if (identity != identity_) {
+            options_.session_cache->erase(identity_);
+            identity_ = std::move(identity);
+            if (state_ == SessionState::Registered) {
+                remember_registration();
+            }
+        }
+    }
+    const auto result = frame_.update(config_);
+    if (heartbeat_follows_frame_) {
+        options_.heartbeat_interval = std::chrono::seconds{frame_.frame().heartbeat_seconds};
+    }
+    return result;
+}
+
+void CoordinatorSession::send_heartbeat() {
+    if (state_ != SessionState::Registered || !socket_) {
+        return;
+    }
+    ++heartbeats_sent_;
+    queue_frame(PacketCoordinatorType::ServerUpdate);
+}
+
+} // namespace sotc::network
@@ -0,0 +1,202 @@
+#include "network/dns_cache.hpp"
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <netdb.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace sotc::network {
+
+DnsAnswer system_dns_backend(const std::string &host, std::uint16_t port, int socket_type) {
+    int error = 0;
+    DnsAnswer answer{resolve_endpoints(host, port, socket_type, &error), std::nullopt};
+    bool missing = error == EAI_NONAME;
+#ifdef EAI_NODATA
+    missing = missing || error == EAI_NODATA;
+#endif
+    answer.transient = answer.endpoints.empty() && error != 0 && !missing;
+    return answer;
+}
+
+DnsCache::DnsCache(DnsCacheOptions options, DnsBackend backend)
+    : options_(options), backend_(std::move(backend)) {
+    wakeup_ = SocketHandle{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)};
+    if (!wakeup_) {
+        throw std::system_error{errno, std::generic_category(), "eventfd() failed"};
+    }
+    worker_ = std::thread{[this] { run_worker(); }};
+}
+
+DnsCache::~DnsCache() {
+    detach();
+    {
+        const std::lock_guard lock{mutex_};
+        stopping_ = true;
+    }
+    work_ready_.notify_all();
+    worker_.join();
+}
+
+void DnsCache::attach(EventLoop &loop) {
+    detach();
+    loop_ = &loop;
+    loop_->add(wakeup_.get(), EventLoop::kReadable, [this](std::uint32_t) { dispatch_completed(); });
+    dispatch_completed();
+}
+
+void DnsCache::detach() noexcept {
+    if (loop_ != nullptr) {
+        loop_->remove(wakeup_.get());
+        loop_ = nullptr;
+    }
+}
+
+std::string DnsCache::make_key(const std::string &host, std::uint16_t port, int socket_type) {
+    return host + '\n' + std::to_string(port) + '\n' + std::to_string(socket_type);
+}
+
+DnsCache::Entry &DnsCache::ensure_lookup(const std::string &key, const std::string &host, std::uint16_t port,
+                                         int socket_type) {
+    auto &entry = entries_[key];
+    const bool fresh = entry.resolved && EventLoop::Clock::now() < entry.expires;
+    if (!fresh && !entry.resolving) {
+        entry.resolving = true;
+        jobs_.push_back(Job{key, host, port, socket_type});
+        work_ready_.notify_one();
+    }
+    return entry;
+}
+
+void DnsCache::prefetch(const std::string &host, std::uint16_t port, int socket_type) {
+    const std::lock_guard lock{mutex_};
+    static_cast<void>(ensure_lookup(make_key(host, port, socket_type), host, port, socket_type));
+}
+
+DnsCache::RequestId DnsCache::resolve(const std::string &host, std::uint16_t port, ResolveCallback callback,
+                                      int socket_type) {
+    std::vector<Endpoint> endpoints;
+    {
+        const std::lock_guard lock{mutex_};
+        const auto key = make_key(host, port, socket_type);
+        if (const auto found = entries_.find(key);
+            found != entries_.end() && found->second.resolved && EventLoop::Clock::now() < found->second.expires) {
+            ++(found->second.endpoints.empty() ? negative_hits_ : hits_);
+            endpoints = found->second.endpoints;
+        } else {
+            ++misses_;
+            auto &entry = ensure_lookup(key, host, port, socket_type);
+            const auto id = next_request_++;
+            entry.waiters.push_back(id);
+            requests_.emplace(id, std::move(callback));
+            return id;
+        }
+    }
+    callback(endpoints);
+    return 0;
+}
+
+void DnsCache::cancel(RequestId id) noexcept {
+    const std::lock_guard lock{mutex_};
+    requests_.erase(id);
+}
+
+std::optional<std::vector<Endpoint>> DnsCache::cached(const std::string &host, std::uint16_t port,
+                                                      int socket_type) const {
+    const std::lock_guard lock{mutex_};
+    const auto found = entries_.find(make_key(host, port, socket_type));
+    if (found == entries_.end() || !found->second.resolved || EventLoop::Clock::now() >= found->second.expires) {
+        return std::nullopt;
+    }
+    return found->second.endpoints;
+}
+
+void DnsCache::clear() {
+    const std::lock_guard lock{mutex_};
+    // Entries with waiters stay until those have been answered.
+    std::erase_if(entries_, [](const auto &item) { return !item.second.resolving && item.second.waiters.empty(); });
+}
+
+std::uint64_t DnsCache::hits() const noexcept {
+    const std::lock_guard lock{mutex_};
+    return hits_;
+}
+
+std::uint64_t DnsCache::negative_hits() const noexcept {
+    const std::lock_guard lock{mutex_};
+    return negative_hits_;
+}
+
+std::uint64_t DnsCache::misses() const noexcept {
+    const std::lock_guard lock{mutex_};
+    return misses_;
+}
+
+std::uint64_t DnsCache::lookups() const noexcept {
+    const std::lock_guard lock{mutex_};
+    return lookups_;
+}
+
+void DnsCache::run_worker() {
+    std::unique_lock lock{mutex_};
+    while (true) {
+        if (!work_ready_.wait_for(lock, std::chrono::seconds{1}, [this] { return stopping_ || !jobs_.empty(); })) {
+            continue;
+        }
+        if (stopping_) {
+            return;
+        }
+        auto job = std::move(jobs_.front());
+        jobs_.pop_front();
+        ++lookups_;
+
+        lock.unlock();
+        auto answer = backend_(job.host, job.port, job.socket_type);
+        lock.lock();
+
+        auto &entry = entries_[job.key];
+        auto ttl = answer.transient ? options_.transient_ttl : options_.negative_ttl;
+        if (!answer.endpoints.empty()) {
+            ttl = answer.ttl ? EventLoop::Clock::duration{*answer.ttl} : options_.positive_ttl;
+        }
+        entry.endpoints = std::move(answer.endpoints);
+        entry.expires = EventLoop::Clock::now() + ttl;
+        entry.resolved = true;
+        entry.resolving = false;
+        if (!entry.waiters.empty()) {
+            completed_.push_back(job.key);
+            const std::uint64_t one = 1;
+            static_cast<void>(::write(wakeup_.get(), &one, sizeof(one)));
+        }
+    }
+}
+
+void DnsCache::dispatch_completed() {
+    std::uint64_t count = 0;
+    static_cast<void>(::read(wakeup_.get(), &count, sizeof(count)));
+
+    std::vector<std::pair<ResolveCallback, std::vector<Endpoint>>> ready;
+    {
+        const std::lock_guard lock{mutex_};
+        for (const auto &key : completed_) {
+            const auto found = entries_.find(key);
+            if (found == entries_.end()) {
+                continue;
+            }
+            for (const auto id : found->second.waiters) {
+                if (auto request = requests_.extract(id)) {
+                    ready.emplace_back(std::move(request.mapped()), found->second.endpoints);
+                }
+            }
+            found->second.waiters.clear();
+        }
+        completed_.clear();
+    }
+    for (auto &[callback, endpoints] : ready) {
+        callback(endpoints);
+    }
+}
+
+} // namespace sotc::network
@@ -0,0 +1,153 @@
+#include "network/event_loop.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <system_error>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace sotc::network {
+
+namespace {
+
+constexpr int kMaxEventsPerWait = 64;
+
+[[nodiscard]] std::uint32_t to_epoll_events(std::uint32_t events) noexcept {
+    std::uint32_t mask = 0;
+    if (events & EventLoop::kReadable) {
+        mask |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (events & EventLoop::kWritable) {
+        mask |= EPOLLOUT;
+    }
+    return mask;
+}
+
+[[nodiscard]] std::uint32_t from_epoll_events(std::uint32_t mask) noexcept {
+    std::uint32_t events = 0;
+    if (mask & EPOLLIN) {
+        events |= EventLoop::kReadable;
+    }
+    if (mask & EPOLLOUT) {
+        events |= EventLoop::kWritable;
+    }
+    if (mask & EPOLLERR) {
+        events |= EventLoop::kError;
+    }
+    if (mask & (EPOLLHUP | EPOLLRDHUP)) {
+        events |= EventLoop::kHangup;
+    }
+    return events;
+}
+
+} // namespace
+
+EventLoop::EventLoop() : epoll_fd_(::epoll_create1(EPOLL_CLOEXEC)) {
+    if (epoll_fd_ < 0) {
+        throw std::system_error{errno, std::generic_category(), "epoll_create1 failed"};
+    }
+}
+
+EventLoop::~EventLoop() {
+    ::close(epoll_fd_);
+}
+
+void EventLoop::add(int fd, std::uint32_t events, IoCallback callback) {
+    epoll_event event{};
+    event.events = to_epoll_events(events);
+    event.data.fd = fd;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0) {
+        throw std::system_error{errno, std::generic_category(), "epoll_ctl(ADD) failed"};
+    }
+    handlers_[fd] = std::make_shared<IoCallback>(std::move(callback));
+}
+
+void EventLoop::modify(int fd, std::uint32_t events) {
+    epoll_event event{};
+    event.events = to_epoll_events(events);
+    event.data.fd = fd;
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) != 0) {
+        throw std::system_error{errno, std::generic_category(), "epoll_ctl(MOD) failed"};
+    }
+}
+
+void EventLoop::remove(int fd) noexcept {
+    if (handlers_.erase(fd) != 0) {
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+}
+
+EventLoop::TimerId EventLoop::schedule_at(Clock::time_point deadline, TimerCallback callback) {
+    const auto id = next_timer_id_++;
+    timers_.emplace(TimerKey{deadline, id}, std::move(callback));
+    timer_deadlines_.emplace(id, deadline);
+    return id;
+}
+
+EventLoop::TimerId EventLoop::schedule_after(Clock::duration delay, TimerCallback callback) {
+    return schedule_at(Clock::now() + delay, std::move(callback));
+}
+
+void EventLoop::cancel(TimerId id) noexcept {
+    const auto found = timer_deadlines_.find(id);
+    if (found == timer_deadlines_.end()) {
+        return;
+    }
+    timers_.erase(TimerKey{found->second, id});
+    timer_deadlines_.erase(found);
+}
+
+std::size_t EventLoop::dispatch_timers() {
+    std::size_t dispatched = 0;
+    const auto now = Clock::now();
+    while (!timers_.empty() && timers_.begin()->first.first <= now) {
+        auto node = timers_.extract(timers_.begin());
+        timer_deadlines_.erase(node.key().second);
+        node.mapped()();
+        ++dispatched;
+    }
+    return dispatched;
+}
+
+std::size_t EventLoop::run_once(Clock::duration max_wait) {
+    auto wait = std::max(max_wait, Clock::duration::zero());
+    if (!timers_.empty()) {
+        wait = std::min(wait, std::max(timers_.begin()->first.first - Clock::now(), Clock::duration::zero()));
+    }
+    // Round up so a timer due in under a millisecond does not busy-spin.
+    const auto timeout_ms = std::chrono::ceil<std::chrono::milliseconds>(wait).count();
+
+    std::array<epoll_event, kMaxEventsPerWait> events{};
+    const int ready = ::epoll_wait(epoll_fd_, events.data(), kMaxEventsPerWait, static_cast<int>(timeout_ms));
+    if (ready < 0 && errno != EINTR) {
+        throw std::system_error{errno, std::generic_category(), "epoll_wait failed"};
+    }
+
+    std::size_t dispatched = 0;
+    for (int index = 0; index < ready; ++index) {
+        const auto &event = events[static_cast<std::size_t>(index)];
+        const auto found = handlers_.find(event.data.fd);
+        if (found == handlers_.end()) {
+            continue;
+        }
+        // Keep the callback alive even if it removes its own registration.
+        const auto handler = found->second;
+        (*handler)(from_epoll_events(event.events));
+        ++dispatched;
+    }
+
+    dispatched += dispatch_timers();
+    return dispatched;
+}
+
+void EventLoop::run() {
+    stopped_ = false;
+    while (!stopped_ && (!handlers_.empty() || !timers_.empty())) {
+        run_once(std::chrono::milliseconds{250});
+    }
+}
+
+} // namespace sotc::network
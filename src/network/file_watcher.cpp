@@ -0,0 +1,106 @@
+#include "network/file_watcher.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace sotc::network {
+
+namespace {
+
+// Saving a file either closes a write to it or moves a new file over it.
+constexpr std::uint32_t kWatchMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+} // namespace
+
+FileWatcher::FileWatcher(EventLoop &loop, const std::vector<std::filesystem::path> &files, FileWatcherOptions options)
+    : loop_(loop), options_(options), inotify_(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {
+    if (!inotify_) {
+        throw std::system_error{errno, std::generic_category(), "inotify_init1() failed"};
+    }
+    // One watch per directory; inotify hands back the same descriptor when a
+    // directory is added twice.
+    for (const auto &file : files) {
+        const auto absolute = std::filesystem::absolute(file).lexically_normal();
+        const auto directory = absolute.parent_path();
+        const int watch = ::inotify_add_watch(inotify_.get(), directory.c_str(), kWatchMask);
+        if (watch < 0) {
+            throw std::system_error{errno, std::generic_category(), "Unable to watch " + directory.string()};
+        }
+        watches_[watch].emplace(absolute.filename().string(), WatchedFile{file});
+    }
+    loop_.add(inotify_.get(), EventLoop::kReadable, [this](std::uint32_t) { on_readable(); });
+}
+
+FileWatcher::~FileWatcher() {
+    loop_.cancel(settle_timer_);
+    loop_.remove(inotify_.get());
+}
+
+void FileWatcher::on_readable() {
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        const auto received = ::read(inotify_.get(), buffer, sizeof(buffer));
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        if (received == 0) {
+            return;
+        }
+        for (std::size_t offset = 0; offset < static_cast<std::size_t>(received);) {
+            inotify_event event{};
+            std::memcpy(&event, buffer + offset, sizeof(event));
+            const char *name = buffer + offset + sizeof(inotify_event);
+            offset += sizeof(inotify_event) + event.len;
+            if (event.len == 0) {
+                continue;
+            }
+            const auto directory = watches_.find(event.wd);
+            if (directory == watches_.end()) {
+                continue;
+            }
+            const auto file = directory->second.find(name);
+            if (file == directory->second.end()) {
+                continue;
+            }
+            ++events_;
+            file->second.pending = true;
+            if (settle_timer_ == 0) {
+                first_event_ = Clock::now();
+                settle_timer_ = loop_.schedule_after(options_.settle, [this] {
+                    settle_timer_ = 0;
+                    notify();
+                });
+            }
+        }
+    }
+}
+
+void FileWatcher::notify() {
+    std::vector<std::filesystem::path> changed;
+    for (auto &[watch, files] : watches_) {
+        for (auto &[name, file] : files) {
+            if (file.pending) {
+                file.pending = false;
+                changed.push_back(file.path);
+            }
+        }
+    }
+    if (changed.empty()) {
+        return;
+    }
+    ++changes_;
+    if (change_callback_) {
+        change_callback_(changed, first_event_);
+    }
+}
+
+} // namespace sotc::network
@@ -0,0 +1,96 @@
+#include "network/grf_list.hpp"
+
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace sotc::network {
+
+namespace {
+
+using Storage = std::vector<std::string>;
+
+// Live lists by content hash. Entries of lists that have since been freed are
+// dropped when their bucket is next searched and in a sweep of the whole
+// table every kSweepInterval insertions.
+class InternTable {
+public:
+    [[nodiscard]] std::shared_ptr<const Storage> intern(Storage grfs) {
+        const auto hash = hash_of(grfs);
+        const std::lock_guard lock{mutex_};
+        auto &bucket = lists_[hash];
+        for (auto entry = bucket.begin(); entry != bucket.end();) {
+            auto existing = entry->lock();
+            if (existing == nullptr) {
+                entry = bucket.erase(entry);
+                continue;
+            }
+            if (*existing == grfs) {
+                return existing;
+            }
+            ++entry;
+        }
+        auto created = std::make_shared<const Storage>(std::move(grfs));
+        bucket.push_back(created);
+        if (++insertions_ % kSweepInterval == 0) {
+            sweep();
+        }
+        return created;
+    }
+
+private:
+    static constexpr std::size_t kSweepInterval = 1024;
+
+    [[nodiscard]] static std::size_t hash_of(const Storage &grfs) noexcept {
+        std::size_t hash = grfs.size();
+        for (const auto &grf : grfs) {
+            hash ^= std::hash<std::string>{}(grf) + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
+    void sweep() {
+        for (auto bucket = lists_.begin(); bucket != lists_.end();) {
+            std::erase_if(bucket->second, [](const auto &entry) { return entry.expired(); });
+            bucket = bucket->second.empty() ? lists_.erase(bucket) : std::next(bucket);
+        }
+    }
+
+    std::mutex mutex_;
+    std::unordered_map<std::size_t, std::vector<std::weak_ptr<const Storage>>> lists_;
+    std::size_t insertions_{0};
+};
+
+[[nodiscard]] InternTable &intern_table() {
+    static InternTable table;
+    return table;
+}
+
+} // namespace
+
+GrfList::GrfList(std::vector<std::string> grfs) {
+    if (!grfs.empty()) {
+        grfs_ = std::make_shared<const Storage>(std::move(grfs));
+    }
+}
+
+GrfList::GrfList(std::initializer_list<std::string_view> grfs) : GrfList(Storage(grfs.begin(), grfs.end())) {}
+
+GrfList GrfList::interned(std::vector<std::string> grfs) {
+    if (grfs.empty()) {
+        return GrfList{};
+    }
+    return GrfList{intern_table().intern(std::move(grfs))};
+}
+
+GrfList GrfList::appended(std::string grf) const {
+    Storage grfs;
+    grfs.reserve(size() + 1);
+    grfs.assign(begin(), end());
+    grfs.push_back(std::move(grf));
+    return interned(std::move(grfs));
+}
+
+} // namespace sotc::network
@@ -0,0 +1,338 @@
+#include "network/lan_discovery.hpp"
+
+#include "network/packet_framer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+namespace sotc::network {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr unsigned kMinSubnetPrefix = 16;
+
+[[nodiscard]] std::optional<std::uint16_t> parse_port(std::string_view text) {
+    unsigned value = 0;
+    const auto *end = text.data() + text.size();
+    const auto [parsed, error] = std::from_chars(text.data(), end, value);
+    if (error != std::errc{} || parsed != end || value == 0 || value > 0xFFFF) {
+        return std::nullopt;
+    }
+    return static_cast<std::uint16_t>(value);
+}
+
+[[nodiscard]] Endpoint ipv4_endpoint(std::uint32_t address, std::uint16_t port) {
+    Endpoint endpoint{};
+    auto *ipv4 = reinterpret_cast<sockaddr_in *>(&endpoint.address);
+    ipv4->sin_family = AF_INET;
+    ipv4->sin_port = htons(port);
+    ipv4->sin_addr.s_addr = htonl(address);
+    endpoint.length = sizeof(sockaddr_in);
+    return endpoint;
+}
+
+// A.B.C.D/N, expanded to its host addresses. Subnets with room for them
+// leave out the network and broadcast addresses.
+void expand_subnet(std::string_view target, std::size_t slash, std::uint16_t port, std::vector<Endpoint> &out) {
+    const std::string network_text{target.substr(0, slash)};
+    const auto prefix_text = target.substr(slash + 1);
+    unsigned prefix = 0;
+    const auto [parsed, error] = std::from_chars(prefix_text.data(), prefix_text.data() + prefix_text.size(), prefix);
+    in_addr network{};
+    if (error != std::errc{} || parsed != prefix_text.data() + prefix_text.size() || prefix > 32 ||
+        ::inet_pton(AF_INET, network_text.c_str(), &network) != 1) {
+        throw std::invalid_argument{"Invalid LAN subnet: " + std::string{target}};
+    }
+    if (prefix < kMinSubnetPrefix) {
+        throw std::invalid_argument{"LAN subnet is larger than /16: " + std::string{target}};
+    }
+
+    const auto mask = ~std::uint32_t{0} << (32 - prefix);
+    const auto first = ntohl(network.s_addr) & mask;
+    const auto last = first | ~mask;
+    const bool skip_edges = prefix < 31;
+    for (auto address = first + (skip_edges ? 1U : 0U); address <= last - (skip_edges ? 1U : 0U); ++address) {
+        out.push_back(ipv4_endpoint(address, port));
+        if (address == last) {
+            break;
+        }
+    }
+}
+
+[[nodiscard]] std::optional<std::uint16_t> read_header(std::span<const std::byte> datagram, std::uint8_t &type) {
+    if (datagram.size() < NETWORK_PACKET_HEADER_SIZE) {
+        return std::nullopt;
+    }
+    const auto total = static_cast<std::uint16_t>((std::to_integer<unsigned>(datagram[0]) << 8U) |
+                                                  std::to_integer<unsigned>(datagram[1]));
+    type = std::to_integer<std::uint8_t>(datagram[2]);
+    return total;
+}
+
+[[nodiscard]] SocketHandle open_udp_socket(int family) {
+    SocketHandle socket{::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+    if (!socket) {
+        throw std::system_error{errno, std::generic_category(), "Unable to create UDP socket"};
+    }
+    if (family == AF_INET) {
+        const int enabled = 1;
+        ::setsockopt(socket.get(), SOL_SOCKET, SO_BROADCAST, &enabled, sizeof(enabled));
+    }
+    return socket;
+}
+
+[[nodiscard]] int remaining_ms(Clock::time_point deadline) {
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now());
+    return static_cast<int>(std::max<std::chrono::milliseconds::rep>(remaining.count(), 0));
+}
+
+bool wait_writable(int fd, Clock::time_point deadline) {
+    pollfd entry{fd, POLLOUT, 0};
+    return ::poll(&entry, 1, remaining_ms(deadline)) > 0;
+}
+
+// Sends the probe to every destination of one socket, batch_size datagrams
+// per sendmmsg. A destination the kernel rejects outright is skipped.
+void send_probes(int fd, std::span<const Endpoint> destinations, std::span<const std::byte> probe,
+                 std::size_t batch_size, Clock::time_point deadline,
+                 std::unordered_map<std::string, Clock::time_point> &sent_at, LanDiscoveryResult &result) {
+    iovec payload{const_cast<std::byte *>(probe.data()), probe.size()};
+    std::vector<mmsghdr> messages(std::min(batch_size, destinations.size()));
+
+    std::size_t next = 0;
+    while (next < destinations.size()) {
+        const auto count = std::min(messages.size(), destinations.size() - next);
+        for (std::size_t index = 0; index < count; ++index) {
+            auto &header = messages[index].msg_hdr;
+            header = msghdr{};
+            header.msg_name = const_cast<sockaddr_storage *>(&destinations[next + index].address);
+            header.msg_namelen = destinations[next + index].length;
+            header.msg_iov = &payload;
+            header.msg_iovlen = 1;
+        }
+        const auto sent = ::sendmmsg(fd, messages.data(), static_cast<unsigned>(count), MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                if (!wait_writable(fd, deadline)) {
+                    return;
+                }
+                continue;
+            }
+            // The first datagram of the batch failed; drop it and carry on.
+            ++result.probes_failed;
+            ++next;
+            continue;
+        }
+        const auto now = Clock::now();
+        for (std::size_t index = 0; index < static_cast<std::size_t>(sent); ++index) {
+            sent_at.try_emplace(destinations[next + index].to_string(), now);
+        }
+        result.probes_sent += static_cast<std::size_t>(sent);
+        next += static_cast<std::size_t>(sent);
+    }
+}
+
+} // namespace
+
+std::vector<Endpoint> expand_lan_targets(const std::vector<std::string> &targets, std::uint16_t default_port) {
+    std::vector<Endpoint> endpoints;
+    for (const auto &target_string : targets) {
+        const std::string_view target{target_string};
+        if (const auto slash = target.find('/'); slash != std::string_view::npos) {
+            expand_subnet(target, slash, default_port, endpoints);
+            continue;
+        }
+
+        auto host = target;
+        auto port = std::optional<std::uint16_t>{default_port};
+        if (!host.empty() && host.front() == '[') {
+            const auto close = host.find(']');
+            if (close == std::string_view::npos) {
+                throw std::invalid_argument{"Invalid LAN target: " + target_string};
+            }
+            if (close + 1 < host.size()) {
+                port = host[close + 1] == ':' ? parse_port(host.substr(close + 2)) : std::nullopt;
+            }
+            host = host.substr(1, close - 1);
+        } else if (const auto colon = host.find(':');
+                   colon != std::string_view::npos && host.find(':', colon + 1) == std::string_view::npos) {
+            port = parse_port(host.substr(colon + 1));
+            host = host.substr(0, colon);
+        }
+        if (!port || host.empty()) {
+            throw std::invalid_argument{"Invalid LAN target: " + target_string};
+        }
+
+        const auto resolved = resolve_endpoints(std::string{host}, *port, SOCK_DGRAM);
+        if (resolved.empty()) {
+            throw std::invalid_argument{"Unable to resolve LAN target: " + target_string};
+        }
+        endpoints.push_back(resolved.front());
+    }
+
+    std::unordered_set<std::string> seen;
+    std::erase_if(endpoints, [&](const Endpoint &endpoint) { return !seen.insert(endpoint.to_string()).second; });
+    return endpoints;
+}
+
+std::vector<std::byte> build_lan_probe() {
+    std::vector<std::byte> datagram(NETWORK_PACKET_HEADER_SIZE);
+    write_packet_header(datagram, static_cast<std::uint8_t>(PacketUdpType::ClientFindServer), 0);
+    return datagram;
+}
+
+std::vector<std::byte> build_lan_response(const NetworkGameInfo &info) {
+    const auto payload = serialize_game_info(info);
+    std::vector<std::byte> datagram(NETWORK_PACKET_HEADER_SIZE);
+    write_packet_header(datagram, static_cast<std::uint8_t>(PacketUdpType::ServerResponse), payload.size());
+    datagram.insert(datagram.end(), payload.begin(), payload.end());
+    return datagram;
+}
+
+bool is_lan_probe(std::span<const std::byte> datagram) noexcept {
+    std::uint8_t type = 0;
+    const auto total = read_header(datagram, type);
+    return total && *total == datagram.size() && type == static_cast<std::uint8_t>(PacketUdpType::ClientFindServer);
+}
+
+DecodeResult<NetworkGameInfo> parse_lan_response(std::span<const std::byte> datagram) {
+    std::uint8_t type = 0;
+    const auto total = read_header(datagram, type);
+    if (!total) {
+        return DecodeResult<NetworkGameInfo>{DecodeError::Truncated, "packet header"};
+    }
+    if (*total != datagram.size()) {
+        return DecodeResult<NetworkGameInfo>{DecodeError::InvalidPacketSize, "packet header"};
+    }
+    if (type != static_cast<std::uint8_t>(PacketUdpType::ServerResponse)) {
+        return DecodeResult<NetworkGameInfo>{DecodeError::InvalidValue, "packet type"};
+    }
+    return try_parse_game_info(datagram.subspan(NETWORK_PACKET_HEADER_SIZE));
+}
+
+LanDiscoveryResult discover_local_servers(const LanDiscoveryOptions &options) {
+    const auto deadline = Clock::now() + options.timeout;
+    const auto destinations = expand_lan_targets(options.targets, options.default_port);
+    const auto batch_size = std::max<std::size_t>(options.batch_size, 1);
+
+    LanDiscoveryResult result;
+    std::vector<Endpoint> ipv4;
+    std::vector<Endpoint> ipv6;
+    for (const auto &destination : destinations) {
+        (destination.address.ss_family == AF_INET6 ? ipv6 : ipv4).push_back(destination);
+    }
+
+    std::array<SocketHandle, 2> sockets{};
+    std::vector<pollfd> watched;
+    std::unordered_map<std::string, Clock::time_point> sent_at;
+    const auto probe = build_lan_probe();
+    for (std::size_t family = 0; family < sockets.size(); ++family) {
+        const auto &group = family == 0 ? ipv4 : ipv6;
+        if (group.empty()) {
+            continue;
+        }
+        sockets[family] = open_udp_socket(family == 0 ? AF_INET : AF_INET6);
+        watched.push_back(pollfd{sockets[family].get(), POLLIN, 0});
+        send_probes(sockets[family].get(), group, probe, batch_size, deadline, sent_at, result);
+    }
+
+    // Broadcast addresses never answer themselves, so their presence keeps
+    // the loop running until the deadline.
+    auto unanswered = sent_at.size();
+    auto first_probe = Clock::now();
+    for (const auto &[destination, sent] : sent_at) {
+        first_probe = std::min(first_probe, sent);
+    }
+    std::unordered_set<std::string> responders;
+    std::vector<std::byte> buffers(batch_size * NETWORK_LAN_MAX_DATAGRAM_SIZE);
+    std::vector<sockaddr_storage> sources(batch_size);
+    std::vector<iovec> vectors(batch_size);
+    std::vector<mmsghdr> messages(batch_size);
+
+    while (!watched.empty() && unanswered > 0) {
+        const auto timeout = remaining_ms(deadline);
+        if (timeout == 0) {
+            break;
+        }
+        const auto ready = ::poll(watched.data(), watched.size(), timeout);
+        if (ready < 0 && errno != EINTR) {
+            throw std::system_error{errno, std::generic_category(), "poll() failed during LAN discovery"};
+        }
+        for (const auto &entry : watched) {
+            if ((entry.revents & POLLIN) == 0) {
+                continue;
+            }
+            for (;;) {
+                for (std::size_t index = 0; index < batch_size; ++index) {
+                    vectors[index] = iovec{buffers.data() + index * NETWORK_LAN_MAX_DATAGRAM_SIZE,
+                                           NETWORK_LAN_MAX_DATAGRAM_SIZE};
+                    auto &header = messages[index].msg_hdr;
+                    header = msghdr{};
+                    header.msg_name = &sources[index];
+                    header.msg_namelen = sizeof(sockaddr_storage);
+                    header.msg_iov = &vectors[index];
+                    header.msg_iovlen = 1;
+                }
+                const auto received =
+                    ::recvmmsg(entry.fd, messages.data(), static_cast<unsigned>(batch_size), MSG_DONTWAIT, nullptr);
+                if (received <= 0) {
+                    break;
+                }
+                const auto now = Clock::now();
+                for (std::size_t index = 0; index < static_cast<std::size_t>(received); ++index) {
+                    const auto &header = messages[index].msg_hdr;
+                    Endpoint source{};
+                    std::memcpy(&source.address, &sources[index], header.msg_namelen);
+                    source.length = header.msg_namelen;
+                    const auto key = source.to_string();
+                    if ((header.msg_flags & MSG_TRUNC) != 0) {
+                        ++result.malformed;
+                        continue;
+                    }
+                    auto parsed = parse_lan_response(
+                        std::span<const std::byte>{static_cast<const std::byte *>(vectors[index].iov_base),
+                                                   messages[index].msg_len});
+                    if (!parsed) {
+                        ++result.malformed;
+                        continue;
+                    }
+                    if (!responders.insert(key).second) {
+                        ++result.duplicates;
+                        continue;
+                    }
+                    const auto probe_sent = sent_at.find(key);
+                    if (probe_sent != sent_at.end()) {
+                        --unanswered;
+                    }
+                    const auto sent = probe_sent != sent_at.end() ? probe_sent->second : first_probe;
+                    result.servers.push_back(LanServer{source, std::move(parsed).value(), now - sent});
+                }
+                if (static_cast<std::size_t>(received) < batch_size) {
+                    break;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace sotc::network
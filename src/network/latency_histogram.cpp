@@ -0,0 +1,128 @@
+#include "network/latency_histogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace sotc::network {
+
+std::size_t LatencyHistogram::bucket_index(std::uint64_t value) noexcept {
+    if (value < kSubBuckets) {
+        return static_cast<std::size_t>(value);
+    }
+    const auto msb = static_cast<std::size_t>(std::bit_width(value)) - 1;
+    const auto shift = msb - kSubBucketBits;
+    const auto sub_bucket = static_cast<std::size_t>((value >> shift) & (kSubBuckets - 1));
+    return (msb - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+}
+
+std::uint64_t LatencyHistogram::bucket_upper_bound(std::size_t index) noexcept {
+    const auto major = index / kSubBuckets;
+    const auto sub_bucket = index % kSubBuckets;
+    if (major == 0) {
+        return sub_bucket;
+    }
+    const auto shift = major - 1;
+    const auto lower = static_cast<std::uint64_t>(kSubBuckets + sub_bucket) << shift;
+    return lower + ((std::uint64_t{1} << shift) - 1);
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds value) noexcept {
+    const auto sample = static_cast<std::uint64_t>(std::max<std::int64_t>(value.count(), 0));
+    ++buckets_[bucket_index(sample)];
+    ++count_;
+    sum_ += sample;
+    min_ = std::min(min_, sample);
+    max_ = std::max(max_, sample);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) noexcept {
+    for (std::size_t index = 0; index < kBucketCount; ++index) {
+        buckets_[index] += other.buckets_[index];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::reset() noexcept {
+    *this = LatencyHistogram{};
+}
+
+std::chrono::nanoseconds LatencyHistogram::min() const noexcept {
+    return std::chrono::nanoseconds{count_ == 0 ? 0 : static_cast<std::int64_t>(min_)};
+}
+
+std::chrono::nanoseconds LatencyHistogram::max() const noexcept {
+    return std::chrono::nanoseconds{static_cast<std::int64_t>(max_)};
+}
+
+std::chrono::nanoseconds LatencyHistogram::mean() const noexcept {
+    return std::chrono::nanoseconds{count_ == 0 ? 0 : static_cast<std::int64_t>(sum_ / count_)};
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double percentile) const noexcept {
+    if (count_ == 0) {
+        return std::chrono::nanoseconds{0};
+    }
+    const auto clamped = std::clamp(percentile, 0.0, 100.0);
+    const auto rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(clamped / 100.0 * static_cast<double>(count_))));
+
+    std::uint64_t seen = 0;
+    for (std::size_t index = 0; index < kBucketCount; ++index) {
+        seen += buckets_[index];
+        if (seen >= rank) {
+            const auto bound = std::clamp(bucket_upper_bound(index), min_, max_);
+            return std::chrono::nanoseconds{static_cast<std::int64_t>(bound)};
+        }
+    }
+    return max();
+}
+
+RttWindow::RttWindow(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {
+    samples_.reserve(capacity_);
+}
+
+void RttWindow::record(std::chrono::nanoseconds value) {
+    if (samples_.size() < capacity_) {
+        samples_.push_back(value);
+    } else {
+        samples_[next_] = value;
+    }
+    next_ = (next_ + 1) % capacity_;
+}
+
+void RttWindow::reset() noexcept {
+    samples_.clear();
+    next_ = 0;
+}
+
+std::chrono::nanoseconds RttWindow::last() const noexcept {
+    if (samples_.empty()) {
+        return std::chrono::nanoseconds{0};
+    }
+    return samples_[(next_ + capacity_ - 1) % capacity_];
+}
+
+std::chrono::nanoseconds RttWindow::min() const noexcept {
+    if (samples_.empty()) {
+        return std::chrono::nanoseconds{0};
+    }
+    return *std::min_element(samples_.begin(), samples_.end());
+}
+
+std::chrono::nanoseconds RttWindow::percentile(double percentile) const {
+    if (samples_.empty()) {
+        return std::chrono::nanoseconds{0};
+    }
+    auto sorted = samples_;
+    const auto clamped = std::clamp(percentile, 0.0, 100.0);
+    const auto rank = static_cast<std::size_t>(std::ceil(clamped / 100.0 * static_cast<double>(sorted.size())));
+    const auto index = rank == 0 ? 0 : rank - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(index), sorted.end());
+    return sorted[index];
+}
+
+} // namespace sotc::network
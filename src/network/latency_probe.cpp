@@ -0,0 +1,291 @@
+#include "network/latency_probe.hpp"
+
+#include "network/lan_discovery.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <sys/socket.h>
+
+namespace sotc::network {
+
+namespace {
+
+// Only the header is checked: a full decode of the game info is not needed
+// to time the reply.
+[[nodiscard]] bool is_lan_response(std::span<const std::byte> datagram) noexcept {
+    if (datagram.size() < NETWORK_PACKET_HEADER_SIZE) {
+        return false;
+    }
+    const auto total = (std::to_integer<std::size_t>(datagram[0]) << 8U) | std::to_integer<std::size_t>(datagram[1]);
+    return total == datagram.size() &&
+           std::to_integer<std::uint8_t>(datagram[2]) == static_cast<std::uint8_t>(PacketUdpType::ServerResponse);
+}
+
+} // namespace
+
+LatencyProber::LatencyProber(EventLoop &loop, LatencyProbeOptions options)
+    : loop_(loop), options_(std::move(options)), probe_(build_lan_probe()), buffer_(NETWORK_LAN_MAX_DATAGRAM_SIZE) {
+    options_.max_in_flight = std::max<std::size_t>(options_.max_in_flight, 1);
+}
+
+LatencyProber::~LatencyProber() { close(); }
+
+LatencyProber::EndpointId LatencyProber::add(std::string host, std::uint16_t port) {
+    if (options_.resolver == nullptr) {
+        const auto resolved = resolve_endpoints(host, port, SOCK_DGRAM);
+        if (!resolved.empty()) {
+            return add(std::move(host), port, resolved.front());
+        }
+    }
+    const auto id = endpoints_.size();
+    auto &state = endpoints_.emplace_back();
+    state.latency.host = std::move(host);
+    state.latency.port = port;
+    state.latency.rtt = RttWindow{options_.window};
+    if (options_.resolver == nullptr) {
+        if (result_callback_) {
+            result_callback_(id, state.latency);
+        }
+        return id;
+    }
+
+    state.resolving = true;
+    ++resolving_;
+    // May complete before returning when the answer is cached.
+    const auto request = options_.resolver->resolve(
+        state.latency.host, port,
+        [this, id](const std::vector<Endpoint> &endpoints) { on_resolved(id, endpoints); }, SOCK_DGRAM);
+    if (endpoints_[id].resolving) {
+        endpoints_[id].resolve_request = request;
+    }
+    return id;
+}
+
+void LatencyProber::on_resolved(EndpointId id, const std::vector<Endpoint> &endpoints) {
+    auto &state = endpoints_[id];
+    state.resolving = false;
+    state.resolve_request = 0;
+    --resolving_;
+    if (endpoints.empty()) {
+        if (result_callback_) {
+            result_callback_(id, state.latency);
+        }
+        return;
+    }
+    state.latency.endpoint = endpoints.front();
+    const auto [existing, inserted] = by_address_.try_emplace(state.latency.endpoint.to_string(), id);
+    if (!inserted) {
+        reprobe(existing->second);
+        return;
+    }
+    state.latency.resolved = true;
+    reprobe(id);
+}
+
+LatencyProber::EndpointId LatencyProber::add(std::string host, std::uint16_t port, const Endpoint &endpoint) {
+    const auto id = endpoints_.size();
+    auto &state = endpoints_.emplace_back();
+    state.latency.host = std::move(host);
+    state.latency.port = port;
+    state.latency.rtt = RttWindow{options_.window};
+    state.latency.endpoint = endpoint;
+    state.latency.resolved = true;
+
+    // Replies are matched by source address, so one address maps to one
+    // endpoint; a second add() for it just probes the first again.
+    const auto [existing, inserted] = by_address_.try_emplace(state.latency.endpoint.to_string(), id);
+    if (!inserted) {
+        endpoints_.pop_back();
+        reprobe(existing->second);
+        return existing->second;
+    }
+    reprobe(id);
+    return id;
+}
+
+void LatencyProber::reprobe(EndpointId id) {
+    auto &state = endpoints_.at(id);
+    if (!state.latency.resolved || options_.probes_per_endpoint == 0) {
+        return;
+    }
+    const bool scheduled = state.queued > 0 || state.in_flight || state.waiting;
+    state.queued += options_.probes_per_endpoint;
+    if (!scheduled) {
+        ready_.push_back(id);
+        pump();
+    }
+}
+
+void LatencyProber::close() noexcept {
+    for (auto &state : endpoints_) {
+        if (state.timer != 0) {
+            loop_.cancel(state.timer);
+            state.timer = 0;
+        }
+        if (state.resolving) {
+            options_.resolver->cancel(state.resolve_request);
+            state.resolve_request = 0;
+            state.resolving = false;
+        }
+        state.queued = 0;
+        state.in_flight = false;
+        state.waiting = false;
+    }
+    for (auto &socket : sockets_) {
+        if (socket) {
+            loop_.remove(socket.get());
+            socket.reset();
+        }
+    }
+    ready_.clear();
+    waiting_ = 0;
+    resolving_ = 0;
+    in_flight_ = 0;
+}
+
+bool LatencyProber::done(EndpointId id) const {
+    const auto &state = endpoints_.at(id);
+    return state.queued == 0 && !state.in_flight && !state.waiting && !state.resolving;
+}
+
+bool LatencyProber::idle() const noexcept {
+    return ready_.empty() && waiting_ == 0 && resolving_ == 0 && in_flight_ == 0;
+}
+
+void LatencyProber::pump() {
+    while (in_flight_ < options_.max_in_flight && !ready_.empty()) {
+        const auto id = ready_.front();
+        ready_.pop_front();
+        send_probe(id);
+    }
+}
+
+void LatencyProber::send_probe(EndpointId id) {
+    auto &state = endpoints_[id];
+    const auto &endpoint = state.latency.endpoint;
+    --state.queued;
+    ++state.latency.sent;
+
+    int fd = -1;
+    try {
+        fd = socket_for(endpoint, state.lane);
+    } catch (const std::system_error &) {
+        fd = -1;
+    }
+    state.probe_fd = fd;
+    state.sent_at = EventLoop::Clock::now();
+    if (fd < 0 || ::sendto(fd, probe_.data(), probe_.size(), MSG_NOSIGNAL,
+                           reinterpret_cast<const sockaddr *>(&endpoint.address), endpoint.length) < 0) {
+        // Refused outright (unreachable, no buffer space); counts as lost
+        // without holding a slot.
+        ++in_flight_;
+        state.in_flight = true;
+        finish_probe(id, false, state.sent_at);
+        return;
+    }
+
+    state.in_flight = true;
+    ++in_flight_;
+    peak_in_flight_ = std::max(peak_in_flight_, in_flight_);
+    state.timer = loop_.schedule_after(options_.probe_timeout, [this, id] {
+        endpoints_[id].timer = 0;
+        finish_probe(id, false, EventLoop::Clock::now());
+        pump();
+    });
+}
+
+void LatencyProber::finish_probe(EndpointId id, bool replied, EventLoop::Clock::time_point now) {
+    auto &state = endpoints_[id];
+    state.in_flight = false;
+    --in_flight_;
+    if (state.timer != 0) {
+        loop_.cancel(state.timer);
+        state.timer = 0;
+    }
+    if (replied) {
+        const auto round_trip = std::chrono::duration_cast<std::chrono::nanoseconds>(now - state.sent_at);
+        state.latency.rtt.record(round_trip);
+        histogram_.record(round_trip);
+        ++state.latency.received;
+    } else {
+        ++state.latency.lost;
+        // Its reply may still arrive; it must not answer the next probe.
+        state.lane ^= 1U;
+    }
+
+    if (state.queued > 0) {
+        if (options_.probe_interval > EventLoop::Clock::duration::zero()) {
+            state.waiting = true;
+            ++waiting_;
+            state.timer = loop_.schedule_after(options_.probe_interval, [this, id] {
+                auto &waiting = endpoints_[id];
+                waiting.timer = 0;
+                waiting.waiting = false;
+                --waiting_;
+                ready_.push_back(id);
+                pump();
+            });
+        } else {
+            ready_.push_back(id);
+        }
+    }
+
+    if (result_callback_) {
+        result_callback_(id, state.latency);
+    }
+}
+
+void LatencyProber::on_readable(int fd) {
+    for (;;) {
+        sockaddr_storage source{};
+        socklen_t source_length = sizeof(source);
+        const auto received = ::recvfrom(fd, buffer_.data(), buffer_.size(), MSG_DONTWAIT,
+                                         reinterpret_cast<sockaddr *>(&source), &source_length);
+        if (received < 0) {
+            // An ICMP error reported for some earlier probe; that probe will
+            // time out on its own.
+            if (errno == EINTR || errno == ECONNREFUSED || errno == EHOSTUNREACH || errno == ENETUNREACH) {
+                continue;
+            }
+            break;
+        }
+        const auto now = EventLoop::Clock::now();
+        if (!is_lan_response({buffer_.data(), static_cast<std::size_t>(received)})) {
+            continue;
+        }
+        Endpoint sender{};
+        sender.address = source;
+        sender.length = source_length;
+        const auto found = by_address_.find(sender.to_string());
+        if (found == by_address_.end()) {
+            continue;
+        }
+        auto &state = endpoints_[found->second];
+        if (!state.in_flight || state.probe_fd != fd) {
+            ++state.latency.late;
+            continue;
+        }
+        finish_probe(found->second, true, now);
+    }
+    pump();
+}
+
+int LatencyProber::socket_for(const Endpoint &endpoint, std::size_t lane) {
+    const auto family = endpoint.address.ss_family;
+    auto &socket = sockets_[(family == AF_INET6 ? 2 : 0) + lane];
+    if (!socket) {
+        SocketHandle opened{::socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+        if (!opened) {
+            throw std::system_error{errno, std::generic_category(), "Unable to create UDP socket"};
+        }
+        const int fd = opened.get();
+        loop_.add(fd, EventLoop::kReadable, [this, fd](std::uint32_t) { on_readable(fd); });
+        socket = std::move(opened);
+    }
+    return socket.get();
+}
+
+} // namespace sotc::network
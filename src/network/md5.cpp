@@ -0,0 +1,133 @@
+#include "network/md5.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <string_view>
+
+namespace sotc::network {
+
+namespace {
+
+constexpr std::array<std::uint32_t, 64> kSines{
+    0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+    0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+    0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+    0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+    0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+    0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+    0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+    0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+};
+
+constexpr std::array<int, 16> kShifts{7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21};
+
+[[nodiscard]] std::uint32_t load_le32(const std::uint8_t *bytes) noexcept {
+    return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8U) |
+           (static_cast<std::uint32_t>(bytes[2]) << 16U) | (static_cast<std::uint32_t>(bytes[3]) << 24U);
+}
+
+} // namespace
+
+void Md5::reset() noexcept {
+    state_ = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+    length_ = 0;
+}
+
+void Md5::transform(const std::uint8_t *block) noexcept {
+    std::array<std::uint32_t, 16> words{};
+    for (std::size_t index = 0; index < words.size(); ++index) {
+        words[index] = load_le32(block + index * 4);
+    }
+
+    auto a = state_[0];
+    auto b = state_[1];
+    auto c = state_[2];
+    auto d = state_[3];
+    for (std::size_t round = 0; round < 64; ++round) {
+        std::uint32_t mixed = 0;
+        std::size_t word = 0;
+        switch (round / 16) {
+        case 0:
+            mixed = (b & c) | (~b & d);
+            word = round;
+            break;
+        case 1:
+            mixed = (d & b) | (~d & c);
+            word = (5 * round + 1) % 16;
+            break;
+        case 2:
+            mixed = b ^ c ^ d;
+            word = (3 * round + 5) % 16;
+            break;
+        default:
+            mixed = c ^ (b | ~d);
+            word = (7 * round) % 16;
+            break;
+        }
+        const auto rotated = std::rotl(a + mixed + kSines[round] + words[word], kShifts[(round / 16) * 4 + round % 4]);
+        a = d;
+        d = c;
+        c = b;
+        b += rotated;
+    }
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+}
+
+void Md5::update(std::span<const std::byte> data) noexcept {
+    auto buffered = static_cast<std::size_t>(length_ % buffer_.size());
+    length_ += data.size();
+    const auto *bytes = reinterpret_cast<const std::uint8_t *>(data.data());
+    auto remaining = data.size();
+
+    if (buffered != 0) {
+        const auto take = std::min(remaining, buffer_.size() - buffered);
+        std::memcpy(buffer_.data() + buffered, bytes, take);
+        buffered += take;
+        bytes += take;
+        remaining -= take;
+        if (buffered < buffer_.size()) {
+            return;
+        }
+        transform(buffer_.data());
+    }
+    // Whole blocks are hashed straight from the caller's buffer.
+    for (; remaining >= buffer_.size(); remaining -= buffer_.size(), bytes += buffer_.size()) {
+        transform(bytes);
+    }
+    std::memcpy(buffer_.data(), bytes, remaining);
+}
+
+Md5Digest Md5::finish() noexcept {
+    const auto bit_length = length_ * 8;
+    const auto buffered = static_cast<std::size_t>(length_ % buffer_.size());
+    std::array<std::uint8_t, 72> padding{};
+    padding[0] = 0x80;
+    const auto padding_size = (buffered < 56 ? 56 : 120) - buffered;
+    for (std::size_t index = 0; index < 8; ++index) {
+        padding[padding_size + index] = static_cast<std::uint8_t>(bit_length >> (8 * index));
+    }
+    update(std::as_bytes(std::span{padding.data(), padding_size + 8}));
+
+    Md5Digest digest{};
+    for (std::size_t index = 0; index < digest.size(); ++index) {
+        digest[index] = static_cast<std::uint8_t>(state_[index / 4] >> (8 * (index % 4)));
+    }
+    reset();
+    return digest;
+}
+
+std::string to_hex(const Md5Digest &digest) {
+    constexpr std::string_view digits = "0123456789abcdef";
+    std::string text(digest.size() * 2, '0');
+    for (std::size_t index = 0; index < digest.size(); ++index) {
+        text[index * 2] = digits[digest[index] >> 4U];
+        text[index * 2 + 1] = digits[digest[index] & 0xFU];
+    }
+    return text;
+}
+
+} // namespace sotc::network
@@ -0,0 +1,40 @@
+#include "network/newgrf_set.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace sotc::network {
+
+NewGrfSet::NewGrfSet(std::vector<NewGrfIdentity> identities) : identities_(std::move(identities)) {
+    std::sort(identities_.begin(), identities_.end());
+    identities_.erase(std::unique(identities_.begin(), identities_.end()), identities_.end());
+}
+
+bool NewGrfSet::insert(const NewGrfIdentity &identity) {
+    const auto position = std::lower_bound(identities_.begin(), identities_.end(), identity);
+    if (position != identities_.end() && *position == identity) {
+        return false;
+    }
+    identities_.insert(position, identity);
+    return true;
+}
+
+bool NewGrfSet::contains(const NewGrfIdentity &identity) const noexcept {
+    return std::binary_search(identities_.begin(), identities_.end(), identity);
+}
+
+bool NewGrfSet::includes(std::span<const NewGrfIdentity> sorted) const noexcept {
+    return std::includes(identities_.begin(), identities_.end(), sorted.begin(), sorted.end());
+}
+
+std::vector<NewGrfIdentity> NewGrfSet::missing(std::span<const NewGrfIdentity> required) const {
+    std::vector<NewGrfIdentity> result;
+    for (const auto &identity : required) {
+        if (!contains(identity)) {
+            result.push_back(identity);
+        }
+    }
+    return result;
+}
+
+} // namespace sotc::network
@@ -0,0 +1,117 @@
+#include "network/packet_framer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace sotc::network {
+
+std::span<const std::byte> FramedPacket::linearize(std::vector<std::byte> &scratch) const {
+    if (contiguous()) {
+        return first;
+    }
+    scratch.resize(size());
+    std::memcpy(scratch.data(), first.data(), first.size());
+    std::memcpy(scratch.data() + first.size(), second.data(), second.size());
+    return scratch;
+}
+
+void write_packet_header(std::span<std::byte> buffer, std::uint8_t type, std::size_t payload_size) {
+    const auto total = NETWORK_PACKET_HEADER_SIZE + payload_size;
+    if (total > 0xFFFF) {
+        throw std::length_error{"Packet too large for the uint16 size header"};
+    }
+    if (buffer.size() < NETWORK_PACKET_HEADER_SIZE) {
+        throw std::length_error{"Packet header buffer is too small"};
+    }
+    buffer[0] = static_cast<std::byte>((total >> 8) & 0xFF);
+    buffer[1] = static_cast<std::byte>(total & 0xFF);
+    buffer[2] = static_cast<std::byte>(type);
+}
+
+PacketFramer::PacketFramer(std::size_t capacity, std::size_t max_packet_size)
+    : max_packet_size_(max_packet_size) {
+    if (max_packet_size < NETWORK_PACKET_HEADER_SIZE || max_packet_size > 0xFFFF) {
+        throw std::invalid_argument{"Packet framer maximum packet size is out of range"};
+    }
+    // A power-of-two capacity turns ring positions into a single mask.
+    buffer_.resize(std::bit_ceil(std::max(capacity, max_packet_size)));
+    mask_ = buffer_.size() - 1;
+}
+
+std::span<std::byte> PacketFramer::prepare() noexcept {
+    const auto start = tail_ & mask_;
+    const auto contiguous = std::min(free_space(), capacity() - start);
+    return std::span<std::byte>{buffer_.data() + start, contiguous};
+}
+
+void PacketFramer::commit(std::size_t bytes) noexcept {
+    tail_ += std::min(bytes, free_space());
+}
+
+std::size_t PacketFramer::feed(std::span<const std::byte> data) noexcept {
+    std::size_t accepted = 0;
+    while (accepted < data.size()) {
+        const auto region = prepare();
+        if (region.empty()) {
+            break;
+        }
+        const auto chunk = std::min(region.size(), data.size() - accepted);
+        std::memcpy(region.data(), data.data() + accepted, chunk);
+        commit(chunk);
+        accepted += chunk;
+    }
+    return accepted;
+}
+
+std::optional<FramedPacket> PacketFramer::front() noexcept {
+    if (failed() || buffered() < 2) {
+        return std::nullopt;
+    }
+
+    const auto high = std::to_integer<std::size_t>(at(head_));
+    const auto low = std::to_integer<std::size_t>(at(head_ + 1));
+    const auto packet_size = (high << 8U) | low;
+    if (packet_size < NETWORK_PACKET_HEADER_SIZE || packet_size > max_packet_size_) {
+        error_ = DecodeError::InvalidPacketSize;
+        return std::nullopt;
+    }
+    if (buffered() < packet_size) {
+        return std::nullopt;
+    }
+
+    front_size_ = packet_size;
+
+    FramedPacket packet{};
+    packet.type = std::to_integer<std::uint8_t>(at(head_ + 2));
+    const auto payload_start = (head_ + NETWORK_PACKET_HEADER_SIZE) & mask_;
+    const auto payload_size = packet_size - NETWORK_PACKET_HEADER_SIZE;
+    const auto first_size = std::min(payload_size, capacity() - payload_start);
+    packet.first = std::span<const std::byte>{buffer_.data() + payload_start, first_size};
+    packet.second = std::span<const std::byte>{buffer_.data(), payload_size - first_size};
+    return packet;
+}
+
+void PacketFramer::pop_front() noexcept {
+    if (front_size_ == 0 && !front()) {
+        return;
+    }
+    head_ += front_size_;
+    front_size_ = 0;
+    if (head_ == tail_) {
+        // Restart at the beginning of the ring so later packets are less
+        // likely to wrap.
+        head_ = 0;
+        tail_ = 0;
+    }
+}
+
+void PacketFramer::reset() noexcept {
+    head_ = 0;
+    tail_ = 0;
+    front_size_ = 0;
+    error_ = DecodeError::None;
+}
+
+} // namespace sotc::network
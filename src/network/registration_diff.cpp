@@ -0,0 +1,66 @@
+#include "network/registration_diff.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace sotc::network {
+
+std::string_view to_string(RegistrationChange change) noexcept {
+    switch (change) {
+    case RegistrationChange::Unchanged:
+        return "unchanged";
+    case RegistrationChange::Patched:
+        return "patched";
+    case RegistrationChange::Reregistered:
+        return "re-registered";
+    case RegistrationChange::Added:
+        return "added";
+    case RegistrationChange::Removed:
+        return "removed";
+    }
+    return "unknown";
+}
+
+std::vector<RegistrationDiffEntry> diff_registrations(std::span<const RegistrationConfig> before,
+                                                      std::span<const RegistrationConfig> after) {
+    // (listen port, index) sorted, so equal ports keep their list order.
+    std::vector<std::pair<std::uint16_t, std::size_t>> ports;
+    ports.reserve(before.size());
+    for (std::size_t index = 0; index < before.size(); ++index) {
+        ports.emplace_back(before[index].listen_port, index);
+    }
+    std::sort(ports.begin(), ports.end());
+
+    std::vector<bool> matched(before.size(), false);
+    std::vector<RegistrationDiffEntry> entries;
+    entries.reserve(std::max(before.size(), after.size()));
+    for (std::size_t index = 0; index < after.size(); ++index) {
+        const auto &config = after[index];
+        auto candidate = std::lower_bound(ports.begin(), ports.end(), std::pair{config.listen_port, std::size_t{0}});
+        while (candidate != ports.end() && candidate->first == config.listen_port && matched[candidate->second]) {
+            ++candidate;
+        }
+        if (candidate == ports.end() || candidate->first != config.listen_port) {
+            entries.push_back(RegistrationDiffEntry{RegistrationChange::Added, RegistrationDiffEntry::kNone, index});
+            continue;
+        }
+        matched[candidate->second] = true;
+        const auto &previous = before[candidate->second];
+        auto change = RegistrationChange::Unchanged;
+        if (previous.coordinator_host != config.coordinator_host ||
+            previous.coordinator_port != config.coordinator_port) {
+            change = RegistrationChange::Reregistered;
+        } else if (previous != config) {
+            change = RegistrationChange::Patched;
+        }
+        entries.push_back(RegistrationDiffEntry{change, candidate->second, index});
+    }
+    for (std::size_t index = 0; index < before.size(); ++index) {
+        if (!matched[index]) {
+            entries.push_back(RegistrationDiffEntry{RegistrationChange::Removed, index, RegistrationDiffEntry::kNone});
+        }
+    }
+    return entries;
+}
+
+} // namespace sotc::network
@@ -0,0 +1,320 @@
+#include "network/server_index.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace sotc::network {
+
+namespace {
+
+// Packs eight 0/1 bytes into the low eight bits, first byte lowest.
+[[nodiscard]] std::uint64_t pack_lanes(const std::uint8_t *lanes) noexcept {
+    std::uint64_t bytes = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+        std::memcpy(&bytes, lanes, sizeof(bytes));
+    } else {
+        for (std::size_t lane = 0; lane < 8; ++lane) {
+            bytes |= static_cast<std::uint64_t>(lanes[lane]) << (lane * 8);
+        }
+    }
+    return (bytes * 0x0102040810204080ULL) >> 56U;
+}
+
+// ANDs pred(column[row]) into the selection. Each full word is evaluated as
+// 64 independent byte-wide comparisons, which the compiler vectorises, and
+// then packed into bits; words already empty are skipped.
+template <typename T, typename Pred>
+void scan(std::span<const T> column, SelectionBitmap &selection, Pred pred) {
+    auto words = selection.words();
+    const auto full_words = column.size() / 64;
+    std::array<std::uint8_t, 64> lanes{};
+    for (std::size_t word = 0; word < full_words; ++word) {
+        if (words[word] == 0) {
+            continue;
+        }
+        const auto *values = column.data() + word * 64;
+        for (std::size_t lane = 0; lane < lanes.size(); ++lane) {
+            lanes[lane] = pred(values[lane]) ? 1U : 0U;
+        }
+        std::uint64_t bits = 0;
+        for (std::size_t group = 0; group < 8; ++group) {
+            bits |= pack_lanes(lanes.data() + group * 8) << (group * 8);
+        }
+        words[word] &= bits;
+    }
+    if (full_words < words.size()) {
+        std::uint64_t bits = 0;
+        for (auto row = full_words * 64; row < column.size(); ++row) {
+            bits |= static_cast<std::uint64_t>(pred(column[row])) << (row - full_words * 64);
+        }
+        words[full_words] &= bits;
+    }
+}
+
+// Stable, so equal keys keep ascending row order in both directions.
+template <typename T, typename Key>
+void sort_rows(std::vector<std::uint32_t> &rows, const std::vector<T> &column, bool descending, Key key) {
+    std::stable_sort(rows.begin(), rows.end(), [&](std::uint32_t lhs, std::uint32_t rhs) {
+        return descending ? key(column[rhs]) < key(column[lhs]) : key(column[lhs]) < key(column[rhs]);
+    });
+}
+
+} // namespace
+
+SelectionBitmap::SelectionBitmap(std::size_t size, bool selected)
+    : words_((size + 63) / 64, selected ? ~std::uint64_t{0} : 0), size_(size) {
+    if (selected && size % 64 != 0) {
+        words_.back() = (std::uint64_t{1} << (size % 64)) - 1;
+    }
+}
+
+std::size_t SelectionBitmap::count() const noexcept {
+    std::size_t total = 0;
+    for (const auto word : words_) {
+        total += static_cast<std::size_t>(std::popcount(word));
+    }
+    return total;
+}
+
+SelectionBitmap &SelectionBitmap::operator&=(const SelectionBitmap &other) noexcept {
+    const auto common = std::min(words_.size(), other.words_.size());
+    for (std::size_t word = 0; word < common; ++word) {
+        words_[word] &= other.words_[word];
+    }
+    std::fill(words_.begin() + static_cast<std::ptrdiff_t>(common), words_.end(), 0);
+    return *this;
+}
+
+std::uint32_t StringInterner::intern(std::string_view value) {
+    if (const auto found = ids_.find(value); found != ids_.end()) {
+        return found->second;
+    }
+    const auto id = static_cast<std::uint32_t>(strings_.size());
+    const auto &stored = strings_.emplace_back(value);
+    ids_.emplace(stored, id);
+    return id;
+}
+
+std::optional<std::uint32_t> StringInterner::find(std::string_view value) const {
+    if (const auto found = ids_.find(value); found != ids_.end()) {
+        return found->second;
+    }
+    return std::nullopt;
+}
+
+void StringInterner::clear() noexcept {
+    ids_.clear();
+    strings_.clear();
+}
+
+std::uint32_t ServerIndex::add(const ServerListingEntry &entry, ServerGameType game_type,
+                               std::uint8_t nat_capabilities) {
+    if (size() >= std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error{"Server index is full"};
+    }
+    const auto row = static_cast<std::uint32_t>(size());
+    const auto &info = entry.info;
+    clients_on_.push_back(info.clients_on);
+    clients_max_.push_back(info.clients_max);
+    free_slots_.push_back(info.clients_max > info.clients_on
+                              ? static_cast<std::uint8_t>(info.clients_max - info.clients_on)
+                              : std::uint8_t{0});
+    companies_on_.push_back(info.companies_on);
+    game_types_.push_back(static_cast<std::uint8_t>(game_type));
+    nat_capabilities_.push_back(nat_capabilities);
+    flags_.push_back(static_cast<std::uint8_t>((info.use_password ? kFlagPassword : 0U) |
+                                               (info.dedicated ? kFlagDedicated : 0U)));
+    revision_ids_.push_back(strings_.intern(info.server_revision));
+    name_ids_.push_back(strings_.intern(info.server_name));
+    connection_ids_.push_back(strings_.intern(entry.connection_string));
+    for (const auto &identity : info.newgrfs) {
+        const auto [found, inserted] =
+            newgrf_ids_.try_emplace(identity, static_cast<std::uint32_t>(newgrf_dictionary_.size()));
+        if (inserted) {
+            newgrf_dictionary_.push_back(identity);
+            newgrf_rows_.emplace_back();
+            const auto position = std::lower_bound(
+                newgrf_order_.begin(), newgrf_order_.end(), identity,
+                [this](std::uint32_t id, const NewGrfIdentity &value) { return newgrf_dictionary_[id] < value; });
+            newgrf_order_.insert(position, found->second);
+        }
+        newgrf_refs_.push_back(found->second);
+        auto &rows = newgrf_rows_[found->second];
+        if (rows.empty() || rows.back() != row) {
+            rows.push_back(row);
+        }
+    }
+    newgrf_offsets_.push_back(static_cast<std::uint32_t>(newgrf_refs_.size()));
+    ++generation_;
+    return row;
+}
+
+void ServerIndex::clear() noexcept {
+    strings_.clear();
+    clients_on_.clear();
+    clients_max_.clear();
+    free_slots_.clear();
+    companies_on_.clear();
+    game_types_.clear();
+    nat_capabilities_.clear();
+    flags_.clear();
+    revision_ids_.clear();
+    name_ids_.clear();
+    connection_ids_.clear();
+    newgrf_offsets_.assign(1, 0);
+    newgrf_refs_.clear();
+    newgrf_dictionary_.clear();
+    newgrf_ids_.clear();
+    newgrf_order_.clear();
+    newgrf_rows_.clear();
+    ++generation_;
+}
+
+void ServerIndex::reserve(std::size_t rows) {
+    clients_on_.reserve(rows);
+    clients_max_.reserve(rows);
+    free_slots_.reserve(rows);
+    companies_on_.reserve(rows);
+    game_types_.reserve(rows);
+    nat_capabilities_.reserve(rows);
+    flags_.reserve(rows);
+    revision_ids_.reserve(rows);
+    name_ids_.reserve(rows);
+    connection_ids_.reserve(rows);
+    newgrf_offsets_.reserve(rows + 1);
+}
+
+SelectionBitmap ServerIndex::joinable(const NewGrfSet &installed) const {
+    SelectionBitmap selection{size(), true};
+    // Merge join: both sides ascend, so each is walked once.
+    const auto identities = installed.identities();
+    auto candidate = identities.begin();
+    for (const auto id : newgrf_order_) {
+        const auto &identity = newgrf_dictionary_[id];
+        while (candidate != identities.end() && *candidate < identity) {
+            ++candidate;
+        }
+        if (candidate != identities.end() && *candidate == identity) {
+            continue;
+        }
+        for (const auto row : newgrf_rows_[id]) {
+            selection.reset(row);
+        }
+    }
+    return selection;
+}
+
+std::vector<NewGrfIdentity> ServerIndex::missing_newgrfs(std::uint32_t row, const NewGrfSet &installed) const {
+    std::vector<NewGrfIdentity> missing;
+    for (auto ref = newgrf_offsets_.at(row); ref < newgrf_offsets_.at(row + 1); ++ref) {
+        const auto &identity = newgrf_dictionary_[newgrf_refs_[ref]];
+        if (!installed.contains(identity)) {
+            missing.push_back(identity);
+        }
+    }
+    return missing;
+}
+
+SelectionBitmap ServerIndex::filter(const ServerFilter &filter) const {
+    SelectionBitmap selection{size(), true};
+    const std::span<const std::uint8_t> clients_on{clients_on_};
+
+    if (filter.min_clients) {
+        scan(clients_on, selection, [min = *filter.min_clients](std::uint8_t value) { return value >= min; });
+    }
+    if (filter.max_clients) {
+        scan(clients_on, selection, [max = *filter.max_clients](std::uint8_t value) { return value <= max; });
+    }
+    if (filter.min_free_slots) {
+        scan(std::span<const std::uint8_t>{free_slots_}, selection,
+             [min = *filter.min_free_slots](std::uint8_t value) { return value >= min; });
+    }
+    if (filter.game_type) {
+        scan(std::span<const std::uint8_t>{game_types_}, selection,
+             [type = static_cast<std::uint8_t>(*filter.game_type)](std::uint8_t value) { return value == type; });
+    }
+    if (filter.required_nat_capabilities != 0) {
+        scan(std::span<const std::uint8_t>{nat_capabilities_}, selection,
+             [mask = filter.required_nat_capabilities](std::uint8_t value) { return (value & mask) == mask; });
+    }
+    if (filter.use_password || filter.dedicated) {
+        unsigned mask = 0;
+        unsigned expected = 0;
+        if (filter.use_password) {
+            mask |= kFlagPassword;
+            expected |= *filter.use_password ? kFlagPassword : 0U;
+        }
+        if (filter.dedicated) {
+            mask |= kFlagDedicated;
+            expected |= *filter.dedicated ? kFlagDedicated : 0U;
+        }
+        scan(std::span<const std::uint8_t>{flags_}, selection,
+             [mask, expected](std::uint8_t value) { return (value & mask) == expected; });
+    }
+    if (filter.revision) {
+        const auto id = strings_.find(*filter.revision);
+        if (!id) {
+            return SelectionBitmap{size(), false};
+        }
+        scan(std::span<const std::uint32_t>{revision_ids_}, selection,
+             [id = *id](std::uint32_t value) { return value == id; });
+    }
+    return selection;
+}
+
+void ServerIndex::build_sorted(ServerSortKey key, bool descending, std::vector<std::uint32_t> &rows) const {
+    const auto value = [](auto column_value) { return column_value; };
+    const auto string = [this](std::uint32_t id) -> const std::string & { return strings_.at(id); };
+    switch (key) {
+    case ServerSortKey::Name:
+        sort_rows(rows, name_ids_, descending, string);
+        break;
+    case ServerSortKey::Clients:
+        sort_rows(rows, clients_on_, descending, value);
+        break;
+    case ServerSortKey::FreeSlots:
+        sort_rows(rows, free_slots_, descending, value);
+        break;
+    case ServerSortKey::Companies:
+        sort_rows(rows, companies_on_, descending, value);
+        break;
+    case ServerSortKey::GameType:
+        sort_rows(rows, game_types_, descending, value);
+        break;
+    case ServerSortKey::Revision:
+        sort_rows(rows, revision_ids_, descending, string);
+        break;
+    }
+}
+
+std::span<const std::uint32_t> ServerIndex::sorted(ServerSortKey key, bool descending) {
+    auto &cache = sort_cache_.at(static_cast<std::size_t>(key) + (descending ? SERVER_SORT_KEY_COUNT : 0));
+    if (!cache.valid || cache.generation != generation_) {
+        cache.rows.resize(size());
+        for (std::size_t row = 0; row < cache.rows.size(); ++row) {
+            cache.rows[row] = static_cast<std::uint32_t>(row);
+        }
+        build_sorted(key, descending, cache.rows);
+        cache.generation = generation_;
+        cache.valid = true;
+    }
+    return cache.rows;
+}
+
+std::vector<std::uint32_t> ServerIndex::select_sorted(const SelectionBitmap &selection, ServerSortKey key,
+                                                      bool descending) {
+    std::vector<std::uint32_t> rows;
+    rows.reserve(selection.count());
+    for (const auto row : sorted(key, descending)) {
+        if (row < selection.size() && selection.test(row)) {
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+} // namespace sotc::network
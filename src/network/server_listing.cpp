@@ -0,0 +1,471 @@
+#include "network/server_listing.hpp"
+
+#include "network/packet_codec.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace sotc::network {
+
+namespace {
+
+using ClientListingSchema = codec::PacketSchema<
+    CoordinatorClientListing,
+    codec::UInt8Field<&CoordinatorClientListing::coordinator_version>,
+    codec::UInt8Field<&CoordinatorClientListing::game_info_version>,
+    codec::StringField<&CoordinatorClientListing::revision, NETWORK_MAX_REVISION_LENGTH, "revision">,
+    codec::UInt32Field<&CoordinatorClientListing::newgrf_lookup_cursor>>;
+
+constexpr std::size_t kNewGrfIdentitySize = 4 + 16;
+constexpr std::size_t kListingHeaderSize = 2;
+
+// Sequential reader that remembers the first failure and the field it hit,
+// so the decode paths can chain reads and check once.
+class Reader {
+public:
+    explicit Reader(std::span<const std::byte> payload) noexcept : payload_(payload) {}
+
+    bool u8(std::uint8_t &out, std::string_view field) noexcept {
+        return check(codec::detail::read_uint8(payload_, offset_, out), field);
+    }
+    bool u16(std::uint16_t &out, std::string_view field) noexcept {
+        return check(codec::detail::read_uint16_be(payload_, offset_, out), field);
+    }
+    bool u32(std::uint32_t &out, std::string_view field) noexcept {
+        return check(codec::detail::read_uint32_be(payload_, offset_, out), field);
+    }
+    bool u64(std::uint64_t &out, std::string_view field) noexcept {
+        std::uint32_t high = 0;
+        std::uint32_t low = 0;
+        if (!u32(high, field) || !u32(low, field)) {
+            return false;
+        }
+        out = (static_cast<std::uint64_t>(high) << 32U) | low;
+        return true;
+    }
+    bool boolean(bool &out, std::string_view field) noexcept {
+        std::uint8_t value = 0;
+        if (!u8(value, field)) {
+            return false;
+        }
+        out = value != 0;
+        return true;
+    }
+    bool string(std::string &out, std::size_t max_length, std::string_view field) {
+        std::string_view value;
+        if (!check(codec::detail::read_string_view(payload_, offset_, max_length, value), field)) {
+            return false;
+        }
+        out.assign(value);
+        return true;
+    }
+    bool identity(NewGrfIdentity &out, std::string_view field) noexcept {
+        if (!u32(out.grfid, field)) {
+            return false;
+        }
+        if (payload_.size() - offset_ < out.md5.size()) {
+            return fail(DecodeError::Truncated, field);
+        }
+        std::memcpy(out.md5.data(), payload_.data() + offset_, out.md5.size());
+        offset_ += out.md5.size();
+        return true;
+    }
+
+    bool fail(DecodeError error, std::string_view field) noexcept {
+        error_ = error;
+        field_ = field;
+        return false;
+    }
+
+    [[nodiscard]] bool at_end() const noexcept { return offset_ == payload_.size(); }
+    [[nodiscard]] DecodeError error() const noexcept { return error_; }
+    [[nodiscard]] std::string_view field() const noexcept { return field_; }
+
+private:
+    bool check(DecodeError error, std::string_view field) noexcept {
+        return error == DecodeError::None || fail(error, field);
+    }
+
+    std::span<const std::byte> payload_;
+    std::size_t offset_{0};
+    DecodeError error_{DecodeError::None};
+    std::string_view field_{};
+};
+
+// The game info block from its version byte on. table resolves LookupId
+// serialised NewGRFs; without one that serialisation is rejected.
+bool read_game_info(Reader &reader, const NewGrfLookupTable *table, NetworkGameInfo &info,
+                    std::size_t &unresolved_newgrfs) {
+    std::uint8_t version = 0;
+    if (!reader.u8(version, "game info")) {
+        return false;
+    }
+    if (version != NETWORK_GAME_INFO_VERSION) {
+        return reader.fail(DecodeError::UnsupportedVersion, "game info");
+    }
+
+    std::uint8_t serialization = 0;
+    std::uint8_t grf_count = 0;
+    if (!reader.u64(info.ticks_playing, "ticks playing") || !reader.u8(serialization, "NewGRF serialisation") ||
+        !reader.u32(info.gamescript_version, "game script version") ||
+        !reader.string(info.gamescript_name, NETWORK_MAX_GAMESCRIPT_NAME_LENGTH, "game script name") ||
+        !reader.u8(grf_count, "NewGRF count")) {
+        return false;
+    }
+    if (serialization > static_cast<std::uint8_t>(NewGrfSerialization::LookupId) ||
+        (table == nullptr && serialization == static_cast<std::uint8_t>(NewGrfSerialization::LookupId))) {
+        return reader.fail(DecodeError::InvalidValue, "NewGRF serialisation");
+    }
+
+    info.newgrfs.clear();
+    unresolved_newgrfs = 0;
+    std::string ignored_name;
+    for (std::size_t index = 0; index < grf_count; ++index) {
+        if (serialization == static_cast<std::uint8_t>(NewGrfSerialization::LookupId)) {
+            std::uint32_t lookup = 0;
+            if (!reader.u32(lookup, "NewGRF lookup index")) {
+                return false;
+            }
+            if (const auto *found = table->find(lookup)) {
+                info.newgrfs.push_back(found->identity);
+            } else {
+                ++unresolved_newgrfs;
+            }
+            continue;
+        }
+        NewGrfIdentity identity{};
+        if (!reader.identity(identity, "NewGRF identity")) {
+            return false;
+        }
+        if (serialization == static_cast<std::uint8_t>(NewGrfSerialization::GrfIdMd5Name) &&
+            !reader.string(ignored_name, NETWORK_MAX_NEWGRF_NAME_LENGTH, "NewGRF name")) {
+            return false;
+        }
+        info.newgrfs.push_back(identity);
+    }
+
+    return reader.u32(info.game_date, "game date") && reader.u32(info.start_date, "start date") &&
+           reader.u8(info.companies_max, "companies max") && reader.u8(info.companies_on, "companies on") &&
+           reader.u8(info.spectators_max, "spectators max") &&
+           reader.string(info.server_name, NETWORK_MAX_SERVER_NAME_LENGTH, "server name") &&
+           reader.string(info.server_revision, NETWORK_MAX_REVISION_LENGTH, "server revision") &&
+           reader.boolean(info.use_password, "password flag") && reader.u8(info.clients_max, "clients max") &&
+           reader.u8(info.clients_on, "clients on") && reader.u8(info.spectators_on, "spectators on") &&
+           reader.u16(info.map_width, "map width") && reader.u16(info.map_height, "map height") &&
+           reader.u8(info.landscape, "landscape") && reader.boolean(info.dedicated, "dedicated flag");
+}
+
+bool read_listing_entry(Reader &reader, const NewGrfLookupTable &table, ServerListingEntry &entry) {
+    return reader.string(entry.connection_string, NETWORK_MAX_CONNECTION_STRING_LENGTH, "connection string") &&
+           read_game_info(reader, &table, entry.info, entry.unresolved_newgrfs);
+}
+
+// Growable payload writer on top of the codec's fixed-buffer writers.
+class Writer {
+public:
+    explicit Writer(std::vector<std::byte> &buffer) : buffer_(buffer) {}
+
+    void u8(std::uint8_t value) { codec::detail::write_uint8(grow(1), offset_, value); }
+    void u16(std::uint16_t value) { codec::detail::write_uint16_be(grow(2), offset_, value); }
+    void u32(std::uint32_t value) { codec::detail::write_uint32_be(grow(4), offset_, value); }
+    void u64(std::uint64_t value) {
+        u32(static_cast<std::uint32_t>(value >> 32U));
+        u32(static_cast<std::uint32_t>(value & 0xFFFFFFFFU));
+    }
+    void string(std::string_view value, std::size_t max_length) {
+        value = value.substr(0, max_length);
+        codec::detail::write_string(grow(codec::detail::string_size(value)), offset_, value);
+    }
+    void identity(const NewGrfIdentity &identity) {
+        u32(identity.grfid);
+        std::memcpy(grow(identity.md5.size()).data() + offset_, identity.md5.data(), identity.md5.size());
+        offset_ += identity.md5.size();
+    }
+
+private:
+    std::span<std::byte> grow(std::size_t bytes) {
+        offset_ = buffer_.size();
+        buffer_.resize(offset_ + bytes);
+        return buffer_;
+    }
+
+    std::vector<std::byte> &buffer_;
+    std::size_t offset_{0};
+};
+
+// LookupId serialisation writes table indices; every NewGRF must be in it.
+void write_game_info(Writer &writer, const NetworkGameInfo &info, NewGrfSerialization serialization,
+                     const NewGrfLookupTable *table) {
+    writer.u8(NETWORK_GAME_INFO_VERSION);
+    writer.u64(info.ticks_playing);
+    writer.u8(static_cast<std::uint8_t>(serialization));
+    writer.u32(info.gamescript_version);
+    writer.string(info.gamescript_name, NETWORK_MAX_GAMESCRIPT_NAME_LENGTH);
+    const auto grf_count = std::min(info.newgrfs.size(), NETWORK_MAX_GRF_COUNT);
+    writer.u8(static_cast<std::uint8_t>(grf_count));
+    for (std::size_t index = 0; index < grf_count; ++index) {
+        const auto &identity = info.newgrfs[index];
+        if (serialization != NewGrfSerialization::LookupId) {
+            writer.identity(identity);
+            if (serialization == NewGrfSerialization::GrfIdMd5Name) {
+                const auto *lookup = table == nullptr ? nullptr : table->find(identity);
+                const auto *entry = lookup == nullptr ? nullptr : table->find(*lookup);
+                writer.string(entry == nullptr ? std::string_view{} : std::string_view{entry->name},
+                              NETWORK_MAX_NEWGRF_NAME_LENGTH);
+            }
+            continue;
+        }
+        const auto *lookup = table == nullptr ? nullptr : table->find(identity);
+        if (lookup == nullptr) {
+            throw std::invalid_argument{"Listed NewGRF is missing from the lookup table"};
+        }
+        writer.u32(*lookup);
+    }
+    writer.u32(info.game_date);
+    writer.u32(info.start_date);
+    writer.u8(info.companies_max);
+    writer.u8(info.companies_on);
+    writer.u8(info.spectators_max);
+    writer.string(info.server_name, NETWORK_MAX_SERVER_NAME_LENGTH);
+    writer.string(info.server_revision, NETWORK_MAX_REVISION_LENGTH);
+    writer.u8(info.use_password ? 1U : 0U);
+    writer.u8(info.clients_max);
+    writer.u8(info.clients_on);
+    writer.u8(info.spectators_on);
+    writer.u16(info.map_width);
+    writer.u16(info.map_height);
+    writer.u8(info.landscape);
+    writer.u8(info.dedicated ? 1U : 0U);
+}
+
+void write_listing_entry(std::vector<std::byte> &buffer, const ServerListingEntry &entry,
+                         const NewGrfLookupTable &table) {
+    Writer writer{buffer};
+    writer.string(entry.connection_string, NETWORK_MAX_CONNECTION_STRING_LENGTH);
+    write_game_info(writer, entry.info, NewGrfSerialization::LookupId, &table);
+}
+
+void write_count(std::vector<std::byte> &payload, std::size_t offset, std::size_t count) {
+    payload[offset] = static_cast<std::byte>((count >> 8U) & 0xFFU);
+    payload[offset + 1] = static_cast<std::byte>(count & 0xFFU);
+}
+
+} // namespace
+
+std::size_t NewGrfIdentityHash::operator()(const NewGrfIdentity &identity) const noexcept {
+    // The MD5 is already uniformly distributed; fold in its first eight bytes.
+    std::uint64_t md5_prefix = 0;
+    std::memcpy(&md5_prefix, identity.md5.data(), sizeof(md5_prefix));
+    return static_cast<std::size_t>(md5_prefix ^ (static_cast<std::uint64_t>(identity.grfid) * 0x9E3779B97F4A7C15ULL));
+}
+
+std::size_t CoordinatorClientListing::serialized_size() const {
+    return ClientListingSchema::serialized_size(*this);
+}
+
+std::size_t CoordinatorClientListing::serialize_into(std::span<std::byte> buffer) const {
+    return ClientListingSchema::serialize_into(*this, buffer);
+}
+
+DecodeResult<CoordinatorClientListing> CoordinatorClientListing::try_deserialize(std::span<const std::byte> payload) {
+    return ClientListingSchema::try_parse(payload);
+}
+
+const NewGrfLookupTable::Entry *NewGrfLookupTable::find(std::uint32_t index) const noexcept {
+    const auto found = entries_.find(index);
+    return found == entries_.end() ? nullptr : &found->second;
+}
+
+const std::uint32_t *NewGrfLookupTable::find(const NewGrfIdentity &identity) const noexcept {
+    const auto found = indices_.find(identity);
+    return found == indices_.end() ? nullptr : &found->second;
+}
+
+void NewGrfLookupTable::insert(std::uint32_t index, Entry entry) {
+    indices_[entry.identity] = index;
+    entries_.insert_or_assign(index, std::move(entry));
+    if (index >= cursor_) {
+        cursor_ = index + 1;
+    }
+}
+
+void NewGrfLookupTable::advance_cursor(std::uint32_t cursor) noexcept {
+    cursor_ = std::max(cursor_, cursor);
+}
+
+std::uint32_t NewGrfLookupTable::intern(const NewGrfIdentity &identity, std::string_view name) {
+    if (const auto *index = find(identity)) {
+        return *index;
+    }
+    const auto index = cursor_;
+    insert(index, Entry{identity, std::string{name}});
+    return index;
+}
+
+void NewGrfLookupTable::clear() noexcept {
+    entries_.clear();
+    indices_.clear();
+    cursor_ = 0;
+}
+
+DecodeResult<std::size_t> ServerListingDecoder::decode(PacketCoordinatorType type, std::span<const std::byte> payload) {
+    switch (type) {
+    case PacketCoordinatorType::GcNewGrfLookup:
+        return decode_lookup(payload);
+    case PacketCoordinatorType::GcListing:
+        return decode_listing(payload);
+    default:
+        return std::size_t{0};
+    }
+}
+
+DecodeResult<std::size_t> ServerListingDecoder::decode_lookup(std::span<const std::byte> payload) {
+    Reader reader{payload};
+    std::uint32_t cursor = 0;
+    std::uint16_t count = 0;
+    if (!reader.u32(cursor, "NewGRF lookup cursor") || !reader.u16(count, "NewGRF lookup count")) {
+        return DecodeResult<std::size_t>{reader.error(), reader.field()};
+    }
+
+    for (std::size_t index = 0; index < count; ++index) {
+        std::uint32_t lookup = 0;
+        NewGrfLookupTable::Entry entry{};
+        if (!reader.u32(lookup, "NewGRF lookup index") || !reader.identity(entry.identity, "NewGRF identity") ||
+            !reader.string(entry.name, NETWORK_MAX_NEWGRF_NAME_LENGTH, "NewGRF name")) {
+            return DecodeResult<std::size_t>{reader.error(), reader.field()};
+        }
+        table_.insert(lookup, std::move(entry));
+    }
+    if (!reader.at_end()) {
+        return DecodeResult<std::size_t>{DecodeError::TrailingData, "NewGRF lookup"};
+    }
+    table_.advance_cursor(cursor);
+    lookup_entries_decoded_ += count;
+    return std::size_t{count};
+}
+
+DecodeResult<std::size_t> ServerListingDecoder::decode_listing(std::span<const std::byte> payload) {
+    Reader reader{payload};
+    std::uint16_t count = 0;
+    if (!reader.u16(count, "listing count")) {
+        return DecodeResult<std::size_t>{reader.error(), reader.field()};
+    }
+    if (count == 0) {
+        complete_ = true;
+    }
+
+    for (std::size_t index = 0; index < count; ++index) {
+        if (!read_listing_entry(reader, table_, entry_)) {
+            return DecodeResult<std::size_t>{reader.error(), reader.field()};
+        }
+        ++entries_decoded_;
+        if (entry_callback_) {
+            entry_callback_(entry_);
+        }
+    }
+    if (!reader.at_end()) {
+        return DecodeResult<std::size_t>{DecodeError::TrailingData, "listing"};
+    }
+    return std::size_t{count};
+}
+
+void ServerListingDecoder::reset() noexcept {
+    complete_ = false;
+    entries_decoded_ = 0;
+    lookup_entries_decoded_ = 0;
+}
+
+std::vector<std::byte> serialize_game_info(const NetworkGameInfo &info, NewGrfSerialization serialization,
+                                           const NewGrfLookupTable *table) {
+    std::vector<std::byte> payload;
+    Writer writer{payload};
+    write_game_info(writer, info, serialization, table);
+    return payload;
+}
+
+DecodeResult<NetworkGameInfo> try_parse_game_info(std::span<const std::byte> payload) {
+    Reader reader{payload};
+    NetworkGameInfo info{};
+    std::size_t unresolved = 0;
+    if (!read_game_info(reader, nullptr, info, unresolved)) {
+        return DecodeResult<NetworkGameInfo>{reader.error(), reader.field()};
+    }
+    if (!reader.at_end()) {
+        return DecodeResult<NetworkGameInfo>{DecodeError::TrailingData, "game info"};
+    }
+    return info;
+}
+
+std::vector<std::vector<std::byte>> serialize_newgrf_lookup(const NewGrfLookupTable &table,
+                                                            std::uint32_t since_cursor,
+                                                            std::size_t max_payload) {
+    std::vector<std::vector<std::byte>> payloads;
+    std::vector<std::byte> current;
+    std::size_t count = 0;
+
+    const auto finish = [&] {
+        if (count != 0) {
+            write_count(current, 4, count);
+            payloads.push_back(std::move(current));
+        }
+        current.clear();
+        count = 0;
+    };
+
+    for (auto index = since_cursor; index < table.cursor(); ++index) {
+        const auto *entry = table.find(index);
+        if (entry == nullptr) {
+            continue;
+        }
+        const auto name = std::string_view{entry->name}.substr(0, NETWORK_MAX_NEWGRF_NAME_LENGTH);
+        const auto entry_size = 4 + kNewGrfIdentitySize + 2 + name.size();
+        if (count != 0 && (current.size() + entry_size > max_payload || count == 0xFFFF)) {
+            finish();
+        }
+        Writer writer{current};
+        if (count == 0) {
+            writer.u32(table.cursor());
+            writer.u16(0);
+        }
+        writer.u32(index);
+        writer.identity(entry->identity);
+        writer.string(name, NETWORK_MAX_NEWGRF_NAME_LENGTH);
+        ++count;
+    }
+    finish();
+    return payloads;
+}
+
+std::vector<std::vector<std::byte>> serialize_listing(std::span<const ServerListingEntry> entries,
+                                                      const NewGrfLookupTable &table,
+                                                      std::size_t max_payload) {
+    std::vector<std::vector<std::byte>> payloads;
+    std::vector<std::byte> current(kListingHeaderSize);
+    std::vector<std::byte> encoded;
+    std::size_t count = 0;
+
+    for (const auto &entry : entries) {
+        encoded.clear();
+        write_listing_entry(encoded, entry, table);
+        if (kListingHeaderSize + encoded.size() > max_payload) {
+            throw std::length_error{"Listing entry does not fit in a coordinator packet"};
+        }
+        if (count != 0 && (current.size() + encoded.size() > max_payload || count == 0xFFFF)) {
+            write_count(current, 0, count);
+            payloads.push_back(std::move(current));
+            current.assign(kListingHeaderSize, std::byte{0});
+            count = 0;
+        }
+        current.insert(current.end(), encoded.begin(), encoded.end());
+        ++count;
+    }
+    if (count != 0) {
+        write_count(current, 0, count);
+        payloads.push_back(std::move(current));
+    }
+    payloads.emplace_back(kListingHeaderSize, std::byte{0});
+    return payloads;
+}
+
+} // namespace sotc::network
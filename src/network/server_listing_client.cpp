@@ -0,0 +1,263 @@
+#include "network/server_listing_client.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <sys/socket.h>
+
+namespace sotc::network {
+
+std::string_view to_string(ListingState state) noexcept {
+    switch (state) {
+    case ListingState::Idle:
+        return "idle";
+    case ListingState::Connecting:
+        return "connecting";
+    case ListingState::Receiving:
+        return "receiving";
+    case ListingState::Complete:
+        return "complete";
+    case ListingState::Failed:
+        return "failed";
+    }
+    return "unknown";
+}
+
+ServerListingClient::ServerListingClient(EventLoop &loop, ServerListingOptions options)
+    : loop_(loop), options_(std::move(options)) {}
+
+ServerListingClient::~ServerListingClient() {
+    close();
+}
+
+void ServerListingClient::set_state(ListingState state) {
+    if (state_ == state) {
+        return;
+    }
+    state_ = state;
+    if (state_callback_) {
+        state_callback_(state);
+    }
+}
+
+void ServerListingClient::fail(std::string message) {
+    last_error_ = std::move(message);
+    disconnect();
+    set_state(ListingState::Failed);
+}
+
+void ServerListingClient::disconnect() noexcept {
+    if (resolve_request_ != 0) {
+        options_.resolver->cancel(resolve_request_);
+        resolve_request_ = 0;
+    }
+    loop_.cancel(connect_timer_);
+    loop_.cancel(listing_timer_);
+    connect_timer_ = 0;
+    listing_timer_ = 0;
+    if (socket_) {
+        loop_.remove(socket_.get());
+        socket_.reset();
+    }
+}
+
+void ServerListingClient::close() noexcept {
+    disconnect();
+    if (state_ == ListingState::Connecting || state_ == ListingState::Receiving) {
+        state_ = ListingState::Idle;
+    }
+}
+
+void ServerListingClient::refresh() {
+    disconnect();
+    framer_.reset();
+    decoder_.reset();
+    outbound_.clear();
+    outbound_offset_ = 0;
+    last_error_.clear();
+    ++refreshes_;
+
+    // Both timeouts also bound the lookup.
+    connect_timer_ = loop_.schedule_after(options_.connect_timeout, [this] {
+        connect_timer_ = 0;
+        if (state_ == ListingState::Connecting) {
+            fail("Timed out connecting to coordinator");
+        }
+    });
+    listing_timer_ = loop_.schedule_after(options_.listing_timeout, [this] {
+        listing_timer_ = 0;
+        fail("Timed out waiting for the server listing");
+    });
+
+    if (options_.resolver == nullptr) {
+        connect_to(resolve_endpoints(options_.coordinator_host, options_.coordinator_port));
+        return;
+    }
+    set_state(ListingState::Connecting);
+    const auto request = options_.resolver->resolve(options_.coordinator_host, options_.coordinator_port,
+                                                    [this](const std::vector<Endpoint> &endpoints) {
+                                                        resolve_request_ = 0;
+                                                        connect_to(endpoints);
+                                                    });
+    // Zero when a cached answer was used, and the connect has already begun.
+    if (request != 0) {
+        resolve_request_ = request;
+    }
+}
+
+void ServerListingClient::connect_to(const std::vector<Endpoint> &endpoints) {
+    if (endpoints.empty()) {
+        fail("Unable to resolve coordinator host " + options_.coordinator_host);
+        return;
+    }
+
+    bool in_progress = false;
+    socket_ = connect_nonblocking(endpoints.front(), in_progress);
+    if (!socket_) {
+        fail("Unable to connect to coordinator " + endpoints.front().to_string() + ": " + std::strerror(errno));
+        return;
+    }
+
+    set_state(ListingState::Connecting);
+    watching_writable_ = true;
+    loop_.add(socket_.get(), EventLoop::kReadable | EventLoop::kWritable,
+              [this](std::uint32_t events) { on_io(events); });
+
+    if (!in_progress) {
+        on_connected();
+    }
+}
+
+void ServerListingClient::on_io(std::uint32_t events) {
+    if (state_ == ListingState::Connecting) {
+        if ((events & (EventLoop::kWritable | EventLoop::kError | EventLoop::kHangup)) == 0) {
+            return;
+        }
+        if (const int error = socket_error(socket_.get()); error != 0) {
+            fail(std::string{"Coordinator connection failed: "} + std::strerror(error));
+            return;
+        }
+        on_connected();
+        return;
+    }
+
+    if (events & EventLoop::kReadable) {
+        on_readable();
+    }
+    if (socket_ && (events & EventLoop::kWritable)) {
+        flush();
+    }
+    if (socket_ && (events & EventLoop::kError)) {
+        fail(std::string{"Coordinator connection error: "} + std::strerror(socket_error(socket_.get())));
+    }
+}
+
+void ServerListingClient::on_connected() {
+    loop_.cancel(connect_timer_);
+    connect_timer_ = 0;
+    set_state(ListingState::Receiving);
+
+    CoordinatorClientListing request{};
+    request.revision = options_.revision.substr(0, NETWORK_MAX_REVISION_LENGTH);
+    request.newgrf_lookup_cursor = table_.cursor();
+
+    const auto payload_size = request.serialized_size();
+    outbound_.resize(NETWORK_PACKET_HEADER_SIZE + payload_size);
+    write_packet_header(outbound_, static_cast<std::uint8_t>(PacketCoordinatorType::ClientListing), payload_size);
+    request.serialize_into(std::span<std::byte>{outbound_}.subspan(NETWORK_PACKET_HEADER_SIZE));
+    flush();
+}
+
+void ServerListingClient::flush() {
+    while (outbound_offset_ < outbound_.size()) {
+        const auto sent = ::send(socket_.get(), outbound_.data() + outbound_offset_,
+                                 outbound_.size() - outbound_offset_, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            fail(std::string{"Failed to send to coordinator: "} + std::strerror(errno));
+            return;
+        }
+        outbound_offset_ += static_cast<std::size_t>(sent);
+    }
+
+    if (outbound_offset_ == outbound_.size()) {
+        outbound_.clear();
+        outbound_offset_ = 0;
+    }
+
+    const bool want_writable = !outbound_.empty();
+    if (want_writable != watching_writable_) {
+        loop_.modify(socket_.get(), EventLoop::kReadable | (want_writable ? EventLoop::kWritable : 0U));
+        watching_writable_ = want_writable;
+    }
+}
+
+void ServerListingClient::on_readable() {
+    while (socket_) {
+        auto region = framer_.prepare();
+        if (region.empty()) {
+            fail("Coordinator packet exceeds receive buffer");
+            return;
+        }
+        const auto received = ::recv(socket_.get(), region.data(), region.size(), 0);
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            fail(std::string{"Failed to read from coordinator: "} + std::strerror(errno));
+            return;
+        }
+        if (received == 0) {
+            fail("Coordinator closed the connection before the listing was complete");
+            return;
+        }
+        framer_.commit(static_cast<std::size_t>(received));
+
+        // Decode packet by packet so servers surface while the rest of the
+        // listing is still in flight.
+        while (socket_) {
+            const auto packet = framer_.front();
+            if (!packet) {
+                break;
+            }
+            handle_packet(*packet);
+            framer_.pop_front();
+        }
+        if (socket_ && framer_.failed()) {
+            fail(std::string{"Malformed coordinator stream: "} + std::string{to_string(framer_.error())});
+            return;
+        }
+    }
+}
+
+void ServerListingClient::handle_packet(const FramedPacket &packet) {
+    const auto type = static_cast<PacketCoordinatorType>(packet.type);
+    if (type == PacketCoordinatorType::GcError) {
+        const auto error = CoordinatorErrorPacket::try_deserialize(packet.linearize(scratch_));
+        fail(error ? "Coordinator rejected listing: " + to_string(static_cast<CoordinatorErrorCode>(error->error_code))
+                   : std::string{"Coordinator reported an unreadable error"});
+        return;
+    }
+
+    const auto decoded = decoder_.decode(type, packet.linearize(scratch_));
+    if (!decoded) {
+        fail("Malformed server listing: " + std::string{to_string(decoded.error())} + " in " +
+             std::string{decoded.error_field()});
+        return;
+    }
+    if (decoder_.complete()) {
+        disconnect();
+        set_state(ListingState::Complete);
+    }
+}
+
+} // namespace sotc::network
@@ -0,0 +1,176 @@
+#include "network/server_search_index.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+namespace sotc::network {
+
+namespace {
+
+constexpr std::size_t kMaxGram = 3;
+
+[[nodiscard]] std::string fold_case(std::string_view text) {
+    std::string folded{text};
+    for (auto &character : folded) {
+        if (character >= 'A' && character <= 'Z') {
+            character = static_cast<char>(character - 'A' + 'a');
+        }
+    }
+    return folded;
+}
+
+// Length in the top byte keeps "a", "a\0" and "a\0\0" apart.
+[[nodiscard]] std::uint32_t gram_key(std::string_view text, std::size_t offset, std::size_t length) noexcept {
+    auto key = static_cast<std::uint32_t>(length) << 24U;
+    for (std::size_t index = 0; index < length; ++index) {
+        key |= static_cast<std::uint32_t>(static_cast<unsigned char>(text[offset + index])) << (8U * (2 - index));
+    }
+    return key;
+}
+
+// Every distinct gram of 1 to kMaxGram bytes, sorted.
+[[nodiscard]] std::vector<std::uint32_t> gram_keys(std::string_view folded) {
+    std::vector<std::uint32_t> keys;
+    keys.reserve(folded.size() * kMaxGram);
+    for (std::size_t offset = 0; offset < folded.size(); ++offset) {
+        for (std::size_t length = 1; length <= kMaxGram && offset + length <= folded.size(); ++length) {
+            keys.push_back(gram_key(folded, offset, length));
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+[[nodiscard]] bool is_invite_code(std::string_view connection_string) noexcept {
+    return connection_string.size() > 1 && connection_string.front() == '+';
+}
+
+} // namespace
+
+void ServerSearchIndex::insert(std::uint32_t row, std::string_view server_name, std::string_view connection_string) {
+    erase(row);
+    Row entry{fold_case(server_name), is_invite_code(connection_string) ? std::string{connection_string} : ""};
+    add_postings(row, entry.folded_name);
+    if (!entry.invite_code.empty()) {
+        invite_codes_.emplace(entry.invite_code, row);
+    }
+    rows_.emplace(row, std::move(entry));
+}
+
+bool ServerSearchIndex::erase(std::uint32_t row) {
+    const auto found = rows_.find(row);
+    if (found == rows_.end()) {
+        return false;
+    }
+    remove_postings(row, found->second.folded_name);
+    if (!found->second.invite_code.empty()) {
+        invite_codes_.erase({found->second.invite_code, row});
+    }
+    rows_.erase(found);
+    return true;
+}
+
+void ServerSearchIndex::clear() noexcept {
+    rows_.clear();
+    postings_.clear();
+    invite_codes_.clear();
+}
+
+void ServerSearchIndex::add_postings(std::uint32_t row, std::string_view folded_name) {
+    for (const auto key : gram_keys(folded_name)) {
+        auto &posting = postings_[key];
+        // Listings usually arrive in row order, making this an append.
+        if (posting.empty() || posting.back() < row) {
+            posting.push_back(row);
+        } else {
+            posting.insert(std::lower_bound(posting.begin(), posting.end(), row), row);
+        }
+    }
+}
+
+void ServerSearchIndex::remove_postings(std::uint32_t row, std::string_view folded_name) {
+    for (const auto key : gram_keys(folded_name)) {
+        const auto found = postings_.find(key);
+        if (found == postings_.end()) {
+            continue;
+        }
+        auto &posting = found->second;
+        const auto position = std::lower_bound(posting.begin(), posting.end(), row);
+        if (position != posting.end() && *position == row) {
+            posting.erase(position);
+        }
+        if (posting.empty()) {
+            postings_.erase(found);
+        }
+    }
+}
+
+std::vector<std::uint32_t> ServerSearchIndex::find_name(std::string_view text, std::size_t limit) const {
+    std::vector<std::uint32_t> result;
+    if (text.empty()) {
+        result.reserve(rows_.size());
+        for (const auto &[row, entry] : rows_) {
+            result.push_back(row);
+        }
+        std::sort(result.begin(), result.end());
+        result.resize(std::min(result.size(), limit));
+        return result;
+    }
+
+    const auto query = fold_case(text);
+    if (query.size() <= kMaxGram) {
+        // Short queries are grams themselves; their posting list is exact.
+        const auto found = postings_.find(gram_key(query, 0, query.size()));
+        if (found != postings_.end()) {
+            const auto count = std::min(found->second.size(), limit);
+            result.assign(found->second.begin(), found->second.begin() + static_cast<std::ptrdiff_t>(count));
+        }
+        return result;
+    }
+
+    std::vector<const std::vector<std::uint32_t> *> lists;
+    for (std::size_t offset = 0; offset + kMaxGram <= query.size(); ++offset) {
+        const auto found = postings_.find(gram_key(query, offset, kMaxGram));
+        if (found == postings_.end()) {
+            return result;
+        }
+        lists.push_back(&found->second);
+    }
+    std::sort(lists.begin(), lists.end(), [](const auto *lhs, const auto *rhs) { return lhs->size() < rhs->size(); });
+    lists.erase(std::unique(lists.begin(), lists.end()), lists.end());
+
+    std::vector<std::uint32_t> candidates{*lists.front()};
+    std::vector<std::uint32_t> scratch;
+    for (std::size_t index = 1; index < lists.size() && !candidates.empty(); ++index) {
+        scratch.clear();
+        std::set_intersection(candidates.begin(), candidates.end(), lists[index]->begin(), lists[index]->end(),
+                              std::back_inserter(scratch));
+        candidates.swap(scratch);
+    }
+
+    // Every trigram matching does not mean they are adjacent; confirm.
+    for (const auto row : candidates) {
+        if (result.size() == limit) {
+            break;
+        }
+        if (rows_.at(row).folded_name.find(query) != std::string::npos) {
+            result.push_back(row);
+        }
+    }
+    return result;
+}
+
+std::vector<std::uint32_t> ServerSearchIndex::find_invite_code(std::string_view prefix, std::size_t limit) const {
+    std::string query{"+"};
+    query.append(prefix.starts_with('+') ? prefix.substr(1) : prefix);
+
+    std::vector<std::uint32_t> result;
+    for (auto position = invite_codes_.lower_bound({query, 0});
+         position != invite_codes_.end() && result.size() < limit && position->first.starts_with(query); ++position) {
+        result.push_back(position->second);
+    }
+    return result;
+}
+
+} // namespace sotc::network
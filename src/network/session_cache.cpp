@@ -0,0 +1,179 @@
+#include "network/session_cache.hpp"
+
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sotc::network {
+
+namespace {
+
+constexpr std::string_view kHeader = "# sotc session cache v2";
+constexpr std::size_t kFieldCount = 5;
+
+[[nodiscard]] std::uint64_t fnv1a(std::string_view text, std::uint64_t hash) noexcept {
+    for (const auto character : text) {
+        hash ^= static_cast<unsigned char>(character);
+        hash *= 0x100000001b3ULL;
+    }
+    // Field separator, so ("ab", "c") and ("a", "bc") differ.
+    hash ^= 0xFFU;
+    hash *= 0x100000001b3ULL;
+    return hash;
+}
+
+[[nodiscard]] bool is_storable(std::string_view field) noexcept {
+    return field.find_first_of("\t\r\n") == std::string_view::npos;
+}
+
+template <typename T>
+[[nodiscard]] bool parse_number(std::string_view text, T &out) noexcept {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), out);
+    return error == std::errc{} && end == text.data() + text.size();
+}
+
+} // namespace
+
+std::string session_identity(const RegistrationConfig &config) {
+    auto hash = 0xcbf29ce484222325ULL;
+    hash = fnv1a(config.coordinator_host, hash);
+    hash = fnv1a(std::to_string(config.coordinator_port), hash);
+    hash = fnv1a(std::to_string(config.listen_port), hash);
+    hash = fnv1a(config.server_name, hash);
+    hash = fnv1a(std::to_string(static_cast<unsigned>(config.server_game_type)), hash);
+
+    std::array<char, 16> text{};
+    constexpr std::string_view digits = "0123456789abcdef";
+    for (auto index = text.size(); index-- > 0; hash >>= 4U) {
+        text[index] = digits[hash & 0xFU];
+    }
+    return std::string{text.data(), text.size()};
+}
+
+SessionCache::SessionCache(std::filesystem::path path) : path_(std::move(path)) {}
+
+bool SessionCache::load() {
+    entries_.clear();
+    dirty_ = false;
+    std::ifstream input{path_};
+    if (!input) {
+        return false;
+    }
+    std::string line;
+    if (!std::getline(input, line) || line != kHeader) {
+        return false;
+    }
+    while (std::getline(input, line)) {
+        std::vector<std::string_view> fields;
+        std::string_view rest{line};
+        for (auto tab = rest.find('\t'); tab != std::string_view::npos; tab = rest.find('\t')) {
+            fields.push_back(rest.substr(0, tab));
+            rest.remove_prefix(tab + 1);
+        }
+        fields.push_back(rest);
+
+        CachedSession session{};
+        unsigned connection_type = 0;
+        if (fields.size() != kFieldCount || fields[0].empty() || fields[1].empty() ||
+            !parse_number(fields[2], connection_type) || connection_type > 0xFF ||
+            !parse_number(fields[4], session.saved_at)) {
+            continue;
+        }
+        session.invite_code = fields[1];
+        session.connection_type = static_cast<std::uint8_t>(connection_type);
+        session.coordinator_endpoint = fields[3];
+        entries_.insert_or_assign(std::string{fields[0]}, std::move(session));
+    }
+    return true;
+}
+
+void SessionCache::save() const {
+    std::error_code error;
+    if (path_.has_parent_path()) {
+        std::filesystem::create_directories(path_.parent_path(), error);
+        if (error) {
+            throw std::system_error{error, "Unable to create " + path_.parent_path().string()};
+        }
+    }
+
+    std::ostringstream text;
+    text << kHeader << '\n';
+    for (const auto &[identity, session] : entries_) {
+        text << identity << '\t' << session.invite_code << '\t' << static_cast<unsigned>(session.connection_type)
+             << '\t' << session.coordinator_endpoint << '\t' << session.saved_at << '\n';
+    }
+    const auto contents = std::move(text).str();
+
+    // Invite codes let anyone register as these servers, so the file is
+    // readable by its owner only, from before the first byte is written.
+    auto temporary = path_;
+    temporary += ".tmp";
+    const int fd = ::open(temporary.c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        throw std::system_error{errno, std::generic_category(), "Unable to create " + temporary.string()};
+    }
+    // A temporary left behind by an older run keeps its mode through O_CREAT.
+    bool written = ::fchmod(fd, 0600) == 0;
+    for (std::size_t offset = 0; written && offset < contents.size();) {
+        const auto sent = ::write(fd, contents.data() + offset, contents.size() - offset);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        written = sent > 0;
+        offset += written ? static_cast<std::size_t>(sent) : 0;
+    }
+    const int write_error = written ? 0 : errno;
+    if (::close(fd) != 0 && written) {
+        throw std::system_error{errno, std::generic_category(), "Unable to write " + temporary.string()};
+    }
+    if (!written) {
+        throw std::system_error{write_error, std::generic_category(), "Unable to write " + temporary.string()};
+    }
+    std::filesystem::rename(temporary, path_, error);
+    if (error) {
+        throw std::system_error{error, "Unable to replace " + path_.string()};
+    }
+}
+
+void SessionCache::flush() {
+    if (!dirty_) {
+        return;
+    }
+    save();
+    dirty_ = false;
+}
+
+const CachedSession *SessionCache::find(const std::string &identity) const {
+    const auto found = entries_.find(identity);
+    return found == entries_.end() ? nullptr : &found->second;
+}
+
+void SessionCache::store(const std::string &identity, CachedSession session) {
+    // Fields are tab-separated on disk; anything that would break a line is
+    // not worth resuming with.
+    if (session.invite_code.empty() || !is_storable(session.invite_code) ||
+        !is_storable(session.coordinator_endpoint)) {
+        erase(identity);
+        return;
+    }
+    entries_.insert_or_assign(identity, std::move(session));
+    dirty_ = true;
+}
+
+bool SessionCache::erase(const std::string &identity) {
+    const bool erased = entries_.erase(identity) != 0;
+    dirty_ = dirty_ || erased;
+    return erased;
+}
+
+} // namespace sotc::network
@@ -0,0 +1,186 @@
+#include "network/socket.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+namespace sotc::network {
+
+void SocketHandle::reset(int fd) noexcept {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = fd;
+}
+
+std::uint16_t Endpoint::port() const noexcept {
+    if (address.ss_family == AF_INET) {
+        return ntohs(reinterpret_cast<const sockaddr_in *>(&address)->sin_port);
+    }
+    if (address.ss_family == AF_INET6) {
+        return ntohs(reinterpret_cast<const sockaddr_in6 *>(&address)->sin6_port);
+    }
+    return 0;
+}
+
+std::string Endpoint::to_string() const {
+    char text[INET6_ADDRSTRLEN]{};
+    if (address.ss_family == AF_INET) {
+        const auto *ipv4 = reinterpret_cast<const sockaddr_in *>(&address);
+        ::inet_ntop(AF_INET, &ipv4->sin_addr, text, sizeof(text));
+        return std::string{text} + ':' + std::to_string(port());
+    }
+    if (address.ss_family == AF_INET6) {
+        const auto *ipv6 = reinterpret_cast<const sockaddr_in6 *>(&address);
+        ::inet_ntop(AF_INET6, &ipv6->sin6_addr, text, sizeof(text));
+        return '[' + std::string{text} + "]:" + std::to_string(port());
+    }
+    return "<unknown>";
+}
+
+std::vector<Endpoint> resolve_endpoints(const std::string &host, std::uint16_t port, int socket_type, int *error) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = socket_type;
+    hints.ai_flags = AI_ADDRCONFIG;
+
+    addrinfo *results = nullptr;
+    const auto service = std::to_string(port);
+    const int status = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &results);
+    if (error != nullptr) {
+        *error = status;
+    }
+    if (status != 0) {
+        return {};
+    }
+
+    std::vector<Endpoint> endpoints;
+    for (const auto *entry = results; entry != nullptr; entry = entry->ai_next) {
+        Endpoint endpoint{};
+        std::memcpy(&endpoint.address, entry->ai_addr, entry->ai_addrlen);
+        endpoint.length = entry->ai_addrlen;
+        endpoints.push_back(endpoint);
+    }
+    ::freeaddrinfo(results);
+    return endpoints;
+}
+
+void set_nonblocking(int fd) {
+    const int flags = ::fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+        throw std::system_error{errno, std::generic_category(), "fcntl(O_NONBLOCK) failed"};
+    }
+}
+
+void set_no_delay(int fd) noexcept {
+    const int enabled = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+}
+
+SocketHandle connect_nonblocking(const Endpoint &endpoint, bool &in_progress) {
+    in_progress = false;
+    SocketHandle socket{::socket(endpoint.address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+    if (!socket) {
+        return socket;
+    }
+    set_no_delay(socket.get());
+
+    if (::connect(socket.get(), reinterpret_cast<const sockaddr *>(&endpoint.address), endpoint.length) == 0) {
+        return socket;
+    }
+    if (errno == EINPROGRESS) {
+        in_progress = true;
+        return socket;
+    }
+    return SocketHandle{};
+}
+
+SocketHandle listen_nonblocking(const Endpoint &endpoint, int backlog) {
+    SocketHandle socket{::socket(endpoint.address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)};
+    if (!socket) {
+        throw std::system_error{errno, std::generic_category(), "socket() failed"};
+    }
+    const int reuse = 1;
+    ::setsockopt(socket.get(), SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (::bind(socket.get(), reinterpret_cast<const sockaddr *>(&endpoint.address), endpoint.length) != 0) {
+        throw std::system_error{errno, std::generic_category(), "bind() failed for " + endpoint.to_string()};
+    }
+    if (::listen(socket.get(), backlog) != 0) {
+        throw std::system_error{errno, std::generic_category(), "listen() failed"};
+    }
+    return socket;
+}
+
+Endpoint local_endpoint(int fd) {
+    Endpoint endpoint{};
+    endpoint.length = sizeof(endpoint.address);
+    if (::getsockname(fd, reinterpret_cast<sockaddr *>(&endpoint.address), &endpoint.length) != 0) {
+        throw std::system_error{errno, std::generic_category(), "getsockname() failed"};
+    }
+    return endpoint;
+}
+
+Endpoint loopback_endpoint(std::uint16_t port) {
+    Endpoint endpoint{};
+    auto *ipv4 = reinterpret_cast<sockaddr_in *>(&endpoint.address);
+    ipv4->sin_family = AF_INET;
+    ipv4->sin_port = htons(port);
+    ipv4->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    endpoint.length = sizeof(sockaddr_in);
+    return endpoint;
+}
+
+std::optional<Endpoint> parse_endpoint(std::string_view text) {
+    const auto colon = text.rfind(':');
+    if (colon == std::string_view::npos) {
+        return std::nullopt;
+    }
+    unsigned port = 0;
+    const auto port_text = text.substr(colon + 1);
+    const auto [end, error] = std::from_chars(port_text.data(), port_text.data() + port_text.size(), port);
+    if (error != std::errc{} || end != port_text.data() + port_text.size() || port > 0xFFFF) {
+        return std::nullopt;
+    }
+
+    auto host = text.substr(0, colon);
+    Endpoint endpoint{};
+    if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+        const std::string address{host.substr(1, host.size() - 2)};
+        auto *ipv6 = reinterpret_cast<sockaddr_in6 *>(&endpoint.address);
+        if (::inet_pton(AF_INET6, address.c_str(), &ipv6->sin6_addr) != 1) {
+            return std::nullopt;
+        }
+        ipv6->sin6_family = AF_INET6;
+        ipv6->sin6_port = htons(static_cast<std::uint16_t>(port));
+        endpoint.length = sizeof(sockaddr_in6);
+        return endpoint;
+    }
+    const std::string address{host};
+    auto *ipv4 = reinterpret_cast<sockaddr_in *>(&endpoint.address);
+    if (::inet_pton(AF_INET, address.c_str(), &ipv4->sin_addr) != 1) {
+        return std::nullopt;
+    }
+    ipv4->sin_family = AF_INET;
+    ipv4->sin_port = htons(static_cast<std::uint16_t>(port));
+    endpoint.length = sizeof(sockaddr_in);
+    return endpoint;
+}
+
+int socket_error(int fd) noexcept {
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (::getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0) {
+        return errno;
+    }
+    return error;
+}
+
+} // namespace sotc::network
@@ -0,0 +1,226 @@
+#include "network/timer_wheel.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace sotc::network {
+
+namespace {
+
+constexpr std::uint64_t kSlotMask = TimerWheel::kSlotsPerLevel - 1;
+constexpr std::uint64_t kWheelSpan = std::uint64_t{1} << (TimerWheel::kLevelBits * TimerWheel::kLevels);
+
+[[nodiscard]] constexpr std::uint32_t index_of(TimerWheel::TimerId id) noexcept {
+    return static_cast<std::uint32_t>(id & 0xFFFFFFFFU);
+}
+
+[[nodiscard]] constexpr std::uint32_t generation_of(TimerWheel::TimerId id) noexcept {
+    return static_cast<std::uint32_t>(id >> 32U);
+}
+
+} // namespace
+
+TimerWheel::TimerWheel(Clock::duration tick, Clock::time_point origin) : tick_(tick), origin_(origin) {
+    if (tick_ <= Clock::duration::zero()) {
+        throw std::invalid_argument{"Timer wheel tick must be positive"};
+    }
+    slots_.fill(kNone);
+}
+
+std::uint64_t TimerWheel::ticks_until(Clock::time_point deadline) const noexcept {
+    if (deadline <= origin_) {
+        return 0;
+    }
+    const auto elapsed = static_cast<std::uint64_t>((deadline - origin_).count());
+    const auto tick = static_cast<std::uint64_t>(tick_.count());
+    return (elapsed + tick - 1) / tick;
+}
+
+TimerWheel::TimerId TimerWheel::schedule_at(Clock::time_point deadline, Callback callback) {
+    std::uint32_t index = 0;
+    if (!free_.empty()) {
+        index = free_.back();
+        free_.pop_back();
+    } else {
+        if (nodes_.size() >= kNone) {
+            throw std::length_error{"Timer wheel is full"};
+        }
+        index = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+
+    auto &node = nodes_[index];
+    node.callback = std::move(callback);
+    node.deadline = deadline;
+    node.expires = ticks_until(deadline);
+    link(index);
+    ++active_;
+    return (static_cast<TimerId>(node.generation) << 32U) | index;
+}
+
+TimerWheel::TimerId TimerWheel::schedule_after(Clock::duration delay, Callback callback) {
+    return schedule_at(Clock::now() + delay, std::move(callback));
+}
+
+void TimerWheel::cancel(TimerId id) noexcept {
+    const auto index = index_of(id);
+    if (index >= nodes_.size()) {
+        return;
+    }
+    const auto &node = nodes_[index];
+    if (node.generation != generation_of(id) || node.slot == kNone) {
+        return;
+    }
+    unlink(index);
+    release(index);
+    --active_;
+}
+
+void TimerWheel::link(std::uint32_t index) {
+    auto &node = nodes_[index];
+    // Overdue timers go into the next slot to be dispatched; timers beyond the
+    // top level are parked at its far end and re-cascaded until they fit.
+    auto expires = std::max(node.expires, current_tick_);
+    const auto delta = std::min(expires - current_tick_, kWheelSpan - 1);
+    expires = current_tick_ + delta;
+
+    std::size_t level = 0;
+    while (delta >= (std::uint64_t{1} << (kLevelBits * (level + 1)))) {
+        ++level;
+    }
+    const auto slot = static_cast<std::uint32_t>(level * kSlotsPerLevel +
+                                                 ((expires >> (kLevelBits * level)) & kSlotMask));
+
+    node.slot = slot;
+    node.prev = kNone;
+    node.next = slots_[slot];
+    if (node.next != kNone) {
+        nodes_[node.next].prev = index;
+    }
+    slots_[slot] = index;
+}
+
+void TimerWheel::unlink(std::uint32_t index) noexcept {
+    auto &node = nodes_[index];
+    if (node.prev != kNone) {
+        nodes_[node.prev].next = node.next;
+    } else {
+        slots_[node.slot] = node.next;
+    }
+    if (node.next != kNone) {
+        nodes_[node.next].prev = node.prev;
+    }
+    node.prev = kNone;
+    node.next = kNone;
+    node.slot = kNone;
+}
+
+void TimerWheel::release(std::uint32_t index) noexcept {
+    auto &node = nodes_[index];
+    node.callback = nullptr;
+    if (++node.generation == 0) {
+        node.generation = 1;
+    }
+    free_.push_back(index);
+}
+
+void TimerWheel::cascade(std::size_t level) {
+    const auto slot = level * kSlotsPerLevel + ((current_tick_ >> (kLevelBits * level)) & kSlotMask);
+    auto index = slots_[slot];
+    slots_[slot] = kNone;
+    while (index != kNone) {
+        const auto next = nodes_[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+std::optional<TimerWheel::Clock::time_point> TimerWheel::next_expiry() const noexcept {
+    if (active_ == 0) {
+        return std::nullopt;
+    }
+    if (slots_[kDispatchSlot] != kNone) {
+        return origin_ + tick_ * static_cast<Clock::rep>(current_tick_);
+    }
+    std::optional<std::uint64_t> earliest;
+    // Level 0 holds timers due in the next kSlotsPerLevel ticks, starting
+    // with the current one. A higher-level slot is cascaded by advance() at
+    // the first tick of its range, so that tick is when it next needs work;
+    // the scan starts at the first such boundary not yet processed.
+    for (std::uint64_t step = 0; step < kSlotsPerLevel; ++step) {
+        const auto tick = current_tick_ + step;
+        if (slots_[tick & kSlotMask] != kNone) {
+            earliest = tick;
+            break;
+        }
+    }
+    for (std::size_t level = 1; level < kLevels; ++level) {
+        const auto shift = kLevelBits * level;
+        const auto first = (current_tick_ + (std::uint64_t{1} << shift) - 1) >> shift;
+        for (auto position = first; position < first + kSlotsPerLevel; ++position) {
+            const auto start = position << shift;
+            if (earliest && start >= *earliest) {
+                break;
+            }
+            if (slots_[level * kSlotsPerLevel + (position & kSlotMask)] != kNone) {
+                earliest = start;
+                break;
+            }
+        }
+    }
+    if (!earliest) {
+        return std::nullopt;
+    }
+    return origin_ + tick_ * static_cast<Clock::rep>(*earliest);
+}
+
+std::size_t TimerWheel::advance(Clock::time_point now) {
+    if (now < origin_) {
+        return 0;
+    }
+    const auto target = static_cast<std::uint64_t>((now - origin_) / tick_);
+    std::size_t fired = 0;
+
+    while (current_tick_ <= target) {
+        if (active_ == 0) {
+            current_tick_ = target + 1;
+            break;
+        }
+
+        for (std::size_t level = 1; level < kLevels; ++level) {
+            if (((current_tick_ >> (kLevelBits * (level - 1))) & kSlotMask) != 0) {
+                break;
+            }
+            cascade(level);
+        }
+
+        const auto slot = static_cast<std::size_t>(current_tick_ & kSlotMask);
+        ++current_tick_;
+        // Callbacks may cancel timers still waiting in the dispatch list, so
+        // it stays a linked slot rather than a local copy.
+        slots_[kDispatchSlot] = std::exchange(slots_[slot], kNone);
+        for (auto index = slots_[kDispatchSlot]; index != kNone; index = nodes_[index].next) {
+            nodes_[index].slot = kDispatchSlot;
+        }
+        while (slots_[kDispatchSlot] != kNone) {
+            const auto index = slots_[kDispatchSlot];
+            auto &node = nodes_[index];
+            auto callback = std::move(node.callback);
+            const auto deadline = node.deadline;
+            unlink(index);
+            release(index);
+            --active_;
+
+            jitter_.record(std::max(now - deadline, Clock::duration::zero()));
+            ++fired;
+            if (callback) {
+                callback();
+            }
+        }
+    }
+
+    return fired;
+}
+
+} // namespace sotc::network
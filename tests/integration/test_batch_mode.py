@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Integration test for ``--batch``.
+
+Runs a set of cases once as separate ``--dump-launch-options
+--dump-registration`` processes and once as requests to a single ``--batch``
+process, and checks that every batch response matches the output of its
+process, in request order. Also checks error responses, the interactive
+round trip (a response arrives before stdin is closed) and the throughput
+line on stderr.
+"""
+
+from __future__ import annotations
+
+import argparse
+import pathlib
+import re
+import subprocess
+import sys
+import tempfile
+from typing import List, Tuple
+
+CASES: List[Tuple[str, List[str]]] = [
+    ("", []),
+    ("server_port = 3990\nplayer_name = Batch Bot\nheadless = yes\n", []),
+    ("game_type = invite\ninvite_code = +BATCH\nallow_turn = off\n", ["--server-port", "4001"]),
+    (
+        "advertised_grfs = 11112222,33334444\nheartbeat_interval = 45\n",
+        ["--no-headless", "--advertised-grf", "55556666"],
+    ),
+    ("coordinator_port = 4000\n[alpha]\nserver_port = 3980\n[beta]\nserver_port = 3981\n", ["--profile", "beta"]),
+    ("hosted_server = 3980, name=Alpha\nhosted_server = 3981\n", ["--coordinator", "127.0.0.1:3976"]),
+]
+
+
+def escape(text: str) -> str:
+    return text.replace("\\", "\\\\").replace("\n", "\\n").replace("\t", "\\t")
+
+
+def run_process(binary: pathlib.Path, config: str, overrides: List[str], tmpdir: pathlib.Path) -> str:
+    config_path = tmpdir / "case.cfg"
+    config_path.write_text(config, encoding="utf-8")
+    # --profile only applies to the --config files that follow it.
+    profile: List[str] = []
+    rest = list(overrides)
+    if "--profile" in rest:
+        index = rest.index("--profile")
+        profile = rest[index : index + 2]
+        del rest[index : index + 2]
+    completed = subprocess.run(
+        [str(binary), *profile, "--config", str(config_path), *rest, "--dump-launch-options", "--dump-registration"],
+        check=True,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+    )
+    return completed.stdout
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--binary", type=pathlib.Path, required=True, help="Path to the sotc client executable")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        expected = [run_process(args.binary, config, overrides, pathlib.Path(tmpdir)) for config, overrides in CASES]
+
+    requests = ["\t".join([escape(config), *overrides]) for config, overrides in CASES]
+    requests.append("bogus = 1\t--server-port\tnope")
+    completed = subprocess.run(
+        [str(args.binary), "--batch", "--batch-workers", "4"],
+        input="\n".join(requests) + "\n",
+        check=True,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+    )
+    responses = completed.stdout.split("\n\n")
+    if responses[-1] != "":
+        raise AssertionError(f"Batch output does not end with an empty line:\n{completed.stdout}")
+    responses = responses[:-1]
+    if len(responses) != len(requests):
+        raise AssertionError(f"Expected {len(requests)} responses, got {len(responses)}:\n{completed.stdout}")
+    for number, (response, output) in enumerate(zip(responses, expected), start=1):
+        header = f"request={number}\nstatus=ok\n"
+        if response + "\n" != header + output:
+            raise AssertionError(f"Batch response {number} differs from the process output:\n{response}\n---\n{output}")
+    failure = responses[-1]
+    if failure != (
+        f"request={len(requests)}\nstatus=error\n"
+        "error=Unknown configuration key 'bogus' at line 1\nerror=Invalid server port: nope"
+    ):
+        raise AssertionError(f"Unexpected error response:\n{failure}")
+    throughput = re.search(r"Batch: (\d+) requests \((\d+) failed\).* ([0-9.e+]+) requests/s", completed.stderr)
+    if not throughput or throughput.group(1) != str(len(requests)) or throughput.group(2) != "1":
+        raise AssertionError(f"Unexpected batch summary: {completed.stderr!r}")
+
+    # A caller may keep stdin open and wait for each answer.
+    batch = subprocess.Popen(
+        [str(args.binary), "--batch"],
+        stdin=subprocess.PIPE,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+    )
+    try:
+        assert batch.stdin is not None and batch.stdout is not None
+        for number in (1, 2):
+            batch.stdin.write(f"server_port = {3990 + number}\n")
+            batch.stdin.flush()
+            lines = []
+            while not lines or lines[-1] != "":
+                lines.append(batch.stdout.readline().rstrip("\n"))
+            if lines[0] != f"request={number}" or f"listen_port={3990 + number}" not in lines:
+                raise AssertionError(f"Unexpected interactive response: {lines!r}")
+        batch.stdin.close()
+        if batch.wait(timeout=10) != 0:
+            raise AssertionError("Batch process failed after stdin was closed")
+    finally:
+        if batch.poll() is None:
+            batch.kill()
+            batch.wait()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""Configuration hot reload against the loopback mock Game Coordinator.
+
+Registers three hosted servers from a configuration file in a temporary
+directory with ``--watch-config``, then replaces the file the way editors
+save it: one server renamed, one dropped and one added. The client must patch,
+remove and add exactly those servers, leave the untouched one alone and
+report the reload latency.
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import pathlib
+import re
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+from typing import Dict
+
+
+def parse_key_value_payload(output: str) -> Dict[str, str]:
+    result: Dict[str, str] = {}
+    for line in output.splitlines():
+        if "=" in line:
+            key, value = line.split("=", 1)
+            result[key.strip()] = value.strip()
+    return result
+
+
+def write_config(path: pathlib.Path, coordinator: str, servers: str) -> None:
+    staged = path.with_suffix(".tmp")
+    host, port = coordinator.rsplit(":", 1)
+    staged.write_text(
+        f"headless = yes\ncoordinator_host = {host}\ncoordinator_port = {port}\n{servers}", encoding="utf-8"
+    )
+    os.replace(staged, path)
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--binary", type=pathlib.Path, required=True, help="Path to the sotc client executable")
+    parser.add_argument("--mock", type=pathlib.Path, required=True, help="Path to sotc_mock_coordinator")
+    args = parser.parse_args()
+
+    mock = subprocess.Popen(
+        [str(args.mock), "--report-interval", "0", "--duration", "30"],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+    )
+    try:
+        listening = mock.stdout.readline().strip() if mock.stdout else ""
+        match = re.fullmatch(r"listening=(.+):(\d+)", listening)
+        if not match:
+            raise AssertionError(f"Unexpected mock coordinator banner: {listening!r}")
+        coordinator = f"127.0.0.1:{match.group(2)}"
+
+        with tempfile.TemporaryDirectory() as tmpdir:
+            config_path = pathlib.Path(tmpdir) / "fleet.cfg"
+            write_config(
+                config_path,
+                coordinator,
+                "hosted_server = 3980,name=Alpha\n"
+                "hosted_server = 3981,name=Beta\n"
+                "hosted_server = 3982,name=Gamma\n",
+            )
+            client = subprocess.Popen(
+                [str(args.binary), "--config", str(config_path), "--watch-config", "--register"],
+                stdout=subprocess.PIPE,
+                stderr=subprocess.PIPE,
+                text=True,
+            )
+            time.sleep(1.0)
+            write_config(
+                config_path,
+                coordinator,
+                "hosted_server = 3980,name=Alpha\n"
+                "hosted_server = 3981,name=Beta renamed\n"
+                "hosted_server = 3983,name=Delta\n",
+            )
+            time.sleep(1.0)
+            client.send_signal(signal.SIGINT)
+            client_stdout, client_stderr = client.communicate(timeout=10)
+        if client.returncode != 0:
+            raise AssertionError(f"Client exited with {client.returncode}\nstderr: {client_stderr!r}")
+
+        expected = "1 unchanged, 1 patched, 0 re-registered, 1 added, 1 removed"
+        if not re.search(r"Configuration reloaded in [0-9.]+ ms: " + expected, client_stdout):
+            raise AssertionError(f"Client did not reconcile the reloaded configuration:\n{client_stdout}")
+        if "Configuration reloads: 1 " not in client_stdout:
+            raise AssertionError(f"Client summary is missing the reload latency:\n{client_stdout}")
+        if "Coordinator servers registered: 3/3" not in client_stdout:
+            raise AssertionError(f"Client did not keep three servers registered:\n{client_stdout}")
+
+        mock.send_signal(signal.SIGINT)
+        mock_stdout, _ = mock.communicate(timeout=10)
+        summary = parse_key_value_payload(mock_stdout)
+        if summary.get("registrations") != "4" or summary.get("malformed") != "0":
+            raise AssertionError(f"Unexpected mock coordinator summary: {summary!r}")
+    finally:
+        if mock.poll() is None:
+            mock.kill()
+            mock.wait()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -53,6 +53,11 @@ def test_invalid_heartbeat(binary: pathlib.Path) -> None:
     assert_failure(result, "Invalid heartbeat interval")
 
 
+def test_invalid_hosted_server(binary: pathlib.Path) -> None:
+    result = run_client(binary, "--hosted-server", "3980,heartbeat=soon", "--dump-launch-options")
+    assert_failure(result, "Invalid hosted server setting")
+
+
 def test_invalid_config_flag(binary: pathlib.Path) -> None:
     with tempfile.TemporaryDirectory() as tmpdir:
         config_path = pathlib.Path(tmpdir) / "sotc_invalid.cfg"
@@ -107,15 +112,37 @@ def test_duplicate_config_key(binary: pathlib.Path) -> None:
         assert_failure(result, "Duplicate configuration key")
 
 
+def test_missing_config_profile(binary: pathlib.Path) -> None:
+    with tempfile.TemporaryDirectory() as tmpdir:
+        config_path = pathlib.Path(tmpdir) / "sotc_profiles.cfg"
+        config_path.write_text(
+            textwrap.dedent(
+                """
+                headless = true
+
+                [alpha]
+                server_port = 3980
+                """
+            ).strip()
+            + "\n",
+            encoding="utf-8",
+        )
+
+        result = run_client(binary, "--profile", "gamma", "--config", str(config_path), "--dump-launch-options")
+        assert_failure(result, "Configuration profile 'gamma' not found")
+
+
 def main() -> int:
     parser = argparse.ArgumentParser()
     parser.add_argument("--binary", type=pathlib.Path, required=True, help="Path to the sotc client executable")
     args = parser.parse_args()
 
     test_invalid_heartbeat(args.binary)
+    test_invalid_hosted_server(args.binary)
     test_invalid_config_flag(args.binary)
     test_unknown_config_key(args.binary)
     test_duplicate_config_key(args.binary)
+    test_missing_config_profile(args.binary)
     return 0
 
 
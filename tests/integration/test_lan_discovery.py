@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""End-to-end LAN discovery against loopback UDP responders.
+
+Starts a few UDP responders on 127.0.0.1 that answer
+PACKET_UDP_CLIENT_FIND_SERVER with a game info block, plus one that answers
+twice. Runs the client with ``--discover-lan`` and one ``--lan-target`` per
+responder, then checks that each server was printed exactly once and that the
+summary matches.
+"""
+
+from __future__ import annotations
+
+import argparse
+import pathlib
+import re
+import socket
+import struct
+import subprocess
+import sys
+import threading
+from typing import List
+
+PACKET_UDP_CLIENT_FIND_SERVER = 0
+PACKET_UDP_SERVER_RESPONSE = 1
+GAME_INFO_VERSION = 7
+
+
+def encode_string(value: str) -> bytes:
+    data = value.encode("utf-8")
+    return struct.pack(">H", len(data)) + data
+
+
+def server_response(name: str) -> bytes:
+    payload = b"".join(
+        [
+            struct.pack(">BQBI", GAME_INFO_VERSION, 1000, 0, 0xFFFFFFFF),
+            encode_string(""),
+            struct.pack(">B", 0),
+            struct.pack(">IIBBB", 0, 0, 15, 2, 10),
+            encode_string(name),
+            encode_string("14.1"),
+            struct.pack(">BBBBHHBB", 0, 25, 4, 0, 256, 256, 0, 1),
+        ]
+    )
+    return struct.pack(">HB", len(payload) + 3, PACKET_UDP_SERVER_RESPONSE) + payload
+
+
+class Responder:
+    def __init__(self, name: str, copies: int = 1) -> None:
+        self.socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.socket.bind(("127.0.0.1", 0))
+        self.socket.settimeout(0.1)
+        self.port = self.socket.getsockname()[1]
+        self.reply = server_response(name)
+        self.copies = copies
+        self.stopped = threading.Event()
+        self.thread = threading.Thread(target=self.serve, daemon=True)
+        self.thread.start()
+
+    def serve(self) -> None:
+        while not self.stopped.is_set():
+            try:
+                data, source = self.socket.recvfrom(2048)
+            except socket.timeout:
+                continue
+            if data == struct.pack(">HB", 3, PACKET_UDP_CLIENT_FIND_SERVER):
+                for _ in range(self.copies):
+                    self.socket.sendto(self.reply, source)
+
+    def close(self) -> None:
+        self.stopped.set()
+        self.thread.join()
+        self.socket.close()
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--binary", type=pathlib.Path, required=True, help="Path to the sotc client executable")
+    args = parser.parse_args()
+
+    responders: List[Responder] = [Responder(f"LAN responder {index}") for index in range(3)]
+    responders.append(Responder("LAN responder chatty", copies=2))
+    try:
+        command = [str(args.binary), "--headless", "--discover-lan"]
+        for responder in responders:
+            command += ["--lan-target", f"127.0.0.1:{responder.port}"]
+        client = subprocess.run(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True, timeout=20)
+        if client.returncode != 0:
+            raise AssertionError(f"Client exited with {client.returncode}\nstderr: {client.stderr!r}")
+
+        found = [line for line in client.stdout.splitlines() if "LAN responder" in line]
+        if len(found) != len(responders):
+            raise AssertionError(f"Expected {len(responders)} servers, client printed {len(found)}:\n{client.stdout}")
+        for responder in responders:
+            if sum(f"127.0.0.1:{responder.port}]" in line for line in found) != 1:
+                raise AssertionError(f"Responder on port {responder.port} not printed once:\n{client.stdout}")
+        summary = re.search(r"LAN discovery complete: (\d+) servers, (\d+) probes sent", client.stdout)
+        if not summary or summary.groups() != (str(len(responders)), str(len(responders))):
+            raise AssertionError(f"Unexpected discovery summary:\n{client.stdout}")
+    finally:
+        for responder in responders:
+            responder.close()
+
+    print("LAN discovery integration test passed.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -34,13 +34,14 @@ def parse_key_value_payload(output: str) -> Dict[str, str]:
     return result
 
 
-def run_client(binary: pathlib.Path, *args: str) -> str:
-    """Execute the client binary and return its stdout."""
+def run_client(binary: pathlib.Path, *args: str, stdin: str | None = None) -> str:
+    """Execute the client binary, optionally feeding ``stdin``, and return its stdout."""
 
     command = [str(binary), *args]
     completed = subprocess.run(
         command,
         check=True,
+        input=stdin,
         stdout=subprocess.PIPE,
         stderr=subprocess.PIPE,
         text=True,
@@ -67,6 +68,7 @@ def assert_launch_summary(summary: Dict[str, str]) -> None:
         "allow_turn": "false",
         "heartbeat_interval": "45",
         "advertised_grfs": "11112222,33334444,55556666",
+        "hosted_servers": "3980,name=Alpha,heartbeat=15,stun=off;3981;3982,invite_code=+CLI",
     }
 
     missing = expected.keys() - summary.keys()
@@ -123,6 +125,7 @@ def main() -> int:
 
     with tempfile.TemporaryDirectory() as tmpdir:
         config_path = pathlib.Path(tmpdir) / "sotc_test.cfg"
+        session_cache_path = pathlib.Path(tmpdir) / "sessions.txt"
         config_path.write_text(
             textwrap.dedent(
                 """
@@ -141,9 +144,11 @@ def main() -> int:
                 allow_turn = false
                 heartbeat_interval = 60
                 advertised_grfs = 11112222,33334444
+                hosted_server = 3980, name=Alpha, heartbeat=15, stun=off
+                hosted_server = 3981
                 """
             ).strip()
-            + "\n",
+            + f"\nsession_cache = {session_cache_path}\n",
             encoding="utf-8",
         )
 
@@ -162,15 +167,81 @@ def main() -> int:
             "45",
             "--advertised-grf",
             "55556666",
+            "--hosted-server",
+            "3982,invite_code=+CLI",
         ]
 
         launch_output = run_client(args.binary, *base_args, "--dump-launch-options")
         launch_summary = parse_key_value_payload(launch_output)
         assert_launch_summary(launch_summary)
+        if launch_summary.get("session_cache") != str(session_cache_path):
+            raise AssertionError(f"Launch summary session_cache mismatch\nPayload: {launch_summary!r}")
 
         registration_output = run_client(args.binary, *base_args, "--dump-registration")
         registration_summary = parse_key_value_payload(registration_output)
         assert_registration_summary(registration_summary)
+        if registration_summary.get("session_cache_hit") != "false":
+            raise AssertionError(f"Unexpected session cache hit\nPayload: {registration_summary!r}")
+
+        profiles_path = pathlib.Path(tmpdir) / "sotc_profiles.cfg"
+        profiles_path.write_text(
+            textwrap.dedent(
+                """
+                coordinator_host = fleet.example
+                player_name = Fleet Bot
+
+                [alpha]
+                server_port = 3980
+                hosted_server = 3990, name=Alpha
+
+                [beta]
+                server_port = 3981
+                player_name = Beta Bot
+                """
+            ).strip()
+            + "\n",
+            encoding="utf-8",
+        )
+        profile_summary = parse_key_value_payload(
+            run_client(args.binary, "--profile", "beta", "--config", str(profiles_path), "--dump-launch-options")
+        )
+        expected_profile = {
+            "coordinator_host": "fleet.example",
+            "server_port": "3981",
+            "player_name": "Beta Bot",
+            "hosted_servers": "",
+        }
+        for key, value in expected_profile.items():
+            if profile_summary.get(key) != value:
+                raise AssertionError(
+                    f"Profile summary mismatch for '{key}': expected {value!r}, got {profile_summary.get(key)!r}\n"
+                    f"Payload: {profile_summary!r}"
+                )
+
+        # Every profile registers, with the options after --config applied.
+        all_profiles_args = ["--all-profiles", "--config", str(profiles_path), "--player", "CLI Bot"]
+        all_summary = parse_key_value_payload(run_client(args.binary, *all_profiles_args, "--dump-launch-options"))
+        if all_summary.get("profiles") != "alpha,beta":
+            raise AssertionError(f"Unexpected profiles in summary\nPayload: {all_summary!r}")
+        if profile_summary.get("profiles") != "":
+            raise AssertionError(f"--profile alone must not list profiles\nPayload: {profile_summary!r}")
+
+        # A pipe cannot be mapped; the loader must read it instead.
+        piped_summary = parse_key_value_payload(
+            run_client(
+                args.binary,
+                "--config",
+                "/dev/stdin",
+                "--dump-launch-options",
+                stdin="server_host = piped.example\nplayer_name = Piped Bot\n",
+            )
+        )
+        for key, value in {"server_host": "piped.example", "player_name": "Piped Bot"}.items():
+            if piped_summary.get(key) != value:
+                raise AssertionError(
+                    f"Piped config mismatch for '{key}': expected {value!r}, got {piped_summary.get(key)!r}\n"
+                    f"Payload: {piped_summary!r}"
+                )
 
     return 0
 
@@ -0,0 +1,93 @@
+#!/usr/bin/env python3
+"""End-to-end server listing against the loopback mock Game Coordinator.
+
+Starts ``sotc_mock_coordinator`` with a synthetic listing large enough to span
+several GC_LISTING packets, runs the client with ``--list-servers`` and checks
+that every server was printed, that the NewGRF lookup table was transferred
+and that the coordinator served exactly one listing.
+"""
+
+from __future__ import annotations
+
+import argparse
+import pathlib
+import re
+import signal
+import subprocess
+import sys
+from typing import Dict
+
+LISTED_SERVERS = 400
+
+
+def parse_key_value_payload(output: str) -> Dict[str, str]:
+    result: Dict[str, str] = {}
+    for line in output.splitlines():
+        if "=" in line:
+            key, value = line.split("=", 1)
+            result[key.strip()] = value.strip()
+    return result
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--binary", type=pathlib.Path, required=True, help="Path to the sotc client executable")
+    parser.add_argument("--mock", type=pathlib.Path, required=True, help="Path to sotc_mock_coordinator")
+    args = parser.parse_args()
+
+    mock = subprocess.Popen(
+        [
+            str(args.mock),
+            "--listed-servers",
+            str(LISTED_SERVERS),
+            "--report-interval",
+            "0",
+            "--duration",
+            "30",
+        ],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+    )
+    try:
+        listening = mock.stdout.readline().strip() if mock.stdout else ""
+        match = re.fullmatch(r"listening=(.+):(\d+)", listening)
+        if not match:
+            raise AssertionError(f"Unexpected mock coordinator banner: {listening!r}")
+
+        client = subprocess.run(
+            [str(args.binary), "--headless", "--list-servers", "--coordinator", f"127.0.0.1:{match.group(2)}"],
+            stdout=subprocess.PIPE,
+            stderr=subprocess.PIPE,
+            text=True,
+            timeout=20,
+        )
+        if client.returncode != 0:
+            raise AssertionError(f"Client exited with {client.returncode}\nstderr: {client.stderr!r}")
+
+        listed = [line for line in client.stdout.splitlines() if "Mock listed server" in line]
+        if len(listed) != LISTED_SERVERS:
+            raise AssertionError(f"Expected {LISTED_SERVERS} servers, client printed {len(listed)}:\n{client.stdout}")
+        if "unknown" in client.stdout:
+            raise AssertionError(f"Client could not resolve every NewGRF:\n{client.stdout}")
+        complete = re.search(r"Server listing complete: (\d+) servers, (\d+) NewGRF lookup entries", client.stdout)
+        if not complete or int(complete.group(1)) != LISTED_SERVERS or int(complete.group(2)) == 0:
+            raise AssertionError(f"Unexpected listing summary:\n{client.stdout}")
+
+        mock.send_signal(signal.SIGINT)
+        mock_stdout, _ = mock.communicate(timeout=10)
+        summary = parse_key_value_payload(mock_stdout)
+        if summary.get("listings") != "1" or summary.get("malformed") != "0":
+            raise AssertionError(f"Unexpected mock coordinator summary: {summary!r}")
+        if summary.get("newgrf_lookup_entries_sent") != complete.group(2):
+            raise AssertionError(f"Lookup entries sent and received differ: {summary!r}")
+    finally:
+        if mock.poll() is None:
+            mock.kill()
+            mock.wait()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""End-to-end registration against the loopback mock Game Coordinator.
+
+Starts ``sotc_mock_coordinator`` on a free loopback port, runs the client with
+``--register`` and a few ``--hosted-server`` entries against it, interrupts the
+client once every server has had time to register and then checks both the
+client's and the coordinator's summaries. A second run registers every
+``[profile]`` of a configuration file through ``--all-profiles``. Nothing
+leaves the loopback interface.
+"""
+
+from __future__ import annotations
+
+import argparse
+import pathlib
+import re
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+from typing import Dict
+
+
+def parse_key_value_payload(output: str) -> Dict[str, str]:
+    result: Dict[str, str] = {}
+    for line in output.splitlines():
+        if "=" in line:
+            key, value = line.split("=", 1)
+            result[key.strip()] = value.strip()
+    return result
+
+
+def run_until_interrupted(command: list[str]) -> str:
+    """Run the client for long enough to register, interrupt it and return its stdout."""
+
+    client = subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+    time.sleep(1.5)
+    client.send_signal(signal.SIGINT)
+    client_stdout, client_stderr = client.communicate(timeout=10)
+    if client.returncode != 0:
+        raise AssertionError(f"Client exited with {client.returncode}\nstderr: {client_stderr!r}")
+    return client_stdout
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--binary", type=pathlib.Path, required=True, help="Path to the sotc client executable")
+    parser.add_argument("--mock", type=pathlib.Path, required=True, help="Path to sotc_mock_coordinator")
+    args = parser.parse_args()
+
+    mock = subprocess.Popen(
+        [str(args.mock), "--delay", "5", "--report-interval", "0", "--duration", "30"],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        text=True,
+    )
+    try:
+        listening = mock.stdout.readline().strip() if mock.stdout else ""
+        match = re.fullmatch(r"listening=(.+):(\d+)", listening)
+        if not match:
+            raise AssertionError(f"Unexpected mock coordinator banner: {listening!r}")
+        coordinator = f"127.0.0.1:{match.group(2)}"
+
+        client_stdout = run_until_interrupted(
+            [
+                str(args.binary),
+                "--headless",
+                "--register",
+                "--coordinator",
+                coordinator,
+                "--hosted-server",
+                "3980,name=Alpha",
+                "--hosted-server",
+                "3981,name=Beta,stun=off",
+                "--hosted-server",
+                "3982,name=Gamma,invite_code=+GAMMA",
+            ]
+        )
+
+        if "Coordinator servers registered: 3/3" not in client_stdout:
+            raise AssertionError(f"Client did not register every hosted server:\n{client_stdout}")
+        acknowledgements = re.search(r"Coordinator acknowledgements: (\d+)", client_stdout)
+        if not acknowledgements or int(acknowledgements.group(1)) < 3:
+            raise AssertionError(f"Client reported too few acknowledgements:\n{client_stdout}")
+        if "Heartbeat scheduling jitter" not in client_stdout:
+            raise AssertionError(f"Client summary is missing the jitter metric:\n{client_stdout}")
+
+        # --coordinator follows --config, so it must reach every profile.
+        with tempfile.TemporaryDirectory() as tmpdir:
+            profiles_path = pathlib.Path(tmpdir) / "sotc_profiles.cfg"
+            profiles_path.write_text(
+                "headless = true\n[delta]\nserver_port = 3990\n[epsilon]\nserver_port = 3991\n",
+                encoding="utf-8",
+            )
+            profiles_stdout = run_until_interrupted(
+                [
+                    str(args.binary),
+                    "--all-profiles",
+                    "--config",
+                    str(profiles_path),
+                    "--register",
+                    "--coordinator",
+                    coordinator,
+                ]
+            )
+        if "Coordinator servers registered: 2/2" not in profiles_stdout:
+            raise AssertionError(f"Client did not register every profile:\n{profiles_stdout}")
+
+        mock.send_signal(signal.SIGINT)
+        mock_stdout, _ = mock.communicate(timeout=10)
+        summary = parse_key_value_payload(mock_stdout)
+        if summary.get("registrations") != "5" or summary.get("malformed") != "0":
+            raise AssertionError(f"Unexpected mock coordinator summary: {summary!r}")
+        if float(summary.get("service_latency_p50_ms", "0")) < 5.0:
+            raise AssertionError(f"Configured reply delay was not applied: {summary!r}")
+    finally:
+        if mock.poll() is None:
+            mock.kill()
+            mock.wait()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
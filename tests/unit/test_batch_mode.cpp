@@ -0,0 +1,96 @@
+#include "batch_mode.hpp"
+#include "launch_summary.hpp"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "unit_test.hpp"
+
+namespace {
+
+[[nodiscard]] std::string response_for(std::uint64_t number, const std::string &request,
+                                       const sotc::LaunchOptions &defaults = {}) {
+    std::ostringstream out;
+    static_cast<void>(sotc::write_batch_response(number, request, defaults, out));
+    return out.str();
+}
+
+} // namespace
+
+SOTC_TEST(batch_response_matches_dumps) {
+    sotc::LaunchOptions defaults{};
+    defaults.coordinator_host = "fleet.example";
+    std::ostringstream out;
+    SOTC_CHECK(sotc::write_batch_response(7, "server_port = 3990\\nplayer_name = Tab\\tName\t--headless", defaults,
+                                          out));
+
+    auto expected_options = defaults;
+    expected_options.server_port = 3990;
+    expected_options.player_name = "Tab\tName";
+    expected_options.headless = true;
+    std::ostringstream expected;
+    expected << "request=7\nstatus=ok\n";
+    sotc::write_launch_summary(expected_options, expected);
+    sotc::write_registration_summary(expected_options, expected);
+    expected << '\n';
+    SOTC_CHECK(out.str() == expected.str());
+}
+
+SOTC_TEST(batch_response_applies_overrides_after_config_and_selects_profiles) {
+    const auto overridden = response_for(1, "server_port = 3990\t--server-port\t3991");
+    SOTC_CHECK(overridden.find("\nserver_port=3991\n") != std::string::npos);
+
+    const auto profile = response_for(2, "server_port = 1\\n[beta]\\nserver_port = 2\t--profile\tbeta");
+    SOTC_CHECK(profile.find("\nserver_port=2\n") != std::string::npos);
+}
+
+SOTC_TEST(batch_response_reports_errors) {
+    std::ostringstream out;
+    SOTC_CHECK(!sotc::write_batch_response(3, "bogus = 1\t--server-port\tnope", {}, out));
+    SOTC_CHECK(out.str() == "request=3\nstatus=error\n"
+                            "error=Unknown configuration key 'bogus' at line 1\n"
+                            "error=Invalid server port: nope\n\n");
+
+    SOTC_CHECK(response_for(4, "\t--config\tother.cfg").find(
+                   "error=Option --config is not supported in batch requests\n") != std::string::npos);
+    SOTC_CHECK(response_for(5, "\t--server-port").find("error=Missing value for option --server-port\n") !=
+               std::string::npos);
+    SOTC_CHECK(response_for(6, "\tstray").find("error=Unknown option: stray\n") != std::string::npos);
+    SOTC_CHECK(response_for(7, "\t--profile\tmissing").find("status=error\n") != std::string::npos);
+}
+
+SOTC_TEST(run_batch_answers_in_request_order) {
+    constexpr int kRequests = 500;
+    std::string input;
+    for (int index = 0; index < kRequests; ++index) {
+        input += "server_port = " + std::to_string(1000 + index) + (index % 7 == 0 ? "\t--bogus\n" : "\n");
+    }
+    std::istringstream in{input};
+    std::ostringstream out;
+    sotc::BatchOptions options{};
+    options.workers = 4;
+    options.max_pending = 16;
+    const auto stats = sotc::run_batch(in, out, {}, options);
+    SOTC_CHECK(stats.requests == kRequests);
+    SOTC_CHECK(stats.failed == (kRequests + 6) / 7);
+    SOTC_CHECK(stats.workers == 4);
+    SOTC_CHECK(stats.requests_per_second() > 0.0);
+
+    std::istringstream lines{out.str()};
+    std::string line;
+    int next = 1;
+    while (std::getline(lines, line)) {
+        if (line.rfind("request=", 0) == 0) {
+            SOTC_CHECK(line == "request=" + std::to_string(next));
+            ++next;
+        }
+        if (line.rfind("listen_port=", 0) == 0) {
+            SOTC_CHECK(line == "listen_port=" + std::to_string(1000 + next - 2));
+        }
+    }
+    SOTC_CHECK(next == kRequests + 1);
+}
+
+SOTC_TEST_MAIN()
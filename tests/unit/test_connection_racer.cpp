@@ -0,0 +1,251 @@
+#include "network/connection_racer.hpp"
+
+#include "network/packet_framer.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+using namespace sotc::network;
+
+constexpr std::uint8_t kHelloType = 7;
+constexpr std::uint8_t kReplyType = 6;
+
+// Loopback stand-in for one path. It answers every hello after reply_delay,
+// or never when reply_delay is unset, which simulates a blocked path that
+// still accepts the TCP connection.
+class StandInPath {
+public:
+    StandInPath(EventLoop &loop, std::optional<EventLoop::Clock::duration> reply_delay)
+        : loop_(loop), reply_delay_(reply_delay) {
+        listener_ = listen_nonblocking(loopback_endpoint(0));
+        endpoint_ = local_endpoint(listener_.get());
+        loop_.add(listener_.get(), EventLoop::kReadable, [this](std::uint32_t) { accept_all(); });
+    }
+
+    ~StandInPath() {
+        for (const auto timer : timers_) {
+            loop_.cancel(timer);
+        }
+        for (const auto &[fd, socket] : connections_) {
+            loop_.remove(fd);
+        }
+        loop_.remove(listener_.get());
+    }
+
+    StandInPath(const StandInPath &) = delete;
+    StandInPath &operator=(const StandInPath &) = delete;
+
+    [[nodiscard]] const Endpoint &endpoint() const noexcept { return endpoint_; }
+    [[nodiscard]] std::size_t hellos() const noexcept { return hellos_; }
+
+private:
+    void accept_all() {
+        while (true) {
+            SocketHandle client{::accept4(listener_.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)};
+            if (!client) {
+                return;
+            }
+            const int fd = client.get();
+            connections_.emplace(fd, std::move(client));
+            loop_.add(fd, EventLoop::kReadable, [this, fd](std::uint32_t) { read(fd); });
+        }
+    }
+
+    void read(int fd) {
+        std::byte buffer[256];
+        const auto received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            loop_.remove(fd);
+            connections_.erase(fd);
+            return;
+        }
+        ++hellos_;
+        if (reply_delay_) {
+            timers_.push_back(loop_.schedule_after(*reply_delay_, [this, fd] { reply(fd); }));
+        }
+    }
+
+    void reply(int fd) {
+        if (!connections_.contains(fd)) {
+            return;
+        }
+        std::vector<std::byte> packet(NETWORK_PACKET_HEADER_SIZE + 2);
+        write_packet_header(packet, kReplyType, 2);
+        packet[3] = std::byte{'o'};
+        packet[4] = std::byte{'k'};
+        static_cast<void>(::send(fd, packet.data(), packet.size(), MSG_NOSIGNAL));
+    }
+
+    EventLoop &loop_;
+    std::optional<EventLoop::Clock::duration> reply_delay_;
+    SocketHandle listener_;
+    Endpoint endpoint_{};
+    std::map<int, SocketHandle> connections_;
+    std::vector<EventLoop::TimerId> timers_;
+    std::size_t hellos_{0};
+};
+
+[[nodiscard]] std::vector<std::byte> make_hello() {
+    std::vector<std::byte> hello(NETWORK_PACKET_HEADER_SIZE);
+    write_packet_header(hello, kHelloType, 0);
+    return hello;
+}
+
+[[nodiscard]] Endpoint refused_endpoint() {
+    const auto listener = listen_nonblocking(loopback_endpoint(0));
+    return local_endpoint(listener.get());
+}
+
+bool run_until(EventLoop &loop, const std::function<bool()> &done, EventLoop::Clock::duration timeout = 5s) {
+    const auto deadline = EventLoop::Clock::now() + timeout;
+    while (!done()) {
+        if (EventLoop::Clock::now() > deadline) {
+            return false;
+        }
+        loop.run_once(10ms);
+    }
+    return true;
+}
+
+[[nodiscard]] bool finished(const ConnectionRacer &racer) {
+    return racer.state() == RaceState::Connected || racer.state() == RaceState::Failed;
+}
+
+} // namespace
+
+SOTC_TEST(allowed_paths_follow_registration_config) {
+    RegistrationConfig config{};
+    SOTC_CHECK((allowed_paths(config) ==
+                std::vector<NatCapability>{NatCapability::Direct, NatCapability::Stun, NatCapability::Turn}));
+    config.allow_direct = false;
+    config.allow_turn = false;
+    SOTC_CHECK(allowed_paths(config) == std::vector<NatCapability>{NatCapability::Stun});
+
+    const auto capabilities = static_cast<std::uint8_t>(NatCapability::Direct | NatCapability::Turn);
+    SOTC_CHECK(describe_capabilities(capabilities, NatCapability::Turn) == "direct, TURN; connected via TURN");
+    SOTC_CHECK(to_string(NatCapability::Stun) == "STUN");
+}
+
+SOTC_TEST(fast_direct_path_wins_before_others_start) {
+    EventLoop loop;
+    StandInPath direct{loop, 0ms};
+    StandInPath stun{loop, 0ms};
+
+    ConnectionRaceOptions options{};
+    options.stagger = 2s;
+    ConnectionRacer racer{loop, options};
+    racer.start({{NatCapability::Direct, direct.endpoint(), make_hello()},
+                 {NatCapability::Stun, stun.endpoint(), make_hello()}});
+
+    SOTC_CHECK(run_until(loop, [&] { return finished(racer); }));
+    SOTC_CHECK(racer.state() == RaceState::Connected);
+    SOTC_CHECK(racer.winning_path() == NatCapability::Direct);
+    SOTC_CHECK(racer.attempts()[0].outcome == PathOutcome::Won);
+    SOTC_CHECK(racer.attempts()[1].outcome == PathOutcome::NotStarted);
+    SOTC_CHECK(stun.hellos() == 0);
+    SOTC_CHECK(racer.handshake_reply().size() == NETWORK_PACKET_HEADER_SIZE + 2);
+    SOTC_CHECK(std::to_integer<std::uint8_t>(racer.handshake_reply()[2]) == kReplyType);
+
+    const auto socket = racer.take_socket();
+    SOTC_CHECK(static_cast<bool>(socket));
+    SOTC_CHECK(!racer.take_socket());
+}
+
+SOTC_TEST(slow_path_loses_to_staggered_one) {
+    EventLoop loop;
+    StandInPath direct{loop, 2s};
+    StandInPath stun{loop, 0ms};
+    StandInPath turn{loop, 0ms};
+
+    ConnectionRaceOptions options{};
+    options.stagger = 50ms;
+    ConnectionRacer racer{loop, options};
+    std::size_t completions = 0;
+    racer.set_completion_callback([&](RaceState) { ++completions; });
+    racer.start({{NatCapability::Direct, direct.endpoint(), make_hello()},
+                 {NatCapability::Stun, stun.endpoint(), make_hello()},
+                 {NatCapability::Turn, turn.endpoint(), make_hello()}});
+
+    SOTC_CHECK(run_until(loop, [&] { return finished(racer); }));
+    SOTC_CHECK(completions == 1);
+    SOTC_CHECK(racer.winning_path() == NatCapability::Stun);
+    const auto &attempts = racer.attempts();
+    SOTC_CHECK(attempts[0].outcome == PathOutcome::Cancelled);
+    SOTC_CHECK(attempts[1].outcome == PathOutcome::Won);
+    SOTC_CHECK(attempts[1].started_after >= 50ms);
+    SOTC_CHECK(attempts[1].elapsed < 1s);
+    SOTC_CHECK(attempts[0].elapsed >= attempts[1].started_after);
+    SOTC_CHECK(attempts[2].outcome == PathOutcome::NotStarted);
+    SOTC_CHECK(direct.hellos() == 1);
+    // Only the listeners and the cancelled path's server-side socket remain.
+    SOTC_CHECK(loop.watched_descriptors() == 3 + 1 + 1);
+}
+
+SOTC_TEST(refused_path_starts_next_at_once) {
+    EventLoop loop;
+    StandInPath turn{loop, 0ms};
+
+    ConnectionRaceOptions options{};
+    options.stagger = 5s;
+    ConnectionRacer racer{loop, options};
+    racer.start({{NatCapability::Direct, refused_endpoint(), make_hello()},
+                 {NatCapability::Turn, turn.endpoint(), make_hello()}});
+
+    SOTC_CHECK(run_until(loop, [&] { return finished(racer); }, 2s));
+    SOTC_CHECK(racer.winning_path() == NatCapability::Turn);
+    SOTC_CHECK(racer.attempts()[0].outcome == PathOutcome::Failed);
+    SOTC_CHECK(!racer.attempts()[0].error.empty());
+    SOTC_CHECK(racer.attempts()[1].started_after < 1s);
+}
+
+SOTC_TEST(blocked_paths_time_out) {
+    EventLoop loop;
+    StandInPath direct{loop, std::nullopt};
+    StandInPath stun{loop, std::nullopt};
+
+    ConnectionRaceOptions options{};
+    options.stagger = 10ms;
+    options.timeout = 100ms;
+    ConnectionRacer racer{loop, options};
+    racer.start({{NatCapability::Direct, direct.endpoint(), make_hello()},
+                 {NatCapability::Stun, stun.endpoint(), make_hello()}});
+
+    SOTC_CHECK(run_until(loop, [&] { return finished(racer); }));
+    SOTC_CHECK(racer.state() == RaceState::Failed);
+    SOTC_CHECK(!racer.winning_path());
+    SOTC_CHECK(!racer.last_error().empty());
+    for (const auto &attempt : racer.attempts()) {
+        SOTC_CHECK(attempt.outcome == PathOutcome::Failed);
+        SOTC_CHECK(attempt.error == "Timed out");
+    }
+    SOTC_CHECK(loop.pending_timers() == 0);
+
+    racer.start({});
+    SOTC_CHECK(racer.state() == RaceState::Failed);
+}
+
+SOTC_TEST(connect_alone_wins_without_hello) {
+    EventLoop loop;
+    StandInPath direct{loop, std::nullopt};
+
+    ConnectionRacer racer{loop};
+    racer.start({{NatCapability::Direct, direct.endpoint(), {}}});
+    SOTC_CHECK(run_until(loop, [&] { return finished(racer); }));
+    SOTC_CHECK(racer.winning_path() == NatCapability::Direct);
+    SOTC_CHECK(racer.handshake_reply().empty());
+}
+
+SOTC_TEST_MAIN()
@@ -0,0 +1,270 @@
+#include "network/content_downloader.hpp"
+
+#include "network/md5.hpp"
+#include "network/mock_content_server.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+using namespace sotc::network;
+
+// A cache directory under the temporary directory, removed on scope exit.
+class TemporaryDirectory {
+public:
+    explicit TemporaryDirectory(const std::string &name)
+        : path_(std::filesystem::temp_directory_path() / ("sotc-" + std::to_string(::getpid()) + '-' + name)) {}
+    ~TemporaryDirectory() {
+        std::error_code error;
+        std::filesystem::remove_all(path_, error);
+    }
+
+    TemporaryDirectory(const TemporaryDirectory &) = delete;
+    TemporaryDirectory &operator=(const TemporaryDirectory &) = delete;
+
+    [[nodiscard]] const std::filesystem::path &path() const noexcept { return path_; }
+
+private:
+    std::filesystem::path path_;
+};
+
+[[nodiscard]] Md5Digest md5_of(std::string_view text) {
+    Md5 hash;
+    hash.update(std::as_bytes(std::span{text.data(), text.size()}));
+    return hash.finish();
+}
+
+// Deterministic pseudo-random file contents.
+[[nodiscard]] std::vector<std::byte> make_content(std::size_t size, std::uint32_t seed) {
+    std::vector<std::byte> content(size);
+    for (auto &byte : content) {
+        seed = seed * 1664525U + 1013904223U;
+        byte = static_cast<std::byte>(seed >> 24U);
+    }
+    return content;
+}
+
+[[nodiscard]] ContentRequest serve(MockContentServer &server, std::uint32_t grfid, const std::vector<std::byte> &content,
+                                   bool with_size = true) {
+    Md5 hash;
+    hash.update(content);
+    ContentRequest request{};
+    request.identity.grfid = grfid;
+    request.identity.md5 = hash.finish();
+    const auto path = "/grf/" + to_hex(request.identity.md5);
+    server.add(path, content);
+    request.url = server.url(path);
+    request.size = with_size ? content.size() : 0;
+    return request;
+}
+
+[[nodiscard]] std::vector<std::byte> read_file(const std::filesystem::path &path) {
+    std::ifstream input{path, std::ios::binary};
+    const std::vector<char> bytes{std::istreambuf_iterator<char>{input}, std::istreambuf_iterator<char>{}};
+    const auto *data = reinterpret_cast<const std::byte *>(bytes.data());
+    return std::vector<std::byte>{data, data + bytes.size()};
+}
+
+bool run_until(EventLoop &loop, const std::function<bool()> &done, EventLoop::Clock::duration timeout = 10s) {
+    const auto deadline = EventLoop::Clock::now() + timeout;
+    while (!done()) {
+        if (EventLoop::Clock::now() > deadline) {
+            return false;
+        }
+        loop.run_once(10ms);
+    }
+    return true;
+}
+
+} // namespace
+
+SOTC_TEST(md5_matches_rfc_1321_vectors) {
+    SOTC_CHECK(to_hex(md5_of("")) == "d41d8cd98f00b204e9800998ecf8427e");
+    SOTC_CHECK(to_hex(md5_of("abc")) == "900150983cd24fb0d6963f7d28e17f72");
+    SOTC_CHECK(to_hex(md5_of("message digest")) == "f96b697d7cb7938d525a2f31aaf161d0");
+    SOTC_CHECK(to_hex(md5_of("12345678901234567890123456789012345678901234567890123456789012345678901234567890")) ==
+               "57edf4a22be3c955ac49da2e2107b67a");
+
+    // Feeding the same bytes in uneven pieces gives the same digest.
+    const auto content = make_content(1000, 7);
+    Md5 whole;
+    whole.update(content);
+    Md5 pieces;
+    for (std::size_t offset = 0; offset < content.size(); offset += 37) {
+        pieces.update(std::span{content}.subspan(offset, std::min<std::size_t>(37, content.size() - offset)));
+    }
+    SOTC_CHECK(pieces.size() == content.size());
+    SOTC_CHECK(pieces.finish() == whole.finish());
+}
+
+SOTC_TEST(content_downloader_fetches_verifies_and_caches) {
+    const TemporaryDirectory directory{"content-fetch"};
+    EventLoop loop;
+    MockContentServer server{loop};
+    std::vector<ContentRequest> requests;
+    for (std::uint32_t index = 0; index < 24; ++index) {
+        requests.push_back(serve(server, index, make_content(20'000 + index * 1'000, index + 1), index % 2 == 0));
+    }
+
+    ContentDownloadOptions options{};
+    options.cache_directory = directory.path();
+    options.max_connections_per_host = 3;
+    {
+        ContentDownloader downloader{loop, options};
+        std::size_t settled = 0;
+        downloader.set_result_callback([&](ContentDownloader::DownloadId, const ContentDownload &) { ++settled; });
+        for (const auto &request : requests) {
+            static_cast<void>(downloader.add(request));
+        }
+        // A second request for the same content rides along with the first.
+        const auto duplicate = downloader.add(requests.front());
+        SOTC_CHECK(run_until(loop, [&] { return downloader.idle(); }));
+        SOTC_CHECK(settled == requests.size() + 1);
+
+        for (std::size_t id = 0; id < requests.size(); ++id) {
+            const auto &download = downloader.download(id);
+            SOTC_CHECK(download.status == ContentDownloadStatus::Downloaded);
+            SOTC_CHECK(download.path == downloader.cache().path_for(requests[id].identity.md5));
+            SOTC_CHECK(read_file(download.path) == make_content(20'000 + id * 1'000, static_cast<std::uint32_t>(id + 1)));
+        }
+        SOTC_CHECK(downloader.download(duplicate).status == ContentDownloadStatus::Downloaded);
+        SOTC_CHECK(server.stats().requests == requests.size());
+        SOTC_CHECK(server.stats().peak_active_responses <= 3);
+    }
+
+    // A second join finds everything in the cache.
+    ContentDownloader downloader{loop, options};
+    for (const auto &request : requests) {
+        const auto id = downloader.add(request);
+        SOTC_CHECK(downloader.download(id).status == ContentDownloadStatus::Cached);
+    }
+    SOTC_CHECK(downloader.idle());
+    SOTC_CHECK(downloader.cache_hits() == requests.size());
+    SOTC_CHECK(downloader.bytes_downloaded() == 0);
+    SOTC_CHECK(server.stats().requests == requests.size());
+}
+
+SOTC_TEST(content_downloader_resumes_interrupted_transfers) {
+    const TemporaryDirectory directory{"content-resume"};
+    EventLoop loop;
+    MockContentServerOptions server_options{};
+    server_options.truncate_first_response_after = 10'000;
+    MockContentServer server{loop, server_options};
+    const auto content = make_content(50'000, 42);
+    const auto request = serve(server, 1, content);
+
+    ContentDownloadOptions options{};
+    options.cache_directory = directory.path();
+    ContentDownloader downloader{loop, options};
+    const auto id = downloader.add(request);
+    SOTC_CHECK(run_until(loop, [&] { return downloader.idle(); }));
+
+    const auto &download = downloader.download(id);
+    SOTC_CHECK(download.status == ContentDownloadStatus::Downloaded);
+    SOTC_CHECK(download.attempts == 2);
+    SOTC_CHECK(download.resumed_from == 10'000);
+    SOTC_CHECK(download.bytes_received == content.size());
+    SOTC_CHECK(server.stats().truncated == 1);
+    SOTC_CHECK(server.stats().range_requests == 1);
+    SOTC_CHECK(read_file(download.path) == content);
+    SOTC_CHECK(!std::filesystem::exists(downloader.cache().partial_path_for(request.identity.md5)));
+}
+
+SOTC_TEST(content_downloader_resumes_partial_file_from_earlier_run) {
+    const TemporaryDirectory directory{"content-partial"};
+    EventLoop loop;
+    MockContentServer server{loop};
+    const auto content = make_content(30'000, 9);
+    const auto request = serve(server, 2, content, false);
+
+    const ContentCache cache{directory.path()};
+    std::filesystem::create_directories(cache.partial_path_for(request.identity.md5).parent_path());
+    {
+        std::ofstream partial{cache.partial_path_for(request.identity.md5), std::ios::binary};
+        partial.write(reinterpret_cast<const char *>(content.data()), 12'345);
+    }
+
+    ContentDownloadOptions options{};
+    options.cache_directory = directory.path();
+    ContentDownloader downloader{loop, options};
+    const auto id = downloader.add(request);
+    SOTC_CHECK(run_until(loop, [&] { return downloader.idle(); }));
+    SOTC_CHECK(downloader.download(id).status == ContentDownloadStatus::Downloaded);
+    SOTC_CHECK(downloader.download(id).resumed_from == 12'345);
+    SOTC_CHECK(downloader.bytes_downloaded() == content.size() - 12'345);
+    SOTC_CHECK(read_file(downloader.download(id).path) == content);
+}
+
+SOTC_TEST(content_downloader_restarts_when_range_is_ignored) {
+    const TemporaryDirectory directory{"content-no-range"};
+    EventLoop loop;
+    MockContentServerOptions server_options{};
+    server_options.ignore_range = true;
+    MockContentServer server{loop, server_options};
+    const auto content = make_content(20'000, 5);
+    const auto request = serve(server, 3, content);
+
+    const ContentCache cache{directory.path()};
+    std::filesystem::create_directories(cache.partial_path_for(request.identity.md5).parent_path());
+    {
+        std::ofstream partial{cache.partial_path_for(request.identity.md5), std::ios::binary};
+        partial << "stale bytes that are not the start of the file";
+    }
+
+    ContentDownloadOptions options{};
+    options.cache_directory = directory.path();
+    ContentDownloader downloader{loop, options};
+    const auto id = downloader.add(request);
+    SOTC_CHECK(run_until(loop, [&] { return downloader.idle(); }));
+    SOTC_CHECK(downloader.download(id).status == ContentDownloadStatus::Downloaded);
+    SOTC_CHECK(downloader.download(id).resumed_from == 0);
+    SOTC_CHECK(read_file(downloader.download(id).path) == content);
+}
+
+SOTC_TEST(content_downloader_rejects_bad_content) {
+    const TemporaryDirectory directory{"content-bad"};
+    EventLoop loop;
+    MockContentServer server{loop};
+    const auto content = make_content(8'000, 3);
+
+    auto corrupted = serve(server, 4, content);
+    corrupted.identity.md5[0] ^= 0xFFU;
+    auto oversized = serve(server, 5, make_content(9'000, 4));
+    oversized.size = 4'000;
+    ContentRequest missing{};
+    missing.identity.grfid = 6;
+    missing.url = server.url("/grf/missing");
+
+    ContentDownloadOptions options{};
+    options.cache_directory = directory.path();
+    ContentDownloader downloader{loop, options};
+    const auto corrupted_id = downloader.add(corrupted);
+    const auto oversized_id = downloader.add(oversized);
+    const auto missing_id = downloader.add(missing);
+    SOTC_CHECK(run_until(loop, [&] { return downloader.idle(); }));
+
+    SOTC_CHECK(downloader.download(corrupted_id).status == ContentDownloadStatus::ChecksumMismatch);
+    SOTC_CHECK(!downloader.cache().contains(corrupted.identity.md5));
+    SOTC_CHECK(!std::filesystem::exists(downloader.cache().partial_path_for(corrupted.identity.md5)));
+    SOTC_CHECK(downloader.download(oversized_id).status == ContentDownloadStatus::Failed);
+    SOTC_CHECK(downloader.download(oversized_id).attempts == 1);
+    SOTC_CHECK(downloader.download(missing_id).status == ContentDownloadStatus::Failed);
+    // A 404 is not retried.
+    SOTC_CHECK(downloader.download(missing_id).attempts == 1);
+    SOTC_CHECK(server.stats().not_found == 1);
+}
+
+SOTC_TEST_MAIN()
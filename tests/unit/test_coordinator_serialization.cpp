@@ -0,0 +1,229 @@
+#include "network/coordinator_client.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "unit_test.hpp"
+
+namespace {
+
+std::size_t g_allocation_count = 0;
+
+[[nodiscard]] sotc::network::CoordinatorHandshakeFrame make_frame(std::size_t grf_count) {
+    sotc::network::CoordinatorHandshakeFrame frame{};
+    frame.listen_port = 4500;
+    frame.heartbeat_seconds = 45;
+    frame.server_game_type = static_cast<std::uint8_t>(sotc::network::ServerGameType::InviteOnly);
+    frame.server_name = "Allocation Counter's game";
+    frame.invite_code = "+ABCDEF";
+    std::vector<std::string> newgrfs;
+    for (std::size_t index = 0; index < grf_count; ++index) {
+        newgrfs.push_back("4D4D" + std::to_string(1000 + index));
+    }
+    frame.newgrfs = sotc::network::GrfList{std::move(newgrfs)};
+    return frame;
+}
+
+} // namespace
+
+void *operator new(std::size_t size) {
+    ++g_allocation_count;
+    if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+SOTC_TEST(serialized_size_matches_serialize) {
+    for (const std::size_t grf_count : {0U, 62U, 255U}) {
+        const auto frame = make_frame(grf_count);
+        SOTC_CHECK(frame.serialize().size() == frame.serialized_size());
+    }
+}
+
+SOTC_TEST(serialize_into_round_trips) {
+    const auto frame = make_frame(62);
+    std::vector<std::byte> buffer(frame.serialized_size());
+    const auto written = frame.serialize_into(buffer);
+    SOTC_CHECK(written == buffer.size());
+
+    const auto decoded = sotc::network::CoordinatorHandshakeFrame::deserialize(buffer);
+    SOTC_CHECK(decoded.listen_port == frame.listen_port);
+    SOTC_CHECK(decoded.heartbeat_seconds == frame.heartbeat_seconds);
+    SOTC_CHECK(decoded.server_name == frame.server_name);
+    SOTC_CHECK(decoded.invite_code == frame.invite_code);
+    SOTC_CHECK(decoded.newgrfs == frame.newgrfs);
+}
+
+SOTC_TEST(serialize_into_rejects_short_buffer) {
+    const auto frame = make_frame(3);
+    std::vector<std::byte> buffer(frame.serialized_size() - 1);
+    SOTC_CHECK_THROWS(frame.serialize_into(buffer), std::length_error);
+}
+
+SOTC_TEST(serialize_into_does_not_allocate) {
+    const auto frame = make_frame(255);
+    static std::array<std::byte, 32 * 1024> buffer{};
+
+    const auto before = g_allocation_count;
+    const auto size = frame.serialized_size();
+    const auto written = frame.serialize_into(buffer);
+    SOTC_CHECK(g_allocation_count == before);
+    SOTC_CHECK(written == size);
+}
+
+SOTC_TEST(serialize_allocates_once_per_frame) {
+    const auto frame = make_frame(255);
+
+    const auto before = g_allocation_count;
+    const auto payload = frame.serialize();
+    SOTC_CHECK(g_allocation_count - before == 1);
+    SOTC_CHECK(payload.size() == frame.serialized_size());
+}
+
+SOTC_TEST(serialize_caps_grf_list_at_protocol_limit) {
+    const auto frame = make_frame(sotc::network::NETWORK_MAX_GRF_COUNT + 5);
+    const auto decoded = sotc::network::CoordinatorHandshakeFrame::deserialize(frame.serialize());
+    SOTC_CHECK(decoded.newgrfs.size() == sotc::network::NETWORK_MAX_GRF_COUNT);
+}
+
+SOTC_TEST(frame_view_exposes_fields_without_copying) {
+    const auto frame = make_frame(255);
+    const auto payload = frame.serialize();
+
+    const auto before = g_allocation_count;
+    const auto view = sotc::network::CoordinatorHandshakeFrameView::parse(payload);
+    std::size_t grf_index = 0;
+    bool grfs_match = true;
+    for (const auto grf_id : view.grfs()) {
+        grfs_match = grfs_match && grf_id == frame.newgrfs[grf_index];
+        ++grf_index;
+    }
+    SOTC_CHECK(g_allocation_count == before);
+
+    SOTC_CHECK(grfs_match);
+    SOTC_CHECK(grf_index == frame.newgrfs.size());
+    SOTC_CHECK(view.grfs().size() == frame.newgrfs.size());
+    SOTC_CHECK(view.listen_port() == frame.listen_port);
+    SOTC_CHECK(view.heartbeat_seconds() == frame.heartbeat_seconds);
+    SOTC_CHECK(view.server_name() == frame.server_name);
+    SOTC_CHECK(view.invite_code() == frame.invite_code);
+    SOTC_CHECK(reinterpret_cast<const std::byte *>(view.server_name().data()) > payload.data());
+    SOTC_CHECK(reinterpret_cast<const std::byte *>(view.server_name().data()) < payload.data() + payload.size());
+}
+
+SOTC_TEST(frame_view_to_frame_matches_deserialize) {
+    const auto frame = make_frame(62);
+    const auto payload = frame.serialize();
+    const auto owned = sotc::network::CoordinatorHandshakeFrameView::parse(payload).to_frame();
+    SOTC_CHECK(owned.server_name == frame.server_name);
+    SOTC_CHECK(owned.invite_code == frame.invite_code);
+    SOTC_CHECK(owned.newgrfs == frame.newgrfs);
+    SOTC_CHECK(owned.nat_capabilities == frame.nat_capabilities);
+}
+
+SOTC_TEST(frame_view_rejects_truncated_grf_entry) {
+    const auto payload = make_frame(4).serialize();
+    const std::span<const std::byte> truncated{payload.data(), payload.size() - 1};
+    SOTC_CHECK_THROWS(sotc::network::CoordinatorHandshakeFrameView::parse(truncated), std::out_of_range);
+}
+
+SOTC_TEST(try_deserialize_reports_error_codes) {
+    using sotc::network::CoordinatorHandshakeFrame;
+    using sotc::network::DecodeError;
+
+    auto payload = make_frame(4).serialize();
+    SOTC_CHECK(CoordinatorHandshakeFrame::try_deserialize(payload).has_value());
+
+    const std::span<const std::byte> truncated{payload.data(), payload.size() - 1};
+    const auto truncated_result = CoordinatorHandshakeFrame::try_deserialize(truncated);
+    SOTC_CHECK(!truncated_result);
+    SOTC_CHECK(truncated_result.error() == DecodeError::Truncated);
+    SOTC_CHECK(truncated_result.error_field() == "GRF identifier");
+
+    auto trailing = payload;
+    trailing.push_back(std::byte{0});
+    SOTC_CHECK(CoordinatorHandshakeFrame::try_deserialize(trailing).error() == DecodeError::TrailingData);
+
+    // Server name length prefix starts right after the fixed 10-byte header.
+    auto long_name = payload;
+    long_name[10] = std::byte{0x01};
+    long_name[11] = std::byte{0x00};
+    const auto long_name_result = CoordinatorHandshakeFrame::try_deserialize(long_name);
+    SOTC_CHECK(long_name_result.error() == DecodeError::StringTooLong);
+    SOTC_CHECK(long_name_result.error_field() == "server name");
+
+    const auto view_result = sotc::network::CoordinatorHandshakeFrameView::try_parse(long_name);
+    SOTC_CHECK(view_result.error() == DecodeError::StringTooLong);
+    SOTC_CHECK_THROWS(CoordinatorHandshakeFrame::deserialize(long_name), std::length_error);
+}
+
+SOTC_TEST(cached_frame_patches_fixed_fields_in_place) {
+    using sotc::network::CachedRegistrationFrame;
+    using sotc::network::FrameUpdate;
+
+    sotc::network::RegistrationConfig config{};
+    config.server_name = "Patched Server";
+    config.invite_code = "+PATCH";
+    config.advertised_grfs = {"4D4D0001", "4D4D0002", "4D4D0003"};
+    CachedRegistrationFrame cached{config};
+    const auto *storage = cached.payload().data();
+
+    SOTC_CHECK(cached.update(config) == FrameUpdate::Unchanged);
+
+    config.heartbeat_interval = std::chrono::seconds{90};
+    config.listed_publicly = false;
+    config.allow_stun = false;
+    config.listen_port = 4001;
+    config.server_game_type = sotc::network::ServerGameType::FriendsOnly;
+    const auto before = g_allocation_count;
+    SOTC_CHECK(cached.update(config) == FrameUpdate::Patched);
+    SOTC_CHECK(g_allocation_count == before);
+    SOTC_CHECK(cached.patches() == 5);
+    SOTC_CHECK(cached.rebuilds() == 0);
+    SOTC_CHECK(cached.payload().data() == storage);
+
+    const auto expected = sotc::network::CoordinatorClient{}.build_registration_frame(config).serialize();
+    SOTC_CHECK(std::equal(expected.begin(), expected.end(), cached.payload().begin(), cached.payload().end()));
+    SOTC_CHECK(cached.frame().heartbeat_seconds == 90);
+    SOTC_CHECK(cached.frame().public_listing == 0);
+}
+
+SOTC_TEST(cached_frame_rebuilds_on_variable_length_change) {
+    using sotc::network::CachedRegistrationFrame;
+    using sotc::network::FrameUpdate;
+
+    sotc::network::RegistrationConfig config{};
+    config.advertised_grfs = {"4D4D0001"};
+    CachedRegistrationFrame cached{config};
+
+    config.advertised_grfs = config.advertised_grfs.appended("4D4D0002");
+    SOTC_CHECK(cached.update(config) == FrameUpdate::Rebuilt);
+    config.server_name = std::string(300, 'n');
+    SOTC_CHECK(cached.update(config) == FrameUpdate::Rebuilt);
+    // Names beyond the protocol limit compare by their truncated form.
+    config.server_name.push_back('x');
+    SOTC_CHECK(cached.update(config) == FrameUpdate::Unchanged);
+    SOTC_CHECK(cached.rebuilds() == 2);
+
+    const auto expected = sotc::network::CoordinatorClient{}.build_registration_frame(config).serialize();
+    SOTC_CHECK(std::equal(expected.begin(), expected.end(), cached.payload().begin(), cached.payload().end()));
+}
+
+SOTC_TEST_MAIN()
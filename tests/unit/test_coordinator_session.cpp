@@ -0,0 +1,300 @@
+#include "network/coordinator_session.hpp"
+
+#include "network/coordinator_fleet.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+using namespace sotc::network;
+
+// Minimal loopback coordinator: acknowledges every register/update, or
+// answers with GC_ERROR when reject is set.
+class StandInCoordinator {
+public:
+    StandInCoordinator(EventLoop &loop, bool reject) : loop_(loop), reject_(reject) {
+        listener_ = listen_nonblocking(loopback_endpoint(0));
+        port_ = local_endpoint(listener_.get()).port();
+        loop_.add(listener_.get(), EventLoop::kReadable, [this](std::uint32_t) { accept_all(); });
+    }
+
+    ~StandInCoordinator() {
+        for (auto &[fd, connection] : connections_) {
+            loop_.remove(fd);
+        }
+        loop_.remove(listener_.get());
+    }
+
+    [[nodiscard]] std::uint16_t port() const noexcept { return port_; }
+    [[nodiscard]] std::size_t registrations() const noexcept { return registrations_; }
+    [[nodiscard]] std::size_t updates() const noexcept { return updates_; }
+    [[nodiscard]] const std::string &last_server_name() const noexcept { return last_server_name_; }
+
+private:
+    struct Connection {
+        SocketHandle socket;
+        PacketFramer framer{4096, 4096};
+    };
+
+    void accept_all() {
+        while (true) {
+            SocketHandle client{::accept4(listener_.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)};
+            if (!client) {
+                return;
+            }
+            const int fd = client.get();
+            auto connection = std::make_unique<Connection>();
+            connection->socket = std::move(client);
+            connections_.emplace(fd, std::move(connection));
+            loop_.add(fd, EventLoop::kReadable, [this, fd](std::uint32_t) { read(fd); });
+        }
+    }
+
+    void read(int fd) {
+        auto &connection = *connections_.at(fd);
+        auto region = connection.framer.prepare();
+        const auto received = ::recv(fd, region.data(), region.size(), 0);
+        if (received <= 0) {
+            loop_.remove(fd);
+            connections_.erase(fd);
+            return;
+        }
+        connection.framer.commit(static_cast<std::size_t>(received));
+        std::vector<std::byte> scratch;
+        while (const auto packet = connection.framer.front()) {
+            const auto frame = CoordinatorHandshakeFrame::try_deserialize(packet->linearize(scratch));
+            if (frame) {
+                last_server_name_ = frame->server_name;
+            }
+            if (packet->type == static_cast<std::uint8_t>(PacketCoordinatorType::ServerRegister)) {
+                ++registrations_;
+            } else {
+                ++updates_;
+            }
+            connection.framer.pop_front();
+            reply(fd);
+        }
+    }
+
+    void reply(int fd) {
+        std::vector<std::byte> packet;
+        if (reject_) {
+            CoordinatorErrorPacket error{static_cast<std::uint8_t>(CoordinatorErrorCode::InvalidInviteCode), "bad"};
+            packet.resize(NETWORK_PACKET_HEADER_SIZE + error.serialized_size());
+            write_packet_header(packet, static_cast<std::uint8_t>(PacketCoordinatorType::GcError),
+                                error.serialized_size());
+            error.serialize_into(std::span<std::byte>{packet}.subspan(NETWORK_PACKET_HEADER_SIZE));
+        } else {
+            CoordinatorRegisterAck ack{"+STANDIN", "secret", static_cast<std::uint8_t>(ConnectionType::Direct)};
+            packet.resize(NETWORK_PACKET_HEADER_SIZE + ack.serialized_size());
+            write_packet_header(packet, static_cast<std::uint8_t>(PacketCoordinatorType::GcRegisterAck),
+                                ack.serialized_size());
+            ack.serialize_into(std::span<std::byte>{packet}.subspan(NETWORK_PACKET_HEADER_SIZE));
+        }
+        static_cast<void>(::send(fd, packet.data(), packet.size(), MSG_NOSIGNAL));
+    }
+
+    EventLoop &loop_;
+    bool reject_;
+    SocketHandle listener_;
+    std::uint16_t port_{0};
+    std::map<int, std::unique_ptr<Connection>> connections_;
+    std::size_t registrations_{0};
+    std::size_t updates_{0};
+    std::string last_server_name_;
+};
+
+// Accepts connections and never reads or answers on them.
+class SilentCoordinator {
+public:
+    explicit SilentCoordinator(EventLoop &loop) : loop_(loop) {
+        listener_ = listen_nonblocking(loopback_endpoint(0));
+        port_ = local_endpoint(listener_.get()).port();
+        loop_.add(listener_.get(), EventLoop::kReadable, [this](std::uint32_t) {
+            while (true) {
+                SocketHandle client{::accept4(listener_.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)};
+                if (!client) {
+                    return;
+                }
+                clients_.push_back(std::move(client));
+            }
+        });
+    }
+
+    ~SilentCoordinator() { loop_.remove(listener_.get()); }
+
+    SilentCoordinator(const SilentCoordinator &) = delete;
+    SilentCoordinator &operator=(const SilentCoordinator &) = delete;
+
+    [[nodiscard]] std::uint16_t port() const noexcept { return port_; }
+    [[nodiscard]] std::size_t accepted() const noexcept { return clients_.size(); }
+
+private:
+    EventLoop &loop_;
+    SocketHandle listener_;
+    std::uint16_t port_{0};
+    std::vector<SocketHandle> clients_;
+};
+
+[[nodiscard]] RegistrationConfig make_config(std::uint16_t port) {
+    RegistrationConfig config{};
+    config.server_name = "Loopback Server";
+    config.coordinator_host = "127.0.0.1";
+    config.coordinator_port = port;
+    config.advertised_grfs = {"4D4D0001", "4D4D0002"};
+    return config;
+}
+
+bool run_until(EventLoop &loop, const std::function<bool()> &done, EventLoop::Clock::duration timeout = 5s) {
+    const auto deadline = EventLoop::Clock::now() + timeout;
+    while (!done()) {
+        if (EventLoop::Clock::now() > deadline) {
+            return false;
+        }
+        loop.run_once(10ms);
+    }
+    return true;
+}
+
+} // namespace
+
+SOTC_TEST(session_registers_and_sends_heartbeats) {
+    EventLoop loop;
+    StandInCoordinator coordinator{loop, false};
+
+    CoordinatorSessionOptions options{};
+    options.heartbeat_interval = 5ms;
+    CoordinatorSession session{loop, make_config(coordinator.port()), options};
+
+    std::vector<SessionState> transitions;
+    session.set_state_callback([&](SessionState state) { transitions.push_back(state); });
+    session.start();
+
+    SOTC_CHECK(run_until(loop, [&] { return session.ack_latency().count() >= 20; }));
+    SOTC_CHECK(session.state() == SessionState::Registered);
+    SOTC_CHECK(session.registration().invite_code == "+STANDIN");
+    SOTC_CHECK(coordinator.registrations() == 1);
+    SOTC_CHECK(coordinator.updates() >= 19);
+    SOTC_CHECK(coordinator.last_server_name() == "Loopback Server");
+    SOTC_CHECK(session.heartbeats_sent() >= 19);
+    SOTC_CHECK(session.ack_latency().percentile(99) > 0ns);
+    SOTC_CHECK(session.ack_latency().percentile(99) < 1s);
+
+    SOTC_CHECK(transitions.size() == 3);
+    SOTC_CHECK(!transitions.empty() && transitions.back() == SessionState::Registered);
+
+    session.close();
+    SOTC_CHECK(session.state() == SessionState::Closed);
+}
+
+SOTC_TEST(session_surfaces_coordinator_errors) {
+    EventLoop loop;
+    StandInCoordinator coordinator{loop, true};
+    CoordinatorSession session{loop, make_config(coordinator.port())};
+    session.start();
+
+    SOTC_CHECK(run_until(loop, [&] { return session.state() == SessionState::Failed; }));
+    SOTC_CHECK(session.last_error().find("invalid invite code") != std::string::npos);
+}
+
+SOTC_TEST(session_fails_when_coordinator_unreachable) {
+    EventLoop loop;
+    std::uint16_t unused_port = 0;
+    {
+        const auto listener = listen_nonblocking(loopback_endpoint(0));
+        unused_port = local_endpoint(listener.get()).port();
+    }
+    CoordinatorSession session{loop, make_config(unused_port)};
+    session.start();
+
+    SOTC_CHECK(run_until(loop, [&] { return session.state() == SessionState::Failed; }));
+    SOTC_CHECK(loop.watched_descriptors() == 0);
+}
+
+SOTC_TEST(session_fails_when_coordinator_never_acknowledges) {
+    EventLoop loop;
+    SilentCoordinator coordinator{loop};
+    CoordinatorSessionOptions options{};
+    options.register_timeout = 50ms;
+    CoordinatorSession session{loop, make_config(coordinator.port()), options};
+    session.start();
+
+    SOTC_CHECK(run_until(loop, [&] { return session.state() == SessionState::Registering; }));
+    SOTC_CHECK(run_until(loop, [&] { return session.state() == SessionState::Failed; }));
+    SOTC_CHECK(coordinator.accepted() == 1);
+    SOTC_CHECK(session.last_error().find("acknowledge") != std::string::npos);
+    SOTC_CHECK(loop.watched_descriptors() == 1);
+}
+
+SOTC_TEST(fleet_registers_servers_with_independent_heartbeats) {
+    EventLoop loop;
+    StandInCoordinator coordinator{loop, false};
+
+    CoordinatorFleetOptions options{};
+    options.wheel_tick = 1ms;
+    CoordinatorFleet fleet{loop, options};
+
+    constexpr std::size_t kServers = 24;
+    for (std::size_t index = 0; index < kServers; ++index) {
+        auto config = make_config(coordinator.port());
+        config.server_name = "Fleet Server " + std::to_string(index);
+        config.listen_port = static_cast<std::uint16_t>(4000 + index);
+        config.allow_turn = index % 2 == 0;
+        fleet.add(std::move(config), index == 0 ? 5ms : 20ms);
+    }
+    fleet.start();
+
+    SOTC_CHECK(run_until(loop, [&] { return fleet.session(0).heartbeats_sent() >= 20; }));
+    SOTC_CHECK(fleet.count(SessionState::Registered) == kServers);
+    SOTC_CHECK(coordinator.registrations() == kServers);
+    // The 5ms server beats roughly four times as often as the 20ms ones.
+    SOTC_CHECK(fleet.session(1).heartbeats_sent() < fleet.session(0).heartbeats_sent() / 2);
+    SOTC_CHECK(fleet.session(1).heartbeats_sent() >= 2);
+    SOTC_CHECK(fleet.session(1).frame().nat_capabilities != fleet.session(2).frame().nat_capabilities);
+
+    SOTC_CHECK(fleet.heartbeat_jitter().count() == fleet.heartbeats_sent());
+    SOTC_CHECK(fleet.heartbeat_jitter().percentile(50) < 1s);
+    SOTC_CHECK(fleet.wheel().size() == kServers);
+    SOTC_CHECK(loop.pending_timers() == 1);
+
+    fleet.close();
+    SOTC_CHECK(fleet.finished());
+    SOTC_CHECK(fleet.wheel().empty());
+    SOTC_CHECK(loop.pending_timers() == 0);
+}
+
+SOTC_TEST(fleet_wakes_for_earlier_heartbeats_added_later) {
+    EventLoop loop;
+    StandInCoordinator coordinator{loop, false};
+
+    CoordinatorFleetOptions options{};
+    options.wheel_tick = 1ms;
+    CoordinatorFleet fleet{loop, options};
+    auto slow = make_config(coordinator.port());
+    slow.listen_port = 4000;
+    fleet.add(slow, 1h);
+    fleet.start();
+    SOTC_CHECK(run_until(loop, [&] { return fleet.session(0).state() == SessionState::Registered; }));
+    SOTC_CHECK(loop.pending_timers() == 1);
+
+    auto fast = make_config(coordinator.port());
+    fast.listen_port = 4001;
+    const auto server = fleet.add(fast, 5ms);
+    SOTC_CHECK(run_until(loop, [&] { return fleet.session(server).heartbeats_sent() >= 3; }, 2s));
+    SOTC_CHECK(fleet.session(0).heartbeats_sent() == 0);
+    SOTC_CHECK(loop.pending_timers() == 1);
+}
+
+SOTC_TEST_MAIN()
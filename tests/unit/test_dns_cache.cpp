@@ -0,0 +1,219 @@
+#include "network/dns_cache.hpp"
+
+#include "network/coordinator_session.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+using namespace sotc::network;
+
+// Resolves "*.test" names to loopback and everything else to nothing.
+class FakeBackend {
+public:
+    DnsBackend backend() {
+        return [this](const std::string &host, std::uint16_t port, int) {
+            while (held) {
+                std::this_thread::sleep_for(1ms);
+            }
+            ++calls_;
+            DnsAnswer answer{};
+            if (host.ends_with(".test")) {
+                answer.endpoints.push_back(loopback_endpoint(port));
+            }
+            answer.ttl = ttl;
+            answer.transient = answer.endpoints.empty() && transient;
+            return answer;
+        };
+    }
+
+    [[nodiscard]] std::size_t calls() const noexcept { return calls_; }
+
+    std::optional<std::chrono::seconds> ttl{};
+    // Failures are reported as transient while set.
+    std::atomic<bool> transient{false};
+    // Lookups wait while set, so callers can queue up behind one.
+    std::atomic<bool> held{false};
+
+private:
+    std::atomic<std::size_t> calls_{0};
+};
+
+bool run_until(EventLoop &loop, const std::function<bool()> &done, EventLoop::Clock::duration timeout = 5s) {
+    const auto deadline = EventLoop::Clock::now() + timeout;
+    while (!done()) {
+        if (EventLoop::Clock::now() > deadline) {
+            return false;
+        }
+        loop.run_once(10ms);
+    }
+    return true;
+}
+
+} // namespace
+
+SOTC_TEST(dns_cache_shares_lookups_and_caches_answers) {
+    FakeBackend fake;
+    EventLoop loop;
+    DnsCache cache{{}, fake.backend()};
+    cache.attach(loop);
+
+    std::vector<std::string> answers;
+    const auto record = [&](const std::vector<Endpoint> &endpoints) {
+        answers.push_back(endpoints.empty() ? "" : endpoints.front().to_string());
+    };
+    fake.held = true;
+    SOTC_CHECK(cache.resolve("game.test", 3979, record) != 0);
+    SOTC_CHECK(cache.resolve("game.test", 3979, record) != 0);
+    fake.held = false;
+    SOTC_CHECK(run_until(loop, [&] { return answers.size() == 2; }));
+    SOTC_CHECK(answers[0] == "127.0.0.1:3979");
+    SOTC_CHECK(answers[1] == "127.0.0.1:3979");
+    SOTC_CHECK(fake.calls() == 1);
+    SOTC_CHECK(cache.misses() == 2);
+
+    // Fresh answers come back before resolve() returns.
+    SOTC_CHECK(cache.resolve("game.test", 3979, record) == 0);
+    SOTC_CHECK(answers.size() == 3);
+    SOTC_CHECK(cache.hits() == 1);
+    SOTC_CHECK(cache.cached("game.test", 3979).has_value());
+    SOTC_CHECK(!cache.cached("game.test", 3980).has_value());
+    SOTC_CHECK(fake.calls() == 1);
+
+    cache.clear();
+    SOTC_CHECK(!cache.cached("game.test", 3979).has_value());
+    cache.detach();
+    SOTC_CHECK(loop.watched_descriptors() == 0);
+}
+
+SOTC_TEST(dns_cache_remembers_failures_for_negative_ttl) {
+    FakeBackend fake;
+    EventLoop loop;
+    DnsCacheOptions options{};
+    options.negative_ttl = 1h;
+    DnsCache cache{options, fake.backend()};
+    cache.attach(loop);
+
+    std::optional<std::size_t> found;
+    SOTC_CHECK(cache.resolve("missing.example", 3979, [&](const auto &endpoints) { found = endpoints.size(); }) != 0);
+    SOTC_CHECK(run_until(loop, [&] { return found.has_value(); }));
+    SOTC_CHECK(*found == 0);
+
+    found.reset();
+    SOTC_CHECK(cache.resolve("missing.example", 3979, [&](const auto &endpoints) { found = endpoints.size(); }) == 0);
+    SOTC_CHECK(found == std::size_t{0});
+    SOTC_CHECK(cache.negative_hits() == 1);
+    SOTC_CHECK(cache.cached("missing.example", 3979)->empty());
+    SOTC_CHECK(fake.calls() == 1);
+}
+
+SOTC_TEST(dns_cache_retries_transient_failures) {
+    FakeBackend fake;
+    fake.transient = true;
+    EventLoop loop;
+    DnsCacheOptions options{};
+    options.negative_ttl = 1h;
+    DnsCache cache{options, fake.backend()};
+    cache.attach(loop);
+
+    std::optional<std::size_t> found;
+    SOTC_CHECK(cache.resolve("flaky.example", 3979, [&](const auto &endpoints) { found = endpoints.size(); }) != 0);
+    SOTC_CHECK(run_until(loop, [&] { return found.has_value(); }));
+    SOTC_CHECK(*found == 0);
+    SOTC_CHECK(!cache.cached("flaky.example", 3979).has_value());
+
+    // The next request asks again; once the name is known missing, it sticks.
+    fake.transient = false;
+    found.reset();
+    SOTC_CHECK(cache.resolve("flaky.example", 3979, [&](const auto &endpoints) { found = endpoints.size(); }) != 0);
+    SOTC_CHECK(run_until(loop, [&] { return found.has_value(); }));
+    SOTC_CHECK(fake.calls() == 2);
+    SOTC_CHECK(cache.cached("flaky.example", 3979)->empty());
+    SOTC_CHECK(cache.negative_hits() == 0);
+}
+
+SOTC_TEST(dns_cache_honours_backend_ttl) {
+    FakeBackend fake;
+    fake.ttl = 0s;
+    EventLoop loop;
+    DnsCache cache{{}, fake.backend()};
+    cache.attach(loop);
+
+    std::size_t answers = 0;
+    SOTC_CHECK(cache.resolve("game.test", 3979, [&](const auto &) { ++answers; }) != 0);
+    SOTC_CHECK(run_until(loop, [&] { return answers == 1; }));
+    // Already expired: the second request goes back to the backend.
+    SOTC_CHECK(cache.resolve("game.test", 3979, [&](const auto &) { ++answers; }) != 0);
+    SOTC_CHECK(run_until(loop, [&] { return answers == 2; }));
+    SOTC_CHECK(fake.calls() == 2);
+}
+
+SOTC_TEST(dns_cache_prefetches_and_cancels) {
+    FakeBackend fake;
+    EventLoop loop;
+    DnsCache cache{{}, fake.backend()};
+
+    // Nothing is attached yet; the prefetch still runs on the worker.
+    cache.prefetch("coordinator.test", 3976);
+    const auto deadline = EventLoop::Clock::now() + 5s;
+    while (!cache.cached("coordinator.test", 3976) && EventLoop::Clock::now() < deadline) {
+        loop.run_once(5ms);
+    }
+    SOTC_CHECK(cache.cached("coordinator.test", 3976).has_value());
+    SOTC_CHECK(fake.calls() == 1);
+
+    cache.attach(loop);
+    bool cancelled_called = false;
+    bool other_called = false;
+    fake.held = true;
+    const auto cancelled = cache.resolve("server.test", 3979, [&](const auto &) { cancelled_called = true; });
+    SOTC_CHECK(cache.resolve("server.test", 3979, [&](const auto &) { other_called = true; }) != 0);
+    cache.cancel(cancelled);
+    fake.held = false;
+    SOTC_CHECK(run_until(loop, [&] { return other_called; }));
+    SOTC_CHECK(!cancelled_called);
+}
+
+SOTC_TEST(session_resolves_coordinator_through_cache) {
+    FakeBackend fake;
+    EventLoop loop;
+    DnsCache cache{{}, fake.backend()};
+    cache.attach(loop);
+
+    std::uint16_t unused_port = 0;
+    {
+        const auto listener = listen_nonblocking(loopback_endpoint(0));
+        unused_port = local_endpoint(listener.get()).port();
+    }
+
+    CoordinatorSessionOptions options{};
+    options.resolver = &cache;
+    RegistrationConfig config{};
+    config.coordinator_host = "coordinator.test";
+    config.coordinator_port = unused_port;
+    CoordinatorSession session{loop, config, options};
+    session.start();
+    SOTC_CHECK(session.state() == SessionState::Connecting);
+    SOTC_CHECK(run_until(loop, [&] { return session.state() == SessionState::Failed; }));
+    SOTC_CHECK(session.last_error().find("connection failed") != std::string::npos);
+
+    config.coordinator_host = "coordinator.invalid";
+    CoordinatorSession unresolved{loop, config, options};
+    unresolved.start();
+    SOTC_CHECK(run_until(loop, [&] { return unresolved.state() == SessionState::Failed; }));
+    SOTC_CHECK(unresolved.last_error().find("Unable to resolve") != std::string::npos);
+    SOTC_CHECK(fake.calls() == 2);
+}
+
+SOTC_TEST_MAIN()
@@ -0,0 +1,128 @@
+#include "network/file_watcher.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+using namespace sotc::network;
+
+// A directory under the temporary directory, removed with its contents on
+// scope exit.
+class TemporaryDirectory {
+public:
+    explicit TemporaryDirectory(const std::string &name)
+        : path_(std::filesystem::temp_directory_path() / ("sotc-" + std::to_string(::getpid()) + '-' + name)) {
+        std::filesystem::create_directories(path_);
+    }
+    ~TemporaryDirectory() {
+        std::error_code error;
+        std::filesystem::remove_all(path_, error);
+    }
+
+    TemporaryDirectory(const TemporaryDirectory &) = delete;
+    TemporaryDirectory &operator=(const TemporaryDirectory &) = delete;
+
+    [[nodiscard]] std::filesystem::path file(std::string_view name) const { return path_ / name; }
+
+private:
+    std::filesystem::path path_;
+};
+
+void write_file(const std::filesystem::path &path, std::string_view contents) {
+    std::ofstream output{path, std::ios::binary | std::ios::trunc};
+    output << contents;
+}
+
+bool run_until(EventLoop &loop, const std::function<bool()> &done, EventLoop::Clock::duration timeout = 5s) {
+    const auto deadline = EventLoop::Clock::now() + timeout;
+    while (!done()) {
+        if (EventLoop::Clock::now() > deadline) {
+            return false;
+        }
+        loop.run_once(10ms);
+    }
+    return true;
+}
+
+} // namespace
+
+SOTC_TEST(file_watcher_reports_writes_once_settled) {
+    const TemporaryDirectory directory{"watch-write"};
+    const auto config = directory.file("sotc.cfg");
+    write_file(config, "headless = yes\n");
+
+    EventLoop loop;
+    FileWatcher watcher{loop, {config}};
+    std::vector<std::vector<std::filesystem::path>> changes;
+    FileWatcher::Clock::time_point first_event{};
+    watcher.set_change_callback([&](const std::vector<std::filesystem::path> &changed,
+                                    FileWatcher::Clock::time_point when) {
+        changes.push_back(changed);
+        first_event = when;
+    });
+
+    const auto written = FileWatcher::Clock::now();
+    write_file(config, "headless = no\n");
+    write_file(config, "headless = yes\n");
+    write_file(directory.file("other.cfg"), "ignored\n");
+    SOTC_CHECK(run_until(loop, [&] { return !changes.empty(); }));
+    // Both writes land inside one settle window.
+    loop.run_once(50ms);
+    SOTC_CHECK(changes.size() == 1);
+    SOTC_CHECK(changes[0].size() == 1 && changes[0][0] == config);
+    SOTC_CHECK(watcher.events() >= 1);
+    SOTC_CHECK(first_event >= written);
+    SOTC_CHECK(FileWatcher::Clock::now() - first_event >= FileWatcherOptions{}.settle);
+}
+
+SOTC_TEST(file_watcher_follows_files_replaced_by_rename) {
+    const TemporaryDirectory directory{"watch-rename"};
+    const auto first = directory.file("first.cfg");
+    const auto second = directory.file("second.cfg");
+    write_file(first, "server_port = 3979\n");
+    write_file(second, "server_port = 3980\n");
+
+    EventLoop loop;
+    FileWatcher watcher{loop, {first, second}, FileWatcherOptions{.settle = 5ms}};
+    std::vector<std::filesystem::path> changed;
+    watcher.set_change_callback([&](const std::vector<std::filesystem::path> &paths, FileWatcher::Clock::time_point) {
+        changed.insert(changed.end(), paths.begin(), paths.end());
+    });
+
+    // Replace first.cfg the way editors save, twice, to check the watch
+    // survives the first replacement.
+    for (int round = 0; round < 2; ++round) {
+        const auto staged = directory.file("first.cfg.tmp");
+        write_file(staged, "server_port = 4000\n");
+        changed.clear();
+        std::filesystem::rename(staged, first);
+        SOTC_CHECK(run_until(loop, [&] { return !changed.empty(); }));
+        SOTC_CHECK(changed.size() == 1 && changed[0] == first);
+    }
+    SOTC_CHECK(watcher.changes() == 2);
+}
+
+SOTC_TEST(file_watcher_rejects_missing_directories) {
+    EventLoop loop;
+    bool threw = false;
+    try {
+        FileWatcher watcher{loop, {"/nonexistent/sotc/sotc.cfg"}};
+    } catch (const std::system_error &) {
+        threw = true;
+    }
+    SOTC_CHECK(threw);
+}
+
+SOTC_TEST_MAIN()
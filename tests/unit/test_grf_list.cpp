@@ -0,0 +1,125 @@
+#include "network/grf_list.hpp"
+
+#include "client_app.hpp"
+#include "launch_config.hpp"
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "unit_test.hpp"
+
+using sotc::network::GrfList;
+
+SOTC_TEST(interned_grf_lists_share_storage) {
+    const auto first = GrfList::interned({"4D4D0001", "4D4D0002"});
+    const auto second = GrfList::interned({"4D4D0001", "4D4D0002"});
+    SOTC_CHECK(first == second);
+    SOTC_CHECK(first.use_count() == 2);
+    SOTC_CHECK(&first[0] == &second[0]);
+
+    const auto reordered = GrfList::interned({"4D4D0002", "4D4D0001"});
+    SOTC_CHECK(!(reordered == first));
+    SOTC_CHECK(first.use_count() == 2);
+
+    // Lists built directly compare by content and own their storage.
+    const GrfList direct{"4D4D0001", "4D4D0002"};
+    SOTC_CHECK(direct == first);
+    SOTC_CHECK(direct.use_count() == 1);
+}
+
+SOTC_TEST(grf_list_appended_leaves_original_untouched) {
+    const auto original = GrfList::interned({"4D4D0001"});
+    const auto extended = original.appended("4D4D0002");
+    SOTC_CHECK(original.size() == 1);
+    SOTC_CHECK(extended.size() == 2);
+    SOTC_CHECK(extended[1] == "4D4D0002");
+    const auto again = GrfList::interned({"4D4D0001", "4D4D0002"});
+    SOTC_CHECK(&again[0] == &extended[0]);
+}
+
+SOTC_TEST(empty_grf_lists_compare_equal_without_storage) {
+    const GrfList empty{};
+    SOTC_CHECK(empty.empty());
+    SOTC_CHECK(empty.size() == 0);
+    SOTC_CHECK(empty.begin() == empty.end());
+    SOTC_CHECK(empty.use_count() == 0);
+    SOTC_CHECK(empty == GrfList{std::vector<std::string>{}});
+}
+
+SOTC_TEST(launch_option_copies_share_advertised_grfs) {
+    sotc::LaunchOptions options{};
+    SOTC_CHECK(sotc::apply_config_key("advertised_grfs", "4D4D0001,4D4D0002", options) ==
+               sotc::ConfigKeyApplyResult::Applied);
+    sotc::LaunchOptions profile{};
+    SOTC_CHECK(sotc::apply_config_key("advertised_grfs", "4D4D0001, 4D4D0002", profile) ==
+               sotc::ConfigKeyApplyResult::Applied);
+    SOTC_CHECK(profile.advertised_grfs == options.advertised_grfs);
+
+    const auto registrations = sotc::build_registrations(options);
+    SOTC_CHECK(registrations.size() == 1);
+    SOTC_CHECK(registrations.front().advertised_grfs == options.advertised_grfs);
+    const auto frame = sotc::network::CoordinatorClient{}.build_registration_frame(registrations.front());
+    SOTC_CHECK(frame.newgrfs == options.advertised_grfs);
+    SOTC_CHECK(options.advertised_grfs.use_count() == 4);
+}
+
+SOTC_TEST(launch_flag_applier_interns_repeated_grf_flags_once) {
+    sotc::LaunchOptions options{};
+    SOTC_CHECK(sotc::apply_config_key("advertised_grfs", "4D4D0001", options) == sotc::ConfigKeyApplyResult::Applied);
+    const auto grf = *sotc::find_launch_flag("--advertised-grf");
+    const auto clear = *sotc::find_launch_flag("--clear-advertised-grfs");
+    const auto headless = *sotc::find_launch_flag("--headless");
+
+    sotc::LaunchFlagApplier flags{options};
+    SOTC_CHECK(flags.apply(grf, "4D4D0002"));
+    SOTC_CHECK(flags.apply(headless, "true"));
+    SOTC_CHECK(flags.apply(grf, "4D4D0003"));
+    // Nothing is published until finish().
+    SOTC_CHECK(options.advertised_grfs.size() == 1);
+    flags.finish();
+    SOTC_CHECK(options.headless);
+    SOTC_CHECK(options.advertised_grfs == GrfList({"4D4D0001", "4D4D0002", "4D4D0003"}));
+    const auto interned = GrfList::interned({"4D4D0001", "4D4D0002", "4D4D0003"});
+    SOTC_CHECK(&interned[0] == &options.advertised_grfs[0]);
+
+    // Clearing drops what was collected before it, not what follows.
+    SOTC_CHECK(flags.apply(grf, "4D4D0004"));
+    SOTC_CHECK(flags.apply(clear, clear.spec->off_value));
+    SOTC_CHECK(flags.apply(grf, "4D4D0005"));
+    flags.finish();
+    SOTC_CHECK(options.advertised_grfs == GrfList({"4D4D0005"}));
+}
+
+SOTC_TEST(launch_snapshot_slot_publishes_whole_snapshots) {
+    sotc::LaunchOptions first{};
+    first.server_host = "first.example";
+    sotc::LaunchSnapshotSlot slot{sotc::make_launch_snapshot(std::move(first))};
+
+    const auto held = slot.load();
+    sotc::LaunchOptions second{};
+    second.server_host = "second.example";
+    const auto replaced = slot.exchange(sotc::make_launch_snapshot(std::move(second)));
+    SOTC_CHECK(replaced == held);
+    SOTC_CHECK(held->server_host == "first.example");
+    SOTC_CHECK(slot.load()->server_host == "second.example");
+
+    // Readers racing a writer only ever see one of the published snapshots.
+    bool torn = false;
+    std::thread reader{[&] {
+        for (int i = 0; i < 10000; ++i) {
+            const auto snapshot = slot.load();
+            torn = torn || (snapshot->server_host != "second.example" && snapshot->server_host != "third.example");
+        }
+    }};
+    for (int i = 0; i < 1000; ++i) {
+        sotc::LaunchOptions next{};
+        next.server_host = i % 2 == 0 ? "third.example" : "second.example";
+        slot.store(sotc::make_launch_snapshot(std::move(next)));
+    }
+    reader.join();
+    SOTC_CHECK(!torn);
+}
+
+SOTC_TEST_MAIN()
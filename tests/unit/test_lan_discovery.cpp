@@ -0,0 +1,181 @@
+#include "network/lan_discovery.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+using namespace sotc::network;
+
+enum class ReplyMode { Normal, Twice, Garbage };
+
+// Minimal LAN server on a loopback UDP port, answering probes from a thread.
+class LoopbackResponder {
+public:
+    LoopbackResponder(std::string name, ReplyMode mode = ReplyMode::Normal) : mode_(mode) {
+        socket_ = SocketHandle{::socket(AF_INET, SOCK_DGRAM, 0)};
+        const auto endpoint = loopback_endpoint(0);
+        if (::bind(socket_.get(), reinterpret_cast<const sockaddr *>(&endpoint.address), endpoint.length) != 0) {
+            throw std::runtime_error{"bind failed"};
+        }
+        port_ = local_endpoint(socket_.get()).port();
+        info_.server_name = std::move(name);
+        info_.server_revision = "14.1";
+        info_.clients_max = 8;
+        info_.newgrfs.resize(3);
+        thread_ = std::thread{[this] { serve(); }};
+    }
+    ~LoopbackResponder() {
+        stop_ = true;
+        thread_.join();
+    }
+
+    LoopbackResponder(const LoopbackResponder &) = delete;
+    LoopbackResponder &operator=(const LoopbackResponder &) = delete;
+
+    [[nodiscard]] std::uint16_t port() const noexcept { return port_; }
+    [[nodiscard]] std::string target() const { return "127.0.0.1:" + std::to_string(port_); }
+
+private:
+    void serve() {
+        std::vector<std::byte> buffer(NETWORK_LAN_MAX_DATAGRAM_SIZE);
+        while (!stop_) {
+            pollfd entry{socket_.get(), POLLIN, 0};
+            if (::poll(&entry, 1, 20) <= 0) {
+                continue;
+            }
+            sockaddr_storage source{};
+            socklen_t length = sizeof(source);
+            const auto received = ::recvfrom(socket_.get(), buffer.data(), buffer.size(), 0,
+                                             reinterpret_cast<sockaddr *>(&source), &length);
+            if (received <= 0 || !is_lan_probe(std::span{buffer.data(), static_cast<std::size_t>(received)})) {
+                continue;
+            }
+            auto reply = build_lan_response(info_);
+            if (mode_ == ReplyMode::Garbage) {
+                reply.resize(reply.size() / 2);
+            }
+            const int copies = mode_ == ReplyMode::Twice ? 2 : 1;
+            for (int copy = 0; copy < copies; ++copy) {
+                ::sendto(socket_.get(), reply.data(), reply.size(), 0, reinterpret_cast<const sockaddr *>(&source),
+                         length);
+            }
+        }
+    }
+
+    SocketHandle socket_{};
+    std::uint16_t port_{0};
+    NetworkGameInfo info_{};
+    ReplyMode mode_;
+    std::atomic<bool> stop_{false};
+    std::thread thread_{};
+};
+
+} // namespace
+
+SOTC_TEST(lan_response_round_trips) {
+    NetworkGameInfo info{};
+    info.server_name = "LAN game";
+    info.clients_on = 3;
+    info.map_width = 1024;
+    info.newgrfs.resize(2);
+    info.newgrfs[1].grfid = 0x12345678U;
+    const auto datagram = build_lan_response(info);
+
+    const auto parsed = parse_lan_response(datagram);
+    SOTC_CHECK(parsed.has_value());
+    SOTC_CHECK(parsed->server_name == "LAN game");
+    SOTC_CHECK(parsed->clients_on == 3);
+    SOTC_CHECK(parsed->map_width == 1024);
+    SOTC_CHECK(parsed->newgrfs == info.newgrfs);
+
+    SOTC_CHECK(is_lan_probe(build_lan_probe()));
+    SOTC_CHECK(!is_lan_probe(datagram));
+    SOTC_CHECK(parse_lan_response(build_lan_probe()).error() == DecodeError::InvalidValue);
+    auto truncated = datagram;
+    truncated.pop_back();
+    SOTC_CHECK(parse_lan_response(truncated).error() == DecodeError::InvalidPacketSize);
+}
+
+SOTC_TEST(lan_targets_expand_and_deduplicate) {
+    const auto endpoints = expand_lan_targets({"10.1.2.0/24", "10.1.2.7", "10.1.2.7:4000", "[::1]:3980"}, 3979);
+    SOTC_CHECK(endpoints.size() == 254 + 1 + 1);
+    SOTC_CHECK(endpoints.front().to_string() == "10.1.2.1:3979");
+    SOTC_CHECK(endpoints[253].to_string() == "10.1.2.254:3979");
+    SOTC_CHECK(endpoints[254].to_string() == "10.1.2.7:4000");
+    SOTC_CHECK(endpoints[255].to_string() == "[::1]:3980");
+
+    SOTC_CHECK(expand_lan_targets({"192.0.2.9/32"}, 3979).size() == 1);
+    SOTC_CHECK(expand_lan_targets({"192.0.2.8/31"}, 3979).size() == 2);
+    SOTC_CHECK_THROWS(static_cast<void>(expand_lan_targets({"10.0.0.0/8"}, 3979)), std::invalid_argument);
+    SOTC_CHECK_THROWS(static_cast<void>(expand_lan_targets({"10.0.0.0/x"}, 3979)), std::invalid_argument);
+    SOTC_CHECK_THROWS(static_cast<void>(expand_lan_targets({"127.0.0.1:0"}, 3979)), std::invalid_argument);
+}
+
+SOTC_TEST(lan_discovery_finishes_once_every_unicast_target_answered) {
+    std::vector<std::unique_ptr<LoopbackResponder>> responders;
+    LanDiscoveryOptions options{};
+    options.targets.clear();
+    options.timeout = 5s;
+    options.batch_size = 2;
+    for (int index = 0; index < 5; ++index) {
+        responders.push_back(std::make_unique<LoopbackResponder>("LAN " + std::to_string(index)));
+        options.targets.push_back(responders.back()->target());
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    const auto result = discover_local_servers(options);
+    SOTC_CHECK(std::chrono::steady_clock::now() - started < 2s);
+    SOTC_CHECK(result.probes_sent == 5);
+    SOTC_CHECK(result.servers.size() == 5);
+    for (const auto &server : result.servers) {
+        SOTC_CHECK(server.info.server_name.starts_with("LAN "));
+        SOTC_CHECK(server.info.newgrfs.size() == 3);
+        SOTC_CHECK(server.round_trip > 0ns);
+    }
+}
+
+SOTC_TEST(lan_discovery_deduplicates_and_skips_malformed_replies) {
+    LoopbackResponder chatty{"Chatty", ReplyMode::Twice};
+    LoopbackResponder broken{"Broken", ReplyMode::Garbage};
+    LanDiscoveryOptions options{};
+    options.targets = {chatty.target(), broken.target(), chatty.target()};
+    options.timeout = 300ms;
+
+    const auto result = discover_local_servers(options);
+    SOTC_CHECK(result.probes_sent == 2);
+    SOTC_CHECK(result.servers.size() == 1);
+    SOTC_CHECK(result.servers.front().info.server_name == "Chatty");
+    SOTC_CHECK(result.servers.front().endpoint.port() == chatty.port());
+    SOTC_CHECK(result.duplicates == 1);
+    SOTC_CHECK(result.malformed == 1);
+}
+
+SOTC_TEST(lan_discovery_probes_every_host_of_a_subnet) {
+    LoopbackResponder responder{"Subnet"};
+    LanDiscoveryOptions options{};
+    options.targets = {"127.0.0.0/29"};
+    options.default_port = responder.port();
+    options.timeout = 300ms;
+
+    const auto result = discover_local_servers(options);
+    SOTC_CHECK(result.probes_sent == 6);
+    SOTC_CHECK(result.servers.size() == 1);
+    SOTC_CHECK(result.servers.front().endpoint.to_string() == responder.target());
+}
+
+SOTC_TEST_MAIN()
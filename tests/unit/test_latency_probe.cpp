@@ -0,0 +1,322 @@
+#include "network/latency_probe.hpp"
+
+#include "network/lan_discovery.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+using namespace sotc::network;
+
+[[nodiscard]] SocketHandle bind_loopback_udp() {
+    SocketHandle socket{::socket(AF_INET, SOCK_DGRAM, 0)};
+    const auto endpoint = loopback_endpoint(0);
+    if (::bind(socket.get(), reinterpret_cast<const sockaddr *>(&endpoint.address), endpoint.length) != 0) {
+        throw std::runtime_error{"bind failed"};
+    }
+    return socket;
+}
+
+// Answers every LAN probe on a loopback UDP port from a thread.
+class LoopbackResponder {
+public:
+    LoopbackResponder() : socket_(bind_loopback_udp()), port_(local_endpoint(socket_.get()).port()) {
+        NetworkGameInfo info{};
+        info.server_name = "Pinged";
+        reply_ = build_lan_response(info);
+        thread_ = std::thread{[this] { serve(); }};
+    }
+    ~LoopbackResponder() {
+        stop_ = true;
+        thread_.join();
+    }
+
+    LoopbackResponder(const LoopbackResponder &) = delete;
+    LoopbackResponder &operator=(const LoopbackResponder &) = delete;
+
+    [[nodiscard]] std::uint16_t port() const noexcept { return port_; }
+
+private:
+    void serve() {
+        std::vector<std::byte> buffer(NETWORK_LAN_MAX_DATAGRAM_SIZE);
+        while (!stop_) {
+            pollfd entry{socket_.get(), POLLIN, 0};
+            if (::poll(&entry, 1, 20) <= 0) {
+                continue;
+            }
+            sockaddr_storage source{};
+            socklen_t length = sizeof(source);
+            const auto received = ::recvfrom(socket_.get(), buffer.data(), buffer.size(), 0,
+                                             reinterpret_cast<sockaddr *>(&source), &length);
+            if (received > 0 && is_lan_probe(std::span{buffer.data(), static_cast<std::size_t>(received)})) {
+                ::sendto(socket_.get(), reply_.data(), reply_.size(), 0, reinterpret_cast<const sockaddr *>(&source),
+                         length);
+            }
+        }
+    }
+
+    SocketHandle socket_{};
+    std::uint16_t port_{0};
+    std::vector<std::byte> reply_{};
+    std::atomic<bool> stop_{false};
+    std::thread thread_{};
+};
+
+// Answers the n-th probe after delays[n] and ignores probes beyond the list.
+class DelayedResponder {
+public:
+    explicit DelayedResponder(std::vector<std::chrono::milliseconds> delays)
+        : socket_(bind_loopback_udp()), port_(local_endpoint(socket_.get()).port()), delays_(std::move(delays)) {
+        reply_ = build_lan_response(NetworkGameInfo{});
+        thread_ = std::thread{[this] { serve(); }};
+    }
+    ~DelayedResponder() {
+        stop_ = true;
+        thread_.join();
+    }
+
+    DelayedResponder(const DelayedResponder &) = delete;
+    DelayedResponder &operator=(const DelayedResponder &) = delete;
+
+    [[nodiscard]] std::uint16_t port() const noexcept { return port_; }
+
+private:
+    struct Pending {
+        std::chrono::steady_clock::time_point due{};
+        sockaddr_storage source{};
+        socklen_t length{0};
+    };
+
+    void serve() {
+        std::vector<std::byte> buffer(NETWORK_LAN_MAX_DATAGRAM_SIZE);
+        std::vector<Pending> pending;
+        std::size_t probes = 0;
+        while (!stop_) {
+            const auto now = std::chrono::steady_clock::now();
+            for (auto entry = pending.begin(); entry != pending.end();) {
+                if (entry->due > now) {
+                    ++entry;
+                    continue;
+                }
+                ::sendto(socket_.get(), reply_.data(), reply_.size(), 0,
+                         reinterpret_cast<const sockaddr *>(&entry->source), entry->length);
+                entry = pending.erase(entry);
+            }
+            pollfd entry{socket_.get(), POLLIN, 0};
+            if (::poll(&entry, 1, 2) <= 0) {
+                continue;
+            }
+            Pending reply{};
+            reply.length = sizeof(reply.source);
+            const auto received = ::recvfrom(socket_.get(), buffer.data(), buffer.size(), 0,
+                                             reinterpret_cast<sockaddr *>(&reply.source), &reply.length);
+            if (received > 0 && probes < delays_.size()) {
+                reply.due = std::chrono::steady_clock::now() + delays_[probes++];
+                pending.push_back(reply);
+            }
+        }
+    }
+
+    SocketHandle socket_{};
+    std::uint16_t port_{0};
+    std::vector<std::chrono::milliseconds> delays_{};
+    std::vector<std::byte> reply_{};
+    std::atomic<bool> stop_{false};
+    std::thread thread_{};
+};
+
+void run_until_idle(EventLoop &loop, const LatencyProber &prober) {
+    const auto deadline = EventLoop::Clock::now() + 5s;
+    while (!prober.idle() && EventLoop::Clock::now() < deadline) {
+        loop.run_once(50ms);
+    }
+}
+
+} // namespace
+
+SOTC_TEST(rtt_window_keeps_most_recent_samples) {
+    RttWindow window{4};
+    SOTC_CHECK(window.size() == 0);
+    SOTC_CHECK(window.percentile(50) == 0ns);
+    for (const auto sample : {40ns, 10ns, 30ns, 20ns}) {
+        window.record(sample);
+    }
+    SOTC_CHECK(window.min() == 10ns);
+    SOTC_CHECK(window.last() == 20ns);
+    SOTC_CHECK(window.percentile(50) == 20ns);
+    SOTC_CHECK(window.percentile(99) == 40ns);
+    SOTC_CHECK(window.percentile(0) == 10ns);
+
+    // 50 overwrites 40, the oldest sample.
+    window.record(50ns);
+    SOTC_CHECK(window.size() == 4);
+    SOTC_CHECK(window.last() == 50ns);
+    SOTC_CHECK(window.percentile(100) == 50ns);
+    SOTC_CHECK(window.percentile(25) == 10ns);
+
+    window.record(5ns);
+    SOTC_CHECK(window.min() == 5ns);
+    window.reset();
+    SOTC_CHECK(window.size() == 0);
+    SOTC_CHECK(window.last() == 0ns);
+}
+
+SOTC_TEST(prober_caps_probes_in_flight) {
+    std::vector<std::unique_ptr<LoopbackResponder>> responders;
+    for (int index = 0; index < 8; ++index) {
+        responders.push_back(std::make_unique<LoopbackResponder>());
+    }
+
+    EventLoop loop;
+    LatencyProbeOptions options{};
+    options.max_in_flight = 3;
+    options.probes_per_endpoint = 2;
+    options.probe_interval = 0ms;
+    LatencyProber prober{loop, options};
+
+    std::size_t results = 0;
+    std::size_t finished = 0;
+    prober.set_result_callback([&](LatencyProber::EndpointId id, const EndpointLatency &) {
+        ++results;
+        SOTC_CHECK(prober.in_flight() <= 3);
+        if (prober.done(id)) {
+            ++finished;
+        }
+    });
+    for (const auto &responder : responders) {
+        static_cast<void>(prober.add("127.0.0.1", responder->port()));
+    }
+    SOTC_CHECK(prober.in_flight() == 3);
+    run_until_idle(loop, prober);
+
+    SOTC_CHECK(prober.idle());
+    SOTC_CHECK(results == 16);
+    SOTC_CHECK(finished == 8);
+    SOTC_CHECK(prober.peak_in_flight() == 3);
+    SOTC_CHECK(prober.rtt_histogram().count() == 16);
+    for (std::size_t id = 0; id < prober.size(); ++id) {
+        const auto &latency = prober.endpoint(id);
+        SOTC_CHECK(latency.resolved);
+        SOTC_CHECK(latency.sent == 2);
+        SOTC_CHECK(latency.received == 2);
+        SOTC_CHECK(latency.lost == 0);
+        SOTC_CHECK(latency.rtt.size() == 2);
+        SOTC_CHECK(latency.rtt.min() > 0ns);
+        SOTC_CHECK(latency.rtt.percentile(99) < 1s);
+    }
+}
+
+SOTC_TEST(prober_times_out_silent_endpoints) {
+    LoopbackResponder responder;
+    // Bound but never read: probes to it are neither answered nor refused.
+    const auto silent = bind_loopback_udp();
+    const auto silent_port = local_endpoint(silent.get()).port();
+
+    EventLoop loop;
+    LatencyProbeOptions options{};
+    options.probes_per_endpoint = 2;
+    options.probe_timeout = 50ms;
+    options.probe_interval = 10ms;
+    LatencyProber prober{loop, options};
+
+    const auto answering = prober.add("127.0.0.1", responder.port());
+    const auto quiet = prober.add("127.0.0.1", silent_port);
+    SOTC_CHECK(prober.add("127.0.0.1", silent_port) == quiet);
+    SOTC_CHECK(prober.size() == 2);
+    run_until_idle(loop, prober);
+
+    SOTC_CHECK(prober.endpoint(answering).received == 2);
+    const auto &timed_out = prober.endpoint(quiet);
+    SOTC_CHECK(timed_out.sent == 4);
+    SOTC_CHECK(timed_out.received == 0);
+    SOTC_CHECK(timed_out.lost == 4);
+    SOTC_CHECK(timed_out.rtt.size() == 0);
+    SOTC_CHECK(prober.done(quiet));
+
+    prober.reprobe(answering);
+    SOTC_CHECK(!prober.idle());
+    prober.close();
+    SOTC_CHECK(prober.idle());
+    SOTC_CHECK(loop.watched_descriptors() == 0);
+    SOTC_CHECK(loop.pending_timers() == 0);
+}
+
+SOTC_TEST(prober_ignores_replies_to_timed_out_probes) {
+    // The first reply arrives while the second probe is in flight; taking it
+    // as the second one's reply would halve the round trip.
+    DelayedResponder responder{{300ms, 150ms}};
+
+    EventLoop loop;
+    LatencyProbeOptions options{};
+    options.probes_per_endpoint = 2;
+    options.probe_timeout = 200ms;
+    options.probe_interval = 0ms;
+    LatencyProber prober{loop, options};
+
+    const auto id = prober.add("127.0.0.1", responder.port());
+    run_until_idle(loop, prober);
+    const auto deadline = EventLoop::Clock::now() + 200ms;
+    while (EventLoop::Clock::now() < deadline) {
+        loop.run_once(20ms);
+    }
+
+    const auto &latency = prober.endpoint(id);
+    SOTC_CHECK(latency.sent == 2);
+    SOTC_CHECK(latency.lost == 1);
+    SOTC_CHECK(latency.received == 1);
+    SOTC_CHECK(latency.late == 1);
+    SOTC_CHECK(latency.rtt.min() >= 140ms);
+    prober.close();
+}
+
+SOTC_TEST(prober_resolves_hosts_through_dns_cache) {
+    LoopbackResponder responder;
+    std::vector<std::string> lookups;
+    DnsCache resolver{{}, [&](const std::string &host, std::uint16_t port, int socket_type) {
+                          lookups.push_back(host + (socket_type == SOCK_DGRAM ? "/udp" : "/tcp"));
+                          DnsAnswer answer{};
+                          if (host == "pinged.test") {
+                              answer.endpoints.push_back(loopback_endpoint(port));
+                          }
+                          return answer;
+                      }};
+    EventLoop loop;
+    resolver.attach(loop);
+    LatencyProbeOptions options{};
+    options.probes_per_endpoint = 1;
+    options.resolver = &resolver;
+    LatencyProber prober{loop, options};
+
+    std::size_t reported = 0;
+    prober.set_result_callback([&](LatencyProber::EndpointId, const EndpointLatency &) { ++reported; });
+    const auto found = prober.add("pinged.test", responder.port());
+    const auto missing = prober.add("missing.test", responder.port());
+    SOTC_CHECK(!prober.idle());
+    run_until_idle(loop, prober);
+
+    SOTC_CHECK(prober.endpoint(found).resolved);
+    SOTC_CHECK(prober.endpoint(found).received == 1);
+    SOTC_CHECK(!prober.endpoint(missing).resolved);
+    SOTC_CHECK(prober.done(missing));
+    SOTC_CHECK(reported == 2);
+    SOTC_CHECK((lookups == std::vector<std::string>{"pinged.test/udp", "missing.test/udp"}));
+    prober.close();
+    resolver.detach();
+}
+
+SOTC_TEST_MAIN()
@@ -0,0 +1,238 @@
+#include "launch_config.hpp"
+#include "perfect_hash.hpp"
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "unit_test.hpp"
+
+namespace {
+
+// A configuration file under the temporary directory, removed on scope exit.
+class TemporaryConfig {
+public:
+    TemporaryConfig(const std::string &name, std::string_view contents)
+        : path_(std::filesystem::temp_directory_path() / ("sotc-test-" + name + ".cfg")) {
+        std::ofstream output{path_, std::ios::binary};
+        output << contents;
+    }
+    ~TemporaryConfig() {
+        std::error_code error;
+        std::filesystem::remove(path_, error);
+    }
+
+    TemporaryConfig(const TemporaryConfig &) = delete;
+    TemporaryConfig &operator=(const TemporaryConfig &) = delete;
+
+    [[nodiscard]] std::string path() const { return path_.string(); }
+
+private:
+    std::filesystem::path path_;
+};
+
+} // namespace
+
+SOTC_TEST(load_config_file_applies_top_level_keys) {
+    const TemporaryConfig config{"top-level",
+                                 "# comment\r\n"
+                                 "server_host = example.org \r\n"
+                                 "  ; another comment\n"
+                                 "server_port=3980\n"
+                                 "advertised_grfs = 11112222, ,33334444,\n"
+                                 "hosted_server = 3990, name=Alpha ,stun=off\n"
+                                 "hosted_server = 3991\n"
+                                 "\n"
+                                 "headless = yes"};
+    sotc::LaunchOptions options{};
+    SOTC_CHECK(sotc::load_config_file(config.path(), options));
+    SOTC_CHECK(options.server_host == "example.org");
+    SOTC_CHECK(options.server_port == 3980);
+    SOTC_CHECK(options.headless);
+    SOTC_CHECK((options.advertised_grfs == sotc::network::GrfList{"11112222", "33334444"}));
+    SOTC_CHECK(options.hosted_servers.size() == 2);
+    SOTC_CHECK(options.hosted_servers[0].server_name == "Alpha");
+    SOTC_CHECK(options.hosted_servers[0].allow_stun == false);
+}
+
+SOTC_TEST(load_config_file_rejects_duplicate_and_unknown_keys) {
+    const TemporaryConfig duplicate{"duplicate", "headless = yes\nheadless = no\n"};
+    sotc::LaunchOptions options{};
+    SOTC_CHECK(!sotc::load_config_file(duplicate.path(), options));
+    SOTC_CHECK(options.headless);
+
+    const TemporaryConfig unknown{"unknown", "sever_host = typo.example\n"};
+    SOTC_CHECK(!sotc::load_config_file(unknown.path(), options));
+
+    sotc::LaunchOptions missing{};
+    SOTC_CHECK(!sotc::load_config_file("/nonexistent/sotc.cfg", missing));
+}
+
+SOTC_TEST(load_config_file_applies_selected_profile) {
+    const TemporaryConfig config{"select",
+                                 "player_name = Base\n"
+                                 "server_port = 3979\n"
+                                 "[alpha]\n"
+                                 "server_port = 3980\n"
+                                 "[beta]\n"
+                                 "server_port = 3981\n"
+                                 "player_name = Beta\n"
+                                 "[ broken\n"};
+
+    sotc::LaunchOptions top_level{};
+    SOTC_CHECK(sotc::load_config_file(config.path(), top_level));
+    SOTC_CHECK(top_level.server_port == 3979);
+    SOTC_CHECK(top_level.player_name == "Base");
+
+    sotc::LaunchOptions beta{};
+    SOTC_CHECK(sotc::load_config_file(config.path(), beta, "beta"));
+    SOTC_CHECK(beta.server_port == 3981);
+    SOTC_CHECK(beta.player_name == "Beta");
+
+    sotc::LaunchOptions missing{};
+    SOTC_CHECK(!sotc::load_config_file(config.path(), missing, "gamma"));
+}
+
+SOTC_TEST(load_config_profiles_reads_every_section) {
+    const TemporaryConfig config{"profiles",
+                                 "coordinator_host = fleet.example\n"
+                                 "player_name = Fleet\n"
+                                 "\n"
+                                 "[alpha]\n"
+                                 "server_port = 3980\n"
+                                 "hosted_server = 3990, name=Alpha\n"
+                                 "hosted_server = 3991\n"
+                                 "[beta]\n"
+                                 "player_name = Beta\n"
+                                 "[empty]\n"};
+    sotc::LaunchOptions base{};
+    std::vector<sotc::ConfigProfile> profiles;
+    SOTC_CHECK(sotc::load_config_profiles(config.path(), base, profiles));
+    SOTC_CHECK(base.coordinator_host == "fleet.example");
+    SOTC_CHECK(profiles.size() == 3);
+    SOTC_CHECK(profiles[0].name == "alpha");
+    SOTC_CHECK(profiles[0].options.server_port == 3980);
+    SOTC_CHECK(profiles[0].options.player_name == "Fleet");
+    SOTC_CHECK(profiles[0].options.hosted_servers.size() == 2);
+    SOTC_CHECK(profiles[1].name == "beta");
+    SOTC_CHECK(profiles[1].options.player_name == "Beta");
+    SOTC_CHECK(profiles[1].options.coordinator_host == "fleet.example");
+    SOTC_CHECK(profiles[1].options.hosted_servers.empty());
+    SOTC_CHECK(profiles[2].name == "empty");
+    SOTC_CHECK(profiles[2].options.server_port == base.server_port);
+}
+
+SOTC_TEST(build_registrations_registers_every_profile) {
+    const TemporaryConfig config{"profile-registrations",
+                                 "player_name = Fleet\n"
+                                 "[alpha]\n"
+                                 "hosted_server = 3990, name=Alpha\n"
+                                 "hosted_server = 3991\n"
+                                 "[beta]\n"
+                                 "server_port = 3981\n"
+                                 "allow_turn = false\n"};
+    sotc::LaunchOptions options{};
+    std::vector<sotc::ConfigProfile> profiles;
+    SOTC_CHECK(sotc::load_config_profiles(config.path(), options, profiles));
+    options.profiles = std::move(profiles);
+    const auto registrations = sotc::build_registrations(options);
+    SOTC_CHECK(registrations.size() == 3);
+    SOTC_CHECK(registrations[0].listen_port == 3990 && registrations[0].server_name == "Alpha");
+    SOTC_CHECK(registrations[1].listen_port == 3991);
+    SOTC_CHECK(registrations[2].listen_port == 3981);
+    SOTC_CHECK(!registrations[2].allow_turn && registrations[0].allow_turn);
+
+    options.profiles.clear();
+    SOTC_CHECK(sotc::build_registrations(options).size() == 1);
+}
+
+SOTC_TEST(load_config_profiles_reports_duplicates_per_section) {
+    const TemporaryConfig config{"profile-duplicates",
+                                 "server_port = 3979\n"
+                                 "[alpha]\n"
+                                 "server_port = 3980\n"
+                                 "[beta]\n"
+                                 "server_port = 3981\n"
+                                 "server_port = 3982\n"
+                                 "[alpha]\n"
+                                 "server_port = 3983\n"};
+    sotc::LaunchOptions base{};
+    std::vector<sotc::ConfigProfile> profiles;
+    // The second [alpha] is rejected; beta keeps its first port.
+    SOTC_CHECK(!sotc::load_config_profiles(config.path(), base, profiles));
+    SOTC_CHECK(profiles.size() == 2);
+    SOTC_CHECK(profiles[0].name == "alpha");
+    SOTC_CHECK(profiles[0].options.server_port == 3980);
+    SOTC_CHECK(profiles[1].options.server_port == 3981);
+}
+
+SOTC_TEST(perfect_hash_finds_every_key_and_rejects_others) {
+    static constexpr std::array<std::string_view, 5> keys{"alpha", "beta", "gamma", "delta", ""};
+    static constexpr sotc::PerfectHash<keys.size()> hash{keys};
+    static_assert(hash.find("gamma") == 2);
+    for (std::size_t index = 0; index < keys.size(); ++index) {
+        SOTC_CHECK(hash.find(keys[index]) == index);
+    }
+    SOTC_CHECK(!hash.find("epsilon"));
+    SOTC_CHECK(!hash.find("alph"));
+    SOTC_CHECK(!hash.find("alphaa"));
+}
+
+SOTC_TEST(launch_option_table_resolves_every_spelling) {
+    for (const auto &spec : sotc::launch_option_specs()) {
+        SOTC_CHECK(!spec.flag.empty());
+        SOTC_CHECK(spec.command != sotc::LaunchCommand::None || spec.apply != nullptr);
+        for (const auto name : {spec.flag, spec.short_flag, spec.flag_alias}) {
+            if (!name.empty()) {
+                const auto flag = sotc::find_launch_flag(name);
+                SOTC_CHECK(flag && flag->spec == &spec && !flag->off);
+            }
+        }
+        if (!spec.off_flag.empty()) {
+            const auto flag = sotc::find_launch_flag(spec.off_flag);
+            SOTC_CHECK(flag && flag->spec == &spec && flag->off);
+        }
+        for (const auto key : {spec.key, spec.key_alias}) {
+            if (!key.empty()) {
+                SOTC_CHECK(sotc::find_config_key(key) == &spec);
+                SOTC_CHECK(sotc::is_known_config_key(key));
+            }
+        }
+        SOTC_CHECK((spec.format == nullptr) == spec.summary_key.empty());
+    }
+    SOTC_CHECK(sotc::find_config_key("game_type") == sotc::find_config_key("server_game_type"));
+    SOTC_CHECK(!sotc::find_launch_flag("--server-hos"));
+    SOTC_CHECK(!sotc::find_launch_flag("server_host"));
+    SOTC_CHECK(sotc::find_config_key("--server-host") == nullptr);
+}
+
+SOTC_TEST(launch_option_flags_and_keys_share_appliers) {
+    sotc::LaunchOptions options{};
+    const auto grf = sotc::find_launch_flag("--advertised-grf");
+    SOTC_CHECK(grf && grf->spec->apply_flag(" 11112222", options));
+    SOTC_CHECK(grf->spec->apply_flag("33334444", options));
+    SOTC_CHECK(options.advertised_grfs.size() == 2);
+    const auto clear = sotc::find_launch_flag("--clear-advertised-grfs");
+    SOTC_CHECK(clear && clear->off && clear->spec->apply(clear->spec->off_value, options));
+    SOTC_CHECK(options.advertised_grfs.empty());
+
+    SOTC_CHECK(sotc::apply_config_key("advertised_grfs", "1, 2", options) == sotc::ConfigKeyApplyResult::Applied);
+    SOTC_CHECK(options.advertised_grfs.size() == 2);
+    SOTC_CHECK(sotc::apply_config_key("heartbeat_interval", "-1", options) ==
+               sotc::ConfigKeyApplyResult::InvalidValue);
+    SOTC_CHECK(sotc::apply_config_key("heartbeat", "10", options) == sotc::ConfigKeyApplyResult::Unknown);
+
+    const auto headless = sotc::find_launch_flag("-D");
+    SOTC_CHECK(headless && headless->spec->apply(headless->spec->on_value, options) && options.headless);
+    const auto endpoint = sotc::find_launch_flag("--coordinator");
+    SOTC_CHECK(endpoint && endpoint->spec->apply("[::1]:4000", options));
+    SOTC_CHECK(options.coordinator_host == "::1");
+    SOTC_CHECK(options.coordinator_port == 4000);
+}
+
+SOTC_TEST_MAIN()
@@ -0,0 +1,253 @@
+#include "network/mock_coordinator.hpp"
+
+#include "network/coordinator_fleet.hpp"
+#include "network/server_listing_client.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+using namespace sotc::network;
+
+[[nodiscard]] RegistrationConfig make_config(const MockCoordinator &coordinator, std::size_t index) {
+    RegistrationConfig config{};
+    config.server_name = "Mock Client " + std::to_string(index);
+    config.coordinator_host = "127.0.0.1";
+    config.coordinator_port = coordinator.endpoint().port();
+    config.listen_port = static_cast<std::uint16_t>(4000 + index);
+    return config;
+}
+
+bool run_until(EventLoop &loop, const std::function<bool()> &done, EventLoop::Clock::duration timeout = 10s) {
+    const auto deadline = EventLoop::Clock::now() + timeout;
+    while (!done()) {
+        if (EventLoop::Clock::now() > deadline) {
+            return false;
+        }
+        loop.run_once(10ms);
+    }
+    return true;
+}
+
+[[nodiscard]] ServerListingEntry make_listed_server(std::size_t index, std::size_t grf_count) {
+    ServerListingEntry entry{};
+    entry.connection_string = "192.0.2.7:" + std::to_string(3979 + index);
+    entry.info.server_name = "Listed " + std::to_string(index);
+    entry.info.clients_max = 10;
+    for (std::size_t grf = 0; grf < grf_count; ++grf) {
+        NewGrfIdentity identity{};
+        identity.grfid = static_cast<std::uint32_t>(0x53540000U + grf);
+        entry.info.newgrfs.push_back(identity);
+    }
+    return entry;
+}
+
+} // namespace
+
+SOTC_TEST(mock_coordinator_serves_many_concurrent_registrations) {
+    EventLoop loop;
+    MockCoordinatorOptions options{};
+    options.delay = 2ms;
+    MockCoordinator coordinator{loop, options};
+
+    constexpr std::size_t kServers = 400;
+    CoordinatorFleet fleet{loop};
+    for (std::size_t index = 0; index < kServers; ++index) {
+        fleet.add(make_config(coordinator, index), 50ms);
+    }
+    fleet.start();
+
+    SOTC_CHECK(run_until(loop, [&] { return coordinator.stats().updates >= 2 * kServers; }));
+    const auto &stats = coordinator.stats();
+    SOTC_CHECK(fleet.count(SessionState::Registered) == kServers);
+    SOTC_CHECK(stats.connections_accepted == kServers);
+    SOTC_CHECK(stats.connections_active == kServers);
+    SOTC_CHECK(stats.registrations == kServers);
+    SOTC_CHECK(stats.malformed == 0);
+    SOTC_CHECK(stats.service_latency.min() >= 2ms);
+    SOTC_CHECK(fleet.ack_latency().min() >= 2ms);
+    SOTC_CHECK(fleet.session(0).registration().invite_code != fleet.session(1).registration().invite_code);
+
+    fleet.close();
+    SOTC_CHECK(run_until(loop, [&] { return coordinator.stats().connections_active == 0; }));
+}
+
+SOTC_TEST(mock_coordinator_rejects_configured_fraction) {
+    EventLoop loop;
+    MockCoordinatorOptions options{};
+    options.error_rate = 0.5;
+    options.error_code = CoordinatorErrorCode::ReuseOfInviteCode;
+    MockCoordinator coordinator{loop, options};
+
+    constexpr std::size_t kServers = 200;
+    CoordinatorFleet fleet{loop};
+    for (std::size_t index = 0; index < kServers; ++index) {
+        fleet.add(make_config(coordinator, index));
+    }
+    fleet.start();
+
+    SOTC_CHECK(run_until(loop, [&] {
+        return fleet.count(SessionState::Registered) + fleet.count(SessionState::Failed) == kServers;
+    }));
+    const auto failed = fleet.count(SessionState::Failed);
+    SOTC_CHECK(failed == coordinator.stats().errors_sent);
+    SOTC_CHECK(failed > kServers / 4 && failed < 3 * kServers / 4);
+    for (std::size_t index = 0; index < kServers; ++index) {
+        if (fleet.session(index).state() == SessionState::Failed) {
+            SOTC_CHECK(fleet.session(index).last_error().find("invite code already in use") != std::string::npos);
+            break;
+        }
+    }
+}
+
+SOTC_TEST(fleet_reconcile_touches_only_changed_servers) {
+    EventLoop loop;
+    MockCoordinator coordinator{loop};
+
+    std::vector<RegistrationConfig> configs;
+    for (std::size_t index = 0; index < 4; ++index) {
+        configs.push_back(make_config(coordinator, index));
+    }
+    CoordinatorFleet fleet{loop};
+    for (const auto &config : configs) {
+        fleet.add(config, 10s);
+    }
+    fleet.start();
+    SOTC_CHECK(run_until(loop, [&] { return fleet.count(SessionState::Registered) == 4; }));
+    const auto invite_code = fleet.session(0).registration().invite_code;
+
+    auto desired = configs;
+    desired[1].server_name = "Renamed";
+    desired.erase(desired.begin() + 2);
+    desired.push_back(make_config(coordinator, 4));
+    const auto result = fleet.reconcile(desired);
+    SOTC_CHECK(result.unchanged == 2);
+    SOTC_CHECK(result.patched == 1);
+    SOTC_CHECK(result.added == 1);
+    SOTC_CHECK(result.removed == 1);
+    SOTC_CHECK(result.reregistered == 0);
+    // The removed server's index is reused rather than the fleet growing.
+    SOTC_CHECK(fleet.size() == 4);
+    SOTC_CHECK((fleet.active() == std::vector<std::size_t>{0, 1, 3, 2}));
+
+    SOTC_CHECK(run_until(loop, [&] {
+        const auto &stats = coordinator.stats();
+        return stats.registrations == 5 && stats.updates == 1 && stats.connections_active == 4 &&
+               fleet.session(2).state() == SessionState::Registered;
+    }));
+    SOTC_CHECK(fleet.session(0).heartbeats_sent() == 0);
+    SOTC_CHECK(fleet.session(0).registration().invite_code == invite_code);
+    SOTC_CHECK(fleet.session(1).config().server_name == "Renamed");
+    SOTC_CHECK(fleet.session(1).heartbeats_sent() == 1);
+    SOTC_CHECK(fleet.session(2).config().listen_port == 4004);
+
+    // Moving a server to another coordinator replaces its session.
+    desired[0].coordinator_host = "localhost";
+    const auto moved = fleet.reconcile(desired);
+    SOTC_CHECK(moved.reregistered == 1 && moved.unchanged == 3);
+    SOTC_CHECK(fleet.size() == 4);
+    SOTC_CHECK(fleet.session(0).config().coordinator_host == "localhost");
+    SOTC_CHECK(run_until(loop, [&] { return fleet.session(0).state() == SessionState::Registered; }));
+    SOTC_CHECK(fleet.heartbeats_sent() == 1);
+    fleet.close();
+}
+
+SOTC_TEST(fleet_reuses_indices_of_removed_servers) {
+    EventLoop loop;
+    MockCoordinator coordinator{loop};
+    CoordinatorFleet fleet{loop};
+    fleet.start();
+
+    const auto first = fleet.add(make_config(coordinator, 0), 10s);
+    const auto second = fleet.add(make_config(coordinator, 1), 10s);
+    SOTC_CHECK(run_until(loop, [&] { return fleet.count(SessionState::Registered) == 2; }));
+    fleet.remove(first);
+    fleet.remove(first);
+    SOTC_CHECK(fleet.size() == 1);
+    SOTC_CHECK((fleet.active() == std::vector<std::size_t>{second}));
+
+    for (std::size_t round = 0; round < 10; ++round) {
+        const auto added = fleet.add(make_config(coordinator, 2 + round), 10s);
+        SOTC_CHECK(added == first);
+        SOTC_CHECK(run_until(loop, [&] { return fleet.session(added).state() == SessionState::Registered; }));
+        fleet.remove(added);
+    }
+    SOTC_CHECK(fleet.size() == 1);
+    SOTC_CHECK(run_until(loop, [&] { return coordinator.stats().connections_active == 1; }));
+    SOTC_CHECK(!fleet.finished());
+    fleet.close();
+    SOTC_CHECK(fleet.finished());
+}
+
+SOTC_TEST(mock_coordinator_drops_malformed_streams) {
+    EventLoop loop;
+    MockCoordinator coordinator{loop};
+
+    bool in_progress = false;
+    auto client = connect_nonblocking(coordinator.endpoint(), in_progress);
+    SOTC_CHECK(run_until(loop, [&] { return coordinator.stats().connections_active == 1; }));
+
+    // A SERVER_REGISTER whose payload is far too short for a handshake frame.
+    std::vector<std::byte> packet(NETWORK_PACKET_HEADER_SIZE + 2);
+    write_packet_header(packet, static_cast<std::uint8_t>(PacketCoordinatorType::ServerRegister), 2);
+    SOTC_CHECK(::send(client.get(), packet.data(), packet.size(), MSG_NOSIGNAL) ==
+               static_cast<ssize_t>(packet.size()));
+
+    SOTC_CHECK(run_until(loop, [&] { return coordinator.stats().connections_active == 0; }));
+    SOTC_CHECK(coordinator.stats().malformed == 1);
+    SOTC_CHECK(coordinator.stats().registrations == 0);
+}
+
+SOTC_TEST(listing_client_keeps_newgrf_table_between_refreshes) {
+    EventLoop loop;
+    MockCoordinator coordinator{loop};
+    std::vector<ServerListingEntry> listing;
+    for (std::size_t index = 0; index < 300; ++index) {
+        listing.push_back(make_listed_server(index, index % 30));
+    }
+    coordinator.set_listing(listing);
+
+    ServerListingOptions options{};
+    options.coordinator_host = "127.0.0.1";
+    options.coordinator_port = coordinator.endpoint().port();
+    ServerListingClient client{loop, options};
+    std::size_t received = 0;
+    client.set_entry_callback([&](const ServerListingEntry &entry) {
+        SOTC_CHECK(entry.unresolved_newgrfs == 0);
+        ++received;
+    });
+
+    client.refresh();
+    SOTC_CHECK(run_until(loop, [&] { return client.state() == ListingState::Complete; }));
+    SOTC_CHECK(received == listing.size());
+    SOTC_CHECK(client.entries_received() == listing.size());
+    SOTC_CHECK(client.lookup_entries_received() == 29);
+    SOTC_CHECK(client.newgrf_table().size() == 29);
+
+    // An up-to-date table is not sent again.
+    client.refresh();
+    SOTC_CHECK(run_until(loop, [&] { return client.state() == ListingState::Complete; }));
+    SOTC_CHECK(received == 2 * listing.size());
+    SOTC_CHECK(client.lookup_entries_received() == 0);
+
+    listing.push_back(make_listed_server(listing.size(), 31));
+    coordinator.set_listing(listing);
+    client.refresh();
+    SOTC_CHECK(run_until(loop, [&] { return client.state() == ListingState::Complete; }));
+    SOTC_CHECK(client.entries_received() == listing.size());
+    SOTC_CHECK(client.lookup_entries_received() == 2);
+    SOTC_CHECK(coordinator.stats().listings == 3);
+    SOTC_CHECK(coordinator.stats().newgrf_lookup_entries_sent == 31);
+}
+
+SOTC_TEST_MAIN()
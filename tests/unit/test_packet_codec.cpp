@@ -0,0 +1,117 @@
+#include "network/packet_codec.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "unit_test.hpp"
+
+namespace {
+
+namespace codec = sotc::network::codec;
+
+struct FixedPacket {
+    std::uint8_t kind{0};
+    std::uint16_t port{0};
+    std::uint32_t token{0};
+};
+
+using FixedSchema = codec::PacketSchema<FixedPacket,
+                                        codec::UInt8Field<&FixedPacket::kind>,
+                                        codec::UInt16Field<&FixedPacket::port>,
+                                        codec::UInt32Field<&FixedPacket::token>>;
+
+struct VariablePacket {
+    std::uint8_t kind{0};
+    std::string name;
+    std::vector<std::string> tags;
+};
+
+using VariableSchema = codec::PacketSchema<VariablePacket,
+                                           codec::UInt8Field<&VariablePacket::kind>,
+                                           codec::StringField<&VariablePacket::name, 8, "name">,
+                                           codec::StringListField<&VariablePacket::tags, 3, 4, "tag", "tags">>;
+
+static_assert(FixedSchema::is_fixed_size);
+static_assert(FixedSchema::min_size == 7);
+static_assert(!VariableSchema::is_fixed_size);
+static_assert(VariableSchema::min_size == 4);
+static_assert(VariableSchema::max_size == 1 + (2 + 8) + 1 + 3 * (2 + 4));
+static_assert(FixedSchema::fixed_offset<&FixedPacket::kind>() == 0);
+static_assert(FixedSchema::fixed_offset<&FixedPacket::token>() == 3);
+static_assert(VariableSchema::fixed_offset<&VariablePacket::name>() == 1);
+
+} // namespace
+
+SOTC_TEST(fixed_schema_round_trips_big_endian) {
+    const FixedPacket packet{7, 0x1234, 0xDEADBEEF};
+    std::array<std::byte, FixedSchema::min_size> buffer{};
+    SOTC_CHECK(FixedSchema::serialize_into(packet, buffer) == buffer.size());
+    SOTC_CHECK(buffer[1] == std::byte{0x12});
+    SOTC_CHECK(buffer[3] == std::byte{0xDE});
+    SOTC_CHECK(buffer[6] == std::byte{0xEF});
+
+    const auto decoded = FixedSchema::parse(buffer);
+    SOTC_CHECK(decoded.kind == 7);
+    SOTC_CHECK(decoded.port == 0x1234);
+    SOTC_CHECK(decoded.token == 0xDEADBEEF);
+}
+
+SOTC_TEST(variable_schema_round_trips) {
+    const VariablePacket packet{1, "openttd", {"a", "bb", "ccc"}};
+    std::vector<std::byte> buffer(VariableSchema::serialized_size(packet));
+    SOTC_CHECK(VariableSchema::serialize_into(packet, buffer) == buffer.size());
+
+    const auto decoded = VariableSchema::parse(buffer);
+    SOTC_CHECK(decoded.name == packet.name);
+    SOTC_CHECK(decoded.tags == packet.tags);
+}
+
+SOTC_TEST(list_is_truncated_on_write) {
+    const VariablePacket packet{1, "x", {"a", "b", "c", "d"}};
+    std::vector<std::byte> buffer(VariableSchema::serialized_size(packet));
+    VariableSchema::serialize_into(packet, buffer);
+    SOTC_CHECK(VariableSchema::parse(buffer).tags.size() == 3);
+}
+
+SOTC_TEST(parse_enforces_limits) {
+    const VariablePacket long_name{1, "far too long", {}};
+    std::vector<std::byte> buffer(VariableSchema::serialized_size(long_name));
+    VariableSchema::serialize_into(long_name, buffer);
+    SOTC_CHECK_THROWS(VariableSchema::parse(buffer), std::length_error);
+
+    std::vector<std::byte> trailing(FixedSchema::min_size + 1);
+    SOTC_CHECK_THROWS(FixedSchema::parse(trailing), std::invalid_argument);
+
+    std::vector<std::byte> short_buffer(FixedSchema::min_size - 1);
+    SOTC_CHECK_THROWS(FixedSchema::parse(short_buffer), std::out_of_range);
+    SOTC_CHECK_THROWS(FixedSchema::serialize_into(FixedPacket{}, short_buffer), std::length_error);
+}
+
+SOTC_TEST(try_parse_reports_failing_field) {
+    using sotc::network::DecodeError;
+
+    const VariablePacket packet{1, "x", {"a", "b"}};
+    std::vector<std::byte> buffer(VariableSchema::serialized_size(packet));
+    VariableSchema::serialize_into(packet, buffer);
+
+    auto too_many = buffer;
+    too_many[1 + 2 + 1] = std::byte{4};
+    const auto count_result = VariableSchema::try_parse(too_many);
+    SOTC_CHECK(count_result.error() == DecodeError::TooManyItems);
+    SOTC_CHECK(count_result.error_field() == "tags");
+
+    const std::span<const std::byte> header_only{buffer.data(), 2};
+    const auto short_result = VariableSchema::try_parse(header_only);
+    SOTC_CHECK(short_result.error() == DecodeError::Truncated);
+
+    const auto ok = VariableSchema::try_parse(buffer);
+    SOTC_CHECK(ok.has_value());
+    SOTC_CHECK(ok->tags.size() == 2);
+}
+
+SOTC_TEST_MAIN()
@@ -0,0 +1,166 @@
+#include "network/packet_framer.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using sotc::network::FramedPacket;
+using sotc::network::NETWORK_PACKET_HEADER_SIZE;
+using sotc::network::PacketFramer;
+
+struct Packet {
+    std::uint8_t type;
+    std::vector<std::byte> payload;
+};
+
+[[nodiscard]] std::vector<Packet> make_packets(std::size_t count, std::size_t max_payload, std::mt19937 &rng) {
+    std::vector<Packet> packets;
+    for (std::size_t index = 0; index < count; ++index) {
+        Packet packet{static_cast<std::uint8_t>(index), {}};
+        packet.payload.resize(std::uniform_int_distribution<std::size_t>{0, max_payload}(rng));
+        for (auto &byte : packet.payload) {
+            byte = static_cast<std::byte>(rng() & 0xFFU);
+        }
+        packets.push_back(std::move(packet));
+    }
+    return packets;
+}
+
+[[nodiscard]] std::vector<std::byte> encode(const std::vector<Packet> &packets) {
+    std::vector<std::byte> stream;
+    for (const auto &packet : packets) {
+        const auto offset = stream.size();
+        stream.resize(offset + NETWORK_PACKET_HEADER_SIZE);
+        sotc::network::write_packet_header(std::span<std::byte>{stream}.subspan(offset), packet.type,
+                                           packet.payload.size());
+        stream.insert(stream.end(), packet.payload.begin(), packet.payload.end());
+    }
+    return stream;
+}
+
+[[nodiscard]] bool matches(const FramedPacket &framed, const Packet &expected) {
+    if (framed.type != expected.type || framed.size() != expected.payload.size()) {
+        return false;
+    }
+    return std::equal(framed.first.begin(), framed.first.end(), expected.payload.begin()) &&
+           std::equal(framed.second.begin(), framed.second.end(),
+                      expected.payload.begin() + static_cast<std::ptrdiff_t>(framed.first.size()));
+}
+
+// Feeds the stream in chunks chosen by next_chunk, draining packets as they
+// complete, and checks they arrive intact and in order.
+template <typename ChunkFn>
+[[nodiscard]] bool replay(PacketFramer &framer,
+                          const std::vector<Packet> &packets,
+                          const std::vector<std::byte> &stream,
+                          ChunkFn next_chunk,
+                          std::size_t &wrapped) {
+    std::size_t offset = 0;
+    std::size_t received = 0;
+    while (received < packets.size()) {
+        if (offset < stream.size()) {
+            const auto chunk = std::min(next_chunk(), stream.size() - offset);
+            offset += framer.feed(std::span<const std::byte>{stream}.subspan(offset, chunk));
+        }
+        while (auto packet = framer.front()) {
+            if (!matches(*packet, packets[received])) {
+                return false;
+            }
+            wrapped += packet->contiguous() ? 0U : 1U;
+            framer.pop_front();
+            ++received;
+        }
+        if (framer.failed()) {
+            return false;
+        }
+    }
+    return framer.buffered() == 0;
+}
+
+} // namespace
+
+SOTC_TEST(one_byte_reads_reassemble_packets) {
+    std::mt19937 rng{1};
+    const auto packets = make_packets(64, 300, rng);
+    const auto stream = encode(packets);
+
+    PacketFramer framer{512, 512};
+    std::size_t wrapped = 0;
+    SOTC_CHECK(replay(framer, packets, stream, [] { return std::size_t{1}; }, wrapped));
+}
+
+SOTC_TEST(random_split_reads_reassemble_and_wrap) {
+    std::mt19937 rng{2};
+    const auto packets = make_packets(500, 400, rng);
+    const auto stream = encode(packets);
+
+    PacketFramer framer{1024, 512};
+    std::size_t wrapped = 0;
+    std::uniform_int_distribution<std::size_t> chunk_size{1, 700};
+    SOTC_CHECK(replay(framer, packets, stream, [&] { return chunk_size(rng); }, wrapped));
+    SOTC_CHECK(wrapped > 0);
+}
+
+SOTC_TEST(full_size_tcp_packets_fit) {
+    std::mt19937 rng{3};
+    std::vector<Packet> packets{Packet{7, std::vector<std::byte>(sotc::network::NETWORK_TCP_MTU, std::byte{0x5A})},
+                                Packet{8, std::vector<std::byte>(sotc::network::NETWORK_COMPAT_MTU, std::byte{0x11})}};
+    const auto stream = encode(packets);
+
+    PacketFramer framer{};
+    std::size_t wrapped = 0;
+    std::uniform_int_distribution<std::size_t> chunk_size{1, 4096};
+    SOTC_CHECK(replay(framer, packets, stream, [&] { return chunk_size(rng); }, wrapped));
+}
+
+SOTC_TEST(prepare_commit_writes_in_place) {
+    PacketFramer framer{64, 64};
+    const std::vector<Packet> packets{Packet{1, {std::byte{0xAA}, std::byte{0xBB}}}};
+    const auto stream = encode(packets);
+
+    auto region = framer.prepare();
+    SOTC_CHECK(region.size() == framer.capacity());
+    std::copy(stream.begin(), stream.end(), region.begin());
+    framer.commit(stream.size());
+
+    const auto packet = framer.front();
+    SOTC_CHECK(packet.has_value());
+    SOTC_CHECK(packet && matches(*packet, packets.front()));
+    SOTC_CHECK(packet && packet->first.data() == region.data() + NETWORK_PACKET_HEADER_SIZE);
+}
+
+SOTC_TEST(oversized_packet_fails_stream) {
+    PacketFramer framer{64, 64};
+    const std::vector<std::byte> header{std::byte{0x01}, std::byte{0x00}, std::byte{0x01}};
+    SOTC_CHECK(framer.feed(header) == header.size());
+    SOTC_CHECK(!framer.front());
+    SOTC_CHECK(framer.failed());
+    SOTC_CHECK(framer.error() == sotc::network::DecodeError::InvalidPacketSize);
+
+    framer.reset();
+    SOTC_CHECK(!framer.failed());
+    SOTC_CHECK(framer.buffered() == 0);
+}
+
+SOTC_TEST(linearize_copies_only_wrapped_packets) {
+    FramedPacket contiguous{};
+    const std::vector<std::byte> bytes{std::byte{1}, std::byte{2}, std::byte{3}};
+    contiguous.first = bytes;
+    std::vector<std::byte> scratch;
+    SOTC_CHECK(contiguous.linearize(scratch).data() == bytes.data());
+    SOTC_CHECK(scratch.empty());
+
+    FramedPacket wrapped{};
+    wrapped.first = std::span<const std::byte>{bytes}.subspan(0, 1);
+    wrapped.second = std::span<const std::byte>{bytes}.subspan(1);
+    const auto joined = wrapped.linearize(scratch);
+    SOTC_CHECK(std::equal(joined.begin(), joined.end(), bytes.begin(), bytes.end()));
+}
+
+SOTC_TEST_MAIN()
@@ -0,0 +1,61 @@
+#include "network/registration_diff.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace sotc::network;
+
+[[nodiscard]] RegistrationConfig make_config(std::uint16_t listen_port, std::string server_name) {
+    RegistrationConfig config{};
+    config.server_name = std::move(server_name);
+    config.coordinator_host = "coordinator.example";
+    config.listen_port = listen_port;
+    return config;
+}
+
+} // namespace
+
+SOTC_TEST(diff_registrations_classifies_by_listen_port) {
+    const std::vector<RegistrationConfig> before{make_config(4000, "Alpha"), make_config(4001, "Beta"),
+                                                 make_config(4002, "Gamma"), make_config(4003, "Delta")};
+    auto after = before;
+    after[1].invite_code = "+BETA";
+    after[2].coordinator_port = 4976;
+    after.erase(after.begin() + 3);
+    after.insert(after.begin(), make_config(4004, "Epsilon"));
+
+    const auto diff = diff_registrations(before, after);
+    SOTC_CHECK(diff.size() == 5);
+    SOTC_CHECK(diff[0].change == RegistrationChange::Added);
+    SOTC_CHECK(diff[0].before == RegistrationDiffEntry::kNone && diff[0].after == 0);
+    SOTC_CHECK(diff[1].change == RegistrationChange::Unchanged);
+    SOTC_CHECK(diff[1].before == 0 && diff[1].after == 1);
+    SOTC_CHECK(diff[2].change == RegistrationChange::Patched);
+    SOTC_CHECK(diff[2].before == 1 && diff[2].after == 2);
+    SOTC_CHECK(diff[3].change == RegistrationChange::Reregistered);
+    SOTC_CHECK(diff[3].before == 2 && diff[3].after == 3);
+    SOTC_CHECK(diff[4].change == RegistrationChange::Removed);
+    SOTC_CHECK(diff[4].before == 3 && diff[4].after == RegistrationDiffEntry::kNone);
+    SOTC_CHECK(to_string(diff[3].change) == "re-registered");
+}
+
+SOTC_TEST(diff_registrations_pairs_repeated_ports_in_order) {
+    const std::vector<RegistrationConfig> before{make_config(4000, "First"), make_config(4000, "Second")};
+    const std::vector<RegistrationConfig> after{make_config(4000, "First"), make_config(4000, "Renamed"),
+                                                make_config(4000, "Third")};
+    const auto diff = diff_registrations(before, after);
+    SOTC_CHECK(diff.size() == 3);
+    SOTC_CHECK(diff[0].change == RegistrationChange::Unchanged && diff[0].before == 0);
+    SOTC_CHECK(diff[1].change == RegistrationChange::Patched && diff[1].before == 1);
+    SOTC_CHECK(diff[2].change == RegistrationChange::Added && diff[2].after == 2);
+
+    SOTC_CHECK(diff_registrations(before, before).size() == 2);
+    SOTC_CHECK(diff_registrations({}, {}).empty());
+}
+
+SOTC_TEST_MAIN()
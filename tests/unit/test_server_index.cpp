@@ -0,0 +1,207 @@
+#include "network/server_index.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace sotc::network;
+
+[[nodiscard]] ServerListingEntry make_entry(std::string name, std::uint8_t clients_on, std::uint8_t clients_max,
+                                            std::string revision = "14.1") {
+    ServerListingEntry entry{};
+    entry.connection_string = "192.0.2.1:" + std::to_string(3979 + clients_on);
+    entry.info.server_name = std::move(name);
+    entry.info.server_revision = std::move(revision);
+    entry.info.clients_on = clients_on;
+    entry.info.clients_max = clients_max;
+    return entry;
+}
+
+[[nodiscard]] NewGrfIdentity grf(std::uint32_t grfid, std::uint8_t md5_first = 0) {
+    NewGrfIdentity identity{};
+    identity.grfid = grfid;
+    identity.md5[0] = md5_first;
+    return identity;
+}
+
+[[nodiscard]] std::vector<std::uint32_t> selected_rows(const SelectionBitmap &selection) {
+    std::vector<std::uint32_t> rows;
+    selection.for_each([&](std::size_t row) { rows.push_back(static_cast<std::uint32_t>(row)); });
+    return rows;
+}
+
+} // namespace
+
+SOTC_TEST(selection_bitmap_masks_tail_bits) {
+    const SelectionBitmap all{130, true};
+    SOTC_CHECK(all.count() == 130);
+    SOTC_CHECK(all.test(129));
+    SOTC_CHECK(all.words().size() == 3);
+
+    SelectionBitmap some{130, false};
+    some.set(3);
+    some.set(64);
+    some.set(129);
+    SOTC_CHECK(some.count() == 3);
+    SOTC_CHECK((selected_rows(some) == std::vector<std::uint32_t>{3, 64, 129}));
+
+    SelectionBitmap combined{130, true};
+    combined &= some;
+    SOTC_CHECK(combined.count() == 3);
+}
+
+SOTC_TEST(server_index_filters_numeric_columns) {
+    ServerIndex index;
+    const auto both = static_cast<std::uint8_t>(NatCapability::Direct | NatCapability::Stun);
+    const auto stun = static_cast<std::uint8_t>(NatCapability::Stun);
+    index.add(make_entry("Alpha", 0, 10), ServerGameType::Public, both);
+    index.add(make_entry("Bravo", 5, 10), ServerGameType::Public, stun);
+    index.add(make_entry("Charlie", 10, 10), ServerGameType::FriendsOnly, both);
+    auto password = make_entry("Delta", 3, 25, "13.4");
+    password.info.use_password = true;
+    index.add(password, ServerGameType::InviteOnly, 0);
+    SOTC_CHECK(index.size() == 4);
+
+    SOTC_CHECK(index.filter(ServerFilter{}).count() == 4);
+
+    ServerFilter populated{};
+    populated.min_clients = 1;
+    SOTC_CHECK((selected_rows(index.filter(populated)) == std::vector<std::uint32_t>{1, 2, 3}));
+
+    ServerFilter joinable{};
+    joinable.min_free_slots = 1;
+    joinable.game_type = ServerGameType::Public;
+    SOTC_CHECK((selected_rows(index.filter(joinable)) == std::vector<std::uint32_t>{0, 1}));
+
+    ServerFilter direct{};
+    direct.required_nat_capabilities = static_cast<std::uint8_t>(NatCapability::Direct);
+    SOTC_CHECK((selected_rows(index.filter(direct)) == std::vector<std::uint32_t>{0, 2}));
+
+    ServerFilter open{};
+    open.use_password = false;
+    open.revision = "14.1";
+    open.max_clients = 5;
+    SOTC_CHECK((selected_rows(index.filter(open)) == std::vector<std::uint32_t>{0, 1}));
+
+    ServerFilter unknown_revision{};
+    unknown_revision.revision = "1.0";
+    SOTC_CHECK(index.filter(unknown_revision).count() == 0);
+}
+
+SOTC_TEST(server_index_filters_across_many_words) {
+    ServerIndex index;
+    for (std::size_t row = 0; row < 1000; ++row) {
+        index.add(make_entry("Server " + std::to_string(row), static_cast<std::uint8_t>(row % 26), 25));
+    }
+    ServerFilter filter{};
+    filter.min_clients = 20;
+    const auto selection = index.filter(filter);
+    std::size_t expected = 0;
+    for (std::size_t row = 0; row < 1000; ++row) {
+        expected += row % 26 >= 20 ? 1U : 0U;
+        SOTC_CHECK(selection.test(row) == (row % 26 >= 20));
+    }
+    SOTC_CHECK(selection.count() == expected);
+}
+
+SOTC_TEST(server_index_reuses_sorted_views_until_changed) {
+    ServerIndex index;
+    index.add(make_entry("Charlie", 4, 10));
+    index.add(make_entry("Alpha", 8, 10));
+    index.add(make_entry("Bravo", 4, 10));
+
+    const auto by_name = index.sorted(ServerSortKey::Name);
+    SOTC_CHECK((std::vector<std::uint32_t>(by_name.begin(), by_name.end()) == std::vector<std::uint32_t>{1, 2, 0}));
+    SOTC_CHECK(index.sorted(ServerSortKey::Name).data() == by_name.data());
+
+    // Ties keep row order in both directions.
+    const auto busiest = index.sorted(ServerSortKey::Clients, true);
+    SOTC_CHECK((std::vector<std::uint32_t>(busiest.begin(), busiest.end()) == std::vector<std::uint32_t>{1, 0, 2}));
+    const auto quietest = index.sorted(ServerSortKey::Clients);
+    SOTC_CHECK((std::vector<std::uint32_t>(quietest.begin(), quietest.end()) == std::vector<std::uint32_t>{0, 2, 1}));
+
+    const auto generation = index.generation();
+    index.add(make_entry("Aardvark", 0, 10));
+    SOTC_CHECK(index.generation() != generation);
+    const auto resorted = index.sorted(ServerSortKey::Name);
+    SOTC_CHECK(resorted.size() == 4);
+    SOTC_CHECK(resorted.front() == 3);
+    SOTC_CHECK(index.name(resorted.front()) == "Aardvark");
+
+    ServerFilter filter{};
+    filter.min_clients = 1;
+    SOTC_CHECK((index.select_sorted(index.filter(filter), ServerSortKey::Name) == std::vector<std::uint32_t>{1, 2, 0}));
+
+    index.clear();
+    SOTC_CHECK(index.size() == 0);
+    SOTC_CHECK(index.sorted(ServerSortKey::Name).empty());
+}
+
+SOTC_TEST(newgrf_set_keeps_identities_sorted_and_unique) {
+    NewGrfSet set{{grf(3), grf(1, 2), grf(1, 1), grf(3)}};
+    SOTC_CHECK(set.size() == 3);
+    SOTC_CHECK((std::vector<NewGrfIdentity>(set.identities().begin(), set.identities().end()) ==
+                std::vector<NewGrfIdentity>{grf(1, 1), grf(1, 2), grf(3)}));
+    SOTC_CHECK(set.contains(grf(1, 2)));
+    // Same grfid, different MD5: another version of the NewGRF.
+    SOTC_CHECK(!set.contains(grf(3, 1)));
+    SOTC_CHECK(set.insert(grf(2)));
+    SOTC_CHECK(!set.insert(grf(2)));
+
+    SOTC_CHECK(set.includes(NewGrfSet{{grf(3), grf(1, 1)}}));
+    SOTC_CHECK(!set.includes(NewGrfSet{{grf(3), grf(4)}}));
+    SOTC_CHECK(set.includes(NewGrfSet{}));
+    const std::vector<NewGrfIdentity> required{grf(4), grf(2), grf(3, 1)};
+    SOTC_CHECK((set.missing(required) == std::vector<NewGrfIdentity>{grf(4), grf(3, 1)}));
+}
+
+SOTC_TEST(server_index_selects_joinable_servers) {
+    ServerIndex index;
+    auto vanilla = make_entry("Vanilla", 1, 10);
+    auto installed_only = make_entry("Installed", 1, 10);
+    installed_only.info.newgrfs = {grf(7), grf(5), grf(7)};
+    auto needs_download = make_entry("Download", 1, 10);
+    needs_download.info.newgrfs = {grf(5), grf(6)};
+    auto other_version = make_entry("Version", 1, 10);
+    other_version.info.newgrfs = {grf(5, 9)};
+    index.add(vanilla);
+    index.add(installed_only);
+    index.add(needs_download);
+    index.add(other_version);
+
+    const NewGrfSet installed{{grf(5), grf(7), grf(8)}};
+    SOTC_CHECK((selected_rows(index.joinable(installed)) == std::vector<std::uint32_t>{0, 1}));
+    SOTC_CHECK((index.missing_newgrfs(2, installed) == std::vector<NewGrfIdentity>{grf(6)}));
+    SOTC_CHECK((index.missing_newgrfs(3, installed) == std::vector<NewGrfIdentity>{grf(5, 9)}));
+    SOTC_CHECK(index.missing_newgrfs(1, installed).empty());
+    SOTC_CHECK((selected_rows(index.joinable(NewGrfSet{})) == std::vector<std::uint32_t>{0}));
+
+    // Many rows, so the result spans several bitmap words.
+    ServerIndex large;
+    for (std::uint32_t row = 0; row < 200; ++row) {
+        auto entry = make_entry("Server", 1, 10);
+        entry.info.newgrfs = {grf(row % 10), grf(10 + row % 3)};
+        large.add(entry);
+    }
+    NewGrfSet most;
+    for (std::uint32_t grfid = 0; grfid < 12; ++grfid) {
+        if (grfid != 4) {
+            most.insert(grf(grfid));
+        }
+    }
+    const auto selection = large.joinable(most);
+    for (std::uint32_t row = 0; row < 200; ++row) {
+        SOTC_CHECK(selection.test(row) == (row % 10 != 4 && row % 3 != 2));
+    }
+
+    large.clear();
+    large.add(vanilla);
+    SOTC_CHECK(large.joinable(most).count() == 1);
+}
+
+SOTC_TEST_MAIN()
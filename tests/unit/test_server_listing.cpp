@@ -0,0 +1,185 @@
+#include "network/server_listing.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace sotc::network;
+
+[[nodiscard]] NewGrfIdentity make_grf(std::uint32_t id) {
+    NewGrfIdentity identity{};
+    identity.grfid = 0x4D4D0000U + id;
+    identity.md5[0] = static_cast<std::uint8_t>(id);
+    identity.md5[15] = 0xAB;
+    return identity;
+}
+
+[[nodiscard]] ServerListingEntry make_entry(std::size_t index, std::size_t grf_count) {
+    ServerListingEntry entry{};
+    entry.connection_string = "192.0.2.1:" + std::to_string(3979 + index);
+    entry.info.ticks_playing = 0x0102030405060708ULL + index;
+    entry.info.server_name = "Listed " + std::to_string(index);
+    entry.info.server_revision = "14.1";
+    entry.info.gamescript_name = "GS";
+    entry.info.gamescript_version = 3;
+    entry.info.clients_max = 25;
+    entry.info.clients_on = static_cast<std::uint8_t>(index % 25);
+    entry.info.map_width = 256;
+    entry.info.map_height = 1024;
+    entry.info.use_password = (index & 1U) != 0;
+    entry.info.dedicated = true;
+    for (std::size_t grf = 0; grf < grf_count; ++grf) {
+        entry.info.newgrfs.push_back(make_grf(static_cast<std::uint32_t>((index + grf) % 64)));
+    }
+    return entry;
+}
+
+// Coordinator-side table holding every GRF used by make_entry().
+[[nodiscard]] NewGrfLookupTable make_server_table() {
+    NewGrfLookupTable table;
+    for (std::uint32_t id = 0; id < 64; ++id) {
+        static_cast<void>(table.intern(make_grf(id), "GRF " + std::to_string(id)));
+    }
+    return table;
+}
+
+void feed_lookup(ServerListingDecoder &decoder, const NewGrfLookupTable &server, std::uint32_t cursor) {
+    for (const auto &payload : serialize_newgrf_lookup(server, cursor)) {
+        SOTC_CHECK(decoder.decode(PacketCoordinatorType::GcNewGrfLookup, payload).has_value());
+    }
+}
+
+} // namespace
+
+SOTC_TEST(client_listing_round_trips) {
+    CoordinatorClientListing request{};
+    request.revision = "sotc-test";
+    request.newgrf_lookup_cursor = 0x01020304U;
+    std::vector<std::byte> buffer(request.serialized_size());
+    SOTC_CHECK(request.serialize_into(buffer) == buffer.size());
+
+    const auto decoded = CoordinatorClientListing::try_deserialize(buffer);
+    SOTC_CHECK(decoded.has_value());
+    SOTC_CHECK(decoded->revision == "sotc-test");
+    SOTC_CHECK(decoded->newgrf_lookup_cursor == 0x01020304U);
+    SOTC_CHECK(decoded->game_info_version == NETWORK_GAME_INFO_VERSION);
+}
+
+SOTC_TEST(listing_decodes_entries_packet_by_packet) {
+    const auto server = make_server_table();
+    std::vector<ServerListingEntry> entries;
+    for (std::size_t index = 0; index < 50; ++index) {
+        entries.push_back(make_entry(index, index % 20));
+    }
+    // A small payload limit forces the listing over many packets.
+    const auto payloads = serialize_listing(entries, server, 1024);
+    SOTC_CHECK(payloads.size() > 3);
+
+    NewGrfLookupTable client;
+    ServerListingDecoder decoder{client};
+    std::vector<ServerListingEntry> received;
+    decoder.set_entry_callback([&](const ServerListingEntry &entry) { received.push_back(entry); });
+    feed_lookup(decoder, server, client.cursor());
+    SOTC_CHECK(client.size() == 64);
+    SOTC_CHECK(client.cursor() == server.cursor());
+
+    const auto first = decoder.decode(PacketCoordinatorType::GcListing, payloads.front());
+    SOTC_CHECK(first.has_value());
+    SOTC_CHECK(*first > 0);
+    SOTC_CHECK(received.size() == *first);
+    SOTC_CHECK(!decoder.complete());
+
+    for (std::size_t index = 1; index < payloads.size(); ++index) {
+        SOTC_CHECK(payloads[index].size() <= 1024);
+        SOTC_CHECK(decoder.decode(PacketCoordinatorType::GcListing, payloads[index]).has_value());
+    }
+    SOTC_CHECK(decoder.complete());
+    SOTC_CHECK(received.size() == entries.size());
+    SOTC_CHECK(decoder.entries_decoded() == entries.size());
+
+    for (std::size_t index = 0; index < entries.size(); ++index) {
+        const auto &expected = entries[index];
+        const auto &actual = received[index];
+        SOTC_CHECK(actual.connection_string == expected.connection_string);
+        SOTC_CHECK(actual.unresolved_newgrfs == 0);
+        SOTC_CHECK(actual.info.newgrfs == expected.info.newgrfs);
+        SOTC_CHECK(actual.info.ticks_playing == expected.info.ticks_playing);
+        SOTC_CHECK(actual.info.server_name == expected.info.server_name);
+        SOTC_CHECK(actual.info.use_password == expected.info.use_password);
+        SOTC_CHECK(actual.info.map_height == expected.info.map_height);
+        SOTC_CHECK(actual.info.gamescript_version == expected.info.gamescript_version);
+    }
+}
+
+SOTC_TEST(lookup_table_refresh_only_transfers_new_entries) {
+    auto server = make_server_table();
+    NewGrfLookupTable client;
+    ServerListingDecoder decoder{client};
+    feed_lookup(decoder, server, client.cursor());
+    SOTC_CHECK(decoder.lookup_entries_decoded() == 64);
+
+    // Nothing new: an up-to-date client is sent no lookup packets.
+    SOTC_CHECK(serialize_newgrf_lookup(server, client.cursor()).empty());
+
+    static_cast<void>(server.intern(make_grf(100), "Late GRF"));
+    static_cast<void>(server.intern(make_grf(101), "Later GRF"));
+    SOTC_CHECK(server.intern(make_grf(5), "duplicate") == 5);
+    decoder.reset();
+    feed_lookup(decoder, server, client.cursor());
+    SOTC_CHECK(decoder.lookup_entries_decoded() == 2);
+    SOTC_CHECK(client.size() == 66);
+    SOTC_CHECK(client.find(64) != nullptr);
+    SOTC_CHECK(client.find(64)->name == "Late GRF");
+    SOTC_CHECK(client.find(64)->identity == make_grf(100));
+}
+
+SOTC_TEST(listing_reports_unresolved_lookup_indices) {
+    const auto server = make_server_table();
+    const std::vector<ServerListingEntry> entries{make_entry(0, 10)};
+    const auto payloads = serialize_listing(entries, server);
+
+    // A client that never received the lookup table still decodes the entry.
+    NewGrfLookupTable client;
+    ServerListingDecoder decoder{client};
+    std::size_t unresolved = 0;
+    decoder.set_entry_callback([&](const ServerListingEntry &entry) { unresolved = entry.unresolved_newgrfs; });
+    SOTC_CHECK(decoder.decode(PacketCoordinatorType::GcListing, payloads.front()).has_value());
+    SOTC_CHECK(unresolved == 10);
+}
+
+SOTC_TEST(listing_rejects_malformed_payloads) {
+    const auto server = make_server_table();
+    const std::vector<ServerListingEntry> entries{make_entry(1, 4)};
+    auto payload = serialize_listing(entries, server).front();
+
+    NewGrfLookupTable client;
+    ServerListingDecoder decoder{client};
+
+    auto truncated = payload;
+    truncated.resize(truncated.size() - 3);
+    const auto short_result = decoder.decode(PacketCoordinatorType::GcListing, truncated);
+    SOTC_CHECK(!short_result.has_value());
+    SOTC_CHECK(short_result.error() == DecodeError::Truncated);
+
+    auto trailing = payload;
+    trailing.push_back(std::byte{0});
+    SOTC_CHECK(decoder.decode(PacketCoordinatorType::GcListing, trailing).error() == DecodeError::TrailingData);
+
+    // Game info version follows the uint16 count and the connection string.
+    auto wrong_version = payload;
+    const auto version_offset = 2 + 2 + entries.front().connection_string.size();
+    wrong_version[version_offset] = std::byte{6};
+    const auto version_result = decoder.decode(PacketCoordinatorType::GcListing, wrong_version);
+    SOTC_CHECK(version_result.error() == DecodeError::UnsupportedVersion);
+    SOTC_CHECK(version_result.error_field() == "game info");
+
+    SOTC_CHECK(!decoder.complete());
+    SOTC_CHECK(decoder.decode(PacketCoordinatorType::GcRegisterAck, payload).has_value());
+}
+
+SOTC_TEST_MAIN()
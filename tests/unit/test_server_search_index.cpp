@@ -0,0 +1,83 @@
+#include "network/server_search_index.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using sotc::network::ServerSearchIndex;
+using Rows = std::vector<std::uint32_t>;
+
+[[nodiscard]] ServerSearchIndex make_index() {
+    ServerSearchIndex index;
+    index.insert(0, "Alpha Transport Co.", "192.0.2.1:3979");
+    index.insert(1, "Bravo Rail", "+AbCdEf");
+    index.insert(2, "Rail & Road Fun", "+AbZzzz");
+    index.insert(3, "Railroad Tycoons", "+XyZ123");
+    index.insert(4, "railway RAILWAY", "[2001:db8::1]:3979");
+    return index;
+}
+
+} // namespace
+
+SOTC_TEST(search_index_matches_name_substrings_case_insensitively) {
+    const auto index = make_index();
+    SOTC_CHECK(index.size() == 5);
+    SOTC_CHECK((index.find_name("rail") == Rows{1, 2, 3, 4}));
+    SOTC_CHECK((index.find_name("RAILROAD") == Rows{3}));
+    SOTC_CHECK((index.find_name("railway railway") == Rows{4}));
+    SOTC_CHECK((index.find_name("ail") == Rows{1, 2, 3, 4}));
+    SOTC_CHECK((index.find_name("r") == Rows{0, 1, 2, 3, 4}));
+    SOTC_CHECK((index.find_name("o.") == Rows{0}));
+    SOTC_CHECK((index.find_name("") == Rows{0, 1, 2, 3, 4}));
+    SOTC_CHECK((index.find_name("rail", 2) == Rows{1, 2}));
+    SOTC_CHECK(index.find_name("monorail").empty());
+    SOTC_CHECK(index.find_name("zzz").empty());
+}
+
+SOTC_TEST(search_index_confirms_trigram_candidates) {
+    ServerSearchIndex index;
+    // Holds every trigram of "abcabd" but not the string itself.
+    index.insert(7, "abcab xbcabd", "");
+    index.insert(9, "xabcabdx", "");
+    SOTC_CHECK((index.find_name("abcabd") == Rows{9}));
+}
+
+SOTC_TEST(search_index_finds_invite_code_prefixes) {
+    const auto index = make_index();
+    SOTC_CHECK((index.find_invite_code("+Ab") == Rows{1, 2}));
+    SOTC_CHECK((index.find_invite_code("AbC") == Rows{1}));
+    SOTC_CHECK((index.find_invite_code("+") == Rows{1, 2, 3}));
+    SOTC_CHECK((index.find_invite_code("", 1) == Rows{1}));
+    SOTC_CHECK(index.find_invite_code("ab").empty());
+    SOTC_CHECK(index.find_invite_code("+Q").empty());
+}
+
+SOTC_TEST(search_index_updates_postings_when_servers_change) {
+    auto index = make_index();
+    SOTC_CHECK(index.erase(2));
+    SOTC_CHECK(!index.erase(2));
+    SOTC_CHECK(!index.contains(2));
+    SOTC_CHECK((index.find_name("rail") == Rows{1, 3, 4}));
+    SOTC_CHECK((index.find_invite_code("+Ab") == Rows{1}));
+    SOTC_CHECK(index.find_name("fun").empty());
+
+    // Re-inserting a row replaces its name and invite code.
+    index.insert(1, "Fun Express", "10.0.0.1:3979");
+    SOTC_CHECK((index.find_name("fun") == Rows{1}));
+    SOTC_CHECK((index.find_name("rail") == Rows{3, 4}));
+    SOTC_CHECK(index.find_invite_code("+Ab").empty());
+
+    // Out-of-order inserts keep posting lists sorted.
+    index.insert(0, "Zero Rail", "");
+    SOTC_CHECK((index.find_name("rail") == Rows{0, 3, 4}));
+
+    index.clear();
+    SOTC_CHECK(index.size() == 0);
+    SOTC_CHECK(index.find_name("rail").empty());
+}
+
+SOTC_TEST_MAIN()
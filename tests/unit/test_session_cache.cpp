@@ -0,0 +1,339 @@
+#include "network/session_cache.hpp"
+
+#include "network/coordinator_fleet.hpp"
+#include "network/coordinator_session.hpp"
+#include "network/mock_coordinator.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+using namespace sotc::network;
+
+// A cache file under the temporary directory, removed again on scope exit.
+class TemporaryCache {
+public:
+    explicit TemporaryCache(const std::string &name)
+        : path_(std::filesystem::temp_directory_path() /
+                ("sotc-" + std::to_string(::getpid()) + '-' + name) / "sessions.txt") {}
+    ~TemporaryCache() {
+        std::error_code error;
+        std::filesystem::remove_all(path_.parent_path(), error);
+    }
+
+    TemporaryCache(const TemporaryCache &) = delete;
+    TemporaryCache &operator=(const TemporaryCache &) = delete;
+
+    [[nodiscard]] const std::filesystem::path &path() const noexcept { return path_; }
+
+private:
+    std::filesystem::path path_;
+};
+
+[[nodiscard]] RegistrationConfig make_config(std::uint16_t coordinator_port) {
+    RegistrationConfig config{};
+    config.server_name = "Cached server";
+    config.coordinator_host = "127.0.0.1";
+    config.coordinator_port = coordinator_port;
+    return config;
+}
+
+bool run_until(EventLoop &loop, const std::function<bool()> &done, EventLoop::Clock::duration timeout = 5s) {
+    const auto deadline = EventLoop::Clock::now() + timeout;
+    while (!done()) {
+        if (EventLoop::Clock::now() > deadline) {
+            return false;
+        }
+        loop.run_once(10ms);
+    }
+    return true;
+}
+
+} // namespace
+
+SOTC_TEST(session_identity_ignores_volatile_settings) {
+    RegistrationConfig config{};
+    const auto identity = session_identity(config);
+    SOTC_CHECK(identity.size() == 16);
+
+    auto changed = config;
+    changed.heartbeat_interval = 5s;
+    changed.allow_turn = false;
+    changed.invite_code = "+ABC";
+    SOTC_CHECK(session_identity(changed) == identity);
+
+    changed.listen_port = 4000;
+    SOTC_CHECK(session_identity(changed) != identity);
+    changed = config;
+    changed.server_name += 'x';
+    SOTC_CHECK(session_identity(changed) != identity);
+}
+
+SOTC_TEST(session_cache_round_trips_and_skips_bad_lines) {
+    const TemporaryCache file{"round-trip"};
+    SessionCache cache{file.path()};
+    SOTC_CHECK(!cache.load());
+
+    cache.store("a", CachedSession{"+AAA", 1, "192.0.2.1:3976", 1700000000});
+    cache.store("b", CachedSession{"+BBB", 2, "[2001:db8::1]:3976", 1700000001});
+    cache.store("c", CachedSession{"+C\tC", 0, "", 0});
+    SOTC_CHECK(cache.size() == 2);
+    SOTC_CHECK(cache.dirty());
+    cache.flush();
+    SOTC_CHECK(!cache.dirty());
+    const auto permissions = std::filesystem::status(file.path()).permissions();
+    SOTC_CHECK(permissions == (std::filesystem::perms::owner_read | std::filesystem::perms::owner_write));
+
+    {
+        std::ofstream append{file.path(), std::ios::app};
+        append << "broken line\n" << "d\t+DDD\tnot-a-number\t\t0\n";
+    }
+
+    SessionCache reloaded{file.path()};
+    SOTC_CHECK(reloaded.load());
+    SOTC_CHECK(!reloaded.dirty());
+    SOTC_CHECK(reloaded.size() == 2);
+    const auto *entry = reloaded.find("a");
+    SOTC_CHECK(entry != nullptr);
+    SOTC_CHECK(entry->invite_code == "+AAA");
+    SOTC_CHECK(entry->connection_type == 1);
+    SOTC_CHECK(entry->coordinator_endpoint == "192.0.2.1:3976");
+    SOTC_CHECK(entry->saved_at == 1700000000);
+    SOTC_CHECK(parse_endpoint(reloaded.find("b")->coordinator_endpoint)->to_string() == "[2001:db8::1]:3976");
+    SOTC_CHECK(!reloaded.erase("missing"));
+    SOTC_CHECK(!reloaded.dirty());
+    SOTC_CHECK(reloaded.erase("a"));
+    SOTC_CHECK(!reloaded.erase("a"));
+    SOTC_CHECK(reloaded.dirty());
+}
+
+SOTC_TEST(session_resumes_cached_registration) {
+    const TemporaryCache file{"resume"};
+    EventLoop loop;
+    MockCoordinator coordinator{loop};
+    SessionCache cache{file.path()};
+    CoordinatorSessionOptions options{};
+    options.session_cache = &cache;
+    const auto config = make_config(coordinator.endpoint().port());
+
+    CoordinatorSession first{loop, config, options};
+    first.start();
+    SOTC_CHECK(run_until(loop, [&] { return first.state() == SessionState::Registered; }));
+    SOTC_CHECK(!first.resumed());
+    SOTC_CHECK(first.time_to_registered() > 0ns);
+    const auto invite_code = first.registration().invite_code;
+    first.close();
+    // A session leaves writing the cache to its owner.
+    cache.flush();
+
+    SessionCache reloaded{file.path()};
+    SOTC_CHECK(reloaded.load());
+    SOTC_CHECK(reloaded.find(session_identity(config))->invite_code == invite_code);
+
+    options.session_cache = &reloaded;
+    CoordinatorSession second{loop, config, options};
+    second.start();
+    SOTC_CHECK(run_until(loop, [&] { return second.state() == SessionState::Registered; }));
+    SOTC_CHECK(second.resumed());
+    SOTC_CHECK(second.registration().invite_code == invite_code);
+    SOTC_CHECK(coordinator.stats().resumed == 1);
+}
+
+SOTC_TEST(session_moves_cache_entry_when_renamed) {
+    const TemporaryCache file{"rename"};
+    EventLoop loop;
+    MockCoordinator coordinator{loop};
+    SessionCache cache{file.path()};
+    CoordinatorSessionOptions options{};
+    options.session_cache = &cache;
+    const auto config = make_config(coordinator.endpoint().port());
+
+    CoordinatorSession session{loop, config, options};
+    session.start();
+    SOTC_CHECK(run_until(loop, [&] { return session.state() == SessionState::Registered; }));
+    const auto invite_code = session.registration().invite_code;
+
+    auto renamed = config;
+    renamed.server_name = "Renamed server";
+    static_cast<void>(session.update_registration(renamed));
+    SOTC_CHECK(cache.find(session_identity(config)) == nullptr);
+    SOTC_CHECK(cache.size() == 1);
+    cache.flush();
+
+    SessionCache reloaded{file.path()};
+    SOTC_CHECK(reloaded.load());
+    SOTC_CHECK(reloaded.find(session_identity(config)) == nullptr);
+    const auto *moved = reloaded.find(session_identity(renamed));
+    SOTC_CHECK(moved != nullptr && moved->invite_code == invite_code);
+    SOTC_CHECK(moved != nullptr && moved->coordinator_endpoint == coordinator.endpoint().to_string());
+}
+
+SOTC_TEST(fleet_reconcile_keeps_resumed_invite_code) {
+    const TemporaryCache file{"reconcile"};
+    EventLoop loop;
+    MockCoordinator coordinator{loop};
+    SessionCache cache{file.path()};
+    CoordinatorSessionOptions options{};
+    options.session_cache = &cache;
+    const auto config = make_config(coordinator.endpoint().port());
+
+    CoordinatorSession first{loop, config, options};
+    first.start();
+    SOTC_CHECK(run_until(loop, [&] { return first.state() == SessionState::Registered; }));
+    const auto invite_code = first.registration().invite_code;
+    first.close();
+
+    CoordinatorFleetOptions fleet_options{};
+    fleet_options.session_cache = &cache;
+    CoordinatorFleet fleet{loop, fleet_options};
+    fleet.add(config, 10s);
+    fleet.start();
+    SOTC_CHECK(run_until(loop, [&] { return fleet.session(0).state() == SessionState::Registered; }));
+    SOTC_CHECK(fleet.session(0).resumed());
+    SOTC_CHECK(fleet.session(0).config().invite_code == invite_code);
+
+    // The same configuration again: nothing to patch, nothing sent.
+    const std::vector<RegistrationConfig> same{config};
+    const auto result = fleet.reconcile(same);
+    SOTC_CHECK(result.unchanged == 1 && result.patched == 0);
+    loop.run_once(50ms);
+    SOTC_CHECK(coordinator.stats().updates == 0);
+    SOTC_CHECK(fleet.session(0).heartbeats_sent() == 0);
+    SOTC_CHECK(fleet.session(0).config().invite_code == invite_code);
+
+    // A real change is patched without losing the resumed invite code.
+    auto changed = config;
+    changed.allow_turn = false;
+    const std::vector<RegistrationConfig> desired{changed};
+    SOTC_CHECK(fleet.reconcile(desired).patched == 1);
+    SOTC_CHECK(run_until(loop, [&] { return coordinator.stats().updates == 1; }));
+    SOTC_CHECK(fleet.session(0).config().invite_code == invite_code);
+    SOTC_CHECK(fleet.session(0).frame().invite_code == invite_code);
+    fleet.close();
+}
+
+SOTC_TEST(fleet_coalesces_session_cache_writes) {
+    const TemporaryCache file{"coalesce"};
+    EventLoop loop;
+    MockCoordinator coordinator{loop};
+    SessionCache cache{file.path()};
+
+    CoordinatorFleetOptions fleet_options{};
+    fleet_options.session_cache = &cache;
+    fleet_options.cache_flush_delay = 1h;
+    {
+        CoordinatorFleet fleet{loop, fleet_options};
+        for (std::uint16_t port = 3980; port < 3983; ++port) {
+            auto config = make_config(coordinator.endpoint().port());
+            config.listen_port = port;
+            fleet.add(config, 10s);
+        }
+        fleet.start();
+        SOTC_CHECK(run_until(loop, [&] { return fleet.count(SessionState::Registered) == 3; }));
+        // Every registration is in memory, none has touched the disk yet.
+        SOTC_CHECK(cache.size() == 3);
+        SOTC_CHECK(cache.dirty());
+        SOTC_CHECK(!std::filesystem::exists(file.path()));
+    }
+    SOTC_CHECK(!cache.dirty());
+    SessionCache written{file.path()};
+    SOTC_CHECK(written.load());
+    SOTC_CHECK(written.size() == 3);
+
+    // Without a close, the flush timer writes the changes out.
+    fleet_options.cache_flush_delay = 1ms;
+    CoordinatorFleet fleet{loop, fleet_options};
+    auto config = make_config(coordinator.endpoint().port());
+    config.listen_port = 3990;
+    fleet.add(config, 10s);
+    fleet.start();
+    SOTC_CHECK(run_until(loop, [&] { return fleet.session(0).state() == SessionState::Registered && !cache.dirty(); }));
+    SOTC_CHECK(written.load());
+    SOTC_CHECK(written.size() == 4);
+}
+
+SOTC_TEST(session_falls_back_when_cached_coordinator_is_gone) {
+    const TemporaryCache file{"fallback"};
+    EventLoop loop;
+    MockCoordinator coordinator{loop};
+    const auto config = make_config(coordinator.endpoint().port());
+
+    std::uint16_t unused_port = 0;
+    {
+        const auto listener = listen_nonblocking(loopback_endpoint(0));
+        unused_port = local_endpoint(listener.get()).port();
+    }
+    SessionCache cache{file.path()};
+    cache.store(session_identity(config), CachedSession{"+STALE", 0, loopback_endpoint(unused_port).to_string(), 0});
+
+    CoordinatorSessionOptions options{};
+    options.session_cache = &cache;
+    CoordinatorSession session{loop, config, options};
+    session.start();
+    SOTC_CHECK(run_until(loop, [&] { return session.state() == SessionState::Registered; }));
+    SOTC_CHECK(!session.resumed());
+    SOTC_CHECK(session.registration().invite_code != "+STALE");
+    SOTC_CHECK(session.frame().invite_code.empty());
+    SOTC_CHECK(cache.find(session_identity(config))->coordinator_endpoint == coordinator.endpoint().to_string());
+}
+
+SOTC_TEST(session_falls_back_when_cached_coordinator_never_acknowledges) {
+    const TemporaryCache file{"silent"};
+    EventLoop loop;
+    MockCoordinator coordinator{loop};
+    const auto config = make_config(coordinator.endpoint().port());
+
+    // The kernel completes the handshake on a listener nobody accepts from,
+    // so the session connects and then hears nothing back.
+    const auto silent = listen_nonblocking(loopback_endpoint(0));
+    SessionCache cache{file.path()};
+    cache.store(session_identity(config),
+                CachedSession{"+SILENT", 0, local_endpoint(silent.get()).to_string(), 0});
+
+    CoordinatorSessionOptions options{};
+    options.session_cache = &cache;
+    options.register_timeout = 50ms;
+    CoordinatorSession session{loop, config, options};
+    session.start();
+    SOTC_CHECK(session.resumed());
+    SOTC_CHECK(run_until(loop, [&] { return session.state() == SessionState::Registered; }));
+    SOTC_CHECK(!session.resumed());
+    SOTC_CHECK(session.registration().invite_code != "+SILENT");
+    SOTC_CHECK(cache.find(session_identity(config))->coordinator_endpoint == coordinator.endpoint().to_string());
+}
+
+SOTC_TEST(session_drops_rejected_cache_entry) {
+    const TemporaryCache file{"rejected"};
+    EventLoop loop;
+    MockCoordinatorOptions mock_options{};
+    mock_options.error_rate = 1.0;
+    MockCoordinator coordinator{loop, mock_options};
+    const auto config = make_config(coordinator.endpoint().port());
+
+    SessionCache cache{file.path()};
+    cache.store(session_identity(config), CachedSession{"+OLD", 0, coordinator.endpoint().to_string(), 0});
+    CoordinatorSessionOptions options{};
+    options.session_cache = &cache;
+    CoordinatorSession session{loop, config, options};
+    session.start();
+    SOTC_CHECK(run_until(loop, [&] { return session.state() == SessionState::Failed; }));
+    // One register with the cached code, one from scratch.
+    SOTC_CHECK(coordinator.stats().registrations == 2);
+    SOTC_CHECK(cache.size() == 0);
+    cache.flush();
+    SessionCache reloaded{file.path()};
+    SOTC_CHECK(reloaded.load());
+    SOTC_CHECK(reloaded.size() == 0);
+}
+
+SOTC_TEST_MAIN()
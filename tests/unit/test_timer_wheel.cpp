@@ -0,0 +1,248 @@
+#include "network/timer_wheel.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "unit_test.hpp"
+
+namespace {
+
+using namespace std::chrono_literals;
+using sotc::network::TimerWheel;
+
+const TimerWheel::Clock::time_point kOrigin{};
+
+} // namespace
+
+SOTC_TEST(wheel_fires_on_deadline_not_before) {
+    TimerWheel wheel{1ms, kOrigin};
+    bool fired = false;
+    wheel.schedule_at(kOrigin + 5ms, [&] { fired = true; });
+
+    SOTC_CHECK(wheel.advance(kOrigin + 4ms) == 0);
+    SOTC_CHECK(!fired);
+    SOTC_CHECK(wheel.advance(kOrigin + 5ms) == 1);
+    SOTC_CHECK(fired);
+    SOTC_CHECK(wheel.empty());
+}
+
+SOTC_TEST(wheel_rounds_partial_ticks_up) {
+    TimerWheel wheel{10ms, kOrigin};
+    bool fired = false;
+    wheel.schedule_at(kOrigin + 11ms, [&] { fired = true; });
+
+    wheel.advance(kOrigin + 19ms);
+    SOTC_CHECK(!fired);
+    wheel.advance(kOrigin + 20ms);
+    SOTC_CHECK(fired);
+    SOTC_CHECK(wheel.jitter().count() == 1);
+    SOTC_CHECK(wheel.jitter().max() >= 9ms);
+}
+
+SOTC_TEST(wheel_cascades_across_every_level) {
+    TimerWheel wheel{1ms, kOrigin};
+    const std::vector<std::uint64_t> deadlines{1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 300000, 16777216 + 5};
+    std::vector<std::uint64_t> fired_at;
+    std::uint64_t now = 0;
+    for (const auto deadline : deadlines) {
+        wheel.schedule_at(kOrigin + std::chrono::milliseconds{deadline}, [&] { fired_at.push_back(now); });
+    }
+
+    // Jump straight to one tick before each deadline, then onto it.
+    for (std::size_t index = 0; index < deadlines.size(); ++index) {
+        now = deadlines[index] - 1;
+        wheel.advance(kOrigin + std::chrono::milliseconds{now});
+        SOTC_CHECK(fired_at.size() == index);
+        now = deadlines[index];
+        wheel.advance(kOrigin + std::chrono::milliseconds{now});
+        SOTC_CHECK(fired_at.size() == index + 1);
+    }
+    SOTC_CHECK(fired_at == deadlines);
+    SOTC_CHECK(wheel.empty());
+}
+
+SOTC_TEST(wheel_cancel_is_stable_across_reuse) {
+    TimerWheel wheel{1ms, kOrigin};
+    int fired = 0;
+    const auto first = wheel.schedule_at(kOrigin + 10ms, [&] { fired += 1; });
+    wheel.cancel(first);
+    SOTC_CHECK(wheel.empty());
+
+    const auto second = wheel.schedule_at(kOrigin + 10ms, [&] { fired += 10; });
+    SOTC_CHECK(second != first);
+    // A stale id must not cancel the timer that reused its node.
+    wheel.cancel(first);
+    SOTC_CHECK(wheel.size() == 1);
+
+    wheel.advance(kOrigin + 10ms);
+    SOTC_CHECK(fired == 10);
+    wheel.cancel(second);
+    wheel.cancel(0);
+}
+
+SOTC_TEST(wheel_callbacks_can_reschedule_themselves) {
+    TimerWheel wheel{1ms, kOrigin};
+    std::size_t beats = 0;
+    std::function<void()> heartbeat;
+    auto next = kOrigin;
+    heartbeat = [&] {
+        ++beats;
+        next += 7ms;
+        wheel.schedule_at(next, heartbeat);
+    };
+    next += 7ms;
+    wheel.schedule_at(next, heartbeat);
+
+    for (auto now = kOrigin; now <= kOrigin + 700ms; now += 1ms) {
+        wheel.advance(now);
+    }
+    SOTC_CHECK(beats == 100);
+    SOTC_CHECK(wheel.size() == 1);
+    SOTC_CHECK(wheel.jitter().max() == 0ns);
+}
+
+SOTC_TEST(wheel_reschedule_one_revolution_ahead_waits_for_it) {
+    // The rescheduled timer lands in the level-0 slot that is being
+    // dispatched; it must stay there until the wheel comes round again.
+    TimerWheel wheel{1ms, kOrigin};
+    std::vector<std::int64_t> fired_at;
+    std::int64_t now = 10;
+    std::function<void()> heartbeat;
+    heartbeat = [&] {
+        fired_at.push_back(now);
+        if (fired_at.size() < 3) {
+            wheel.schedule_at(kOrigin + std::chrono::milliseconds{now + 64}, heartbeat);
+        }
+    };
+    wheel.schedule_at(kOrigin + 10ms, heartbeat);
+
+    wheel.advance(kOrigin + 10ms);
+    SOTC_CHECK(fired_at.size() == 1);
+    SOTC_CHECK(wheel.size() == 1);
+    for (now = 11; now <= 200; ++now) {
+        wheel.advance(kOrigin + std::chrono::milliseconds{now});
+    }
+    SOTC_CHECK((fired_at == std::vector<std::int64_t>{10, 74, 138}));
+    SOTC_CHECK(wheel.jitter().max() == 0ns);
+}
+
+SOTC_TEST(wheel_callbacks_can_cancel_timers_due_on_the_same_tick) {
+    TimerWheel wheel{1ms, kOrigin};
+    int fired = 0;
+    TimerWheel::TimerId first = 0;
+    TimerWheel::TimerId second = 0;
+    first = wheel.schedule_at(kOrigin + 5ms, [&] {
+        ++fired;
+        wheel.cancel(second);
+    });
+    second = wheel.schedule_at(kOrigin + 5ms, [&] {
+        ++fired;
+        wheel.cancel(first);
+    });
+
+    SOTC_CHECK(wheel.advance(kOrigin + 5ms) == 1);
+    SOTC_CHECK(fired == 1);
+    SOTC_CHECK(wheel.empty());
+}
+
+SOTC_TEST(wheel_overdue_timers_fire_on_next_tick) {
+    TimerWheel wheel{1ms, kOrigin};
+    wheel.advance(kOrigin + 100ms);
+    bool fired = false;
+    wheel.schedule_at(kOrigin + 50ms, [&] { fired = true; });
+    wheel.advance(kOrigin + 100ms);
+    SOTC_CHECK(!fired);
+    wheel.advance(kOrigin + 101ms);
+    SOTC_CHECK(fired);
+    SOTC_CHECK(wheel.jitter().max() == 51ms);
+}
+
+SOTC_TEST(wheel_matches_reference_order_for_random_timers) {
+    TimerWheel wheel{1ms, kOrigin};
+    std::mt19937 rng{7};
+    std::uniform_int_distribution<int> delay{1, 20000};
+
+    std::vector<int> deadlines;
+    std::vector<int> fired;
+    std::vector<TimerWheel::TimerId> ids;
+    for (int index = 0; index < 2000; ++index) {
+        const int deadline = delay(rng);
+        deadlines.push_back(deadline);
+        ids.push_back(wheel.schedule_at(kOrigin + std::chrono::milliseconds{deadline}, [&fired, deadline] {
+            fired.push_back(deadline);
+        }));
+    }
+    for (std::size_t index = 0; index < ids.size(); index += 3) {
+        wheel.cancel(ids[index]);
+    }
+
+    int now = 0;
+    bool on_time = true;
+    while (!wheel.empty()) {
+        now += 13;
+        const auto before = fired.size();
+        wheel.advance(kOrigin + std::chrono::milliseconds{now});
+        for (auto index = before; index < fired.size(); ++index) {
+            on_time = on_time && fired[index] <= now && fired[index] > now - 13;
+        }
+    }
+    SOTC_CHECK(on_time);
+    SOTC_CHECK(fired.size() == deadlines.size() - (deadlines.size() + 2) / 3);
+}
+
+SOTC_TEST(wheel_next_expiry_reports_when_work_is_due) {
+    TimerWheel wheel{1ms, kOrigin};
+    SOTC_CHECK(!wheel.next_expiry());
+
+    wheel.schedule_at(kOrigin + 40ms, [] {});
+    SOTC_CHECK(wheel.next_expiry() == kOrigin + 40ms);
+
+    // Beyond level 0 the answer is the boundary each cascade happens at,
+    // one level at a time, then the deadline itself.
+    TimerWheel far{1ms, kOrigin};
+    far.schedule_at(kOrigin + 5000ms, [] {});
+    SOTC_CHECK(far.next_expiry() == kOrigin + 4096ms);
+    SOTC_CHECK(far.advance(kOrigin + 4096ms) == 0);
+    SOTC_CHECK(far.next_expiry() == kOrigin + 4992ms);
+    SOTC_CHECK(far.advance(kOrigin + 4992ms) == 0);
+    SOTC_CHECK(far.next_expiry() == kOrigin + 5000ms);
+    SOTC_CHECK(far.advance(kOrigin + 5000ms) == 1);
+    SOTC_CHECK(!far.next_expiry());
+}
+
+SOTC_TEST(wheel_sleeping_until_next_expiry_fires_every_timer_on_time) {
+    TimerWheel wheel{1ms, kOrigin};
+    std::mt19937 rng{11};
+    std::uniform_int_distribution<int> delay{0, 300000};
+
+    std::size_t late = 0;
+    std::size_t fired = 0;
+    TimerWheel::Clock::time_point now = kOrigin;
+    for (int index = 0; index < 500; ++index) {
+        const auto deadline = kOrigin + std::chrono::milliseconds{delay(rng)};
+        wheel.schedule_at(deadline, [&, deadline] {
+            ++fired;
+            if (now > deadline) {
+                ++late;
+            }
+        });
+    }
+    std::size_t wakes = 0;
+    while (const auto next = wheel.next_expiry()) {
+        SOTC_CHECK(*next >= now);
+        now = *next;
+        wheel.advance(now);
+        ++wakes;
+    }
+    SOTC_CHECK(fired == 500);
+    SOTC_CHECK(late == 0);
+    // At most one wake per timer and level, against the 300000 ticks a
+    // per-tick poll would take.
+    SOTC_CHECK(wakes <= 500 * TimerWheel::kLevels);
+}
+
+SOTC_TEST_MAIN()
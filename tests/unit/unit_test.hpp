@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sotc::test {
+
+struct TestCase {
+    std::string_view name;
+    std::function<void()> body;
+};
+
+inline std::vector<TestCase> &registry() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+inline int &failure_count() {
+    static int failures = 0;
+    return failures;
+}
+
+struct Registrar {
+    Registrar(std::string_view name, std::function<void()> body) {
+        registry().push_back(TestCase{name, std::move(body)});
+    }
+};
+
+inline void report_failure(std::string_view expression, const char *file, int line) {
+    ++failure_count();
+    std::cerr << file << ':' << line << ": check failed: " << expression << '\n';
+}
+
+inline int run_all() {
+    for (const auto &test : registry()) {
+        const int failures_before = failure_count();
+        try {
+            test.body();
+        } catch (const std::exception &error) {
+            ++failure_count();
+            std::cerr << test.name << ": unexpected exception: " << error.what() << '\n';
+        }
+        std::cout << (failure_count() == failures_before ? "[ PASS ] " : "[ FAIL ] ") << test.name << '\n';
+    }
+    return failure_count() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace sotc::test
+
+#define SOTC_TEST_CONCAT_INNER(a, b) a##b
+#define SOTC_TEST_CONCAT(a, b) SOTC_TEST_CONCAT_INNER(a, b)
+
+#define SOTC_TEST(name)                                                                          \
+    static void name();                                                                          \
+    static const ::sotc::test::Registrar SOTC_TEST_CONCAT(name, _registrar){#name, &name};       \
+    static void name()
+
+#define SOTC_CHECK(expression)                                                                   \
+    do {                                                                                         \
+        if (!(expression)) {                                                                     \
+            ::sotc::test::report_failure(#expression, __FILE__, __LINE__);                       \
+        }                                                                                        \
+    } while (false)
+
+#define SOTC_CHECK_THROWS(expression, exception_type)                                            \
+    do {                                                                                         \
+        bool sotc_caught = false;                                                                \
+        try {                                                                                    \
+            static_cast<void>(expression);                                                       \
+        } catch (const exception_type &) {                                                       \
+            sotc_caught = true;                                                                  \
+        }                                                                                        \
+        if (!sotc_caught) {                                                                      \
+            ::sotc::test::report_failure(#expression " throws " #exception_type, __FILE__, __LINE__); \
+        }                                                                                        \
+    } while (false)
+
+#define SOTC_TEST_MAIN()                                                                         \
+    int main() { return ::sotc::test::run_all(); }
@@ -0,0 +1,291 @@
+// Stand-in Game Coordinator for load and latency testing of the client's
+// network stack without reaching coordinator.openttd.org.
+
+#include "network/coordinator_fleet.hpp"
+#include "network/event_loop.hpp"
+#include "network/mock_coordinator.hpp"
+#include "network/socket.hpp"
+
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+
+namespace {
+
+using namespace std::chrono_literals;
+using sotc::network::EventLoop;
+
+volatile std::sig_atomic_t g_interrupted = 0;
+
+extern "C" void handle_interrupt(int) {
+    g_interrupted = 1;
+}
+
+struct ToolOptions {
+    std::string listen_host{"127.0.0.1"};
+    std::uint16_t listen_port{0};
+    sotc::network::MockCoordinatorOptions coordinator{};
+    double duration_seconds{0.0};
+    double report_interval_seconds{1.0};
+    std::size_t clients{0};
+    EventLoop::Clock::duration client_heartbeat{1s};
+    std::size_t listed_servers{0};
+};
+
+void print_help() {
+    std::cout << "sotc_mock_coordinator usage:\n"
+              << "  sotc_mock_coordinator [options]\n\n"
+              << "Options:\n"
+              << "  -h, --help                 Show this help message.\n"
+              << "      --listen HOST:PORT     Address to listen on (default 127.0.0.1:0, any free port).\n"
+              << "      --delay MS             Hold every reply back by MS milliseconds.\n"
+              << "      --delay-jitter MS      Add up to MS milliseconds of random extra delay.\n"
+              << "      --error-rate P         Reject this fraction (0-1) of registrations with GC_ERROR.\n"
+              << "      --error-code N         Error code sent with rejections (default 1).\n"
+              << "      --duration SECONDS     Exit after SECONDS (default: run until interrupted).\n"
+              << "      --report-interval S    Seconds between progress reports; 0 disables them.\n"
+              << "      --clients N            Also register N in-process servers against this coordinator.\n"
+              << "      --client-heartbeat MS  Heartbeat interval of the in-process servers (default 1000).\n"
+              << "      --listed-servers N     Answer CLIENT_LISTING with N synthetic servers.\n";
+}
+
+[[nodiscard]] std::optional<double> parse_number(std::string_view value) {
+    try {
+        std::size_t consumed = 0;
+        const double parsed = std::stod(std::string{value}, &consumed);
+        if (consumed != value.size() || parsed < 0.0) {
+            return std::nullopt;
+        }
+        return parsed;
+    } catch (const std::exception &) {
+        return std::nullopt;
+    }
+}
+
+[[nodiscard]] EventLoop::Clock::duration milliseconds(double value) {
+    return std::chrono::duration_cast<EventLoop::Clock::duration>(std::chrono::duration<double, std::milli>{value});
+}
+
+[[nodiscard]] bool parse_arguments(int argc, char **argv, ToolOptions &options, bool &show_help) {
+    for (int index = 1; index < argc; ++index) {
+        const std::string_view current{argv[index]};
+        if (current == "-h" || current == "--help") {
+            show_help = true;
+            return true;
+        }
+        if (index + 1 >= argc) {
+            std::cerr << "Missing value for option " << current << '\n';
+            return false;
+        }
+        const std::string_view value{argv[++index]};
+
+        if (current == "--listen") {
+            const auto colon = value.rfind(':');
+            const auto port = colon == std::string_view::npos ? std::nullopt : parse_number(value.substr(colon + 1));
+            if (!port || *port > 65535.0) {
+                std::cerr << "Invalid listen address: " << value << '\n';
+                return false;
+            }
+            auto host = value.substr(0, colon);
+            if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+                host = host.substr(1, host.size() - 2);
+            }
+            options.listen_host = std::string{host};
+            options.listen_port = static_cast<std::uint16_t>(*port);
+            continue;
+        }
+
+        const auto number = parse_number(value);
+        if (!number) {
+            std::cerr << "Invalid value for " << current << ": " << value << '\n';
+            return false;
+        }
+        if (current == "--delay") {
+            options.coordinator.delay = milliseconds(*number);
+        } else if (current == "--delay-jitter") {
+            options.coordinator.delay_jitter = milliseconds(*number);
+        } else if (current == "--error-rate" && *number <= 1.0) {
+            options.coordinator.error_rate = *number;
+        } else if (current == "--error-code" && *number <= 255.0) {
+            options.coordinator.error_code = static_cast<sotc::network::CoordinatorErrorCode>(*number);
+        } else if (current == "--duration") {
+            options.duration_seconds = *number;
+        } else if (current == "--report-interval") {
+            options.report_interval_seconds = *number;
+        } else if (current == "--clients") {
+            options.clients = static_cast<std::size_t>(*number);
+        } else if (current == "--client-heartbeat" && *number > 0.0) {
+            options.client_heartbeat = milliseconds(*number);
+        } else if (current == "--listed-servers") {
+            options.listed_servers = static_cast<std::size_t>(*number);
+        } else {
+            std::cerr << "Unknown option or invalid value: " << current << ' ' << value << '\n';
+            return false;
+        }
+    }
+    return true;
+}
+
+// Each in-process server holds two descriptors (client and accepted side).
+void raise_descriptor_limit() {
+    rlimit limit{};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+// Synthetic listing: servers draw overlapping NewGRF sets from a shared pool,
+// as real servers do, so the lookup table stays much smaller than the sum of
+// every server's GRF list.
+void publish_listing(sotc::network::MockCoordinator &coordinator, std::size_t count) {
+    constexpr std::size_t kGrfPool = 200;
+    std::vector<sotc::network::NewGrfIdentity> pool(kGrfPool);
+    for (std::size_t index = 0; index < kGrfPool; ++index) {
+        pool[index].grfid = static_cast<std::uint32_t>(0x4D4D0000U + index);
+        pool[index].md5[0] = static_cast<std::uint8_t>(index & 0xFFU);
+        static_cast<void>(coordinator.newgrf_table().intern(pool[index], "Mock NewGRF " + std::to_string(index)));
+    }
+
+    std::vector<sotc::network::ServerListingEntry> entries(count);
+    for (std::size_t index = 0; index < count; ++index) {
+        auto &entry = entries[index];
+        entry.connection_string = "192.0.2." + std::to_string(index % 250 + 1) + ':' + std::to_string(3979 + index);
+        entry.info.server_name = "Mock listed server " + std::to_string(index);
+        entry.info.server_revision = "14.1";
+        entry.info.clients_max = 25;
+        entry.info.clients_on = static_cast<std::uint8_t>(index % 26);
+        entry.info.companies_max = 15;
+        entry.info.companies_on = static_cast<std::uint8_t>(index % 16);
+        entry.info.map_width = 512;
+        entry.info.map_height = 512;
+        entry.info.dedicated = true;
+        for (std::size_t grf = 0; grf < index % 40; ++grf) {
+            entry.info.newgrfs.push_back(pool[(index * 7 + grf) % kGrfPool]);
+        }
+    }
+    coordinator.set_listing(std::move(entries));
+}
+
+[[nodiscard]] double to_ms(std::chrono::nanoseconds value) {
+    return std::chrono::duration<double, std::milli>(value).count();
+}
+
+void print_histogram(std::string_view prefix, const sotc::network::LatencyHistogram &histogram) {
+    std::cout << prefix << "_count=" << histogram.count() << '\n'
+              << prefix << "_p50_ms=" << to_ms(histogram.percentile(50)) << '\n'
+              << prefix << "_p90_ms=" << to_ms(histogram.percentile(90)) << '\n'
+              << prefix << "_p99_ms=" << to_ms(histogram.percentile(99)) << '\n'
+              << prefix << "_max_ms=" << to_ms(histogram.max()) << '\n';
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    ToolOptions options{};
+    bool show_help = false;
+    if (!parse_arguments(argc, argv, options, show_help)) {
+        return 1;
+    }
+    if (show_help) {
+        print_help();
+        return 0;
+    }
+
+    try {
+        const auto endpoints = sotc::network::resolve_endpoints(options.listen_host, options.listen_port);
+        if (endpoints.empty()) {
+            std::cerr << "Unable to resolve listen address " << options.listen_host << '\n';
+            return 1;
+        }
+        options.coordinator.listen = endpoints.front();
+        raise_descriptor_limit();
+
+        EventLoop loop;
+        sotc::network::MockCoordinator coordinator{loop, options.coordinator};
+        if (options.listed_servers > 0) {
+            publish_listing(coordinator, options.listed_servers);
+        }
+        std::cout << "listening=" << coordinator.endpoint().to_string() << std::endl;
+
+        sotc::network::CoordinatorFleet fleet{loop};
+        for (std::size_t index = 0; index < options.clients; ++index) {
+            sotc::network::RegistrationConfig config{};
+            config.server_name = "Mock load server " + std::to_string(index);
+            config.coordinator_host = options.listen_host;
+            config.coordinator_port = coordinator.endpoint().port();
+            config.listen_port = static_cast<std::uint16_t>(3979 + index % 60000);
+            fleet.add(std::move(config), options.client_heartbeat);
+        }
+
+        g_interrupted = 0;
+        std::signal(SIGINT, handle_interrupt);
+        std::signal(SIGTERM, handle_interrupt);
+
+        const auto started = EventLoop::Clock::now();
+        const auto report_interval = std::chrono::duration<double>{options.report_interval_seconds};
+        auto next_report = started + std::chrono::duration_cast<EventLoop::Clock::duration>(report_interval);
+        auto reported_requests = std::uint64_t{0};
+        fleet.start();
+
+        while (!g_interrupted) {
+            const auto now = EventLoop::Clock::now();
+            const auto elapsed = std::chrono::duration<double>{now - started}.count();
+            if (options.duration_seconds > 0.0 && elapsed >= options.duration_seconds) {
+                break;
+            }
+            if (options.report_interval_seconds > 0.0 && now >= next_report) {
+                const auto &stats = coordinator.stats();
+                const auto requests = stats.registrations + stats.updates;
+                std::cerr << "t=" << elapsed << "s connections=" << stats.connections_active
+                          << " registered=" << fleet.count(sotc::network::SessionState::Registered)
+                          << " requests/s=" << static_cast<double>(requests - reported_requests) /
+                                                   options.report_interval_seconds
+                          << " service_p99_ms=" << to_ms(stats.service_latency.percentile(99)) << std::endl;
+                reported_requests = requests;
+                next_report += std::chrono::duration_cast<EventLoop::Clock::duration>(report_interval);
+            }
+            loop.run_once(50ms);
+        }
+
+        const auto elapsed = std::chrono::duration<double>{EventLoop::Clock::now() - started}.count();
+        const auto &stats = coordinator.stats();
+        std::cout << "elapsed_seconds=" << elapsed << '\n'
+                  << "connections_accepted=" << stats.connections_accepted << '\n'
+                  << "registrations=" << stats.registrations << '\n'
+                  << "resumed=" << stats.resumed << '\n'
+                  << "updates=" << stats.updates << '\n'
+                  << "listings=" << stats.listings << '\n'
+                  << "newgrf_lookup_entries_sent=" << stats.newgrf_lookup_entries_sent << '\n'
+                  << "errors_sent=" << stats.errors_sent << '\n'
+                  << "malformed=" << stats.malformed << '\n'
+                  << "bytes_received=" << stats.bytes_received << '\n'
+                  << "bytes_sent=" << stats.bytes_sent << '\n'
+                  << "requests_per_second="
+                  << (elapsed > 0.0 ? static_cast<double>(stats.registrations + stats.updates) / elapsed : 0.0)
+                  << '\n';
+        print_histogram("service_latency", stats.service_latency);
+        if (options.clients > 0) {
+            std::cout << "clients_registered=" << fleet.count(sotc::network::SessionState::Registered) << '\n'
+                      << "clients_failed=" << fleet.count(sotc::network::SessionState::Failed) << '\n';
+            print_histogram("client_ack_latency", fleet.ack_latency());
+            print_histogram("client_heartbeat_jitter", fleet.heartbeat_jitter());
+        }
+        std::cout.flush();
+        fleet.close();
+    } catch (const std::exception &error) {
+        std::cerr << "sotc_mock_coordinator: " << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
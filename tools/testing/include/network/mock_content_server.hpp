@@ -0,0 +1,99 @@
+#pragma once
+
+#include "network/event_loop.hpp"
+#include "network/socket.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sotc::network {
+
+struct MockContentServerOptions {
+    Endpoint listen{loopback_endpoint(0)};
+    // When non-zero, the first response for every path is cut off after this
+    // many body bytes by closing the connection, as a dropped transfer would.
+    std::size_t truncate_first_response_after{0};
+    // Answer range requests with the whole file, like servers without
+    // byte-range support.
+    bool ignore_range{false};
+    // Body bytes written per writable event; small values spread a response
+    // over many loop iterations.
+    std::size_t chunk_size{16 * 1024};
+};
+
+struct MockContentServerStats {
+    std::uint64_t connections_accepted{0};
+    std::uint64_t requests{0};
+    // Requests carrying a Range header, whether or not it was honoured.
+    std::uint64_t range_requests{0};
+    std::uint64_t not_found{0};
+    std::uint64_t truncated{0};
+    std::uint64_t malformed{0};
+    std::uint64_t body_bytes_sent{0};
+    // Responses being written at the same time, at most.
+    std::size_t peak_active_responses{0};
+};
+
+// Loopback HTTP/1.1 stand-in for a content server. Serves the bodies passed
+// to add() to GET requests with keep-alive and "Range: bytes=N-" support, so
+// downloads, resumes and connection limits can be tested without a network.
+class MockContentServer {
+public:
+    MockContentServer(EventLoop &loop, MockContentServerOptions options = {});
+    ~MockContentServer();
+
+    MockContentServer(const MockContentServer &) = delete;
+    MockContentServer &operator=(const MockContentServer &) = delete;
+
+    // path must start with '/'.
+    void add(std::string path, std::vector<std::byte> body);
+    [[nodiscard]] std::string url(const std::string &path) const;
+
+    [[nodiscard]] const Endpoint &endpoint() const noexcept { return endpoint_; }
+    [[nodiscard]] const MockContentServerStats &stats() const noexcept { return stats_; }
+
+private:
+    struct Connection {
+        explicit Connection(SocketHandle handle) : socket(std::move(handle)) {}
+
+        SocketHandle socket;
+        std::string request{};
+        std::string header{};
+        std::size_t header_offset{0};
+        std::shared_ptr<const std::vector<std::byte>> body{};
+        std::size_t body_offset{0};
+        std::size_t body_end{0};
+        bool truncate{false};
+        bool responding{false};
+        bool watching_writable{false};
+    };
+
+    void accept_all();
+    void on_io(int fd, std::uint32_t events);
+    void on_readable(Connection &connection);
+    // Starts the response to the request at the front of the buffer, if it
+    // is complete.
+    void handle_request(Connection &connection);
+    void respond(Connection &connection, int status, std::string extra_headers,
+                 std::shared_ptr<const std::vector<std::byte>> body, std::size_t begin);
+    void flush(Connection &connection);
+    void finish_response(Connection &connection);
+    void drop(int fd) noexcept;
+
+    EventLoop &loop_;
+    MockContentServerOptions options_;
+    SocketHandle listener_{};
+    Endpoint endpoint_{};
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_{};
+    std::unordered_map<std::string, std::shared_ptr<const std::vector<std::byte>>> files_{};
+    std::unordered_set<std::string> truncated_paths_{};
+    std::size_t active_responses_{0};
+    MockContentServerStats stats_{};
+};
+
+} // namespace sotc::network
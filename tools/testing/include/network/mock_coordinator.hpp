@@ -0,0 +1,124 @@
+#pragma once
+
+#include "network/coordinator_protocol.hpp"
+#include "network/event_loop.hpp"
+#include "network/latency_histogram.hpp"
+#include "network/packet_framer.hpp"
+#include "network/server_listing.hpp"
+#include "network/socket.hpp"
+#include "network/timer_wheel.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sotc::network {
+
+struct MockCoordinatorOptions {
+    Endpoint listen{loopback_endpoint(0)};
+    // Every reply is held back by delay plus a uniformly distributed extra of
+    // up to delay_jitter.
+    EventLoop::Clock::duration delay{};
+    EventLoop::Clock::duration delay_jitter{};
+    // Probability in [0, 1] that a SERVER_REGISTER is answered with GC_ERROR
+    // carrying error_code instead of an acknowledgement.
+    double error_rate{0.0};
+    CoordinatorErrorCode error_code{CoordinatorErrorCode::RegistrationFailed};
+    std::size_t max_packet_size{4 * NETWORK_COMPAT_MTU};
+    std::uint32_t seed{0x5eed};
+};
+
+struct MockCoordinatorStats {
+    std::uint64_t connections_accepted{0};
+    std::uint64_t connections_active{0};
+    std::uint64_t registrations{0};
+    // Registrations that presented a server invite code and were given it back.
+    std::uint64_t resumed{0};
+    std::uint64_t updates{0};
+    std::uint64_t listings{0};
+    // Lookup table entries sent with listings; a client that keeps its table
+    // only receives entries added since its previous listing.
+    std::uint64_t newgrf_lookup_entries_sent{0};
+    std::uint64_t errors_sent{0};
+    std::uint64_t malformed{0};
+    std::uint64_t bytes_received{0};
+    std::uint64_t bytes_sent{0};
+    // Time from a packet being framed to its reply being written, including
+    // the configured delay.
+    LatencyHistogram service_latency{};
+};
+
+// Stand-in Game Coordinator for load and latency testing. Accepts the
+// coordinator TCP framing on an EventLoop, validates every SERVER_REGISTER and
+// SERVER_UPDATE as a CoordinatorHandshakeFrame and answers with
+// GC_REGISTER_ACK or GC_ERROR after the configured delay. CLIENT_LISTING is
+// answered immediately with the NewGRF lookup delta and the servers passed to
+// set_listing().
+class MockCoordinator {
+public:
+    MockCoordinator(EventLoop &loop, MockCoordinatorOptions options = {});
+    ~MockCoordinator();
+
+    MockCoordinator(const MockCoordinator &) = delete;
+    MockCoordinator &operator=(const MockCoordinator &) = delete;
+
+    [[nodiscard]] const Endpoint &endpoint() const noexcept { return endpoint_; }
+    [[nodiscard]] const MockCoordinatorStats &stats() const noexcept { return stats_; }
+    void reset_latency() noexcept { stats_.service_latency.reset(); }
+
+    // Servers returned by CLIENT_LISTING. NewGRFs not yet in newgrf_table()
+    // are added to it without a name.
+    void set_listing(std::vector<ServerListingEntry> entries);
+    [[nodiscard]] NewGrfLookupTable &newgrf_table() noexcept { return newgrf_table_; }
+
+private:
+    using Clock = EventLoop::Clock;
+
+    struct Connection {
+        explicit Connection(SocketHandle handle, std::size_t max_packet_size)
+            : socket(std::move(handle)), framer(max_packet_size, max_packet_size) {}
+
+        SocketHandle socket;
+        PacketFramer framer;
+        std::vector<std::byte> outbound{};
+        std::size_t outbound_offset{0};
+        bool watching_writable{false};
+        std::uint64_t generation{0};
+        std::string invite_code{};
+    };
+
+    void accept_all();
+    void on_io(int fd, std::uint32_t events);
+    void on_readable(Connection &connection);
+    void handle_packet(Connection &connection, const FramedPacket &packet);
+    void reply_listing(Connection &connection, std::span<const std::byte> payload);
+    void reply(int fd, std::uint64_t generation, bool reject, Clock::time_point received);
+    void flush(Connection &connection);
+    void drop(int fd) noexcept;
+    void arm_wheel();
+
+    EventLoop &loop_;
+    MockCoordinatorOptions options_;
+    SocketHandle listener_{};
+    Endpoint endpoint_{};
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_{};
+    std::uint64_t next_generation_{1};
+    std::uint64_t next_invite_code_{1};
+    TimerWheel delays_{std::chrono::milliseconds{1}};
+    EventLoop::TimerId wheel_timer_{0};
+    std::mt19937 rng_;
+    std::vector<std::byte> scratch_{};
+    NewGrfLookupTable newgrf_table_{};
+    std::vector<ServerListingEntry> listing_{};
+    std::vector<std::vector<std::byte>> listing_payloads_{};
+    MockCoordinatorStats stats_{};
+};
+
+} // namespace sotc::network
@@ -0,0 +1,338 @@
+#include "network/mock_content_server.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include <sys/socket.h>
+
+namespace sotc::network {
+
+namespace {
+
+// Requests are a request line and a few headers; anything larger is garbage.
+constexpr std::size_t kMaxRequestSize = 8 * 1024;
+
+struct ByteRange {
+    std::size_t begin{0};
+    std::optional<std::size_t> last{};
+};
+
+[[nodiscard]] bool iequals(std::string_view left, std::string_view right) noexcept {
+    return left.size() == right.size() && std::equal(left.begin(), left.end(), right.begin(), [](char a, char b) {
+               return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+           });
+}
+
+[[nodiscard]] std::optional<std::size_t> parse_size(std::string_view text) noexcept {
+    std::size_t value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc{} || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// "bytes=N-" or "bytes=N-M"; suffix and multi-part ranges are not needed.
+[[nodiscard]] std::optional<ByteRange> parse_range(std::string_view value) noexcept {
+    constexpr std::string_view prefix = "bytes=";
+    if (!value.starts_with(prefix)) {
+        return std::nullopt;
+    }
+    value.remove_prefix(prefix.size());
+    const auto dash = value.find('-');
+    if (dash == std::string_view::npos) {
+        return std::nullopt;
+    }
+    const auto begin = parse_size(value.substr(0, dash));
+    if (!begin) {
+        return std::nullopt;
+    }
+    ByteRange range{*begin, std::nullopt};
+    if (dash + 1 < value.size()) {
+        range.last = parse_size(value.substr(dash + 1));
+        if (!range.last || *range.last < range.begin) {
+            return std::nullopt;
+        }
+    }
+    return range;
+}
+
+} // namespace
+
+MockContentServer::MockContentServer(EventLoop &loop, MockContentServerOptions options)
+    : loop_(loop), options_(std::move(options)) {
+    options_.chunk_size = std::max<std::size_t>(options_.chunk_size, 1);
+    listener_ = listen_nonblocking(options_.listen);
+    endpoint_ = local_endpoint(listener_.get());
+    loop_.add(listener_.get(), EventLoop::kReadable, [this](std::uint32_t) { accept_all(); });
+}
+
+MockContentServer::~MockContentServer() {
+    for (auto &[fd, connection] : connections_) {
+        loop_.remove(fd);
+    }
+    loop_.remove(listener_.get());
+}
+
+void MockContentServer::add(std::string path, std::vector<std::byte> body) {
+    files_[std::move(path)] = std::make_shared<const std::vector<std::byte>>(std::move(body));
+}
+
+std::string MockContentServer::url(const std::string &path) const {
+    return "http://" + endpoint_.to_string() + path;
+}
+
+void MockContentServer::accept_all() {
+    while (true) {
+        SocketHandle client{::accept4(listener_.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)};
+        if (!client) {
+            return;
+        }
+        set_no_delay(client.get());
+        const int fd = client.get();
+        connections_[fd] = std::make_unique<Connection>(std::move(client));
+        loop_.add(fd, EventLoop::kReadable, [this, fd](std::uint32_t events) { on_io(fd, events); });
+        ++stats_.connections_accepted;
+    }
+}
+
+void MockContentServer::on_io(int fd, std::uint32_t events) {
+    const auto found = connections_.find(fd);
+    if (found == connections_.end()) {
+        return;
+    }
+    auto &connection = *found->second;
+    if (events & EventLoop::kError) {
+        drop(fd);
+        return;
+    }
+    if (events & EventLoop::kWritable) {
+        flush(connection);
+        if (!connections_.contains(fd)) {
+            return;
+        }
+    }
+    if (events & (EventLoop::kReadable | EventLoop::kHangup)) {
+        on_readable(connection);
+    }
+}
+
+void MockContentServer::on_readable(Connection &connection) {
+    const int fd = connection.socket.get();
+    char buffer[4096];
+    while (true) {
+        const auto received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                drop(fd);
+                return;
+            }
+            break;
+        }
+        if (received == 0) {
+            drop(fd);
+            return;
+        }
+        connection.request.append(buffer, static_cast<std::size_t>(received));
+        if (connection.request.size() > kMaxRequestSize) {
+            ++stats_.malformed;
+            drop(fd);
+            return;
+        }
+    }
+    if (!connection.responding) {
+        handle_request(connection);
+    }
+}
+
+void MockContentServer::handle_request(Connection &connection) {
+    const auto end = connection.request.find("\r\n\r\n");
+    if (end == std::string::npos) {
+        return;
+    }
+    const std::string request = connection.request.substr(0, end);
+    connection.request.erase(0, end + 4);
+
+    const std::string_view text{request};
+    const auto line_end = text.find("\r\n");
+    const auto request_line = text.substr(0, line_end);
+    const auto first_space = request_line.find(' ');
+    const auto second_space = request_line.rfind(' ');
+    if (first_space == std::string_view::npos || second_space <= first_space ||
+        request_line.substr(0, first_space) != "GET") {
+        ++stats_.malformed;
+        drop(connection.socket.get());
+        return;
+    }
+    const std::string path{request_line.substr(first_space + 1, second_space - first_space - 1)};
+    ++stats_.requests;
+
+    std::optional<ByteRange> range;
+    bool has_range = false;
+    auto headers = line_end == std::string_view::npos ? std::string_view{} : text.substr(line_end + 2);
+    while (!headers.empty()) {
+        const auto next = headers.find("\r\n");
+        const auto header = headers.substr(0, next);
+        headers = next == std::string_view::npos ? std::string_view{} : headers.substr(next + 2);
+        const auto colon = header.find(':');
+        if (colon == std::string_view::npos || !iequals(header.substr(0, colon), "range")) {
+            continue;
+        }
+        auto value = header.substr(colon + 1);
+        value.remove_prefix(std::min(value.find_first_not_of(' '), value.size()));
+        has_range = true;
+        range = parse_range(value);
+    }
+    if (has_range) {
+        ++stats_.range_requests;
+    }
+
+    const auto file = files_.find(path);
+    if (file == files_.end()) {
+        ++stats_.not_found;
+        respond(connection, 404, {}, nullptr, 0);
+        flush(connection);
+        return;
+    }
+    const auto &body = file->second;
+    if (!has_range || options_.ignore_range) {
+        respond(connection, 200, "Accept-Ranges: bytes\r\n", body, 0);
+    } else if (!range || range->begin >= body->size()) {
+        respond(connection, 416, "Content-Range: bytes */" + std::to_string(body->size()) + "\r\n", nullptr, 0);
+    } else {
+        const auto last = std::min(range->last.value_or(body->size() - 1), body->size() - 1);
+        respond(connection, 206,
+                "Content-Range: bytes " + std::to_string(range->begin) + '-' + std::to_string(last) + '/' +
+                    std::to_string(body->size()) + "\r\n",
+                body, range->begin);
+        connection.body_end = last + 1;
+    }
+
+    if (connection.body && options_.truncate_first_response_after != 0 &&
+        connection.body_end - connection.body_offset > options_.truncate_first_response_after &&
+        truncated_paths_.insert(path).second) {
+        connection.truncate = true;
+        connection.body_end = connection.body_offset + options_.truncate_first_response_after;
+    }
+    flush(connection);
+}
+
+void MockContentServer::respond(Connection &connection, int status, std::string extra_headers,
+                                std::shared_ptr<const std::vector<std::byte>> body, std::size_t begin) {
+    std::string_view reason = "OK";
+    switch (status) {
+    case 206:
+        reason = "Partial Content";
+        break;
+    case 404:
+        reason = "Not Found";
+        break;
+    case 416:
+        reason = "Range Not Satisfiable";
+        break;
+    default:
+        break;
+    }
+    const auto length = body ? body->size() - begin : 0;
+    connection.header = "HTTP/1.1 " + std::to_string(status) + ' ' + std::string{reason} + "\r\n" +
+                        "Content-Type: application/octet-stream\r\n" + "Content-Length: " + std::to_string(length) +
+                        "\r\n" + extra_headers + "\r\n";
+    connection.header_offset = 0;
+    connection.body = std::move(body);
+    connection.body_offset = begin;
+    connection.body_end = begin + length;
+    connection.truncate = false;
+    connection.responding = true;
+    ++active_responses_;
+    stats_.peak_active_responses = std::max(stats_.peak_active_responses, active_responses_);
+}
+
+void MockContentServer::flush(Connection &connection) {
+    const int fd = connection.socket.get();
+    while (connection.header_offset < connection.header.size()) {
+        const auto sent = ::send(fd, connection.header.data() + connection.header_offset,
+                                 connection.header.size() - connection.header_offset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                drop(fd);
+                return;
+            }
+            break;
+        }
+        connection.header_offset += static_cast<std::size_t>(sent);
+    }
+
+    std::size_t budget = options_.chunk_size;
+    while (connection.header_offset == connection.header.size() && connection.body_offset < connection.body_end &&
+           budget > 0) {
+        const auto size = std::min(budget, connection.body_end - connection.body_offset);
+        const auto sent = ::send(fd, connection.body->data() + connection.body_offset, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                drop(fd);
+                return;
+            }
+            break;
+        }
+        connection.body_offset += static_cast<std::size_t>(sent);
+        stats_.body_bytes_sent += static_cast<std::uint64_t>(sent);
+        budget -= static_cast<std::size_t>(sent);
+    }
+
+    const bool done = connection.header_offset == connection.header.size() &&
+                      connection.body_offset == connection.body_end;
+    if (done) {
+        if (connection.truncate) {
+            ++stats_.truncated;
+            drop(fd);
+            return;
+        }
+        finish_response(connection);
+        return;
+    }
+    if (!connection.watching_writable) {
+        loop_.modify(fd, EventLoop::kReadable | EventLoop::kWritable);
+        connection.watching_writable = true;
+    }
+}
+
+void MockContentServer::finish_response(Connection &connection) {
+    connection.responding = false;
+    connection.header.clear();
+    connection.body.reset();
+    --active_responses_;
+    if (connection.watching_writable) {
+        loop_.modify(connection.socket.get(), EventLoop::kReadable);
+        connection.watching_writable = false;
+    }
+    // A keep-alive client may already have sent its next request.
+    handle_request(connection);
+}
+
+void MockContentServer::drop(int fd) noexcept {
+    const auto found = connections_.find(fd);
+    if (found == connections_.end()) {
+        return;
+    }
+    if (found->second->responding) {
+        --active_responses_;
+    }
+    loop_.remove(fd);
+    connections_.erase(found);
+}
+
+} // namespace sotc::network
@@ -0,0 +1,298 @@
+#include "network/mock_coordinator.hpp"
+
+#include "network/coordinator_client.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <span>
+
+#include <sys/socket.h>
+
+namespace sotc::network {
+
+namespace {
+
+// Appends one framed packet to outbound, serialising the payload in place.
+template <typename Packet>
+void append_packet(std::vector<std::byte> &outbound, PacketCoordinatorType type, const Packet &packet) {
+    const auto payload_size = packet.serialized_size();
+    const auto start = outbound.size();
+    outbound.resize(start + NETWORK_PACKET_HEADER_SIZE + payload_size);
+    const std::span<std::byte> frame{outbound.data() + start, NETWORK_PACKET_HEADER_SIZE + payload_size};
+    write_packet_header(frame, static_cast<std::uint8_t>(type), payload_size);
+    packet.serialize_into(frame.subspan(NETWORK_PACKET_HEADER_SIZE));
+}
+
+void append_payload(std::vector<std::byte> &outbound, PacketCoordinatorType type, std::span<const std::byte> payload) {
+    const auto start = outbound.size();
+    outbound.resize(start + NETWORK_PACKET_HEADER_SIZE + payload.size());
+    write_packet_header(std::span<std::byte>{outbound}.subspan(start), static_cast<std::uint8_t>(type), payload.size());
+    std::memcpy(outbound.data() + start + NETWORK_PACKET_HEADER_SIZE, payload.data(), payload.size());
+}
+
+} // namespace
+
+MockCoordinator::MockCoordinator(EventLoop &loop, MockCoordinatorOptions options)
+    : loop_(loop), options_(options), rng_(options_.seed) {
+    listener_ = listen_nonblocking(options_.listen, 4096);
+    endpoint_ = local_endpoint(listener_.get());
+    loop_.add(listener_.get(), EventLoop::kReadable, [this](std::uint32_t) { accept_all(); });
+}
+
+MockCoordinator::~MockCoordinator() {
+    loop_.cancel(wheel_timer_);
+    for (auto &[fd, connection] : connections_) {
+        loop_.remove(fd);
+    }
+    loop_.remove(listener_.get());
+}
+
+void MockCoordinator::accept_all() {
+    while (true) {
+        SocketHandle client{::accept4(listener_.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)};
+        if (!client) {
+            // EAGAIN ends the batch; EMFILE and friends leave the backlog for
+            // the next readiness notification.
+            return;
+        }
+        set_no_delay(client.get());
+        const int fd = client.get();
+        auto connection = std::make_unique<Connection>(std::move(client), options_.max_packet_size);
+        connection->generation = next_generation_++;
+        connections_[fd] = std::move(connection);
+        loop_.add(fd, EventLoop::kReadable, [this, fd](std::uint32_t events) { on_io(fd, events); });
+        ++stats_.connections_accepted;
+        ++stats_.connections_active;
+    }
+}
+
+void MockCoordinator::on_io(int fd, std::uint32_t events) {
+    const auto found = connections_.find(fd);
+    if (found == connections_.end()) {
+        return;
+    }
+    auto &connection = *found->second;
+    if (events & (EventLoop::kError | EventLoop::kHangup)) {
+        drop(fd);
+        return;
+    }
+    if (events & EventLoop::kWritable) {
+        flush(connection);
+        if (!connections_.contains(fd)) {
+            return;
+        }
+    }
+    if (events & EventLoop::kReadable) {
+        on_readable(connection);
+    }
+}
+
+void MockCoordinator::on_readable(Connection &connection) {
+    const int fd = connection.socket.get();
+    while (true) {
+        auto region = connection.framer.prepare();
+        if (region.empty()) {
+            ++stats_.malformed;
+            drop(fd);
+            return;
+        }
+        const auto received = ::recv(fd, region.data(), region.size(), 0);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                drop(fd);
+            }
+            return;
+        }
+        if (received == 0) {
+            drop(fd);
+            return;
+        }
+        stats_.bytes_received += static_cast<std::uint64_t>(received);
+        connection.framer.commit(static_cast<std::size_t>(received));
+
+        const auto generation = connection.generation;
+        while (const auto packet = connection.framer.front()) {
+            handle_packet(connection, *packet);
+            // Replies may fail the connection; stop touching it if so.
+            const auto current = connections_.find(fd);
+            if (current == connections_.end() || current->second->generation != generation) {
+                return;
+            }
+            connection.framer.pop_front();
+        }
+        if (connection.framer.failed()) {
+            ++stats_.malformed;
+            drop(fd);
+            return;
+        }
+    }
+}
+
+void MockCoordinator::handle_packet(Connection &connection, const FramedPacket &packet) {
+    const auto received = Clock::now();
+    const auto type = static_cast<PacketCoordinatorType>(packet.type);
+    if (type == PacketCoordinatorType::ClientListing) {
+        reply_listing(connection, packet.linearize(scratch_));
+        return;
+    }
+    if (type != PacketCoordinatorType::ServerRegister && type != PacketCoordinatorType::ServerUpdate) {
+        return;
+    }
+    const auto frame = CoordinatorHandshakeFrameView::try_parse(packet.linearize(scratch_));
+    if (!frame) {
+        ++stats_.malformed;
+        drop(connection.socket.get());
+        return;
+    }
+
+    bool reject = false;
+    if (type == PacketCoordinatorType::ServerRegister) {
+        ++stats_.registrations;
+        reject = options_.error_rate > 0.0 && std::uniform_real_distribution<double>{0.0, 1.0}(rng_) < options_.error_rate;
+        // Server invite codes start with '+'; one presented again is handed
+        // back instead of a fresh code, like a resumed registration.
+        if (!reject && connection.invite_code.empty() && frame->invite_code().starts_with('+')) {
+            connection.invite_code = frame->invite_code();
+            ++stats_.resumed;
+        }
+    } else {
+        ++stats_.updates;
+    }
+
+    auto delay = options_.delay;
+    if (options_.delay_jitter > Clock::duration::zero()) {
+        delay += Clock::duration{
+            std::uniform_int_distribution<Clock::rep>{0, options_.delay_jitter.count()}(rng_)};
+    }
+
+    const int fd = connection.socket.get();
+    const auto generation = connection.generation;
+    if (delay <= Clock::duration::zero()) {
+        reply(fd, generation, reject, received);
+        return;
+    }
+    delays_.schedule_at(received + delay, [this, fd, generation, reject, received] {
+        reply(fd, generation, reject, received);
+    });
+    arm_wheel();
+}
+
+void MockCoordinator::set_listing(std::vector<ServerListingEntry> entries) {
+    for (const auto &entry : entries) {
+        for (const auto &identity : entry.info.newgrfs) {
+            static_cast<void>(newgrf_table_.intern(identity, {}));
+        }
+    }
+    listing_ = std::move(entries);
+    listing_payloads_.clear();
+}
+
+void MockCoordinator::reply_listing(Connection &connection, std::span<const std::byte> payload) {
+    const auto request = CoordinatorClientListing::try_deserialize(payload);
+    if (!request) {
+        ++stats_.malformed;
+        drop(connection.socket.get());
+        return;
+    }
+    ++stats_.listings;
+
+    const auto since = std::min(request->newgrf_lookup_cursor, newgrf_table_.cursor());
+    for (const auto &lookup : serialize_newgrf_lookup(newgrf_table_, since)) {
+        append_payload(connection.outbound, PacketCoordinatorType::GcNewGrfLookup, lookup);
+    }
+    stats_.newgrf_lookup_entries_sent += newgrf_table_.cursor() - since;
+
+    if (listing_payloads_.empty()) {
+        listing_payloads_ = serialize_listing(listing_, newgrf_table_);
+    }
+    for (const auto &listing : listing_payloads_) {
+        append_payload(connection.outbound, PacketCoordinatorType::GcListing, listing);
+    }
+    flush(connection);
+}
+
+void MockCoordinator::reply(int fd, std::uint64_t generation, bool reject, Clock::time_point received) {
+    const auto found = connections_.find(fd);
+    if (found == connections_.end() || found->second->generation != generation) {
+        return;
+    }
+    auto &connection = *found->second;
+
+    if (reject) {
+        const CoordinatorErrorPacket error{static_cast<std::uint8_t>(options_.error_code),
+                                           "rejected by mock coordinator"};
+        append_packet(connection.outbound, PacketCoordinatorType::GcError, error);
+        ++stats_.errors_sent;
+    } else {
+        if (connection.invite_code.empty()) {
+            char code[16]{};
+            std::snprintf(code, sizeof(code), "+M%07llX", static_cast<unsigned long long>(next_invite_code_++));
+            connection.invite_code = code;
+        }
+        const CoordinatorRegisterAck ack{connection.invite_code, "mock-secret",
+                                         static_cast<std::uint8_t>(ConnectionType::Direct)};
+        append_packet(connection.outbound, PacketCoordinatorType::GcRegisterAck, ack);
+    }
+    stats_.service_latency.record(Clock::now() - received);
+    flush(connection);
+}
+
+void MockCoordinator::flush(Connection &connection) {
+    const int fd = connection.socket.get();
+    while (connection.outbound_offset < connection.outbound.size()) {
+        const auto sent = ::send(fd, connection.outbound.data() + connection.outbound_offset,
+                                 connection.outbound.size() - connection.outbound_offset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                drop(fd);
+                return;
+            }
+            break;
+        }
+        connection.outbound_offset += static_cast<std::size_t>(sent);
+        stats_.bytes_sent += static_cast<std::uint64_t>(sent);
+    }
+
+    if (connection.outbound_offset == connection.outbound.size()) {
+        connection.outbound.clear();
+        connection.outbound_offset = 0;
+    }
+    const bool want_writable = !connection.outbound.empty();
+    if (want_writable != connection.watching_writable) {
+        loop_.modify(fd, EventLoop::kReadable | (want_writable ? EventLoop::kWritable : 0U));
+        connection.watching_writable = want_writable;
+    }
+}
+
+void MockCoordinator::drop(int fd) noexcept {
+    const auto found = connections_.find(fd);
+    if (found == connections_.end()) {
+        return;
+    }
+    loop_.remove(fd);
+    connections_.erase(found);
+    --stats_.connections_active;
+}
+
+void MockCoordinator::arm_wheel() {
+    if (wheel_timer_ != 0) {
+        return;
+    }
+    wheel_timer_ = loop_.schedule_after(delays_.tick(), [this] {
+        wheel_timer_ = 0;
+        delays_.advance(Clock::now());
+        if (!delays_.empty()) {
+            arm_wheel();
+        }
+    });
+}
+
+} // namespace sotc::network